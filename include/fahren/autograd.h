@@ -0,0 +1,97 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Reverse-mode automatic differentiation for custom losses and heads.
+ * A tape records every operation applied to its variables (2-D row-major
+ * float matrices) together with the forward value, which it computes on
+ * the spot. fahren_tape_backward then walks the records in reverse from a
+ * scalar and adds d(loss)/d(param) into the gradient buffers of the
+ * parameters that lead to it:
+ *
+ *   fahren_tape_param(tape, w, dw, in, out, &W);
+ *   fahren_tape_param(tape, b, db, 1, out, &B);
+ *   fahren_tape_constant(tape, x, batch, in, &X);
+ *   fahren_tape_matmul(tape, X, W, &h);
+ *   fahren_tape_add(tape, h, B, &h);           // B broadcasts over rows
+ *   fahren_tape_softmax_xent(tape, h, labels, &loss);
+ *   fahren_tape_backward(tape, loss);          // dw, db += gradients
+ *   fahren_tape_reset(tape);                   // O(1), ready for the next step
+ *
+ * All values and gradients live in one arena sized at creation, so a
+ * training step allocates nothing; an op that would overflow it fails
+ * with FAHREN_ERROR_PROCESSING_FAILED. Gradients of intermediate results
+ * exist only during backward: each buffer is taken when the first
+ * gradient reaches its variable and recycled as soon as that variable's
+ * own backward step has run, so peak gradient memory follows the widest
+ * point of the graph rather than its length. Parameters and constants
+ * are not copied; their buffers must stay valid until the next reset. */
+#ifndef FAHREN_AUTOGRAD_H
+#define FAHREN_AUTOGRAD_H
+
+#include <stddef.h>
+
+#include <fahren/fahren.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FAHRENTape FAHRENTape;
+typedef size_t FAHRENVar; /* handle, valid until the next reset */
+
+/* A tape holding up to `max_vars` variables and `arena_bytes` of values,
+ * gradients and op scratch. */
+FAHRENStatus fahren_tape_create(size_t max_vars, size_t arena_bytes, FAHRENTape** out);
+void fahren_tape_destroy(FAHRENTape* tape);
+
+/* Forget every variable. O(1); the arena is kept. */
+void fahren_tape_reset(FAHRENTape* tape);
+
+/* Leaves. A parameter's gradient is accumulated into `grad` (rows x
+ * cols, not cleared by the tape); a constant gets none. */
+FAHRENStatus fahren_tape_param(FAHRENTape* tape, const float* value, float* grad, size_t rows, size_t cols,
+                               FAHRENVar* out);
+FAHRENStatus fahren_tape_constant(FAHRENTape* tape, const float* value, size_t rows, size_t cols, FAHRENVar* out);
+
+const float* fahren_tape_value(const FAHRENTape* tape, FAHRENVar v);
+void fahren_tape_shape(const FAHRENTape* tape, FAHRENVar v, size_t* rows, size_t* cols);
+
+/* Elementwise over equal shapes; for add and sub `b` may also be a single
+ * row (1 x cols), which is broadcast over the rows of `a`. */
+FAHRENStatus fahren_tape_add(FAHRENTape* tape, FAHRENVar a, FAHRENVar b, FAHRENVar* out);
+FAHRENStatus fahren_tape_sub(FAHRENTape* tape, FAHRENVar a, FAHRENVar b, FAHRENVar* out);
+FAHRENStatus fahren_tape_mul(FAHRENTape* tape, FAHRENVar a, FAHRENVar b, FAHRENVar* out);
+FAHRENStatus fahren_tape_scale(FAHRENTape* tape, FAHRENVar a, float s, FAHRENVar* out);
+
+/* (m x k) * (k x n) */
+FAHRENStatus fahren_tape_matmul(FAHRENTape* tape, FAHRENVar a, FAHRENVar b, FAHRENVar* out);
+
+FAHRENStatus fahren_tape_activation(FAHRENTape* tape, FAHRENVar a, FAHRENActivation act, FAHRENVar* out);
+FAHRENStatus fahren_tape_exp(FAHRENTape* tape, FAHRENVar a, FAHRENVar* out);
+FAHRENStatus fahren_tape_log(FAHRENTape* tape, FAHRENVar a, FAHRENVar* out);
+
+/* Reductions to a 1 x 1 variable. */
+FAHRENStatus fahren_tape_sum(FAHRENTape* tape, FAHRENVar a, FAHRENVar* out);
+FAHRENStatus fahren_tape_mean(FAHRENTape* tape, FAHRENVar a, FAHRENVar* out);
+/* Mean over rows of the cross-entropy of softmax(logits row) against
+ * labels[row]; `labels` must stay valid until backward. */
+FAHRENStatus fahren_tape_softmax_xent(FAHRENTape* tape, FAHRENVar logits, const int* labels, FAHRENVar* out);
+/* Mean of (a - b)^2 over all elements. */
+FAHRENStatus fahren_tape_mse(FAHRENTape* tape, FAHRENVar a, FAHRENVar b, FAHRENVar* out);
+
+/* Backpropagate from the 1 x 1 variable `loss` (seeded with 1) into the
+ * gradients of every parameter it depends on. May be called more than
+ * once per recording; each call adds another full gradient. */
+FAHRENStatus fahren_tape_backward(FAHRENTape* tape, FAHRENVar loss);
+
+/* Bytes of the arena in use, and the most used since creation. */
+size_t fahren_tape_arena_used(const FAHRENTape* tape);
+size_t fahren_tape_arena_peak(const FAHRENTape* tape);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_AUTOGRAD_H */
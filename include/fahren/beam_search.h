@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Beam search over a paged KV cache.
+ * Beams are KV cache sequences forked from their parent, so they share
+ * every block of the common prefix and copy at most the block they are
+ * writing into. All live beams are scored in one batched forward call per
+ * step through a user callback. */
+#ifndef FAHREN_BEAM_SEARCH_H
+#define FAHREN_BEAM_SEARCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fahren/fahren.h>
+#include <fahren/kv_cache.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* One batched forward step. For each i in [0, count): feed token
+ * tokens[i] to KV sequence seqs[i] (append its K/V with
+ * fahren_kv_seq_append and attend over the sequence's block table), and
+ * write that position's `vocab` logits to row i of `logits`. */
+typedef FAHRENStatus (*FAHRENBeamStepFn)(void* user, FAHRENKVCache* cache,
+                                         const int* seqs, const int32_t* tokens,
+                                         size_t count, float* logits);
+
+typedef struct FAHRENBeamSearchParams {
+    size_t beam_width;    /* live beams per step */
+    size_t max_new_tokens;
+    size_t vocab;
+    int32_t eos_token;    /* < 0 disables early finishing */
+    float length_penalty; /* final score = logprob / length^penalty */
+} FAHRENBeamSearchParams;
+
+/* Decode from `prompt_seq`, whose cache already holds the prompt except
+ * for `start_token`, which is fed first. The prompt sequence is left
+ * untouched; beams are forked from it and freed before returning. Writes
+ * the best hypothesis (without the start token, with EOS if it ended on
+ * one) to `out_tokens`, which must hold `max_new_tokens` entries. */
+FAHRENStatus fahren_beam_search(FAHRENKVCache* cache, int prompt_seq, int32_t start_token,
+                                const FAHRENBeamSearchParams* params,
+                                FAHRENBeamStepFn step, void* user,
+                                int32_t* out_tokens, size_t* out_length, float* out_score);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_BEAM_SEARCH_H */
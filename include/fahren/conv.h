@@ -0,0 +1,95 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Convolution kernels on NCHW float tensors. Images of a batch are stored
+ * back to back; weights use the usual framework layouts noted per call. */
+#ifndef FAHREN_CONV_H
+#define FAHREN_CONV_H
+
+#include <stddef.h>
+
+#include <fahren/fahren.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Geometry of a 2D convolution. Zero stride or dilation means 1, so a
+ * zero-initialized struct plus channels and kernel size is a valid
+ * stride-1, unpadded convolution. */
+typedef struct FAHRENConvParams {
+    int in_channels;
+    int out_channels;
+    int kernel_h, kernel_w;
+    int stride_h, stride_w;
+    int pad_h, pad_w;
+    int dilation_h, dilation_w;
+} FAHRENConvParams;
+
+/* How fahren_conv2d_forward computes the convolution. AUTO picks FFT
+ * when a cost model rates it cheaper (large kernels), otherwise DIRECT for
+ * layers with few input channels (raw image stems), WINOGRAD for 3x3
+ * stride-1 undilated kernels, DIRECT when the im2col buffer would be very
+ * large and IM2COL + GEMM for the rest. WINOGRAD is F(2x2, 3x3) and only
+ * accepts the kernels just named. */
+typedef enum FAHRENConvAlgo {
+    FAHREN_CONV_ALGO_AUTO = 0,
+    FAHREN_CONV_ALGO_IM2COL = 1,
+    FAHREN_CONV_ALGO_DIRECT = 2,
+    FAHREN_CONV_ALGO_FFT = 3,
+    FAHREN_CONV_ALGO_WINOGRAD = 4
+} FAHRENConvAlgo;
+
+/* out = (in + 2 * pad - dilation * (kernel - 1) - 1) / stride + 1 per axis. */
+FAHRENStatus fahren_conv2d_output_size(const FAHRENConvParams* p, int in_h, int in_w,
+                                       int* out_h, int* out_w);
+
+/* Convolution (cross-correlation) of a batch. Weights are out_channels x
+ * in_channels x kernel_h x kernel_w; `bias` (out_channels) may be NULL. */
+FAHRENStatus fahren_conv2d_forward(const FAHRENConvParams* p, size_t batch, int in_h, int in_w,
+                                   const float* x, const float* weights, const float* bias,
+                                   float* y, FAHRENConvAlgo algo);
+
+/* Gradients of fahren_conv2d_forward given dL/dy. `dx` is overwritten;
+ * `dweights` and `dbias` are accumulated into. Any of the three may be
+ * NULL to skip that gradient. `algo` applies to the data gradient: IM2COL
+ * is GEMM + col2im and works for every geometry; with stride 1 the data
+ * gradient is a convolution of dy with the flipped kernel, which the
+ * other algorithms (Winograd for 3x3) compute. AUTO uses that whenever
+ * the stride allows. The weight gradient sums per-thread partials over
+ * the batch with a pairwise tree reduction. */
+FAHRENStatus fahren_conv2d_backward(const FAHRENConvParams* p, size_t batch, int in_h, int in_w,
+                                    const float* x, const float* weights, const float* dy,
+                                    float* dx, float* dweights, float* dbias, FAHRENConvAlgo algo);
+
+/* The FFT algorithm caches kernel spectra across calls, keyed by geometry,
+ * the weights pointer and a hash of the weight values. This frees every
+ * cached spectrum that is not in use. */
+void fahren_conv_fft_cache_clear(void);
+
+/* Transposed convolution ("deconvolution"), the adjoint of a convolution
+ * with the same parameters: an in_h x in_w input becomes
+ * (in - 1) * stride - 2 * pad + dilation * (kernel - 1) + 1 per axis.
+ * Computed as one GEMM per image followed by col2im, so no zeros are ever
+ * inserted between input pixels. Weights are in_channels x out_channels x
+ * kernel_h x kernel_w; `bias` (out_channels) may be NULL. */
+FAHRENStatus fahren_conv_transpose_output_size(const FAHRENConvParams* p, int in_h, int in_w,
+                                               int* out_h, int* out_w);
+FAHRENStatus fahren_conv_transpose_forward(const FAHRENConvParams* p, size_t batch, int in_h, int in_w,
+                                           const float* x, const float* weights, const float* bias,
+                                           float* y);
+
+/* Gradients of the transposed convolution given dL/dy. `dx` is
+ * overwritten; `dweights` and `dbias` are accumulated into. Any of the
+ * three may be NULL to skip that gradient. */
+FAHRENStatus fahren_conv_transpose_backward(const FAHRENConvParams* p, size_t batch, int in_h, int in_w,
+                                            const float* x, const float* weights, const float* dy,
+                                            float* dx, float* dweights, float* dbias);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_CONV_H */
@@ -0,0 +1,61 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* 1D and dilated convolution for sequence models (FAHREN_LAYER_CONV1D).
+ * Tensors are N x C x L (channels-major per sequence); weights are
+ * out_channels x in_channels x kernel_size. Convolutions are stride 1.
+ * A streaming mode keeps the last (kernel_size - 1) * dilation input
+ * frames per channel so each pushed frame only computes its own output. */
+#ifndef FAHREN_CONV1D_H
+#define FAHREN_CONV1D_H
+
+#include <stddef.h>
+
+#include <fahren/fahren.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Zero dilation means 1. With `causal` set the input is padded on the
+ * left by (kernel_size - 1) * dilation and the output has the input's
+ * length, so output t only sees inputs <= t; otherwise `pad` zeros are
+ * added on both sides. */
+typedef struct FAHRENConv1DParams {
+    int in_channels;
+    int out_channels;
+    int kernel_size;
+    int dilation;
+    int causal;
+    int pad;
+} FAHRENConv1DParams;
+
+FAHRENStatus fahren_conv1d_output_length(const FAHRENConv1DParams* p, size_t length, size_t* out_length);
+
+/* y (N x out_channels x out_length) = conv(x) + bias; `bias` may be NULL. */
+FAHRENStatus fahren_conv1d_forward(const FAHRENConv1DParams* p, size_t batch, size_t length,
+                                   const float* x, const float* weights, const float* bias,
+                                   float* y);
+
+typedef struct FAHRENConv1DStream FAHRENConv1DStream;
+
+/* Streaming state for one sequence. Always causal. `weights` and `bias`
+ * are referenced, not copied, and must outlive the stream. */
+FAHRENConv1DStream* fahren_conv1d_stream_create(const FAHRENConv1DParams* p, const float* weights,
+                                                const float* bias);
+void fahren_conv1d_stream_destroy(FAHRENConv1DStream* s);
+
+/* Forget all history (as if the sequence restarted with silence). */
+void fahren_conv1d_stream_reset(FAHRENConv1DStream* s);
+
+/* Feed `frames` new input frames (in_channels x frames, channels-major)
+ * and get their outputs (out_channels x frames). */
+FAHRENStatus fahren_conv1d_stream_push(FAHRENConv1DStream* s, const float* x, size_t frames, float* y);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_CONV1D_H */
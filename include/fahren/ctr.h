@@ -0,0 +1,67 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Kernels for click-through-rate style layers: factorization machines
+ * (FAHREN_LAYER_FACTORIZATION_MACHINE) and DCN cross layers
+ * (FAHREN_LAYER_CROSS). Batches are processed in parallel on the library
+ * thread pool. Backward kernels accumulate (+=) into parameter gradients so
+ * several batches can be summed before an update. */
+#ifndef FAHREN_CTR_H
+#define FAHREN_CTR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fahren/fahren.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Sparse input rows in CSR form: row r owns entries
+ * [row_ptr[r], row_ptr[r+1]) of `indices`/`values`. A NULL `values` means
+ * every listed feature has value 1 (one-hot categorical input). */
+typedef struct FAHRENSparseBatch {
+    size_t rows;
+    const int64_t* row_ptr;  /* rows + 1 entries */
+    const int32_t* indices;  /* feature ids in [0, features) */
+    const float* values;     /* may be NULL */
+} FAHRENSparseBatch;
+
+/* Factorization machine over `features` inputs with `factors` latent
+ * dimensions:
+ *   y = w0 + sum_i w[i] x_i + 1/2 sum_f ((sum_i V[i,f] x_i)^2 - sum_i V[i,f]^2 x_i^2)
+ * which costs O(factors * nnz) per row instead of O(factors * nnz^2).
+ * V is features x factors, row-major. `sums` (rows x factors) receives
+ * sum_i V[i,f] x_i per row and must be passed back to the backward pass. */
+FAHRENStatus fahren_fm_forward(const FAHRENSparseBatch* x, size_t features, size_t factors,
+                               float w0, const float* w, const float* V,
+                               float* y, float* sums);
+
+/* Gradients of the FM given dL/dy per row. dV is dense (features x
+ * factors) but only rows of features present in the batch are touched. */
+FAHRENStatus fahren_fm_backward(const FAHRENSparseBatch* x, size_t features, size_t factors,
+                                const float* V, const float* sums, const float* dy,
+                                float* dw0, float* dw, float* dV);
+
+/* DCN cross layer on dense rows of width `dim`:
+ *   out = x0 * (xl . w) + b + xl
+ * `x0` is the input of the cross stack, `xl` the previous cross output
+ * (x0 itself for the first layer). `dots` (rows) keeps xl . w for backward. */
+FAHRENStatus fahren_cross_forward(const float* x0, const float* xl, size_t rows, size_t dim,
+                                  const float* w, const float* b, float* out, float* dots);
+
+/* Cross layer backward. Writes dL/dxl to `dxl`, accumulates dL/dx0 into
+ * `dx0` (every layer of the stack contributes to it) and parameter
+ * gradients into `dw` and `db`. `dxl` may alias `dout`. */
+FAHRENStatus fahren_cross_backward(const float* x0, const float* xl, size_t rows, size_t dim,
+                                   const float* w, const float* dots, const float* dout,
+                                   float* dx0, float* dxl, float* dw, float* db);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_CTR_H */
@@ -0,0 +1,71 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Quantized, tiered embedding tables.
+ * Tables are stored row-wise quantized (8 or 4 bits per value with a
+ * per-row scale and offset) in a file that is mmapped read-only, so cold
+ * rows cost page cache only while they are being touched. Frequently used
+ * rows are promoted into a bounded RAM cache of dequantized rows; access
+ * frequency is tracked with a small count-min sketch, so bookkeeping does
+ * not grow with the table either. An optional background thread prefetches
+ * the rows of an upcoming batch. */
+#ifndef FAHREN_EMBEDDING_H
+#define FAHREN_EMBEDDING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fahren/fahren.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FAHRENEmbeddingStore FAHRENEmbeddingStore;
+
+typedef struct FAHRENEmbeddingConfig {
+    size_t cache_rows;     /* dequantized rows kept in RAM (0 disables) */
+    int prefetch_thread;   /* non-zero starts the background prefetcher */
+} FAHRENEmbeddingConfig;
+
+typedef struct FAHRENEmbeddingStats {
+    uint64_t hits;         /* lookups served from the RAM cache */
+    uint64_t misses;       /* lookups dequantized from the mapping */
+    uint64_t promotions;   /* rows moved into the RAM cache */
+    uint64_t prefetched;   /* rows paged in by the prefetcher */
+    size_t cached_rows;
+} FAHRENEmbeddingStats;
+
+/* Quantize a rows x dim float table (row-major) to `bits` (8 or 4) and
+ * write it to `path`. */
+FAHRENStatus fahren_embedding_write_quantized(const float* table, size_t rows, size_t dim,
+                                              int bits, const char* path);
+
+/* Open a quantized table. `config` may be NULL for defaults (no cache, no
+ * prefetcher). Returns NULL on failure. */
+FAHRENEmbeddingStore* fahren_embedding_open(const char* path, const FAHRENEmbeddingConfig* config);
+void fahren_embedding_close(FAHRENEmbeddingStore* store);
+
+size_t fahren_embedding_rows(const FAHRENEmbeddingStore* store);
+size_t fahren_embedding_dim(const FAHRENEmbeddingStore* store);
+
+/* Gather `count` rows into `out` (count x dim floats). Safe to call from
+ * several threads at once. */
+FAHRENStatus fahren_embedding_lookup(FAHRENEmbeddingStore* store, const int64_t* ids,
+                                     size_t count, float* out);
+
+/* Hint that `ids` will be looked up soon. With the prefetcher running
+ * this returns immediately and the rows are paged in (and promoted if
+ * they are hot enough) in the background; otherwise it only issues
+ * madvise(WILLNEED) for their pages. */
+FAHRENStatus fahren_embedding_prefetch(FAHRENEmbeddingStore* store, const int64_t* ids, size_t count);
+
+void fahren_embedding_stats(FAHRENEmbeddingStore* store, FAHRENEmbeddingStats* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_EMBEDDING_H */
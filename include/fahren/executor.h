@@ -0,0 +1,62 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Running the library's parallel kernels on the host application's
+ * threads. By default every parallel loop runs on a built-in pool sized
+ * to the machine (FAHREN_NUM_THREADS overrides it). A host that already
+ * owns a pool passes an executor to fahren_init_ex instead; from then on
+ * loops are handed to it and the built-in pool is never started. NUMA
+ * split layers then run as plain loops on the executor as well, since
+ * the library no longer owns the threads it would pin. */
+#ifndef FAHREN_EXECUTOR_H
+#define FAHREN_EXECUTOR_H
+
+#include <stddef.h>
+
+#include <fahren/fahren.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Body of a parallel loop: process indices in [begin, end). */
+typedef void (*fahren_range_fn)(void* ctx, size_t begin, size_t end);
+
+/* A unit of work handed to the executor. */
+typedef void (*fahren_task_fn)(void* arg);
+
+typedef struct FAHRENExecutor {
+    void* user;  /* passed back to every callback */
+
+    /* Run task(arg) once, on any thread. Return 0 once it is queued (or
+     * already run); non-zero if it cannot be, and the library does that
+     * share of the work on the calling thread instead. */
+    int (*submit)(void* user, fahren_task_fn task, void* arg);
+
+    /* Optional. Run fn over [0, n) in chunks of at least `grain` indices
+     * and return once all of them are done. When NULL the library splits
+     * the loop itself, submits helper tasks and works on it from the
+     * calling thread too. */
+    void (*parallel_for)(void* user, size_t n, size_t grain, fahren_range_fn fn, void* ctx);
+
+    /* Threads one loop can use, the caller included; 0 counts as 1. Asked
+     * again before every loop, so it may follow a pool that resizes. */
+    size_t (*worker_count)(void* user);
+} FAHRENExecutor;
+
+/* fahren_init that also selects the executor for every parallel kernel
+ * in the process. The executor is copied, but its `user` state must stay
+ * valid while anything can still run; NULL goes back to the built-in
+ * pool. Switch executors only while no inference or training is running.
+ * An executor needs `worker_count` and at least one of `submit` and
+ * `parallel_for`; anything less is FAHREN_ERROR_INVALID_ARGUMENT. */
+FAHRENStatus fahren_init_ex(FAHREN* cm, FAHRENModelType model_type, size_t layer_count, FAHRENLayer* layers,
+                            const FAHRENExecutor* executor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_EXECUTOR_H */
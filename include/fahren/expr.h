@@ -0,0 +1,84 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Lazily recorded elementwise expressions for pre- and postprocessing
+ * around models. Recording only appends to a small op list kept in the
+ * FAHRENExpr itself (no allocation); fahren_expr_eval then makes a single
+ * pass over memory for the whole chain:
+ *
+ *   FAHRENExpr e;
+ *   fahren_expr_init(&e);
+ *   fahren_expr_mul(&e, gain);              // v *= gain[i]
+ *   fahren_expr_affine(&e, 1.0f / 255, -0.5f);
+ *   fahren_expr_clip(&e, -0.5f, 0.5f);
+ *   fahren_expr_activation(&e, FAHREN_ACTIVATION_TANH);
+ *   fahren_expr_eval(&e, x, y, n);
+ *
+ * Adjacent affine ops are folded into one while recording, as are
+ * adjacent clips, so a chain of scales and shifts costs one multiply-add
+ * per element (folding may change the last bit of the result). Recorders
+ * return FAHREN_ERROR_INVALID_ARGUMENT on bad arguments or once
+ * FAHREN_EXPR_MAX_OPS ops are recorded; the error is sticky, and
+ * fahren_expr_eval refuses to run an expression that saw one. */
+#ifndef FAHREN_EXPR_H
+#define FAHREN_EXPR_H
+
+#include <stddef.h>
+
+#include <fahren/fahren.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FAHREN_EXPR_MAX_OPS 32
+
+typedef enum FAHRENExprOpKind {
+    FAHREN_EXPR_AFFINE = 0,     /* v = v * a + b */
+    FAHREN_EXPR_CLIP = 1,       /* v = min(max(v, a), b) */
+    FAHREN_EXPR_ACTIVATION = 2, /* v = act(v), act stored in `act` */
+    FAHREN_EXPR_EXP = 3,        /* v = exp(v) */
+    FAHREN_EXPR_ADD = 4,        /* v = v + src[i] */
+    FAHREN_EXPR_MUL = 5         /* v = v * src[i] */
+} FAHRENExprOpKind;
+
+typedef struct FAHRENExprOp {
+    FAHRENExprOpKind kind;
+    FAHRENActivation act;
+    float a, b;
+    const float* src; /* n elements, for ADD and MUL */
+} FAHRENExprOp;
+
+typedef struct FAHRENExpr {
+    size_t op_count;
+    FAHRENExprOp ops[FAHREN_EXPR_MAX_OPS];
+    int error; /* sticky */
+} FAHRENExpr;
+
+/* Start an empty expression (the identity). */
+void fahren_expr_init(FAHRENExpr* e);
+
+FAHRENStatus fahren_expr_affine(FAHRENExpr* e, float scale, float shift);
+FAHRENStatus fahren_expr_scale(FAHRENExpr* e, float scale);
+FAHRENStatus fahren_expr_shift(FAHRENExpr* e, float shift);
+/* lo <= hi; use +-INFINITY for a one-sided clip. */
+FAHRENStatus fahren_expr_clip(FAHRENExpr* e, float lo, float hi);
+/* The same activations the runtime applies to layer outputs. */
+FAHRENStatus fahren_expr_activation(FAHRENExpr* e, FAHRENActivation act);
+FAHRENStatus fahren_expr_exp(FAHRENExpr* e);
+/* Elementwise with a second operand of the same length as the data. It is
+ * only read at evaluation time and may be x or y. */
+FAHRENStatus fahren_expr_add(FAHRENExpr* e, const float* src);
+FAHRENStatus fahren_expr_mul(FAHRENExpr* e, const float* src);
+
+/* y[i] = e(x[i]) for i < n, in one pass, split across the thread pool for
+ * large n. y may be x. */
+FAHRENStatus fahren_expr_eval(const FAHRENExpr* e, const float* x, float* y, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_EXPR_H */
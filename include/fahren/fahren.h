@@ -46,7 +46,10 @@ typedef enum FAHRENStatus {
     FAHREN_SUCCESS = 0,
     FAHREN_ERROR_INVALID_ARGUMENT = 1,
     FAHREN_ERROR_NOT_INITIALIZED = 2,
-    FAHREN_ERROR_PROCESSING_FAILED = 3
+    FAHREN_ERROR_PROCESSING_FAILED = 3,
+    FAHREN_ERROR_DEADLINE_EXCEEDED = 4,  /* request shed: it could no longer finish in time */
+    FAHREN_ERROR_OVERLOADED = 5,         /* request rejected at submission: queue full or wait too long */
+    FAHREN_ERROR_CANCELLED = 6           /* request abandoned through its cancellation token */
 } FAHRENStatus;
 
 /* A minimal model type enum: we only need a placeholder for now. */
@@ -57,15 +60,46 @@ typedef enum FAHRENModelType {
 /* Layer kinds supported by the tiny API. */
 typedef enum FAHRENLayerType {
     FAHREN_LAYER_DENSE = 0,
-    FAHREN_LAYER_CONVOLUTIONAL = 1
+    FAHREN_LAYER_CONVOLUTIONAL = 1,
+    FAHREN_LAYER_FACTORIZATION_MACHINE = 2, /* scalar FM over the previous layer */
+    FAHREN_LAYER_CROSS = 3,                 /* DCN cross layer, width-preserving */
+    FAHREN_LAYER_CONV_TRANSPOSE = 4,        /* transposed (up-)convolution */
+    FAHREN_LAYER_UPSAMPLE = 5,              /* parameter-free resize, keeps channels */
+    FAHREN_LAYER_CONV1D = 6                 /* 1D / dilated (causal) convolution */
 } FAHRENLayerType;
 
+/* Elementwise activation the runtime applies to a layer's output. */
+typedef enum FAHRENActivation {
+    FAHREN_ACTIVATION_NONE = 0,
+    FAHREN_ACTIVATION_RELU = 1,
+    FAHREN_ACTIVATION_SIGMOID = 2,
+    FAHREN_ACTIVATION_TANH = 3
+} FAHRENActivation;
+
+/* How fahren_write_random_weights draws a layer's weights. The other
+ * schemes use fan_in = inputs x receptive field (kernel taps) and fan_out
+ * = outputs x receptive field, and start an input layer (no
+ * previous_layer) at scale 1. */
+typedef enum FAHRENInit {
+    FAHREN_INIT_UNIFORM = 0,    /* uniform in [-0.5, 0.5], whatever the width */
+    FAHREN_INIT_XAVIER = 1,     /* Glorot: uniform, limit sqrt(6 / (fan_in + fan_out)) */
+    FAHREN_INIT_HE = 2,         /* Kaiming: uniform, limit sqrt(6 / fan_in), for relu */
+    FAHREN_INIT_ORTHOGONAL = 3  /* rows (or columns) of the out x fan_in matrix orthonormal */
+} FAHRENInit;
+
 /* A very small layer descriptor. The user only needs to set `density` and
  * `previous_layer` when building simple sequential models in examples. */
 typedef struct FAHRENLayer {
     int density;               /* number of neurons / filters */
     struct FAHRENLayer* previous_layer; /* pointer to previous layer or NULL */
     FAHRENLayerType layer_type;/* kind of layer */
+    int factors;               /* FM latent factors per feature (FM layers only) */
+    int kernel_size;           /* conv kernel extent per spatial axis; 0 means 3 */
+    int dilation;              /* conv1d tap spacing; 0 means 1 (no parameters) */
+    FAHRENActivation activation; /* applied to the layer output by the runtime */
+    int numa_split;            /* dense: split output rows across NUMA nodes */
+    FAHRENInit init;           /* weight initializer */
+    int zero_bias;             /* start biases at 0 instead of drawing them like weights */
 } FAHRENLayer;
 
 /* Opaque model instance held by library users; keep fields minimal. */
@@ -0,0 +1,247 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Header-only C++20 layer over the C API. Model owns a runtime and
+ * Context owns a scheduler, both move-only; Tensor / ConstTensor are
+ * non-owning row-major views over caller memory; Context::infer returns
+ * an awaitable that submits a scheduler request and resumes the awaiting
+ * coroutine from the request's completion callback. The request lives
+ * inside the awaitable, i.e. in the awaiting coroutine's frame, so an
+ * inference allocates nothing beyond what the C API does (nothing).
+ *
+ *   fahren::Context ctx(2);
+ *   fahren::Model model("784,256:relu,10:sigmoid", "weights.bin");
+ *   auto id = ctx.add(model);
+ *   FAHRENStatus st = co_await ctx.infer(id, x, y);
+ *
+ * The coroutine resumes on a scheduler worker thread; hop back to your
+ * own executor after co_await if that matters, and in particular before
+ * the Context can be destroyed: its destructor joins the workers, so
+ * running it on one of them deadlocks. Constructors throw
+ * fahren::Error; per-call paths return FAHRENStatus instead. */
+#ifndef FAHREN_HPP
+#define FAHREN_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <fahren/fahren.h>
+#include <fahren/runtime.h>
+#include <fahren/sched.h>
+
+namespace fahren {
+
+class Error : public std::runtime_error {
+public:
+    Error(const char* what, FAHRENStatus status) : std::runtime_error(what), status_(status) {}
+    FAHRENStatus status() const noexcept { return status_; }
+
+private:
+    FAHRENStatus status_;
+};
+
+/* rows x cols floats, row-major and contiguous. */
+template <class T>
+class BasicTensor {
+public:
+    constexpr BasicTensor() noexcept = default;
+    constexpr BasicTensor(T* data, std::size_t rows, std::size_t cols) noexcept
+        : data_(data), rows_(rows), cols_(cols) {}
+    /* `cols` wide rows over a flat span; a trailing partial row is ignored */
+    constexpr BasicTensor(std::span<T> flat, std::size_t cols) noexcept
+        : data_(flat.data()), rows_(cols ? flat.size() / cols : 0), cols_(cols) {}
+    template <class U>
+        requires std::is_convertible_v<U (*)[], T (*)[]>
+    constexpr BasicTensor(const BasicTensor<U>& other) noexcept
+        : data_(other.data()), rows_(other.rows()), cols_(other.cols()) {}
+
+    constexpr T* data() const noexcept { return data_; }
+    constexpr std::size_t rows() const noexcept { return rows_; }
+    constexpr std::size_t cols() const noexcept { return cols_; }
+    constexpr std::size_t size() const noexcept { return rows_ * cols_; }
+    constexpr std::span<T> flat() const noexcept { return {data_, size()}; }
+    constexpr std::span<T> operator[](std::size_t row) const noexcept { return {data_ + row * cols_, cols_}; }
+    /* rows [first, first + count) */
+    constexpr BasicTensor slice(std::size_t first, std::size_t count) const noexcept {
+        return {data_ + first * cols_, count, cols_};
+    }
+
+private:
+    T* data_ = nullptr;
+    std::size_t rows_ = 0, cols_ = 0;
+};
+
+using Tensor = BasicTensor<float>;
+using ConstTensor = BasicTensor<const float>;
+
+/* A dense runtime built from a layer spec (see fahren_runtime_parse_layers)
+ * and a weights blob. */
+class Model {
+public:
+    Model(const char* spec, const char* weights_path) {
+        FAHRENLayer* layers = nullptr;
+        std::size_t count = 0;
+        FAHRENStatus st = fahren_runtime_parse_layers(spec, &layers, &count);
+        if (st != FAHREN_SUCCESS) throw Error("fahren: bad layer spec", st);
+        FAHREN cm;
+        std::memset(&cm, 0, sizeof(cm));
+        st = fahren_init(&cm, FAHREN_MODEL_SEQUENTIAL, count, layers);
+        if (st == FAHREN_SUCCESS) st = fahren_runtime_create(&cm, weights_path, &rt_);
+        /* the runtime copies what it needs; fahren_shutdown would also
+         * sweep fahren_* files from the working directory */
+        std::free(layers);
+        if (st != FAHREN_SUCCESS) throw Error("fahren: cannot load model", st);
+    }
+    /* Adopt a runtime created through the C API. */
+    explicit Model(FAHRENRuntime* rt) noexcept : rt_(rt) {}
+
+    Model(Model&& other) noexcept : rt_(std::exchange(other.rt_, nullptr)) {}
+    Model& operator=(Model&& other) noexcept {
+        if (this != &other) {
+            fahren_runtime_destroy(rt_);
+            rt_ = std::exchange(other.rt_, nullptr);
+        }
+        return *this;
+    }
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
+    ~Model() { fahren_runtime_destroy(rt_); }
+
+    FAHRENRuntime* get() const noexcept { return rt_; }
+    FAHRENRuntime* release() noexcept { return std::exchange(rt_, nullptr); }
+    std::size_t input_dim() const noexcept { return fahren_runtime_input_dim(rt_); }
+    std::size_t output_dim() const noexcept { return fahren_runtime_output_dim(rt_); }
+
+    /* Synchronous forward pass on the calling thread. */
+    [[nodiscard]] FAHRENStatus forward(ConstTensor x, Tensor y) const noexcept {
+        if (x.cols() != input_dim() || y.cols() != output_dim() || y.rows() != x.rows()) {
+            return FAHREN_ERROR_INVALID_ARGUMENT;
+        }
+        return fahren_runtime_forward(rt_, x.data(), x.rows(), y.data());
+    }
+
+private:
+    FAHRENRuntime* rt_ = nullptr;
+};
+
+struct InferOptions {
+    std::uint64_t deadline_ns = 0;            /* absolute (fahren_sched_now_ns clock); 0: model default */
+    const FAHRENCancelToken* cancel = nullptr;
+};
+
+/* co_await yields the request's FAHRENStatus. A request refused at
+ * submission (overloaded, cancelled, bad shapes: x and y must have the
+ * same rows and the model's input and output widths) does not suspend. The
+ * awaitable must be awaited at most once and not moved once awaited. */
+class InferAwaitable {
+public:
+    InferAwaitable(FAHRENScheduler* sched, std::size_t model, ConstTensor x, Tensor y,
+                   const InferOptions& options) noexcept
+        : sched_(sched) {
+        std::memset(&req_, 0, sizeof(req_));
+        req_.model = model;
+        req_.input = x.data();
+        req_.output = y.data();
+        FAHRENRuntime* rt = fahren_scheduler_runtime(sched, model);
+        bool fits = rt && x.rows() == y.rows() && x.cols() == fahren_runtime_input_dim(rt) &&
+                    y.cols() == fahren_runtime_output_dim(rt);
+        req_.rows = fits ? x.rows() : 0; /* a mismatch is refused at submit */
+        req_.deadline_ns = options.deadline_ns;
+        req_.cancel = options.cancel;
+        req_.on_done = &InferAwaitable::on_done;
+        req_.user = this;
+    }
+    InferAwaitable(const InferAwaitable&) = delete;
+    InferAwaitable& operator=(const InferAwaitable&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> h) noexcept {
+        waiter_ = h;
+        FAHRENStatus st = fahren_scheduler_submit(sched_, &req_);
+        if (st == FAHREN_SUCCESS) return true;
+        req_.status = st;
+        return false;
+    }
+    FAHRENStatus await_resume() const noexcept { return req_.status; }
+
+private:
+    static void on_done(FAHRENRequest* req, void* user) {
+        (void)req;
+        static_cast<InferAwaitable*>(user)->waiter_.resume();
+    }
+
+    FAHRENScheduler* sched_;
+    FAHRENRequest req_;
+    std::coroutine_handle<> waiter_;
+};
+
+/* Scheduler handle: workers, registered models and in-flight requests.
+ * Models added to a context must outlive it. Do not destroy a context
+ * from a coroutine it resumed (e.g. one that owns it and ends right after
+ * co_await): the destructor joins the worker it is running on. */
+class Context {
+public:
+    explicit Context(unsigned workers = 1) {
+        FAHRENSchedulerConfig config;
+        std::memset(&config, 0, sizeof(config));
+        config.workers = workers;
+        FAHRENStatus st = fahren_scheduler_create(&config, &sched_);
+        if (st != FAHREN_SUCCESS) throw Error("fahren: cannot start scheduler", st);
+    }
+    explicit Context(const FAHRENSchedulerConfig& config) {
+        FAHRENStatus st = fahren_scheduler_create(&config, &sched_);
+        if (st != FAHREN_SUCCESS) throw Error("fahren: cannot start scheduler", st);
+    }
+
+    Context(Context&& other) noexcept : sched_(std::exchange(other.sched_, nullptr)) {}
+    Context& operator=(Context&& other) noexcept {
+        if (this != &other) {
+            fahren_scheduler_destroy(sched_);
+            sched_ = std::exchange(other.sched_, nullptr);
+        }
+        return *this;
+    }
+    Context(const Context&) = delete;
+    Context& operator=(const Context&) = delete;
+    ~Context() { fahren_scheduler_destroy(sched_); }
+
+    FAHRENScheduler* get() const noexcept { return sched_; }
+
+    /* Register a model; the id is what infer takes. */
+    std::size_t add(const Model& model, const FAHRENSchedModelConfig* config = nullptr) {
+        std::size_t id = 0;
+        FAHRENStatus st = fahren_scheduler_add_model(sched_, model.get(), config, &id);
+        if (st != FAHREN_SUCCESS) throw Error("fahren: cannot add model", st);
+        return id;
+    }
+
+    [[nodiscard]] InferAwaitable infer(std::size_t model, ConstTensor x, Tensor y,
+                                       const InferOptions& options = {}) const noexcept {
+        return InferAwaitable(sched_, model, x, y, options);
+    }
+
+    void cancel(FAHRENCancelToken& token) const noexcept { fahren_scheduler_cancel(sched_, &token); }
+
+    FAHRENSchedStats stats(std::size_t model) const {
+        FAHRENSchedStats s;
+        FAHRENStatus st = fahren_scheduler_stats(sched_, model, &s);
+        if (st != FAHREN_SUCCESS) throw Error("fahren: no such model", st);
+        return s;
+    }
+
+private:
+    FAHRENScheduler* sched_ = nullptr;
+};
+
+} // namespace fahren
+
+#endif /* FAHREN_HPP */
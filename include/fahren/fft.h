@@ -0,0 +1,41 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Complex single-precision FFT for lengths of the form 2^a * 3^b * 5^c,
+ * using mixed radix-4/2/3/5 passes. Data is held as split real and
+ * imaginary arrays. A plan is immutable once created, so one plan may be
+ * executed from many threads at once, each with its own work buffer. */
+#ifndef FAHREN_FFT_H
+#define FAHREN_FFT_H
+
+#include <stddef.h>
+
+#include <fahren/fahren.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FAHRENFFTPlan FAHRENFFTPlan;
+
+/* Smallest supported length >= n. Lengths from 4 up are rounded to
+ * multiples of 4, which keep every pass on the vector path. */
+size_t fahren_fft_good_size(size_t n);
+
+/* NULL if n is 0, has a prime factor above 5, or allocation fails. */
+FAHRENFFTPlan* fahren_fft_plan_create(size_t n);
+void fahren_fft_plan_destroy(FAHRENFFTPlan* plan);
+size_t fahren_fft_plan_length(const FAHRENFFTPlan* plan);
+
+/* In-place transform of n complex values. `work` holds 2 * n floats.
+ * The forward transform uses exp(-2 pi i jk / n); the inverse is not
+ * scaled, so forward then inverse multiplies the data by n. */
+FAHRENStatus fahren_fft_execute(const FAHRENFFTPlan* plan, float* re, float* im, float* work, int inverse);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_FFT_H */
@@ -0,0 +1,133 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Model blob formats.
+ *
+ * Format 1 ('FAHN') is what fahren_write_random_weights writes and what
+ * fahren_runtime_create and fahren::Sequential load: a FAHRENModelHeader,
+ * then every layer's weights in layer order, then every layer's biases,
+ * all F32. Which layer owns which values follows from the layer chain
+ * (fahren_model_layer_counts), not from the file.
+ *
+ * Format 2 ('FAHX') is for storing and shipping blobs: a
+ * FAHRENModelHeaderV2, an optional table of per-layer (weights, biases)
+ * counts as uint64 pairs, then the values in any FAHRENDType and either
+ * layout. Its checksum covers everything after the header. Convert back
+ * to format 1 (F32, split) before loading a blob.
+ *
+ * All multi-byte fields are little-endian, as written by the hosts FAHREN
+ * supports. Files are read through read-only mappings and written in
+ * place through a preallocated temporary that is renamed on success, so
+ * neither side holds a whole model in heap memory. Every writer opens its
+ * own uniquely named temporary, so concurrent writes and converts to one
+ * path are safe: each leaves a whole blob and the last rename wins. */
+#ifndef FAHREN_FORMAT_H
+#define FAHREN_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fahren/fahren.h>
+#include <fahren/tensor.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FAHREN_MODEL_MAGIC 0x4641484Eu    /* 'FAHN', format 1 */
+#define FAHREN_MODEL_MAGIC_V2 0x46414858u /* 'FAHX', format 2 */
+
+typedef struct FAHRENModelHeader {
+    uint32_t magic;
+    uint32_t version_major, version_minor, version_patch; /* library that wrote the blob */
+    uint64_t weight_count;
+    uint64_t bias_count;
+} FAHRENModelHeader;
+
+typedef enum FAHRENModelLayout {
+    FAHREN_LAYOUT_SPLIT = 0,      /* all weights, then all biases (format 1's) */
+    FAHREN_LAYOUT_INTERLEAVED = 1 /* per layer: its weights, then its biases */
+} FAHRENModelLayout;
+
+typedef struct FAHRENModelHeaderV2 {
+    uint32_t magic;
+    uint32_t version_major, version_minor, version_patch;
+    uint64_t weight_count;
+    uint64_t bias_count;
+    uint32_t dtype;       /* FAHRENDType of every stored value */
+    uint32_t layout;      /* FAHRENModelLayout; INTERLEAVED needs the table */
+    uint64_t layer_count; /* table entries after the header, may be 0 */
+    uint64_t checksum;    /* fahren_model_checksum of the bytes after the header */
+    uint64_t reserved;    /* 0 */
+} FAHRENModelHeaderV2;
+
+/* A validated, read-only mapping of a format 1 or 2 file. */
+typedef struct FAHRENModelView {
+    uint32_t format; /* 1 or 2 */
+    uint32_t version_major, version_minor, version_patch;
+    FAHRENDType dtype;
+    FAHRENModelLayout layout;
+    uint64_t weight_count, bias_count;
+    uint64_t layer_count;
+    const uint64_t* layer_counts; /* 2 x layer_count (weights, biases), or NULL */
+    const void* payload;          /* the values */
+    uint64_t checksum;            /* stored one; format 2 only */
+    const void* base;             /* the whole file */
+    size_t size;
+} FAHRENModelView;
+
+/* Map `path` and check its header, table and size against each other.
+ * FAHREN_ERROR_INVALID_ARGUMENT for a file that is not a well-formed
+ * blob, FAHREN_ERROR_PROCESSING_FAILED when it cannot be opened. */
+FAHRENStatus fahren_model_open(const char* path, FAHRENModelView* view);
+void fahren_model_close(FAHRENModelView* view);
+
+/* 64-bit checksum of `bytes`, hashed in parallel in 1 MiB blocks whose
+ * hashes are then combined in order; the result does not depend on the
+ * thread count. */
+uint64_t fahren_model_checksum(const void* data, size_t bytes);
+
+/* Recompute a format 2 view's checksum; FAHREN_ERROR_PROCESSING_FAILED
+ * on a mismatch, FAHREN_ERROR_INVALID_ARGUMENT for format 1 (which has no
+ * checksum; *actual is still filled in). */
+FAHRENStatus fahren_model_verify(const FAHRENModelView* view, uint64_t* actual);
+
+/* Per-layer (weights, biases) counts of a layer chain into counts[2 * i]
+ * and counts[2 * i + 1]. */
+FAHRENStatus fahren_model_layer_counts(const FAHRENLayer* layers, size_t layer_count, uint64_t* counts);
+
+typedef struct FAHRENModelStats {
+    uint64_t count;
+    uint64_t nonfinite; /* NaN and infinities, left out of the rest */
+    double min, max, mean, rms;
+} FAHRENModelStats;
+
+/* Value statistics of the weights and the biases, computed in parallel. */
+FAHRENStatus fahren_model_stats(const FAHRENModelView* view, FAHRENModelStats* weights, FAHRENModelStats* biases);
+
+typedef struct FAHRENModelConvertOptions {
+    uint32_t format;              /* 1 or 2; format 1 needs F32 and SPLIT */
+    FAHRENDType dtype;
+    FAHRENModelLayout layout;
+    const uint64_t* layer_counts; /* 2 x layer_count, or NULL for the source's table */
+    size_t layer_count;
+} FAHRENModelConvertOptions;
+
+/* Stream `src` into a new file at `path`, converting values (rounding to
+ * nearest even when narrowing) and reordering them into the requested
+ * layout in parallel. Interleaving needs per-layer counts, from the
+ * options or the source. The version triple is kept; format 2 output
+ * gets its checksum and, when known, the layer table. */
+FAHRENStatus fahren_model_convert(const FAHRENModelView* src, const char* path,
+                                  const FAHRENModelConvertOptions* options);
+
+/* Write a fresh format 1 blob for `cm` (see fahren_init). */
+FAHRENStatus fahren_write_random_weights(FAHREN* cm, const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_FORMAT_H */
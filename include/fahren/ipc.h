@@ -0,0 +1,91 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Shared-memory inference between processes on one host. A server maps a
+ * named POSIX shared-memory segment holding request slots (each with room
+ * for its inputs and outputs) and a ring of submitted slot numbers.
+ * Clients write inputs straight into a slot, push it on the ring and wait
+ * for the slot's completion word; the server drains the ring, batches the
+ * pending requests into one forward pass and writes outputs back in
+ * place. Wakeups use futexes on words in the segment, and both sides spin
+ * briefly before sleeping, so a hot round trip never enters the kernel.
+ * Linux only. */
+#ifndef FAHREN_IPC_H
+#define FAHREN_IPC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fahren/fahren.h>
+#include <fahren/runtime.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---- server ----------------------------------------------------------- */
+
+typedef struct FAHRENIpcServerConfig {
+    unsigned slots;           /* requests in flight at once; 0 means 64 */
+    unsigned max_rows;        /* rows per request; 0 means 1 */
+    unsigned max_batch_rows;  /* rows per forward pass, at most (and by default) slots * max_rows */
+    unsigned batch_window_us; /* once a request is in, wait up to this long for more */
+} FAHRENIpcServerConfig;
+
+typedef struct FAHRENIpcServer FAHRENIpcServer;
+
+/* `name` is a shared-memory name ("/fahren" or "fahren"); a stale segment
+ * of the same name is replaced. The runtime must outlive the server. */
+FAHRENStatus fahren_ipc_server_create(const char* name, FAHRENRuntime* rt, const FAHRENIpcServerConfig* config,
+                                      FAHRENIpcServer** out);
+
+/* Serve requests until fahren_ipc_server_stop is called. */
+FAHRENStatus fahren_ipc_server_run(FAHRENIpcServer* server);
+
+/* Make fahren_ipc_server_run return. Async-signal-safe. */
+void fahren_ipc_server_stop(FAHRENIpcServer* server);
+
+/* Unmaps and unlinks the segment. */
+void fahren_ipc_server_destroy(FAHRENIpcServer* server);
+
+/* ---- client ----------------------------------------------------------- */
+
+typedef struct FAHRENIpcClient FAHRENIpcClient;
+
+/* A claimed request slot. `input` (max_rows x input_dim) is written by the
+ * caller before submit; `output` (max_rows x output_dim) is valid after a
+ * successful wait until the request is ended. */
+typedef struct FAHRENIpcRequest {
+    float* input;
+    const float* output;
+    size_t max_rows;
+    uint32_t slot;
+} FAHRENIpcRequest;
+
+FAHRENStatus fahren_ipc_connect(const char* name, FAHRENIpcClient** out);
+void fahren_ipc_disconnect(FAHRENIpcClient* client);
+
+size_t fahren_ipc_input_dim(const FAHRENIpcClient* client);
+size_t fahren_ipc_output_dim(const FAHRENIpcClient* client);
+
+/* Zero-copy path: begin claims a free slot (sleeping until one is
+ * released if all are busy), submit hands `rows` rows of its input to the
+ * server, wait blocks until the outputs are in place and returns the
+ * forward pass's status, end releases the slot. A client may hold several
+ * requests at once. Slots still held by a process that has exited are
+ * released by the server within a fraction of a second. */
+FAHRENStatus fahren_ipc_request_begin(FAHRENIpcClient* client, FAHRENIpcRequest* req);
+FAHRENStatus fahren_ipc_request_submit(FAHRENIpcClient* client, FAHRENIpcRequest* req, size_t rows);
+FAHRENStatus fahren_ipc_request_wait(FAHRENIpcClient* client, FAHRENIpcRequest* req);
+void fahren_ipc_request_end(FAHRENIpcClient* client, FAHRENIpcRequest* req);
+
+/* Copying convenience wrapper around the four calls above. */
+FAHRENStatus fahren_ipc_infer(FAHRENIpcClient* client, const float* x, size_t rows, float* y);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_IPC_H */
@@ -0,0 +1,68 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Paged key/value cache for autoregressive decoding.
+ * Each sequence owns a block table: a list of fixed-size blocks that hold
+ * `block_tokens` token slots of `token_floats` floats (all layers' keys and
+ * values for one position, laid out however the model likes). Blocks are
+ * reference counted, so forking a sequence shares its whole prefix and
+ * only the block a sequence writes into is copied, and only while it is
+ * still shared. Memory therefore follows the divergent suffixes of the
+ * live sequences rather than sequences times length. */
+#ifndef FAHREN_KV_CACHE_H
+#define FAHREN_KV_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fahren/fahren.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FAHRENKVCache FAHRENKVCache;
+
+/* Usage counters, mostly for tests and tuning. */
+typedef struct FAHRENKVCacheStats {
+    size_t blocks_in_use;   /* blocks referenced by at least one sequence */
+    size_t blocks_cached;   /* freed blocks kept for reuse */
+    size_t sequences;       /* live sequences */
+    size_t cow_copies;      /* blocks copied because they were shared */
+} FAHRENKVCacheStats;
+
+/* Create a cache. `max_blocks` bounds the number of live blocks (0 means
+ * no limit); blocks are allocated lazily as sequences grow. */
+FAHRENKVCache* fahren_kv_cache_create(size_t block_tokens, size_t token_floats, size_t max_blocks);
+void fahren_kv_cache_destroy(FAHRENKVCache* cache);
+
+/* Sequence lifetime. Sequence ids are small non-negative integers that
+ * may be reused after fahren_kv_seq_free. */
+FAHRENStatus fahren_kv_seq_new(FAHRENKVCache* cache, int* out_seq);
+FAHRENStatus fahren_kv_seq_fork(FAHRENKVCache* cache, int src_seq, int* out_seq);
+FAHRENStatus fahren_kv_seq_free(FAHRENKVCache* cache, int seq);
+
+/* Reserve the slot for the sequence's next token and return a pointer to
+ * its `token_floats` floats. Copies the last block first if another
+ * sequence still shares it. */
+FAHRENStatus fahren_kv_seq_append(FAHRENKVCache* cache, int seq, float** out_slot);
+
+/* Read access for attention kernels: the sequence's length in tokens and
+ * its block table, and the storage of one block. Slot `t` of a sequence
+ * lives in block blocks[t / block_tokens] at row t % block_tokens. */
+size_t fahren_kv_seq_length(const FAHRENKVCache* cache, int seq);
+FAHRENStatus fahren_kv_seq_blocks(const FAHRENKVCache* cache, int seq,
+                                  const int32_t** out_blocks, size_t* out_count);
+const float* fahren_kv_block_data(const FAHRENKVCache* cache, int32_t block);
+
+size_t fahren_kv_cache_block_tokens(const FAHRENKVCache* cache);
+size_t fahren_kv_cache_token_floats(const FAHRENKVCache* cache);
+void fahren_kv_cache_stats(const FAHRENKVCache* cache, FAHRENKVCacheStats* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_KV_CACHE_H */
@@ -0,0 +1,115 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Socket front end for the dense runtime, for clients that cannot map
+ * the shared-memory ring (see ipc.h). The server runs one edge-triggered
+ * epoll loop per core; each loop has its own SO_REUSEPORT TCP listener
+ * and shares the Unix-domain listener. Request payloads are read
+ * straight into the loop's batch input buffer and everything that
+ * arrived together runs as one forward pass.
+ *
+ * Wire format, in the server's native byte order (the frames are plain
+ * structs; every host FAHREN supports is little-endian, and a client of
+ * the other order fails the hello's magic check):
+ *   on connect, server -> client: FAHRENNetHello
+ *   request:  FAHRENNetFrame{id, rows} + rows x input_dim float32
+ *   response: FAHRENNetFrame{id, rows, status} + rows x output_dim float32
+ *             (no payload and rows = 0 when status is not FAHREN_SUCCESS)
+ * Responses on a connection come back in request order; clients may
+ * pipeline as many requests as they like, but the server stops reading
+ * from a connection whose responses pile up unread, and once the batch is
+ * full it drops a connection whose payload lags its header by more than
+ * 100 ms or the batch window. Linux only. */
+#ifndef FAHREN_NET_H
+#define FAHREN_NET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fahren/fahren.h>
+#include <fahren/runtime.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FAHREN_NET_MAGIC 0x4E484146u /* "FAHN" */
+#define FAHREN_NET_VERSION 1u
+#define FAHREN_NET_MAX_ROWS 65535u
+
+typedef struct FAHRENNetHello {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t input_dim;
+    uint32_t output_dim;
+    uint32_t max_rows;
+} FAHRENNetHello;
+
+typedef struct FAHRENNetFrame {
+    uint32_t id;     /* echoed back in the response */
+    uint16_t rows;
+    uint16_t status; /* responses only; 0 in requests */
+} FAHRENNetFrame;
+
+/* ---- server ----------------------------------------------------------- */
+
+typedef struct FAHRENNetServerConfig {
+    const char* tcp_address; /* "host:port" or "port"; host defaults to 127.0.0.1, port 0 picks one */
+    const char* unix_path;   /* Unix-domain socket path; replaced if it exists */
+    unsigned loops;          /* event loops; 0 means one per online CPU */
+    unsigned max_rows;       /* rows per request; 0 means 64 */
+    unsigned max_batch_rows; /* rows per forward pass; 0 means 256 */
+    unsigned batch_window_us; /* once a request is in, wait up to this long for more */
+} FAHRENNetServerConfig;
+
+typedef struct FAHRENNetServer FAHRENNetServer;
+
+/* Binds the listeners; at least one of tcp_address and unix_path must be
+ * set. The runtime must outlive the server. */
+FAHRENStatus fahren_net_server_create(FAHRENRuntime* rt, const FAHRENNetServerConfig* config,
+                                      FAHRENNetServer** out);
+
+/* Port the TCP listeners are bound to, or 0 without TCP. */
+int fahren_net_server_tcp_port(const FAHRENNetServer* server);
+
+/* Run the event loops (the calling thread becomes one of them) until
+ * fahren_net_server_stop is called. */
+FAHRENStatus fahren_net_server_run(FAHRENNetServer* server);
+
+/* Make fahren_net_server_run return. Async-signal-safe. */
+void fahren_net_server_stop(FAHRENNetServer* server);
+
+void fahren_net_server_destroy(FAHRENNetServer* server);
+
+/* ---- client ----------------------------------------------------------- */
+
+typedef struct FAHRENNetClient FAHRENNetClient;
+
+/* `address` is "unix:PATH" or "[tcp:]host:port". */
+FAHRENStatus fahren_net_connect(const char* address, FAHRENNetClient** out);
+void fahren_net_disconnect(FAHRENNetClient* client);
+
+size_t fahren_net_input_dim(const FAHRENNetClient* client);
+size_t fahren_net_output_dim(const FAHRENNetClient* client);
+size_t fahren_net_max_rows(const FAHRENNetClient* client);
+
+/* Pipelined use: send any number of requests, then receive their
+ * responses in the same order. `y` must hold max_rows x output_dim
+ * floats; recv returns the request's status, with its id and row count
+ * in *id and *rows. */
+FAHRENStatus fahren_net_send(FAHRENNetClient* client, uint32_t id, const float* x, size_t rows);
+FAHRENStatus fahren_net_recv(FAHRENNetClient* client, uint32_t* id, float* y, size_t* rows);
+
+/* One blocking request of any size, split into max_rows pieces with a
+ * bounded number in flight; each response is placed by its id. A
+ * response with an unknown or repeated id fails the call with
+ * FAHREN_ERROR_PROCESSING_FAILED (the connection is then unusable). */
+FAHRENStatus fahren_net_infer(FAHRENNetClient* client, const float* x, size_t rows, float* y);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_NET_H */
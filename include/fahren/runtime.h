@@ -0,0 +1,92 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Inference runtime for sequential dense models. A runtime binds an
+ * initialized FAHREN model to a weights blob written by
+ * fahren_write_random_weights (format 1 in format.h) and
+ * runs batched forward passes. The first layer has no previous_layer and
+ * acts as the input layer: its `density` is the input width and its
+ * weights and biases are a per-feature scale and shift. Every later layer
+ * must be FAHREN_LAYER_DENSE and take the one before it as input; dense
+ * weights are stored as out x in rows. Forward passes may run
+ * concurrently on one runtime. */
+#ifndef FAHREN_RUNTIME_H
+#define FAHREN_RUNTIME_H
+
+#include <stddef.h>
+
+#include <fahren/fahren.h>
+#include <fahren/tensor.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FAHRENRuntime FAHRENRuntime;
+
+/* Load a format 1 blob whose counts match `cm`'s layers. A blob written
+ * by another major version of the library is refused with
+ * FAHREN_ERROR_INVALID_ARGUMENT (fahren_model_convert can rewrite it).
+ * Layers with `numa_split` set have their output rows divided across the
+ * NUMA nodes: each node keeps its slice of the weights in local memory and
+ * computes those outputs on threads pinned to it, and the slices of the
+ * output are written side by side. */
+FAHRENStatus fahren_runtime_create(const FAHREN* cm, const char* weights_path, FAHRENRuntime** out);
+void fahren_runtime_destroy(FAHRENRuntime* rt);
+
+size_t fahren_runtime_input_dim(const FAHRENRuntime* rt);
+size_t fahren_runtime_output_dim(const FAHRENRuntime* rt);
+
+/* y (batch x output_dim) = model(x (batch x input_dim)). */
+FAHRENStatus fahren_runtime_forward(FAHRENRuntime* rt, const float* x, size_t batch, float* y);
+
+/* The same over strided views (tensor.h): x is [batch, input_dim] and y
+ * [batch, output_dim], both F32, with any strides, e.g. a column slice of
+ * a wider buffer or a transposed tensor. Nothing is copied except when y's
+ * inner stride is not 1; then the last layer's output is scattered into
+ * it from scratch. */
+FAHRENStatus fahren_runtime_forward_tensor(FAHRENRuntime* rt, const FAHRENTensor* x, const FAHRENTensor* y);
+
+/* Cancellation flag shared by a requester and the engine. Zero-initialize
+ * it; fahren_cancel may be called from any thread (or a signal handler)
+ * and the engine notices it at its next check. */
+typedef struct FAHRENCancelToken {
+    int cancelled;
+} FAHRENCancelToken;
+
+void fahren_cancel(FAHRENCancelToken* token);
+int fahren_cancelled(const FAHRENCancelToken* token); /* NULL is never cancelled */
+
+/* A run of consecutive rows of a batch that belong to one request. */
+typedef struct FAHRENForwardGroup {
+    size_t rows;
+    const FAHRENCancelToken* cancel; /* may be NULL */
+    int cancelled;                   /* set when the group was dropped */
+} FAHRENForwardGroup;
+
+/* fahren_runtime_forward over a batch made of independent requests. The
+ * tokens are checked before every layer; cancelled groups are compacted
+ * out of the activations so the remaining layers only compute live rows.
+ * Output rows of dropped groups are left untouched. Returns
+ * FAHREN_ERROR_CANCELLED once every group has been dropped. */
+FAHRENStatus fahren_runtime_forward_groups(FAHRENRuntime* rt, const float* x, FAHRENForwardGroup* groups,
+                                           size_t group_count, float* y);
+
+/* Number of NUMA nodes split layers are divided across. */
+size_t fahren_runtime_numa_nodes(void);
+
+/* Build a layer chain for the runtime from a spec such as
+ * "784,256:relu:numa:he,10:sigmoid": comma-separated widths, the first
+ * being the input layer, each optionally followed by ":relu", ":sigmoid",
+ * ":tanh" and ":numa", an initializer (":xavier", ":he", ":orthogonal")
+ * and ":zerobias". The array comes from fahren_alloc_layers and is ready
+ * to pass to fahren_init. */
+FAHRENStatus fahren_runtime_parse_layers(const char* spec, FAHRENLayer** layers, size_t* count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_RUNTIME_H */
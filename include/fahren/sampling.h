@@ -0,0 +1,58 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Token sampling over final logits: temperature, top-k and top-p
+ * (nucleus) sampling for a batch of sequences. Rows are processed in
+ * parallel on the library thread pool. Randomness comes from a
+ * counter-based generator, so a (seed, row, step) triple always yields the
+ * same draw no matter which thread handles the row or in what order. */
+#ifndef FAHREN_SAMPLING_H
+#define FAHREN_SAMPLING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fahren/fahren.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Sampling knobs shared by every row of a batch.
+ * temperature <= 0 selects greedy decoding (argmax); top_k == 0 and
+ * top_p >= 1 disable the respective filters. Filters apply in the usual
+ * order: temperature, then top-k, then top-p. */
+typedef struct FAHRENSamplingParams {
+    float temperature;
+    int top_k;
+    float top_p;
+    uint64_t seed;
+} FAHRENSamplingParams;
+
+/* Philox4x32-10 block: four 32-bit counter words and a 64-bit key in,
+ * four uniformly distributed 32-bit words out. */
+void fahren_philox4x32(const uint32_t counter[4], uint64_t key, uint32_t out[4]);
+
+/* Uniform float in [0, 1) for stream `stream` at position `counter`. */
+float fahren_rng_uniform(uint64_t seed, uint64_t stream, uint64_t counter);
+
+/* Sample one token per row from `logits` (batch x vocab, row-major).
+ * `step` is the decoding step and selects the random draw together with
+ * the row index, so replaying a step reproduces its tokens. Writes one
+ * token id per row to `out_tokens`. */
+FAHRENStatus fahren_sample_batch(const float* logits, size_t batch, size_t vocab,
+                                 const FAHRENSamplingParams* params, uint64_t step,
+                                 int32_t* out_tokens);
+
+/* Top-k selection without sorting the vocabulary: writes the indices and
+ * values of the k largest entries of x[0..n) to `idx`/`val` in descending
+ * order. Returns the number written (min(k, n)). */
+size_t fahren_topk_f32(const float* x, size_t n, size_t k, int32_t* idx, float* val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_SAMPLING_H */
@@ -0,0 +1,173 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Deadline-aware request scheduling for several models in one process.
+ * Every request carries an absolute deadline; the scheduler always runs
+ * the model whose oldest-due request is due first (earliest deadline
+ * first across models) and batches that model's requests in deadline
+ * order for as long as the batch, at the model's measured service time,
+ * still finishes before the nearest deadline in it. Requests that could
+ * not finish in time even on their own are shed with
+ * FAHREN_ERROR_DEADLINE_EXCEEDED instead of wasting a batch slot.
+ * Submission applies admission control: a request that would exceed the
+ * model's queue bound, or whose estimated wait (from the measured service
+ * time) blows its deadline or the model's wait bound, is turned away at
+ * once with FAHREN_ERROR_OVERLOADED rather than queued.
+ * A request may carry a cancellation token: cancelled requests are
+ * dropped before they are batched, and rows already running are
+ * compacted out of the batch at the next layer boundary; either way they
+ * complete with FAHREN_ERROR_CANCELLED.
+ * Completion can be observed without blocking a thread: give a request
+ * a callback (fahren_request_signal_eventfd turns that into an eventfd
+ * wakeup for an epoll loop) and check it with fahren_request_poll.
+ * Every decision is reported to an optional trace hook for profiling. */
+#ifndef FAHREN_SCHED_H
+#define FAHREN_SCHED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fahren/fahren.h>
+#include <fahren/runtime.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Clock deadlines are measured on (CLOCK_MONOTONIC, nanoseconds). */
+uint64_t fahren_sched_now_ns(void);
+
+typedef enum FAHRENSchedEventType {
+    FAHREN_SCHED_SUBMIT = 0,     /* request queued */
+    FAHREN_SCHED_SHED = 1,       /* request dropped: estimated finish past its deadline */
+    FAHREN_SCHED_BATCH_START = 2,
+    FAHREN_SCHED_BATCH_DONE = 3,
+    FAHREN_SCHED_REJECT = 4,     /* request refused by admission control */
+    FAHREN_SCHED_CANCEL = 5      /* request dropped through its token before it ran */
+} FAHRENSchedEventType;
+
+typedef struct FAHRENSchedEvent {
+    FAHRENSchedEventType type;
+    size_t model;
+    uint64_t time_ns;
+    size_t requests, rows;   /* the batch, or the one request */
+    uint64_t deadline_ns;    /* nearest deadline involved; UINT64_MAX when none */
+    int64_t slack_ns;        /* deadline minus estimated (or, when done, actual) finish */
+    uint64_t estimated_ns;   /* predicted service time (SUBMIT/REJECT: wait plus service) */
+    uint64_t measured_ns;    /* BATCH_DONE: actual service time */
+    size_t queued;           /* requests still waiting for this model */
+} FAHRENSchedEvent;
+
+/* Called on scheduler and submitting threads, sometimes with the
+ * scheduler's lock held: keep it short and do not call back into the
+ * scheduler from it. */
+typedef void (*fahren_sched_trace_fn)(void* user, const FAHRENSchedEvent* event);
+
+typedef struct FAHRENSchedulerConfig {
+    unsigned workers;              /* batches run concurrently; 0 means 1 */
+    fahren_sched_trace_fn trace;   /* may be NULL */
+    void* trace_user;
+} FAHRENSchedulerConfig;
+
+typedef struct FAHRENSchedModelConfig {
+    unsigned max_batch_rows;  /* 0 means 64 */
+    unsigned default_slo_us;  /* deadline for requests submitted without one; 0 means none */
+    unsigned max_queue_rows;  /* reject past this many queued rows; 0 means no bound */
+    unsigned max_wait_us;     /* reject when the estimated wait is longer; 0 means no bound */
+} FAHRENSchedModelConfig;
+
+struct FAHRENRequest;
+
+/* Completion callback. It runs once per completed request, on a scheduler
+ * worker or on the thread whose call completed the request (cancel,
+ * destroy), with no scheduler lock held, so it may submit again. From
+ * then on the request is the caller's again. */
+typedef void (*fahren_request_done_fn)(struct FAHRENRequest* req, void* user);
+
+/* A request is caller-owned memory (zero-initialize it before first use)
+ * that must stay put until it has completed; the scheduler allocates
+ * nothing per request. */
+typedef struct FAHRENRequest {
+    size_t model;          /* id from fahren_scheduler_add_model */
+    const float* input;    /* rows x input_dim */
+    float* output;         /* rows x output_dim */
+    size_t rows;
+    uint64_t deadline_ns;  /* absolute; 0 uses the model's default SLO */
+    const FAHRENCancelToken* cancel;  /* may be NULL; may be shared by requests */
+    FAHRENStatus status;   /* result, once completed */
+    fahren_request_done_fn on_done;  /* may be NULL */
+    void* user;                      /* passed to on_done */
+    struct {               /* owned by the scheduler */
+        uint64_t seq;
+        uint64_t submit_ns;
+        int state;
+        struct FAHRENRequest* next;  /* completions waiting for their callback */
+    } internal;
+} FAHRENRequest;
+
+typedef struct FAHRENSchedStats {
+    uint64_t submitted, completed, shed, rejected, cancelled, batches, rows;
+    uint64_t late;            /* completed after their deadline */
+    double base_ns, row_ns;   /* current service-time model: base + rows * row */
+} FAHRENSchedStats;
+
+typedef struct FAHRENScheduler FAHRENScheduler;
+
+FAHRENStatus fahren_scheduler_create(const FAHRENSchedulerConfig* config, FAHRENScheduler** out);
+
+/* Requests still queued complete with FAHREN_ERROR_NOT_INITIALIZED, and
+ * their callbacks run before this returns; submissions made meanwhile
+ * (e.g. from those callbacks) are refused with the same status. Nobody
+ * may be waiting on the scheduler any more. */
+void fahren_scheduler_destroy(FAHRENScheduler* sched);
+
+/* Register a runtime (which must outlive the scheduler). Its service time
+ * is calibrated with a couple of forward passes before this returns and
+ * then tracked from every batch it runs. */
+FAHRENStatus fahren_scheduler_add_model(FAHRENScheduler* sched, FAHRENRuntime* rt,
+                                        const FAHRENSchedModelConfig* config, size_t* model);
+
+/* Queue a request; completion is observed with fahren_request_wait,
+ * fahren_request_poll or the request's callback. Returns
+ * FAHREN_ERROR_OVERLOADED, without queuing, when admission control turns
+ * it away, FAHREN_ERROR_CANCELLED when its token has already fired and
+ * FAHREN_ERROR_NOT_INITIALIZED once fahren_scheduler_destroy has begun;
+ * refused requests never see their callback. */
+FAHRENStatus fahren_scheduler_submit(FAHRENScheduler* sched, FAHRENRequest* req);
+
+/* Cancel `token` and complete every queued request that carries it with
+ * FAHREN_ERROR_CANCELLED right away; requests already running stop at
+ * their next layer boundary. fahren_cancel alone has the same effect,
+ * except that queued requests are only reaped when a worker reaches them. */
+void fahren_scheduler_cancel(FAHRENScheduler* sched, FAHRENCancelToken* token);
+
+/* Block until `req` completes and return its status (for a request with
+ * a callback, until the callback has been entered; see below). */
+FAHRENStatus fahren_request_wait(FAHRENScheduler* sched, FAHRENRequest* req);
+
+/* Non-blocking: returns 1 and stores the status once `req` has completed,
+ * 0 while it is queued or running (or was never submitted). A request
+ * with a callback counts as completed as soon as its callback has been
+ * entered, not when it returns: the callback still holds the request, so
+ * a caller that also polls or waits on it must not reuse or free it
+ * until the callback is done with it (e.g. has signalled). */
+int fahren_request_poll(FAHRENScheduler* sched, FAHRENRequest* req, FAHRENStatus* status);
+
+/* Ready-made on_done that adds 1 to the eventfd (or writes 8 bytes to the
+ * pipe) passed as `user`, i.e. (void*)(intptr_t)fd. One descriptor can
+ * serve any number of requests; after it turns readable, drain it and
+ * poll the outstanding requests. */
+void fahren_request_signal_eventfd(FAHRENRequest* req, void* user);
+
+FAHRENStatus fahren_scheduler_stats(FAHRENScheduler* sched, size_t model, FAHRENSchedStats* stats);
+
+/* The runtime registered as `model`, or NULL for an unknown id. */
+FAHRENRuntime* fahren_scheduler_runtime(FAHRENScheduler* sched, size_t model);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_SCHED_H */
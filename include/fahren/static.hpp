@@ -0,0 +1,243 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Compile-time-shaped dense models (header-only, C++20). For small fixed
+ * models every dimension is a template argument, so buffers are
+ * statically sized and every loop has a constant trip count the
+ * compiler can unroll and vectorize:
+ *
+ *   using Net = fahren::Sequential<fahren::Input<32>,
+ *                                  fahren::Dense<32, 64, FAHREN_ACTIVATION_RELU>,
+ *                                  fahren::Dense<64, 8, FAHREN_ACTIVATION_SIGMOID>>;
+ *   auto net = std::make_unique<Net>();   // parameters live inside the object
+ *   if (net->load("weights.bin") != FAHREN_SUCCESS) ...
+ *   net->forward(x, y, rows);
+ *
+ * It reads the same 'FAHN' blobs as fahren_runtime_create for the model
+ * Net::spec() describes and computes the same function. Dense weights are
+ * transposed at load time so the innermost loop runs over outputs; with
+ * that layout the loops vectorize without reassociating any sum. Rows go
+ * through the layers in tiles of Net::tile, with activations in stack
+ * buffers of Net::tile * max_dim floats. Results agree with the runtime
+ * to float rounding (the runtime uses a polynomial exp and SIMD dot
+ * products). Build users with -O3 (or -O2 -ftree-vectorize): GCC's -O2
+ * alone leaves most of these loops scalar. */
+#ifndef FAHREN_STATIC_HPP
+#define FAHREN_STATIC_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <fahren/fahren.h>
+#include <fahren/format.h>
+
+namespace fahren {
+
+namespace detail {
+
+template <FAHRENActivation A>
+inline float activate(float v) noexcept {
+    if constexpr (A == FAHREN_ACTIVATION_RELU) {
+        return v > 0.0f ? v : 0.0f;
+    } else if constexpr (A == FAHREN_ACTIVATION_SIGMOID) {
+        return 1.0f / (1.0f + std::exp(-v));
+    } else if constexpr (A == FAHREN_ACTIVATION_TANH) {
+        return std::tanh(v);
+    } else {
+        return v;
+    }
+}
+
+constexpr const char* act_suffix(FAHRENActivation a) noexcept {
+    switch (a) {
+    case FAHREN_ACTIVATION_RELU:
+        return ":relu";
+    case FAHREN_ACTIVATION_SIGMOID:
+        return ":sigmoid";
+    case FAHREN_ACTIVATION_TANH:
+        return ":tanh";
+    default:
+        return "";
+    }
+}
+
+static_assert(sizeof(FAHRENModelHeader) == 32, "blob header layout");
+
+} // namespace detail
+
+/* The input layer: a per-feature scale and shift, then `A`. */
+template <std::size_t N, FAHRENActivation A = FAHREN_ACTIVATION_NONE>
+struct Input {
+    static constexpr std::size_t in_dim = N, out_dim = N;
+    static constexpr std::size_t weight_count = N, bias_count = N;
+    static constexpr FAHRENActivation activation = A;
+    static constexpr bool input_layer = true;
+
+    std::array<float, N> scale{};
+    std::array<float, N> shift{};
+
+    bool read_weights(std::FILE* f) { return std::fread(scale.data(), sizeof(float), N, f) == N; }
+    bool read_biases(std::FILE* f) { return std::fread(shift.data(), sizeof(float), N, f) == N; }
+
+    template <std::size_t R>
+    void apply(const float* x, float* y) const noexcept {
+        for (std::size_t r = 0; r < R; ++r) {
+            for (std::size_t i = 0; i < N; ++i) {
+                y[r * N + i] = detail::activate<A>(x[r * N + i] * scale[i] + shift[i]);
+            }
+        }
+    }
+};
+
+/* y = A(W x + b) with W stored Out x In in the blob, In x Out here. */
+template <std::size_t In, std::size_t Out, FAHRENActivation A = FAHREN_ACTIVATION_NONE>
+struct Dense {
+    static_assert(In > 0 && Out > 0, "empty layer");
+    static constexpr std::size_t in_dim = In, out_dim = Out;
+    static constexpr std::size_t weight_count = In * Out, bias_count = Out;
+    static constexpr FAHRENActivation activation = A;
+    static constexpr bool input_layer = false;
+
+    std::array<float, In * Out> wt{};  /* wt[i * Out + o] = W[o][i] */
+    std::array<float, Out> bias{};
+
+    bool read_weights(std::FILE* f) {
+        std::vector<float> w(In * Out);
+        if (std::fread(w.data(), sizeof(float), w.size(), f) != w.size()) return false;
+        for (std::size_t o = 0; o < Out; ++o) {
+            for (std::size_t i = 0; i < In; ++i) wt[i * Out + o] = w[o * In + i];
+        }
+        return true;
+    }
+    bool read_biases(std::FILE* f) { return std::fread(bias.data(), sizeof(float), Out, f) == Out; }
+
+    template <std::size_t R>
+    void apply(const float* x, float* y) const noexcept {
+        float acc[R][Out];
+        for (std::size_t r = 0; r < R; ++r) {
+            for (std::size_t o = 0; o < Out; ++o) acc[r][o] = bias[o];
+        }
+        for (std::size_t i = 0; i < In; ++i) {
+            const float* w = wt.data() + i * Out;
+            for (std::size_t r = 0; r < R; ++r) {
+                const float xi = x[r * In + i];
+                for (std::size_t o = 0; o < Out; ++o) acc[r][o] += xi * w[o];
+            }
+        }
+        for (std::size_t r = 0; r < R; ++r) {
+            for (std::size_t o = 0; o < Out; ++o) y[r * Out + o] = detail::activate<A>(acc[r][o]);
+        }
+    }
+};
+
+template <class First, class... Rest>
+class Sequential {
+    static constexpr std::size_t layer_count = 1 + sizeof...(Rest);
+
+    template <class Prev, class... Next>
+    static constexpr bool chained() {
+        if constexpr (sizeof...(Next) == 0) {
+            return true;
+        } else {
+            using N = std::tuple_element_t<0, std::tuple<Next...>>;
+            return Prev::out_dim == N::in_dim && chained<Next...>();
+        }
+    }
+    static_assert(First::input_layer && !(Rest::input_layer || ...), "an Input layer comes first, and only there");
+    static_assert(chained<First, Rest...>(), "each layer must take the previous layer's output width");
+
+    using Layers = std::tuple<First, Rest...>;
+    using Last = std::tuple_element_t<layer_count - 1, Layers>;
+
+public:
+    static constexpr std::size_t input_dim = First::in_dim;
+    static constexpr std::size_t output_dim = Last::out_dim;
+    static constexpr std::size_t max_dim = std::max({First::out_dim, Rest::out_dim...});
+    static constexpr std::size_t weight_count = (First::weight_count + ... + Rest::weight_count);
+    static constexpr std::size_t bias_count = (First::bias_count + ... + Rest::bias_count);
+    static constexpr std::size_t tile = 4;
+
+    /* The fahren_runtime_parse_layers spec of the same model. */
+    static std::string spec() {
+        std::string s;
+        auto add = [&s](std::size_t width, FAHRENActivation act) {
+            if (!s.empty()) s += ',';
+            s += std::to_string(width);
+            s += detail::act_suffix(act);
+        };
+        add(First::out_dim, First::activation);
+        (add(Rest::out_dim, Rest::activation), ...);
+        return s;
+    }
+
+    /* Load a blob written for spec(). FAHREN_ERROR_INVALID_ARGUMENT when
+     * it is not a FAHN blob of exactly this model's size. */
+    FAHRENStatus load(const char* path) {
+        std::FILE* f = path ? std::fopen(path, "rb") : nullptr;
+        if (!f) return FAHREN_ERROR_PROCESSING_FAILED;
+        FAHRENModelHeader h;
+        FAHRENStatus st = FAHREN_SUCCESS;
+        if (std::fread(&h, sizeof(h), 1, f) != 1 || h.magic != FAHREN_MODEL_MAGIC ||
+            h.weight_count != weight_count || h.bias_count != bias_count) {
+            st = FAHREN_ERROR_INVALID_ARGUMENT;
+        } else {
+            bool ok = std::apply([&](auto&... layer) { return (layer.read_weights(f) && ...); }, layers_);
+            ok = ok && std::apply([&](auto&... layer) { return (layer.read_biases(f) && ...); }, layers_);
+            if (!ok) st = FAHREN_ERROR_PROCESSING_FAILED;
+        }
+        std::fclose(f);
+        return st;
+    }
+
+    /* x is rows x input_dim, y rows x output_dim, both row-major. */
+    void forward(const float* x, float* y, std::size_t rows) const noexcept {
+        std::size_t r = 0;
+        for (; r + tile <= rows; r += tile) run<tile>(x + r * input_dim, y + r * output_dim);
+        for (; r < rows; ++r) run<1>(x + r * input_dim, y + r * output_dim);
+    }
+
+    template <std::size_t I>
+    auto& layer() noexcept {
+        return std::get<I>(layers_);
+    }
+
+private:
+    template <std::size_t R>
+    void run(const float* x, float* y) const noexcept {
+        if constexpr (layer_count == 1) {
+            std::get<0>(layers_).template apply<R>(x, y);
+        } else {
+            float a[R * max_dim], b[R * max_dim];
+            step<0, R>(x, a, b, y);
+        }
+    }
+
+    /* Layer I reads `in` and writes `out` (or y when it is the last one). */
+    template <std::size_t I, std::size_t R>
+    void step(const float* in, float* out, float* spare, float* y) const noexcept {
+        if constexpr (I + 1 == layer_count) {
+            (void)out;
+            (void)spare;
+            std::get<I>(layers_).template apply<R>(in, y);
+        } else {
+            std::get<I>(layers_).template apply<R>(in, out);
+            step<I + 1, R>(out, spare, out, y);
+        }
+    }
+
+    Layers layers_;
+};
+
+} // namespace fahren
+
+#endif /* FAHREN_STATIC_HPP */
@@ -0,0 +1,83 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Strided tensor descriptors. A tensor is a view: an element type, a
+ * shape, per-axis strides in elements (possibly zero or negative) and an
+ * element offset into a buffer the caller owns, e.g. one arena shared by
+ * many tensors. Slicing, transposing, broadcasting an axis and most
+ * reshapes only rewrite the descriptor; fahren_tensor_copy materializes
+ * a view into any other layout when a kernel really needs one.
+ * fahren_runtime_forward_tensor (runtime.h) takes such views directly,
+ * so a sliced, transposed or concatenated-into layout between models
+ * costs no copy. */
+#ifndef FAHREN_TENSOR_H
+#define FAHREN_TENSOR_H
+
+#include <stddef.h>
+
+#include <fahren/fahren.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FAHREN_TENSOR_MAX_RANK 6
+
+/* Kernels compute in F32; F16 (IEEE half) and BF16 are storage types for
+ * views and model files (format.h). */
+typedef enum FAHRENDType {
+    FAHREN_DTYPE_F32 = 0,
+    FAHREN_DTYPE_F16 = 1,
+    FAHREN_DTYPE_BF16 = 2
+} FAHRENDType;
+
+typedef struct FAHRENTensor {
+    FAHRENDType dtype;
+    size_t rank;                              /* 0 is a scalar */
+    size_t shape[FAHREN_TENSOR_MAX_RANK];
+    ptrdiff_t strides[FAHREN_TENSOR_MAX_RANK]; /* in elements */
+    void* base;                               /* buffer (arena) the view points into */
+    size_t offset;                            /* element offset of index (0, ..., 0) */
+} FAHRENTensor;
+
+/* Size in bytes of one element of `dtype`; 0 for an unknown type. */
+size_t fahren_dtype_size(FAHRENDType dtype);
+
+/* Describe a row-major, contiguous tensor at base + offset elements. */
+FAHRENStatus fahren_tensor_init(FAHRENTensor* t, FAHRENDType dtype, void* base, size_t offset, size_t rank,
+                                const size_t* shape);
+
+size_t fahren_tensor_numel(const FAHRENTensor* t);
+
+/* Non-zero when the elements are packed in row-major order. */
+int fahren_tensor_is_contiguous(const FAHRENTensor* t);
+
+/* Address of element (0, ..., 0). */
+void* fahren_tensor_data(const FAHRENTensor* t);
+
+/* Views. `out` may be `t`. */
+FAHRENStatus fahren_tensor_slice(const FAHRENTensor* t, size_t axis, size_t begin, size_t end, FAHRENTensor* out);
+FAHRENStatus fahren_tensor_transpose(const FAHRENTensor* t, size_t axis_a, size_t axis_b, FAHRENTensor* out);
+/* Reverse `axis` (negative stride). */
+FAHRENStatus fahren_tensor_flip(const FAHRENTensor* t, size_t axis, FAHRENTensor* out);
+/* Repeat a size-1 axis `size` times with stride 0. */
+FAHRENStatus fahren_tensor_broadcast(const FAHRENTensor* t, size_t axis, size_t size, FAHRENTensor* out);
+
+/* Same elements, new shape, still a view. Fails with
+ * FAHREN_ERROR_INVALID_ARGUMENT when the element counts differ or when
+ * the strides cannot express the new shape without a copy (copy into a
+ * contiguous tensor first then). */
+FAHRENStatus fahren_tensor_reshape(const FAHRENTensor* t, size_t rank, const size_t* shape, FAHRENTensor* out);
+
+/* dst = src elementwise; same dtype and shape, any strides. Destinations
+ * that overlap themselves (a zero stride) or the source are not
+ * supported. */
+FAHRENStatus fahren_tensor_copy(const FAHRENTensor* src, const FAHRENTensor* dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_TENSOR_H */
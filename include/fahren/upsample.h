@@ -0,0 +1,38 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Spatial upsampling of NCHW tensors. `planes` is batch * channels: every
+ * H x W plane is resized independently, in parallel across planes. */
+#ifndef FAHREN_UPSAMPLE_H
+#define FAHREN_UPSAMPLE_H
+
+#include <stddef.h>
+
+#include <fahren/fahren.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Nearest neighbour by integer factors: y is (h * scale_h) x (w * scale_w). */
+FAHRENStatus fahren_upsample_nearest_forward(const float* x, size_t planes, int h, int w,
+                                             int scale_h, int scale_w, float* y);
+/* dx (overwritten) = sum of the dy entries each input pixel was copied to. */
+FAHRENStatus fahren_upsample_nearest_backward(const float* dy, size_t planes, int h, int w,
+                                              int scale_h, int scale_w, float* dx);
+
+/* Bilinear resize to out_h x out_w with half-pixel centres
+ * (align_corners = false), matching the common framework default. */
+FAHRENStatus fahren_upsample_bilinear_forward(const float* x, size_t planes, int h, int w,
+                                              int out_h, int out_w, float* y);
+/* dx is overwritten with the gradient w.r.t. the h x w input. */
+FAHRENStatus fahren_upsample_bilinear_backward(const float* dy, size_t planes, int h, int w,
+                                               int out_h, int out_w, float* dx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAHREN_UPSAMPLE_H */
@@ -0,0 +1,528 @@
+/* Reverse-mode autodiff tape. See include/fahren/autograd.h.
+ * Variables are recorded in creation order, and an op only takes
+ * variables that already exist, so the record is already a topological
+ * order: backward walks it from the loss down to 0 and every gradient is
+ * complete by the time its variable is reached. A gradient buffer is
+ * taken (zeroed) when the first contribution arrives from a consumer and
+ * returned to a free list right after the variable's own step, which is
+ * its last use; buffers are matched by exact size, which fits the
+ * repeating shapes of layer stacks. Parameter leaves accumulate straight
+ * into the caller's buffers. The free list and all buffers sit in
+ * storage sized at creation, so neither recording nor backward calls
+ * malloc, and reset just rewinds two counters. */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fahren/autograd.h>
+#include "fahren_internal.h"
+
+#define FAHREN_TAPE_ALIGN 64
+
+typedef enum FahrenTapeOp {
+    FAHREN_TAPE_LEAF = 0,
+    FAHREN_TAPE_ADD,
+    FAHREN_TAPE_SUB,
+    FAHREN_TAPE_MUL,
+    FAHREN_TAPE_SCALE,
+    FAHREN_TAPE_MATMUL,
+    FAHREN_TAPE_ACT,
+    FAHREN_TAPE_EXP,
+    FAHREN_TAPE_LOG,
+    FAHREN_TAPE_SUM,
+    FAHREN_TAPE_MEAN,
+    FAHREN_TAPE_XENT,
+    FAHREN_TAPE_MSE
+} FahrenTapeOp;
+
+typedef struct FahrenTapeNode {
+    FahrenTapeOp op;
+    FAHRENActivation act;
+    int needs_grad;      /* some parameter flows into it */
+    FAHRENVar a, b;
+    size_t rows, cols;
+    const float* value;
+    float* param_grad;   /* parameter leaves: the caller's buffer */
+    float* grad;         /* during backward, NULL until reached */
+    float s;             /* SCALE factor */
+    const int* labels;   /* XENT */
+    const float* aux;    /* XENT: softmax probabilities */
+} FahrenTapeNode;
+
+typedef struct FahrenTapeBlock {
+    float* p;
+    size_t n;
+} FahrenTapeBlock;
+
+struct FAHRENTape {
+    FahrenTapeNode* nodes;
+    size_t max_vars, count;
+    unsigned char* arena;
+    size_t cap, used, peak;
+    FahrenTapeBlock* free_blocks; /* max_vars entries */
+    size_t free_count;
+};
+
+FAHRENStatus fahren_tape_create(size_t max_vars, size_t arena_bytes, FAHRENTape** out) {
+    if (!out || max_vars == 0 || arena_bytes == 0) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *out = NULL;
+    FAHRENTape* t = (FAHRENTape*)calloc(1, sizeof(*t));
+    if (!t) return FAHREN_ERROR_PROCESSING_FAILED;
+    t->max_vars = max_vars;
+    t->cap = (arena_bytes + FAHREN_TAPE_ALIGN - 1) & ~(size_t)(FAHREN_TAPE_ALIGN - 1);
+    t->nodes = (FahrenTapeNode*)calloc(max_vars, sizeof(*t->nodes));
+    t->free_blocks = (FahrenTapeBlock*)calloc(max_vars, sizeof(*t->free_blocks));
+    t->arena = (unsigned char*)aligned_alloc(FAHREN_TAPE_ALIGN, t->cap);
+    if (!t->nodes || !t->free_blocks || !t->arena) {
+        fahren_tape_destroy(t);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    *out = t;
+    return FAHREN_SUCCESS;
+}
+
+void fahren_tape_destroy(FAHRENTape* tape) {
+    if (!tape) return;
+    free(tape->nodes);
+    free(tape->free_blocks);
+    free(tape->arena);
+    free(tape);
+}
+
+void fahren_tape_reset(FAHRENTape* tape) {
+    if (!tape) return;
+    tape->count = 0;
+    tape->used = 0;
+}
+
+size_t fahren_tape_arena_used(const FAHRENTape* tape) {
+    return tape ? tape->used : 0;
+}
+
+size_t fahren_tape_arena_peak(const FAHRENTape* tape) {
+    return tape ? tape->peak : 0;
+}
+
+static float* fahren_tape_alloc(FAHRENTape* t, size_t floats) {
+    size_t bytes = floats * sizeof(float);
+    if (floats > SIZE_MAX / sizeof(float) || bytes > t->cap - t->used) return NULL;
+    float* p = (float*)(t->arena + t->used);
+    t->used += (bytes + FAHREN_TAPE_ALIGN - 1) & ~(size_t)(FAHREN_TAPE_ALIGN - 1);
+    if (t->used > t->cap) t->used = t->cap;
+    if (t->used > t->peak) t->peak = t->used;
+    return p;
+}
+
+/* Append a variable; `value` is allocated in the arena unless `extern_value`
+ * is given. */
+static FAHRENStatus fahren_tape_push(FAHRENTape* t, FahrenTapeOp op, FAHRENVar a, FAHRENVar b, size_t rows,
+                                     size_t cols, const float* extern_value, FahrenTapeNode** node, float** value) {
+    if (t->count == t->max_vars) return FAHREN_ERROR_PROCESSING_FAILED;
+    if (cols && rows > SIZE_MAX / cols) return FAHREN_ERROR_INVALID_ARGUMENT;
+    float* v = NULL;
+    if (!extern_value) {
+        v = fahren_tape_alloc(t, rows * cols);
+        if (!v) return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    FahrenTapeNode* n = &t->nodes[t->count++];
+    memset(n, 0, sizeof(*n));
+    n->op = op;
+    n->a = a;
+    n->b = b;
+    n->rows = rows;
+    n->cols = cols;
+    n->value = extern_value ? extern_value : v;
+    if (op != FAHREN_TAPE_LEAF) {
+        n->needs_grad = t->nodes[a].needs_grad || (b != a && t->nodes[b].needs_grad);
+    }
+    *node = n;
+    if (value) *value = v;
+    return FAHREN_SUCCESS;
+}
+
+static int fahren_tape_valid(const FAHRENTape* t, FAHRENVar v) {
+    return t && v < t->count;
+}
+
+/* ---- leaves and accessors ---------------------------------------------- */
+
+FAHRENStatus fahren_tape_param(FAHRENTape* tape, const float* value, float* grad, size_t rows, size_t cols,
+                               FAHRENVar* out) {
+    if (!tape || !value || !grad || !out || rows == 0 || cols == 0) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenTapeNode* n;
+    FAHRENStatus st = fahren_tape_push(tape, FAHREN_TAPE_LEAF, 0, 0, rows, cols, value, &n, NULL);
+    if (st != FAHREN_SUCCESS) return st;
+    n->param_grad = grad;
+    n->needs_grad = 1;
+    *out = tape->count - 1;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_tape_constant(FAHRENTape* tape, const float* value, size_t rows, size_t cols, FAHRENVar* out) {
+    if (!tape || !value || !out || rows == 0 || cols == 0) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenTapeNode* n;
+    FAHRENStatus st = fahren_tape_push(tape, FAHREN_TAPE_LEAF, 0, 0, rows, cols, value, &n, NULL);
+    if (st != FAHREN_SUCCESS) return st;
+    *out = tape->count - 1;
+    return FAHREN_SUCCESS;
+}
+
+const float* fahren_tape_value(const FAHRENTape* tape, FAHRENVar v) {
+    return fahren_tape_valid(tape, v) ? tape->nodes[v].value : NULL;
+}
+
+void fahren_tape_shape(const FAHRENTape* tape, FAHRENVar v, size_t* rows, size_t* cols) {
+    int ok = fahren_tape_valid(tape, v);
+    if (rows) *rows = ok ? tape->nodes[v].rows : 0;
+    if (cols) *cols = ok ? tape->nodes[v].cols : 0;
+}
+
+/* ---- forward ops -------------------------------------------------------- */
+
+static FAHRENStatus fahren_tape_binary(FAHRENTape* t, FahrenTapeOp op, FAHRENVar a, FAHRENVar b, int broadcast,
+                                       FAHRENVar* out) {
+    if (!fahren_tape_valid(t, a) || !fahren_tape_valid(t, b) || !out) return FAHREN_ERROR_INVALID_ARGUMENT;
+    const FahrenTapeNode* na = &t->nodes[a];
+    const FahrenTapeNode* nb = &t->nodes[b];
+    int row = broadcast && nb->rows == 1 && nb->cols == na->cols;
+    if (!row && (na->rows != nb->rows || na->cols != nb->cols)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t rows = na->rows, cols = na->cols;
+    const float* x = na->value;
+    const float* y = nb->value;
+    FahrenTapeNode* n;
+    float* v;
+    FAHRENStatus st = fahren_tape_push(t, op, a, b, rows, cols, NULL, &n, &v);
+    if (st != FAHREN_SUCCESS) return st;
+    for (size_t r = 0; r < rows; ++r) {
+        const float* xr = x + r * cols;
+        const float* yr = row ? y : y + r * cols;
+        float* vr = v + r * cols;
+        if (op == FAHREN_TAPE_ADD) {
+            for (size_t c = 0; c < cols; ++c) vr[c] = xr[c] + yr[c];
+        } else if (op == FAHREN_TAPE_SUB) {
+            for (size_t c = 0; c < cols; ++c) vr[c] = xr[c] - yr[c];
+        } else {
+            for (size_t c = 0; c < cols; ++c) vr[c] = xr[c] * yr[c];
+        }
+    }
+    *out = t->count - 1;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_tape_add(FAHRENTape* tape, FAHRENVar a, FAHRENVar b, FAHRENVar* out) {
+    return fahren_tape_binary(tape, FAHREN_TAPE_ADD, a, b, 1, out);
+}
+
+FAHRENStatus fahren_tape_sub(FAHRENTape* tape, FAHRENVar a, FAHRENVar b, FAHRENVar* out) {
+    return fahren_tape_binary(tape, FAHREN_TAPE_SUB, a, b, 1, out);
+}
+
+FAHRENStatus fahren_tape_mul(FAHRENTape* tape, FAHRENVar a, FAHRENVar b, FAHRENVar* out) {
+    return fahren_tape_binary(tape, FAHREN_TAPE_MUL, a, b, 0, out);
+}
+
+/* Unary elementwise op `op` (with `act` for FAHREN_TAPE_ACT). */
+static FAHRENStatus fahren_tape_unary(FAHRENTape* t, FahrenTapeOp op, FAHRENVar a, FAHRENActivation act, float s,
+                                      FAHRENVar* out) {
+    if (!fahren_tape_valid(t, a) || !out) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t n_el = t->nodes[a].rows * t->nodes[a].cols;
+    FahrenTapeNode* n;
+    float* v;
+    FAHRENStatus st = fahren_tape_push(t, op, a, a, t->nodes[a].rows, t->nodes[a].cols, NULL, &n, &v);
+    if (st != FAHREN_SUCCESS) return st;
+    n->act = act;
+    n->s = s;
+    const float* x = t->nodes[a].value;
+    for (size_t i = 0; i < n_el; ++i) {
+        float xi = x[i];
+        switch (op) {
+        case FAHREN_TAPE_SCALE:
+            v[i] = s * xi;
+            break;
+        case FAHREN_TAPE_EXP:
+            v[i] = expf(xi);
+            break;
+        case FAHREN_TAPE_LOG:
+            v[i] = logf(xi);
+            break;
+        default: /* FAHREN_TAPE_ACT */
+            if (act == FAHREN_ACTIVATION_RELU) v[i] = xi > 0.0f ? xi : 0.0f;
+            else if (act == FAHREN_ACTIVATION_SIGMOID) v[i] = 1.0f / (1.0f + expf(-xi));
+            else if (act == FAHREN_ACTIVATION_TANH) v[i] = tanhf(xi);
+            else v[i] = xi;
+            break;
+        }
+    }
+    *out = t->count - 1;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_tape_scale(FAHRENTape* tape, FAHRENVar a, float s, FAHRENVar* out) {
+    return fahren_tape_unary(tape, FAHREN_TAPE_SCALE, a, FAHREN_ACTIVATION_NONE, s, out);
+}
+
+FAHRENStatus fahren_tape_activation(FAHRENTape* tape, FAHRENVar a, FAHRENActivation act, FAHRENVar* out) {
+    if ((unsigned)act > FAHREN_ACTIVATION_TANH) return FAHREN_ERROR_INVALID_ARGUMENT;
+    return fahren_tape_unary(tape, FAHREN_TAPE_ACT, a, act, 0.0f, out);
+}
+
+FAHRENStatus fahren_tape_exp(FAHRENTape* tape, FAHRENVar a, FAHRENVar* out) {
+    return fahren_tape_unary(tape, FAHREN_TAPE_EXP, a, FAHREN_ACTIVATION_NONE, 0.0f, out);
+}
+
+FAHRENStatus fahren_tape_log(FAHRENTape* tape, FAHRENVar a, FAHRENVar* out) {
+    return fahren_tape_unary(tape, FAHREN_TAPE_LOG, a, FAHREN_ACTIVATION_NONE, 0.0f, out);
+}
+
+FAHRENStatus fahren_tape_matmul(FAHRENTape* tape, FAHRENVar a, FAHRENVar b, FAHRENVar* out) {
+    if (!fahren_tape_valid(tape, a) || !fahren_tape_valid(tape, b) || !out) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t m = tape->nodes[a].rows, k = tape->nodes[a].cols, n = tape->nodes[b].cols;
+    if (tape->nodes[b].rows != k) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t mark = tape->used;
+    FahrenTapeNode* node;
+    float* v;
+    FAHRENStatus st = fahren_tape_push(tape, FAHREN_TAPE_MATMUL, a, b, m, n, NULL, &node, &v);
+    if (st != FAHREN_SUCCESS) return st;
+    if (!fahren_sgemm(0, 0, m, n, k, 1.0f, tape->nodes[a].value, k, tape->nodes[b].value, n, 0.0f, v, n)) {
+        tape->count--;
+        tape->used = mark;
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    *out = tape->count - 1;
+    return FAHREN_SUCCESS;
+}
+
+static FAHRENStatus fahren_tape_reduce(FAHRENTape* t, FahrenTapeOp op, FAHRENVar a, FAHRENVar* out) {
+    if (!fahren_tape_valid(t, a) || !out) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t n_el = t->nodes[a].rows * t->nodes[a].cols;
+    FahrenTapeNode* n;
+    float* v;
+    FAHRENStatus st = fahren_tape_push(t, op, a, a, 1, 1, NULL, &n, &v);
+    if (st != FAHREN_SUCCESS) return st;
+    double sum = 0.0;
+    const float* x = t->nodes[a].value;
+    for (size_t i = 0; i < n_el; ++i) sum += x[i];
+    v[0] = (float)(op == FAHREN_TAPE_MEAN ? sum / (double)n_el : sum);
+    *out = t->count - 1;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_tape_sum(FAHRENTape* tape, FAHRENVar a, FAHRENVar* out) {
+    return fahren_tape_reduce(tape, FAHREN_TAPE_SUM, a, out);
+}
+
+FAHRENStatus fahren_tape_mean(FAHRENTape* tape, FAHRENVar a, FAHRENVar* out) {
+    return fahren_tape_reduce(tape, FAHREN_TAPE_MEAN, a, out);
+}
+
+FAHRENStatus fahren_tape_softmax_xent(FAHRENTape* tape, FAHRENVar logits, const int* labels, FAHRENVar* out) {
+    if (!fahren_tape_valid(tape, logits) || !labels || !out) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t m = tape->nodes[logits].rows, n = tape->nodes[logits].cols;
+    for (size_t r = 0; r < m; ++r) {
+        if (labels[r] < 0 || (size_t)labels[r] >= n) return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    size_t mark = tape->used;
+    float* p = fahren_tape_alloc(tape, m * n);
+    if (!p) return FAHREN_ERROR_PROCESSING_FAILED;
+    FahrenTapeNode* node;
+    float* v;
+    FAHRENStatus st = fahren_tape_push(tape, FAHREN_TAPE_XENT, logits, logits, 1, 1, NULL, &node, &v);
+    if (st != FAHREN_SUCCESS) {
+        tape->used = mark;
+        return st;
+    }
+    node->labels = labels;
+    node->aux = p;
+    const float* x = tape->nodes[logits].value;
+    double loss = 0.0;
+    for (size_t r = 0; r < m; ++r) {
+        const float* xr = x + r * n;
+        float* pr = p + r * n;
+        float mx = xr[0];
+        for (size_t c = 1; c < n; ++c) mx = xr[c] > mx ? xr[c] : mx;
+        float sum = 0.0f;
+        for (size_t c = 0; c < n; ++c) {
+            pr[c] = expf(xr[c] - mx);
+            sum += pr[c];
+        }
+        for (size_t c = 0; c < n; ++c) pr[c] /= sum;
+        loss += (double)(logf(sum) + mx - xr[labels[r]]);
+    }
+    v[0] = (float)(loss / (double)m);
+    *out = tape->count - 1;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_tape_mse(FAHRENTape* tape, FAHRENVar a, FAHRENVar b, FAHRENVar* out) {
+    if (!fahren_tape_valid(tape, a) || !fahren_tape_valid(tape, b) || !out) return FAHREN_ERROR_INVALID_ARGUMENT;
+    const FahrenTapeNode* na = &tape->nodes[a];
+    const FahrenTapeNode* nb = &tape->nodes[b];
+    if (na->rows != nb->rows || na->cols != nb->cols) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t n_el = na->rows * na->cols;
+    const float* x = na->value;
+    const float* y = nb->value;
+    FahrenTapeNode* n;
+    float* v;
+    FAHRENStatus st = fahren_tape_push(tape, FAHREN_TAPE_MSE, a, b, 1, 1, NULL, &n, &v);
+    if (st != FAHREN_SUCCESS) return st;
+    double sum = 0.0;
+    for (size_t i = 0; i < n_el; ++i) sum += (double)(x[i] - y[i]) * (x[i] - y[i]);
+    v[0] = (float)(sum / (double)n_el);
+    *out = tape->count - 1;
+    return FAHREN_SUCCESS;
+}
+
+/* ---- backward ----------------------------------------------------------- */
+
+/* Gradient buffer of variable `v`, taken when the first contribution
+ * arrives; NULL when nothing upstream needs it (or the arena is full,
+ * which backward reports through *failed). */
+static float* fahren_tape_grad_of(FAHRENTape* t, FAHRENVar v, int* failed) {
+    FahrenTapeNode* n = &t->nodes[v];
+    if (!n->needs_grad) return NULL;
+    if (n->param_grad) return n->param_grad;
+    if (n->grad) return n->grad;
+    size_t floats = n->rows * n->cols;
+    float* g = NULL;
+    for (size_t i = 0; i < t->free_count; ++i) {
+        if (t->free_blocks[i].n == floats) {
+            g = t->free_blocks[i].p;
+            t->free_blocks[i] = t->free_blocks[--t->free_count];
+            break;
+        }
+    }
+    if (!g) g = fahren_tape_alloc(t, floats);
+    if (!g) {
+        *failed = 1;
+        return NULL;
+    }
+    memset(g, 0, floats * sizeof(float));
+    n->grad = g;
+    return g;
+}
+
+static FAHRENStatus fahren_tape_step(FAHRENTape* t, const FahrenTapeNode* n, int* failed) {
+    const float* g = n->grad;
+    const FahrenTapeNode* na = &t->nodes[n->a];
+    const FahrenTapeNode* nb = &t->nodes[n->b];
+    size_t n_el = n->rows * n->cols;
+    float* ga;
+    float* gb;
+    switch (n->op) {
+    case FAHREN_TAPE_ADD:
+    case FAHREN_TAPE_SUB: {
+        float sign = n->op == FAHREN_TAPE_ADD ? 1.0f : -1.0f;
+        if ((ga = fahren_tape_grad_of(t, n->a, failed))) {
+            for (size_t i = 0; i < n_el; ++i) ga[i] += g[i];
+        }
+        if ((gb = fahren_tape_grad_of(t, n->b, failed))) {
+            size_t stride = nb->rows == 1 && n->rows != 1 ? 0 : n->cols;
+            for (size_t r = 0; r < n->rows; ++r) {
+                for (size_t c = 0; c < n->cols; ++c) gb[r * stride + c] += sign * g[r * n->cols + c];
+            }
+        }
+        break;
+    }
+    case FAHREN_TAPE_MUL:
+        if ((ga = fahren_tape_grad_of(t, n->a, failed))) {
+            for (size_t i = 0; i < n_el; ++i) ga[i] += g[i] * nb->value[i];
+        }
+        if ((gb = fahren_tape_grad_of(t, n->b, failed))) {
+            for (size_t i = 0; i < n_el; ++i) gb[i] += g[i] * na->value[i];
+        }
+        break;
+    case FAHREN_TAPE_MATMUL: {
+        size_t m = na->rows, k = na->cols, cols = nb->cols;
+        /* dA += dC * B^T, dB += A^T * dC */
+        if ((ga = fahren_tape_grad_of(t, n->a, failed)) &&
+            !fahren_sgemm(0, 1, m, k, cols, 1.0f, g, cols, nb->value, cols, 1.0f, ga, k)) {
+            return FAHREN_ERROR_PROCESSING_FAILED;
+        }
+        if ((gb = fahren_tape_grad_of(t, n->b, failed)) &&
+            !fahren_sgemm(1, 0, k, cols, m, 1.0f, na->value, k, g, cols, 1.0f, gb, cols)) {
+            return FAHREN_ERROR_PROCESSING_FAILED;
+        }
+        break;
+    }
+    case FAHREN_TAPE_SCALE:
+    case FAHREN_TAPE_ACT:
+    case FAHREN_TAPE_EXP:
+    case FAHREN_TAPE_LOG: {
+        if (!(ga = fahren_tape_grad_of(t, n->a, failed))) break;
+        const float* x = na->value;
+        const float* y = n->value;
+        for (size_t i = 0; i < n_el; ++i) {
+            float d;
+            if (n->op == FAHREN_TAPE_SCALE) d = n->s;
+            else if (n->op == FAHREN_TAPE_EXP) d = y[i];
+            else if (n->op == FAHREN_TAPE_LOG) d = 1.0f / x[i];
+            else if (n->act == FAHREN_ACTIVATION_RELU) d = x[i] > 0.0f ? 1.0f : 0.0f;
+            else if (n->act == FAHREN_ACTIVATION_SIGMOID) d = y[i] * (1.0f - y[i]);
+            else if (n->act == FAHREN_ACTIVATION_TANH) d = 1.0f - y[i] * y[i];
+            else d = 1.0f;
+            ga[i] += g[i] * d;
+        }
+        break;
+    }
+    case FAHREN_TAPE_SUM:
+    case FAHREN_TAPE_MEAN: {
+        if (!(ga = fahren_tape_grad_of(t, n->a, failed))) break;
+        size_t count = na->rows * na->cols;
+        float d = n->op == FAHREN_TAPE_MEAN ? g[0] / (float)count : g[0];
+        for (size_t i = 0; i < count; ++i) ga[i] += d;
+        break;
+    }
+    case FAHREN_TAPE_XENT: {
+        if (!(ga = fahren_tape_grad_of(t, n->a, failed))) break;
+        size_t m = na->rows, cols = na->cols;
+        float d = g[0] / (float)m;
+        for (size_t r = 0; r < m; ++r) {
+            for (size_t c = 0; c < cols; ++c) ga[r * cols + c] += d * n->aux[r * cols + c];
+            ga[r * cols + (size_t)n->labels[r]] -= d;
+        }
+        break;
+    }
+    case FAHREN_TAPE_MSE: {
+        size_t count = na->rows * na->cols;
+        float d = 2.0f * g[0] / (float)count;
+        if ((ga = fahren_tape_grad_of(t, n->a, failed))) {
+            for (size_t i = 0; i < count; ++i) ga[i] += d * (na->value[i] - nb->value[i]);
+        }
+        if ((gb = fahren_tape_grad_of(t, n->b, failed))) {
+            for (size_t i = 0; i < count; ++i) gb[i] -= d * (na->value[i] - nb->value[i]);
+        }
+        break;
+    }
+    case FAHREN_TAPE_LEAF:
+        break;
+    }
+    return *failed ? FAHREN_ERROR_PROCESSING_FAILED : FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_tape_backward(FAHRENTape* tape, FAHRENVar loss) {
+    if (!fahren_tape_valid(tape, loss)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenTapeNode* nodes = tape->nodes;
+    if (nodes[loss].rows != 1 || nodes[loss].cols != 1) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (!nodes[loss].needs_grad) return FAHREN_SUCCESS;
+    for (size_t i = 0; i <= loss; ++i) nodes[i].grad = NULL;
+    size_t mark = tape->used;
+    tape->free_count = 0;
+
+    int failed = 0;
+    FAHRENStatus st = FAHREN_SUCCESS;
+    float* seed = fahren_tape_grad_of(tape, loss, &failed);
+    if (!seed) st = FAHREN_ERROR_PROCESSING_FAILED;
+    else seed[0] += 1.0f;
+    for (size_t i = loss + 1; st == FAHREN_SUCCESS && i-- > 0;) {
+        FahrenTapeNode* n = &nodes[i];
+        if (!n->grad || n->op == FAHREN_TAPE_LEAF) continue;
+        st = fahren_tape_step(tape, n, &failed);
+        /* last use of this gradient: recycle it */
+        tape->free_blocks[tape->free_count].p = n->grad;
+        tape->free_blocks[tape->free_count++].n = n->rows * n->cols;
+        n->grad = NULL;
+    }
+    tape->used = mark;
+    tape->free_count = 0;
+    return st;
+}
@@ -0,0 +1,219 @@
+/* Beam search driver. See include/fahren/beam_search.h.
+ * Each step scores all live beams in one callback, takes the best 2*W
+ * continuations of every beam (top-k on the raw logits, then shifted by
+ * the row's log-sum-exp), and keeps the best W overall. Surviving
+ * candidates fork their parent's KV sequence, so the shared prefix is
+ * never copied; the parents are freed right after. Token histories are
+ * kept as (token, parent) pairs per step and unwound at the end. */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <fahren/beam_search.h>
+#include <fahren/sampling.h>
+#include "fahren_internal.h"
+#include "fahren_simd.h"
+
+typedef struct FahrenBeamCand {
+    float score;
+    int32_t parent;
+    int32_t token;
+} FahrenBeamCand;
+
+typedef struct FahrenBeamHyp {
+    float norm_score;
+    float score;
+    size_t step;     /* step that produced the last token */
+    int32_t parent;  /* beam index fed at `step` */
+    int32_t token;   /* last token (EOS for finished hypotheses) */
+} FahrenBeamHyp;
+
+typedef struct FahrenBeamExpand {
+    float* logits;
+    const float* scores;
+    size_t vocab;
+    size_t per_beam;       /* candidates kept per beam (2 * W) */
+    FahrenBeamCand* cands;
+    int32_t* idx;          /* per_beam scratch per beam */
+    float* val;
+} FahrenBeamExpand;
+
+/* Top continuations of each beam with their cumulative log-probs. */
+static void fahren_beam_expand_rows(void* ctx, size_t begin, size_t end) {
+    FahrenBeamExpand* e = (FahrenBeamExpand*)ctx;
+    for (size_t b = begin; b < end; ++b) {
+        float* row = e->logits + b * e->vocab;
+        int32_t* idx = e->idx + b * e->per_beam;
+        float* val = e->val + b * e->per_beam;
+        size_t k = fahren_topk_f32(row, e->vocab, e->per_beam, idx, val);
+        float m = fahren_max_f32(row, e->vocab);
+        /* the row is ours to clobber: exp in place just for the sum */
+        float lse = m + logf(fahren_exp_scaled_f32(row, row, e->vocab, m, 1.0f));
+        FahrenBeamCand* out = e->cands + b * e->per_beam;
+        for (size_t j = 0; j < e->per_beam; ++j) {
+            out[j].parent = (int32_t)b;
+            if (j < k) {
+                out[j].score = e->scores[b] + (val[j] - lse);
+                out[j].token = idx[j];
+            } else {
+                out[j].score = -INFINITY;
+                out[j].token = -1;
+            }
+        }
+    }
+}
+
+static int fahren_beam_cand_desc(const void* a, const void* b) {
+    float x = ((const FahrenBeamCand*)a)->score, y = ((const FahrenBeamCand*)b)->score;
+    return (x < y) - (x > y);
+}
+
+static float fahren_beam_normalize(float score, size_t length, float penalty) {
+    return penalty == 0.0f ? score : score / powf((float)length, penalty);
+}
+
+/* Keep the best `cap` hypotheses, replacing the worst when full. */
+static void fahren_beam_offer(FahrenBeamHyp* hyps, size_t* count, size_t cap, FahrenBeamHyp h) {
+    if (*count < cap) {
+        hyps[(*count)++] = h;
+        return;
+    }
+    size_t worst = 0;
+    for (size_t i = 1; i < *count; ++i) {
+        if (hyps[i].norm_score < hyps[worst].norm_score) worst = i;
+    }
+    if (h.norm_score > hyps[worst].norm_score) hyps[worst] = h;
+}
+
+FAHRENStatus fahren_beam_search(FAHRENKVCache* cache, int prompt_seq, int32_t start_token,
+                                const FAHRENBeamSearchParams* params,
+                                FAHRENBeamStepFn step, void* user,
+                                int32_t* out_tokens, size_t* out_length, float* out_score) {
+    if (!cache || !params || !step || !out_tokens || !out_length) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t W = params->beam_width, T = params->max_new_tokens, V = params->vocab;
+    if (W == 0 || T == 0 || V == 0 || V > INT32_MAX || W > INT32_MAX / 2) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    size_t per_beam = 2 * W < V ? 2 * W : V;
+
+    FAHRENStatus st = FAHREN_SUCCESS;
+    int* seqs = (int*)malloc(W * sizeof(int));
+    int* next_seqs = (int*)malloc(W * sizeof(int));
+    int32_t* tokens = (int32_t*)malloc(W * sizeof(int32_t));
+    float* scores = (float*)malloc(W * sizeof(float));
+    float* next_scores = (float*)malloc(W * sizeof(float));
+    float* logits = (float*)malloc(W * V * sizeof(float));
+    FahrenBeamCand* cands = (FahrenBeamCand*)malloc(W * per_beam * sizeof(FahrenBeamCand));
+    int32_t* idx = (int32_t*)malloc(W * per_beam * sizeof(int32_t));
+    float* val = (float*)malloc(W * per_beam * sizeof(float));
+    int32_t* hist_tok = (int32_t*)malloc(T * W * sizeof(int32_t));
+    int32_t* hist_parent = (int32_t*)malloc(T * W * sizeof(int32_t));
+    FahrenBeamHyp* finished = (FahrenBeamHyp*)malloc(W * sizeof(FahrenBeamHyp));
+    size_t live = 0, finished_count = 0, steps_done = 0;
+
+    if (!seqs || !next_seqs || !tokens || !scores || !next_scores || !logits || !cands ||
+        !idx || !val || !hist_tok || !hist_parent || !finished) {
+        st = FAHREN_ERROR_PROCESSING_FAILED;
+        goto cleanup;
+    }
+
+    st = fahren_kv_seq_fork(cache, prompt_seq, &seqs[0]);
+    if (st != FAHREN_SUCCESS) goto cleanup;
+    live = 1;
+    tokens[0] = start_token;
+    scores[0] = 0.0f;
+
+    for (size_t t = 0; t < T; ++t) {
+        st = step(user, cache, seqs, tokens, live, logits);
+        if (st != FAHREN_SUCCESS) goto cleanup;
+
+        FahrenBeamExpand ex = {logits, scores, V, per_beam, cands, idx, val};
+        fahren_parallel_for(live, 1, fahren_beam_expand_rows, &ex);
+        size_t ncand = live * per_beam;
+        qsort(cands, ncand, sizeof(FahrenBeamCand), fahren_beam_cand_desc);
+
+        size_t next = 0;
+        for (size_t r = 0; r < ncand && next < W; ++r) {
+            const FahrenBeamCand* c = &cands[r];
+            if (c->token < 0) break;
+            if (c->token == params->eos_token) {
+                /* only an EOS that would have made the beam counts */
+                if (r < W) {
+                    FahrenBeamHyp h = {fahren_beam_normalize(c->score, t + 1, params->length_penalty),
+                                       c->score, t, c->parent, c->token};
+                    fahren_beam_offer(finished, &finished_count, W, h);
+                }
+                continue;
+            }
+            st = fahren_kv_seq_fork(cache, seqs[c->parent], &next_seqs[next]);
+            if (st != FAHREN_SUCCESS) {
+                for (size_t i = 0; i < next; ++i) fahren_kv_seq_free(cache, next_seqs[i]);
+                goto cleanup;
+            }
+            hist_tok[t * W + next] = c->token;
+            hist_parent[t * W + next] = c->parent;
+            next_scores[next] = c->score;
+            ++next;
+        }
+
+        for (size_t i = 0; i < live; ++i) fahren_kv_seq_free(cache, seqs[i]);
+        for (size_t i = 0; i < next; ++i) {
+            seqs[i] = next_seqs[i];
+            scores[i] = next_scores[i];
+            tokens[i] = hist_tok[t * W + i];
+        }
+        live = next;
+        steps_done = t + 1;
+        if (live == 0 || finished_count >= W) break;
+    }
+
+    /* Unfinished beams compete with finished ones when the budget ran out. */
+    FahrenBeamHyp best = {-INFINITY, -INFINITY, 0, -1, -1};
+    for (size_t i = 0; i < finished_count; ++i) {
+        if (finished[i].norm_score > best.norm_score) best = finished[i];
+    }
+    if (finished_count < W && steps_done > 0) {
+        size_t t = steps_done - 1;
+        for (size_t b = 0; b < live; ++b) {
+            float norm = fahren_beam_normalize(scores[b], steps_done, params->length_penalty);
+            if (norm > best.norm_score) {
+                FahrenBeamHyp h = {norm, scores[b], t, hist_parent[t * W + b], hist_tok[t * W + b]};
+                best = h;
+            }
+        }
+    }
+    if (best.token < 0) {
+        st = FAHREN_ERROR_PROCESSING_FAILED;
+        goto cleanup;
+    }
+
+    /* Unwind: the hypothesis ends at best.step; earlier tokens come from
+     * following parent links back through the history. */
+    size_t len = best.step + 1;
+    out_tokens[best.step] = best.token;
+    int32_t b = best.parent;
+    for (size_t t = best.step; t-- > 0;) {
+        out_tokens[t] = hist_tok[t * W + (size_t)b];
+        b = hist_parent[t * W + (size_t)b];
+    }
+    *out_length = len;
+    if (out_score) *out_score = best.norm_score;
+
+cleanup:
+    if (seqs) {
+        for (size_t i = 0; i < live; ++i) fahren_kv_seq_free(cache, seqs[i]);
+    }
+    free(seqs);
+    free(next_seqs);
+    free(tokens);
+    free(scores);
+    free(next_scores);
+    free(logits);
+    free(cands);
+    free(idx);
+    free(val);
+    free(hist_tok);
+    free(hist_parent);
+    free(finished);
+    return st;
+}
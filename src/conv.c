@@ -0,0 +1,676 @@
+/* Convolution kernels. See include/fahren/conv.h.
+ * im2col/col2im are parallel over channels; the GEMMs are parallel over
+ * their own row blocks, so images are simply processed one after another.
+ * The direct forward path is parallel over output rows instead. */
+#include <stdlib.h>
+#include <string.h>
+
+#include <fahren/conv.h>
+#include "fahren_internal.h"
+#include "fahren_simd.h"
+
+/* ---- im2col / col2im -------------------------------------------------- */
+
+typedef struct FahrenColJob {
+    const FahrenConvGeom* g;
+    const float* src;
+    float* dst;
+} FahrenColJob;
+
+static void fahren_im2col_channels(void* ctx, size_t begin, size_t end) {
+    FahrenColJob* job = (FahrenColJob*)ctx;
+    const FahrenConvGeom* g = job->g;
+    size_t plane = g->out_h * g->out_w;
+    for (size_t c = begin; c < end; ++c) {
+        const float* img = job->src + c * g->height * g->width;
+        for (size_t ky = 0; ky < g->kernel_h; ++ky) {
+            for (size_t kx = 0; kx < g->kernel_w; ++kx) {
+                float* col = job->dst + ((c * g->kernel_h + ky) * g->kernel_w + kx) * plane;
+                for (size_t oy = 0; oy < g->out_h; ++oy) {
+                    long iy = (long)(oy * g->stride_h + ky * g->dilation_h) - (long)g->pad_h;
+                    float* out = col + oy * g->out_w;
+                    if (iy < 0 || iy >= (long)g->height) {
+                        memset(out, 0, g->out_w * sizeof(float));
+                        continue;
+                    }
+                    const float* row = img + (size_t)iy * g->width;
+                    long ix0 = (long)(kx * g->dilation_w) - (long)g->pad_w;
+                    if (g->stride_w == 1 && ix0 >= 0 && ix0 + (long)g->out_w <= (long)g->width) {
+                        memcpy(out, row + ix0, g->out_w * sizeof(float));
+                        continue;
+                    }
+                    for (size_t ox = 0; ox < g->out_w; ++ox) {
+                        long ix = ix0 + (long)(ox * g->stride_w);
+                        out[ox] = ix >= 0 && ix < (long)g->width ? row[ix] : 0.0f;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void fahren_im2col(const FahrenConvGeom* g, const float* img, float* cols) {
+    FahrenColJob job = {g, img, cols};
+    fahren_parallel_for(g->channels, 1, fahren_im2col_channels, &job);
+}
+
+static void fahren_col2im_channels(void* ctx, size_t begin, size_t end) {
+    FahrenColJob* job = (FahrenColJob*)ctx;
+    const FahrenConvGeom* g = job->g;
+    size_t plane = g->out_h * g->out_w;
+    for (size_t c = begin; c < end; ++c) {
+        float* img = job->dst + c * g->height * g->width;
+        for (size_t ky = 0; ky < g->kernel_h; ++ky) {
+            for (size_t kx = 0; kx < g->kernel_w; ++kx) {
+                const float* col = job->src + ((c * g->kernel_h + ky) * g->kernel_w + kx) * plane;
+                for (size_t oy = 0; oy < g->out_h; ++oy) {
+                    long iy = (long)(oy * g->stride_h + ky * g->dilation_h) - (long)g->pad_h;
+                    if (iy < 0 || iy >= (long)g->height) continue;
+                    float* row = img + (size_t)iy * g->width;
+                    const float* in = col + oy * g->out_w;
+                    long ix0 = (long)(kx * g->dilation_w) - (long)g->pad_w;
+                    if (g->stride_w == 1 && ix0 >= 0 && ix0 + (long)g->out_w <= (long)g->width) {
+                        float* dst = row + ix0;
+                        for (size_t ox = 0; ox < g->out_w; ++ox) dst[ox] += in[ox];
+                        continue;
+                    }
+                    for (size_t ox = 0; ox < g->out_w; ++ox) {
+                        long ix = ix0 + (long)(ox * g->stride_w);
+                        if (ix >= 0 && ix < (long)g->width) row[ix] += in[ox];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void fahren_col2im(const FahrenConvGeom* g, const float* cols, float* img) {
+    FahrenColJob job = {g, cols, img};
+    fahren_parallel_for(g->channels, 1, fahren_col2im_channels, &job);
+}
+
+/* ---- parameter checks ------------------------------------------------- */
+
+static int fahren_conv_params_valid(const FAHRENConvParams* p) {
+    return p && p->in_channels > 0 && p->out_channels > 0 && p->kernel_h > 0 && p->kernel_w > 0 &&
+           p->stride_h >= 0 && p->stride_w >= 0 && p->pad_h >= 0 && p->pad_w >= 0 &&
+           p->dilation_h >= 0 && p->dilation_w >= 0;
+}
+
+static size_t fahren_conv_or_one(int v) {
+    return v > 0 ? (size_t)v : 1;
+}
+
+/* ---- forward convolution ---------------------------------------------- */
+
+#define FAHREN_DC_CO 4  /* output channels per register block */
+#define FAHREN_DC_OX 8  /* output pixels per register block */
+/* AUTO prefers the direct path at or below this many input channels, or
+ * when one image's im2col buffer would exceed the byte limit. */
+#define FAHREN_DC_MAX_CIN 4
+#define FAHREN_DC_COLS_LIMIT ((size_t)32 << 20)
+
+FAHRENStatus fahren_conv2d_output_size(const FAHRENConvParams* p, int in_h, int in_w,
+                                       int* out_h, int* out_w) {
+    if (!fahren_conv_params_valid(p) || in_h <= 0 || in_w <= 0 || !out_h || !out_w) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    long span_h = (long)fahren_conv_or_one(p->dilation_h) * (p->kernel_h - 1) + 1;
+    long span_w = (long)fahren_conv_or_one(p->dilation_w) * (p->kernel_w - 1) + 1;
+    long h = (long)in_h + 2L * p->pad_h - span_h;
+    long w = (long)in_w + 2L * p->pad_w - span_w;
+    if (h < 0 || w < 0) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *out_h = (int)(h / (long)fahren_conv_or_one(p->stride_h) + 1);
+    *out_w = (int)(w / (long)fahren_conv_or_one(p->stride_w) + 1);
+    return FAHREN_SUCCESS;
+}
+
+static FAHRENStatus fahren_conv2d_geom(const FAHRENConvParams* p, int in_h, int in_w, FahrenConvGeom* g) {
+    int oh, ow;
+    FAHRENStatus st = fahren_conv2d_output_size(p, in_h, in_w, &oh, &ow);
+    if (st != FAHREN_SUCCESS) return st;
+    g->channels = (size_t)p->in_channels;
+    g->height = (size_t)in_h;
+    g->width = (size_t)in_w;
+    g->kernel_h = (size_t)p->kernel_h;
+    g->kernel_w = (size_t)p->kernel_w;
+    g->stride_h = fahren_conv_or_one(p->stride_h);
+    g->stride_w = fahren_conv_or_one(p->stride_w);
+    g->pad_h = (size_t)p->pad_h;
+    g->pad_w = (size_t)p->pad_w;
+    g->dilation_h = fahren_conv_or_one(p->dilation_h);
+    g->dilation_w = fahren_conv_or_one(p->dilation_w);
+    g->out_h = (size_t)oh;
+    g->out_w = (size_t)ow;
+    return FAHREN_SUCCESS;
+}
+
+static void fahren_conv_fill_bias(float* y, size_t channels, size_t plane, const float* bias) {
+    for (size_t c = 0; c < channels; ++c) {
+        float b = bias ? bias[c] : 0.0f;
+        for (size_t i = 0; i < plane; ++i) y[c * plane + i] = b;
+    }
+}
+
+static FAHRENStatus fahren_conv2d_im2col(const FahrenConvGeom* g, size_t cout, size_t batch,
+                                         const float* x, const float* weights, const float* bias,
+                                         float* y) {
+    size_t k = g->channels * g->kernel_h * g->kernel_w;
+    size_t hw = g->out_h * g->out_w;
+    size_t in_plane = g->height * g->width;
+    /* a 1x1, stride-1, unpadded kernel's im2col is the image itself */
+    int identity = g->kernel_h == 1 && g->kernel_w == 1 && g->stride_h == 1 && g->stride_w == 1 &&
+                   g->pad_h == 0 && g->pad_w == 0;
+    float* cols = NULL;
+    if (!identity) {
+        cols = (float*)malloc(k * hw * sizeof(float));
+        if (!cols) return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    for (size_t n = 0; n < batch; ++n) {
+        const float* xn = x + n * g->channels * in_plane;
+        float* yn = y + n * cout * hw;
+        if (!identity) fahren_im2col(g, xn, cols);
+        fahren_conv_fill_bias(yn, cout, hw, bias);
+        /* y (Cout x HW) += W (Cout x Cin*kk) * cols (Cin*kk x HW) */
+        if (!fahren_sgemm(0, 0, cout, hw, k, 1.0f, weights, k, identity ? xn : cols, hw, 1.0f, yn, hw)) {
+            free(cols);
+            return FAHREN_ERROR_PROCESSING_FAILED;
+        }
+    }
+    free(cols);
+    return FAHREN_SUCCESS;
+}
+
+/* Direct path. The input is copied once into zero-padded planes so the
+ * kernel never tests bounds, and the weights are repacked as
+ * [co block][ci][ky][kx][4] with zero rows past out_channels, so every
+ * block computes four channels and a tap's four weights are adjacent.
+ * One task is one output row of one channel block of one image. */
+typedef struct FahrenDirectJob {
+    const FahrenConvGeom* g;
+    size_t cout;
+    size_t co_blocks;
+    const float* xpad;   /* batch x Cin x ph x pw, plus slack */
+    size_t ph, pw;
+    const float* wpack;
+    const float* bpack;  /* co_blocks * 4 */
+    float* y;
+} FahrenDirectJob;
+
+#if defined(FAHREN_HAVE_SSE2)
+/* Four input pixels `s` apart. The stride-2 case reads one float past the
+ * last pixel it uses; the padded buffer leaves slack for that. */
+static inline __m128 fahren_dc_load4(const float* p, size_t s) {
+    if (s == 1) return _mm_loadu_ps(p);
+    if (s == 2) return _mm_shuffle_ps(_mm_loadu_ps(p), _mm_loadu_ps(p + 4), _MM_SHUFFLE(2, 0, 2, 0));
+    return _mm_setr_ps(p[0], p[s], p[2 * s], p[3 * s]);
+}
+#endif
+
+static void fahren_direct_rows(void* ctx, size_t begin, size_t end) {
+    FahrenDirectJob* job = (FahrenDirectJob*)ctx;
+    const FahrenConvGeom* g = job->g;
+    size_t cin = g->channels, kh = g->kernel_h, kw = g->kernel_w;
+    size_t sw = g->stride_w, dw = g->dilation_w;
+    size_t in_plane = job->ph * job->pw;
+    size_t out_plane = g->out_h * g->out_w;
+    for (size_t task = begin; task < end; ++task) {
+        size_t oy = task % g->out_h;
+        size_t cb = (task / g->out_h) % job->co_blocks;
+        size_t n = task / (g->out_h * job->co_blocks);
+        size_t co0 = cb * FAHREN_DC_CO;
+        size_t nc = job->cout - co0 < FAHREN_DC_CO ? job->cout - co0 : FAHREN_DC_CO;
+        const float* img = job->xpad + n * cin * in_plane + oy * g->stride_h * job->pw;
+        const float* wb = job->wpack + cb * cin * kh * kw * FAHREN_DC_CO;
+        const float* bb = job->bpack + co0;
+        float* out = job->y + (n * job->cout + co0) * out_plane + oy * g->out_w;
+        size_t ox = 0;
+#if defined(FAHREN_HAVE_SSE2)
+        for (; ox + FAHREN_DC_OX <= g->out_w; ox += FAHREN_DC_OX) {
+            __m128 a00 = _mm_set1_ps(bb[0]), a01 = a00;
+            __m128 a10 = _mm_set1_ps(bb[1]), a11 = a10;
+            __m128 a20 = _mm_set1_ps(bb[2]), a21 = a20;
+            __m128 a30 = _mm_set1_ps(bb[3]), a31 = a30;
+            const float* wp = wb;
+            for (size_t ci = 0; ci < cin; ++ci) {
+                for (size_t ky = 0; ky < kh; ++ky) {
+                    const float* row = img + ci * in_plane + ky * g->dilation_h * job->pw + ox * sw;
+                    for (size_t kx = 0; kx < kw; ++kx, wp += FAHREN_DC_CO) {
+                        const float* px = row + kx * dw;
+                        __m128 x0 = fahren_dc_load4(px, sw), x1 = fahren_dc_load4(px + 4 * sw, sw);
+                        __m128 wv = _mm_loadu_ps(wp);
+                        __m128 c0 = _mm_shuffle_ps(wv, wv, _MM_SHUFFLE(0, 0, 0, 0));
+                        a00 = _mm_add_ps(a00, _mm_mul_ps(c0, x0));
+                        a01 = _mm_add_ps(a01, _mm_mul_ps(c0, x1));
+                        __m128 c1 = _mm_shuffle_ps(wv, wv, _MM_SHUFFLE(1, 1, 1, 1));
+                        a10 = _mm_add_ps(a10, _mm_mul_ps(c1, x0));
+                        a11 = _mm_add_ps(a11, _mm_mul_ps(c1, x1));
+                        __m128 c2 = _mm_shuffle_ps(wv, wv, _MM_SHUFFLE(2, 2, 2, 2));
+                        a20 = _mm_add_ps(a20, _mm_mul_ps(c2, x0));
+                        a21 = _mm_add_ps(a21, _mm_mul_ps(c2, x1));
+                        __m128 c3 = _mm_shuffle_ps(wv, wv, _MM_SHUFFLE(3, 3, 3, 3));
+                        a30 = _mm_add_ps(a30, _mm_mul_ps(c3, x0));
+                        a31 = _mm_add_ps(a31, _mm_mul_ps(c3, x1));
+                    }
+                }
+            }
+            __m128 acc[FAHREN_DC_CO][2] = {{a00, a01}, {a10, a11}, {a20, a21}, {a30, a31}};
+            for (size_t j = 0; j < nc; ++j) {
+                _mm_storeu_ps(out + j * out_plane + ox, acc[j][0]);
+                _mm_storeu_ps(out + j * out_plane + ox + 4, acc[j][1]);
+            }
+        }
+#endif
+        for (; ox < g->out_w; ++ox) {
+            float acc[FAHREN_DC_CO] = {bb[0], bb[1], bb[2], bb[3]};
+            const float* wp = wb;
+            for (size_t ci = 0; ci < cin; ++ci) {
+                for (size_t ky = 0; ky < kh; ++ky) {
+                    const float* row = img + ci * in_plane + ky * g->dilation_h * job->pw + ox * sw;
+                    for (size_t kx = 0; kx < kw; ++kx, wp += FAHREN_DC_CO) {
+                        float v = row[kx * dw];
+                        for (size_t j = 0; j < FAHREN_DC_CO; ++j) acc[j] += wp[j] * v;
+                    }
+                }
+            }
+            for (size_t j = 0; j < nc; ++j) out[j * out_plane + ox] = acc[j];
+        }
+    }
+}
+
+static FAHRENStatus fahren_conv2d_direct(const FahrenConvGeom* g, size_t cout, size_t batch,
+                                         const float* x, const float* weights, const float* bias,
+                                         float* y) {
+    size_t cin = g->channels, kk = g->kernel_h * g->kernel_w;
+    size_t ph = g->height + 2 * g->pad_h, pw = g->width + 2 * g->pad_w;
+    size_t co_blocks = (cout + FAHREN_DC_CO - 1) / FAHREN_DC_CO;
+    size_t in_plane = ph * pw;
+
+    float* xpad = (float*)malloc((batch * cin * in_plane + 8) * sizeof(float));
+    float* wpack = (float*)calloc(co_blocks * cin * kk * FAHREN_DC_CO + co_blocks * FAHREN_DC_CO,
+                                  sizeof(float));
+    if (!xpad || !wpack) {
+        free(xpad);
+        free(wpack);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    memset(xpad + batch * cin * in_plane, 0, 8 * sizeof(float));
+    for (size_t p = 0; p < batch * cin; ++p) {
+        float* dst = xpad + p * in_plane;
+        const float* src = x + p * g->height * g->width;
+        memset(dst, 0, g->pad_h * pw * sizeof(float));
+        for (size_t iy = 0; iy < g->height; ++iy) {
+            float* row = dst + (g->pad_h + iy) * pw;
+            memset(row, 0, g->pad_w * sizeof(float));
+            memcpy(row + g->pad_w, src + iy * g->width, g->width * sizeof(float));
+            memset(row + g->pad_w + g->width, 0, g->pad_w * sizeof(float));
+        }
+        memset(dst + (g->pad_h + g->height) * pw, 0, g->pad_h * pw * sizeof(float));
+    }
+    float* bpack = wpack + co_blocks * cin * kk * FAHREN_DC_CO;
+    for (size_t co = 0; co < cout; ++co) {
+        size_t cb = co / FAHREN_DC_CO, j = co % FAHREN_DC_CO;
+        for (size_t t = 0; t < cin * kk; ++t) {
+            wpack[(cb * cin * kk + t) * FAHREN_DC_CO + j] = weights[co * cin * kk + t];
+        }
+        bpack[co] = bias ? bias[co] : 0.0f;
+    }
+
+    FahrenDirectJob job;
+    job.g = g;
+    job.cout = cout;
+    job.co_blocks = co_blocks;
+    job.xpad = xpad;
+    job.ph = ph;
+    job.pw = pw;
+    job.wpack = wpack;
+    job.bpack = bpack;
+    job.y = y;
+    fahren_parallel_for(batch * co_blocks * g->out_h, 1, fahren_direct_rows, &job);
+    free(xpad);
+    free(wpack);
+    return FAHREN_SUCCESS;
+}
+
+static int fahren_conv_winograd_ok(const FahrenConvGeom* g) {
+    return g->kernel_h == 3 && g->kernel_w == 3 && g->stride_h == 1 && g->stride_w == 1 &&
+           g->dilation_h == 1 && g->dilation_w == 1;
+}
+
+static FAHRENConvAlgo fahren_conv2d_pick(const FahrenConvGeom* g, size_t cout) {
+    size_t taps = g->channels * g->kernel_h * g->kernel_w;
+    size_t cols = taps * g->out_h * g->out_w;
+    double direct = 2.0 * (double)cout * (double)cols;
+    double fft = fahren_conv_fft_cost(g, cout);
+    if (fft > 0.0 && fft < direct) return FAHREN_CONV_ALGO_FFT;
+    if (g->channels <= FAHREN_DC_MAX_CIN) return FAHREN_CONV_ALGO_DIRECT;
+    if (fahren_conv_winograd_ok(g)) return FAHREN_CONV_ALGO_WINOGRAD;
+    if (cols > FAHREN_DC_COLS_LIMIT / sizeof(float)) return FAHREN_CONV_ALGO_DIRECT;
+    return FAHREN_CONV_ALGO_IM2COL;
+}
+
+FAHRENStatus fahren_conv2d_forward(const FAHRENConvParams* p, size_t batch, int in_h, int in_w,
+                                   const float* x, const float* weights, const float* bias,
+                                   float* y, FAHRENConvAlgo algo) {
+    if (!x || !weights || !y) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenConvGeom g;
+    FAHRENStatus st = fahren_conv2d_geom(p, in_h, in_w, &g);
+    if (st != FAHREN_SUCCESS) return st;
+    if (batch == 0) return FAHREN_SUCCESS;
+    size_t cout = (size_t)p->out_channels;
+    if (algo == FAHREN_CONV_ALGO_AUTO) algo = fahren_conv2d_pick(&g, cout);
+    switch (algo) {
+    case FAHREN_CONV_ALGO_IM2COL:
+        return fahren_conv2d_im2col(&g, cout, batch, x, weights, bias, y);
+    case FAHREN_CONV_ALGO_DIRECT:
+        return fahren_conv2d_direct(&g, cout, batch, x, weights, bias, y);
+    case FAHREN_CONV_ALGO_FFT:
+        return fahren_conv_fft_forward(&g, cout, batch, x, weights, bias, y);
+    case FAHREN_CONV_ALGO_WINOGRAD:
+        if (!fahren_conv_winograd_ok(&g)) return FAHREN_ERROR_INVALID_ARGUMENT;
+        return fahren_conv_winograd_forward(&g, cout, batch, x, weights, bias, y);
+    default:
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+/* ---- backward --------------------------------------------------------- */
+
+/* dx = col2im(W^T * dy), one image at a time; works for any geometry. */
+static FAHRENStatus fahren_conv2d_dgrad_col2im(const FahrenConvGeom* g, size_t cout, size_t batch,
+                                               const float* weights, const float* dy, float* dx) {
+    size_t k = g->channels * g->kernel_h * g->kernel_w;
+    size_t hw = g->out_h * g->out_w;
+    size_t in_size = g->channels * g->height * g->width;
+    float* cols = (float*)malloc(k * hw * sizeof(float));
+    if (!cols) return FAHREN_ERROR_PROCESSING_FAILED;
+    for (size_t n = 0; n < batch; ++n) {
+        /* cols (Cin*kk x HW) = W^T (Cin*kk x Cout) * dy (Cout x HW) */
+        if (!fahren_sgemm(1, 0, k, hw, cout, 1.0f, weights, k, dy + n * cout * hw, hw, 0.0f, cols, hw)) {
+            free(cols);
+            return FAHREN_ERROR_PROCESSING_FAILED;
+        }
+        memset(dx + n * in_size, 0, in_size * sizeof(float));
+        fahren_col2im(g, cols, dx + n * in_size);
+    }
+    free(cols);
+    return FAHREN_SUCCESS;
+}
+
+/* With stride 1 the data gradient is itself a convolution: dy padded by
+ * dilation * (kernel - 1) - pad, correlated with the kernel flipped in
+ * both axes and with in/out channels swapped. That lets it use any
+ * forward algorithm, Winograd included. */
+static int fahren_conv2d_dgrad_as_conv(const FahrenConvGeom* g) {
+    return g->stride_h == 1 && g->stride_w == 1 && g->pad_h <= g->dilation_h * (g->kernel_h - 1) &&
+           g->pad_w <= g->dilation_w * (g->kernel_w - 1);
+}
+
+static FAHRENStatus fahren_conv2d_dgrad_flipped(const FahrenConvGeom* g, size_t cout, size_t batch,
+                                                const float* weights, const float* dy, float* dx,
+                                                FAHRENConvAlgo algo) {
+    size_t cin = g->channels, kh = g->kernel_h, kw = g->kernel_w, kk = kh * kw;
+    float* flipped = (float*)malloc(cout * cin * kk * sizeof(float));
+    if (!flipped) return FAHREN_ERROR_PROCESSING_FAILED;
+    for (size_t co = 0; co < cout; ++co) {
+        for (size_t ci = 0; ci < cin; ++ci) {
+            const float* src = weights + (co * cin + ci) * kk;
+            float* dst = flipped + (ci * cout + co) * kk;
+            for (size_t t = 0; t < kk; ++t) dst[kk - 1 - t] = src[t];
+        }
+    }
+    FAHRENConvParams q;
+    memset(&q, 0, sizeof(q));
+    q.in_channels = (int)cout;
+    q.out_channels = (int)cin;
+    q.kernel_h = (int)kh;
+    q.kernel_w = (int)kw;
+    q.pad_h = (int)(g->dilation_h * (kh - 1) - g->pad_h);
+    q.pad_w = (int)(g->dilation_w * (kw - 1) - g->pad_w);
+    q.dilation_h = (int)g->dilation_h;
+    q.dilation_w = (int)g->dilation_w;
+    FAHRENStatus st = fahren_conv2d_forward(&q, batch, (int)g->out_h, (int)g->out_w, dy, flipped, NULL, dx, algo);
+    free(flipped);
+    return st;
+}
+
+/* Weight gradient: the batch is split into one slice per thread, each
+ * accumulating dW = sum dy_n * im2col(x_n)^T into a private partial, and
+ * the partials are then summed pairwise in log2(parts) parallel rounds.
+ * No thread ever waits on another's writes to a shared gradient. */
+typedef struct FahrenWGradJob {
+    const FahrenConvGeom* g;
+    size_t cout;
+    size_t batch;
+    size_t parts;
+    const float* x;
+    const float* dy;
+    float* partials;  /* parts x (cout * Cin*kk) */
+    size_t size;      /* floats per partial */
+    size_t step;      /* reduction round: partial i += partial i + step */
+    size_t chunks;    /* slices per pairwise add */
+    int failed;
+} FahrenWGradJob;
+
+static void fahren_wgrad_parts(void* ctx, size_t begin, size_t end) {
+    FahrenWGradJob* job = (FahrenWGradJob*)ctx;
+    const FahrenConvGeom* g = job->g;
+    size_t k = g->channels * g->kernel_h * g->kernel_w;
+    size_t hw = g->out_h * g->out_w;
+    float* cols = (float*)malloc(k * hw * sizeof(float));
+    if (!cols) {
+        job->failed = 1;
+        return;
+    }
+    for (size_t part = begin; part < end; ++part) {
+        size_t n0 = part * job->batch / job->parts, n1 = (part + 1) * job->batch / job->parts;
+        float* dw = job->partials + part * job->size;
+        for (size_t n = n0; n < n1; ++n) {
+            fahren_im2col(g, job->x + n * g->channels * g->height * g->width, cols);
+            /* dW (Cout x Cin*kk) += dy (Cout x HW) * cols^T */
+            if (!fahren_sgemm(0, 1, job->cout, k, hw, 1.0f, job->dy + n * job->cout * hw, hw, cols, hw,
+                              1.0f, dw, k)) {
+                job->failed = 1;
+                break;
+            }
+        }
+    }
+    free(cols);
+}
+
+static void fahren_wgrad_reduce(void* ctx, size_t begin, size_t end) {
+    FahrenWGradJob* job = (FahrenWGradJob*)ctx;
+    for (size_t task = begin; task < end; ++task) {
+        size_t pair = task / job->chunks, chunk = task % job->chunks;
+        size_t dst = pair * 2 * job->step, src = dst + job->step;
+        if (src >= job->parts) continue;
+        size_t lo = chunk * job->size / job->chunks, hi = (chunk + 1) * job->size / job->chunks;
+        fahren_axpy_f32(1.0f, job->partials + src * job->size + lo, job->partials + dst * job->size + lo, hi - lo);
+    }
+}
+
+static FAHRENStatus fahren_conv2d_wgrad(const FahrenConvGeom* g, size_t cout, size_t batch,
+                                        const float* x, const float* dy, float* dweights) {
+    FahrenWGradJob job;
+    memset(&job, 0, sizeof(job));
+    job.g = g;
+    job.cout = cout;
+    job.batch = batch;
+    job.parts = fahren_thread_count() < batch ? fahren_thread_count() : batch;
+    job.x = x;
+    job.dy = dy;
+    job.size = cout * g->channels * g->kernel_h * g->kernel_w;
+    job.partials = (float*)calloc(job.parts * job.size, sizeof(float));
+    if (!job.partials) return FAHREN_ERROR_PROCESSING_FAILED;
+    if (job.parts == 1) {
+        fahren_wgrad_parts(&job, 0, 1); /* im2col and GEMM parallelize themselves */
+    } else {
+        fahren_parallel_for(job.parts, 1, fahren_wgrad_parts, &job);
+    }
+    job.chunks = fahren_thread_count();
+    for (job.step = 1; job.step < job.parts && !job.failed; job.step *= 2) {
+        size_t pairs = (job.parts + 2 * job.step - 1) / (2 * job.step);
+        fahren_parallel_for(pairs * job.chunks, 1, fahren_wgrad_reduce, &job);
+    }
+    if (!job.failed) fahren_axpy_f32(1.0f, job.partials, dweights, job.size);
+    free(job.partials);
+    return job.failed ? FAHREN_ERROR_PROCESSING_FAILED : FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_conv2d_backward(const FAHRENConvParams* p, size_t batch, int in_h, int in_w,
+                                    const float* x, const float* weights, const float* dy,
+                                    float* dx, float* dweights, float* dbias, FAHRENConvAlgo algo) {
+    if (!dy || (dx && !weights) || (dweights && !x)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenConvGeom g;
+    FAHRENStatus st = fahren_conv2d_geom(p, in_h, in_w, &g);
+    if (st != FAHREN_SUCCESS) return st;
+    if (batch == 0) return FAHREN_SUCCESS;
+    size_t cout = (size_t)p->out_channels;
+    size_t plane = g.out_h * g.out_w;
+    int via_conv = algo != FAHREN_CONV_ALGO_IM2COL &&
+                   (algo != FAHREN_CONV_ALGO_AUTO || fahren_conv2d_dgrad_as_conv(&g));
+    if (dx && via_conv && !fahren_conv2d_dgrad_as_conv(&g)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (dx && algo == FAHREN_CONV_ALGO_WINOGRAD && !fahren_conv_winograd_ok(&g)) return FAHREN_ERROR_INVALID_ARGUMENT;
+
+    if (dbias) {
+        for (size_t n = 0; n < batch; ++n) {
+            for (size_t c = 0; c < cout; ++c) {
+                const float* src = dy + (n * cout + c) * plane;
+                float s = 0.0f;
+                for (size_t i = 0; i < plane; ++i) s += src[i];
+                dbias[c] += s;
+            }
+        }
+    }
+    if (dweights) {
+        st = fahren_conv2d_wgrad(&g, cout, batch, x, dy, dweights);
+        if (st != FAHREN_SUCCESS) return st;
+    }
+    if (!dx) return FAHREN_SUCCESS;
+    if (!via_conv) return fahren_conv2d_dgrad_col2im(&g, cout, batch, weights, dy, dx);
+    return fahren_conv2d_dgrad_flipped(&g, cout, batch, weights, dy, dx, algo);
+}
+
+/* ---- transposed convolution ------------------------------------------- */
+
+FAHRENStatus fahren_conv_transpose_output_size(const FAHRENConvParams* p, int in_h, int in_w,
+                                               int* out_h, int* out_w) {
+    if (!fahren_conv_params_valid(p) || in_h <= 0 || in_w <= 0 || !out_h || !out_w) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    long h = (long)(in_h - 1) * (long)fahren_conv_or_one(p->stride_h) - 2L * p->pad_h +
+             (long)fahren_conv_or_one(p->dilation_h) * (p->kernel_h - 1) + 1;
+    long w = (long)(in_w - 1) * (long)fahren_conv_or_one(p->stride_w) - 2L * p->pad_w +
+             (long)fahren_conv_or_one(p->dilation_w) * (p->kernel_w - 1) + 1;
+    if (h <= 0 || w <= 0 || h > INT32_MAX || w > INT32_MAX) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *out_h = (int)h;
+    *out_w = (int)w;
+    return FAHREN_SUCCESS;
+}
+
+/* The transposed conv's output plays the image role; its input is the
+ * grid of kernel positions. */
+static FAHRENStatus fahren_conv_transpose_geom(const FAHRENConvParams* p, int in_h, int in_w,
+                                               FahrenConvGeom* g) {
+    int oh, ow;
+    FAHRENStatus st = fahren_conv_transpose_output_size(p, in_h, in_w, &oh, &ow);
+    if (st != FAHREN_SUCCESS) return st;
+    g->channels = (size_t)p->out_channels;
+    g->height = (size_t)oh;
+    g->width = (size_t)ow;
+    g->kernel_h = (size_t)p->kernel_h;
+    g->kernel_w = (size_t)p->kernel_w;
+    g->stride_h = fahren_conv_or_one(p->stride_h);
+    g->stride_w = fahren_conv_or_one(p->stride_w);
+    g->pad_h = (size_t)p->pad_h;
+    g->pad_w = (size_t)p->pad_w;
+    g->dilation_h = fahren_conv_or_one(p->dilation_h);
+    g->dilation_w = fahren_conv_or_one(p->dilation_w);
+    g->out_h = (size_t)in_h;
+    g->out_w = (size_t)in_w;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_conv_transpose_forward(const FAHRENConvParams* p, size_t batch, int in_h, int in_w,
+                                           const float* x, const float* weights, const float* bias,
+                                           float* y) {
+    if (!x || !weights || !y) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenConvGeom g;
+    FAHRENStatus st = fahren_conv_transpose_geom(p, in_h, in_w, &g);
+    if (st != FAHREN_SUCCESS) return st;
+
+    size_t cin = (size_t)p->in_channels;
+    size_t rows = g.channels * g.kernel_h * g.kernel_w; /* Cout * kh * kw */
+    size_t hw = g.out_h * g.out_w;
+    size_t out_plane = g.height * g.width;
+    float* cols = (float*)malloc(rows * hw * sizeof(float));
+    if (!cols) return FAHREN_ERROR_PROCESSING_FAILED;
+
+    for (size_t n = 0; n < batch; ++n) {
+        const float* xn = x + n * cin * hw;
+        float* yn = y + n * g.channels * out_plane;
+        /* cols = W^T (Cout*kk x Cin) * x (Cin x HW) */
+        if (!fahren_sgemm(1, 0, rows, hw, cin, 1.0f, weights, rows, xn, hw, 0.0f, cols, hw)) {
+            free(cols);
+            return FAHREN_ERROR_PROCESSING_FAILED;
+        }
+        for (size_t c = 0; c < g.channels; ++c) {
+            float b = bias ? bias[c] : 0.0f;
+            float* plane = yn + c * out_plane;
+            for (size_t i = 0; i < out_plane; ++i) plane[i] = b;
+        }
+        fahren_col2im(&g, cols, yn);
+    }
+    free(cols);
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_conv_transpose_backward(const FAHRENConvParams* p, size_t batch, int in_h, int in_w,
+                                            const float* x, const float* weights, const float* dy,
+                                            float* dx, float* dweights, float* dbias) {
+    if (!dy || (dx && !weights) || (dweights && !x)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenConvGeom g;
+    FAHRENStatus st = fahren_conv_transpose_geom(p, in_h, in_w, &g);
+    if (st != FAHREN_SUCCESS) return st;
+
+    size_t cin = (size_t)p->in_channels;
+    size_t rows = g.channels * g.kernel_h * g.kernel_w;
+    size_t hw = g.out_h * g.out_w;
+    size_t out_plane = g.height * g.width;
+
+    if (dbias) {
+        for (size_t n = 0; n < batch; ++n) {
+            for (size_t c = 0; c < g.channels; ++c) {
+                const float* plane = dy + (n * g.channels + c) * out_plane;
+                float s = 0.0f;
+                for (size_t i = 0; i < out_plane; ++i) s += plane[i];
+                dbias[c] += s;
+            }
+        }
+    }
+    if (!dx && !dweights) return FAHREN_SUCCESS;
+
+    float* cols = (float*)malloc(rows * hw * sizeof(float));
+    if (!cols) return FAHREN_ERROR_PROCESSING_FAILED;
+    for (size_t n = 0; n < batch; ++n) {
+        /* dy's im2col is the gradient w.r.t. the GEMM output above */
+        fahren_im2col(&g, dy + n * g.channels * out_plane, cols);
+        int ok = 1;
+        if (dx) {
+            /* dx (Cin x HW) = W (Cin x Cout*kk) * cols */
+            ok &= fahren_sgemm(0, 0, cin, hw, rows, 1.0f, weights, rows, cols, hw,
+                               0.0f, dx + n * cin * hw, hw);
+        }
+        if (dweights) {
+            /* dW (Cin x Cout*kk) += x (Cin x HW) * cols^T */
+            ok &= fahren_sgemm(0, 1, cin, rows, hw, 1.0f, x + n * cin * hw, hw, cols, hw,
+                               1.0f, dweights, rows);
+        }
+        if (!ok) {
+            free(cols);
+            return FAHREN_ERROR_PROCESSING_FAILED;
+        }
+    }
+    free(cols);
+    return FAHREN_SUCCESS;
+}
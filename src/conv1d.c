@@ -0,0 +1,287 @@
+/* Direct 1D / dilated convolution. See include/fahren/conv1d.h.
+ * With few channels and long sequences the useful parallelism is along
+ * time, so the kernel is register-blocked as 4 output channels x 8 time
+ * steps: every (input channel, tap) loads two vectors of input once and
+ * feeds four broadcast weights. Inputs are first copied into zero-padded
+ * rows so the inner loop never tests bounds. Long kernels go through the
+ * FFT convolution when its cost model says so; streaming is always direct. */
+#include <stdlib.h>
+#include <string.h>
+
+#include <fahren/conv1d.h>
+#include "fahren_internal.h"
+#include "fahren_simd.h"
+
+#define FAHREN_C1D_CO 4
+#define FAHREN_C1D_T 8
+#define FAHREN_C1D_TILE 512  /* time steps per parallel task */
+
+typedef struct FahrenC1DGeom {
+    size_t cin, cout, k, d;
+    size_t left, right;  /* padding */
+} FahrenC1DGeom;
+
+static int fahren_c1d_geom(const FAHRENConv1DParams* p, FahrenC1DGeom* g) {
+    if (!p || p->in_channels <= 0 || p->out_channels <= 0 || p->kernel_size <= 0 ||
+        p->dilation < 0 || p->pad < 0) {
+        return 0;
+    }
+    g->cin = (size_t)p->in_channels;
+    g->cout = (size_t)p->out_channels;
+    g->k = (size_t)p->kernel_size;
+    g->d = p->dilation > 0 ? (size_t)p->dilation : 1;
+    if (p->causal) {
+        g->left = (g->k - 1) * g->d;
+        g->right = 0;
+    } else {
+        g->left = g->right = (size_t)p->pad;
+    }
+    return 1;
+}
+
+/* y[co][t] = b[co] + sum_ci sum_j w[co][ci][j] * x[ci][t + j*d] for
+ * co in [co0, co1), t in [t0, t1). x rows are `xs` apart, y rows `ys`. */
+static void fahren_c1d_kernel(const FahrenC1DGeom* g, const float* x, size_t xs,
+                              const float* w, const float* b, float* y, size_t ys,
+                              size_t co0, size_t co1, size_t t0, size_t t1) {
+    size_t k = g->k, d = g->d, cin = g->cin;
+    size_t co = co0;
+#if defined(FAHREN_HAVE_SSE2)
+    for (; co + FAHREN_C1D_CO <= co1; co += FAHREN_C1D_CO) {
+        const float* w0 = w + (co + 0) * cin * k;
+        const float* w1 = w + (co + 1) * cin * k;
+        const float* w2 = w + (co + 2) * cin * k;
+        const float* w3 = w + (co + 3) * cin * k;
+        size_t t = t0;
+        for (; t + FAHREN_C1D_T <= t1; t += FAHREN_C1D_T) {
+            __m128 a00 = _mm_set1_ps(b ? b[co + 0] : 0.0f), a01 = a00;
+            __m128 a10 = _mm_set1_ps(b ? b[co + 1] : 0.0f), a11 = a10;
+            __m128 a20 = _mm_set1_ps(b ? b[co + 2] : 0.0f), a21 = a20;
+            __m128 a30 = _mm_set1_ps(b ? b[co + 3] : 0.0f), a31 = a30;
+            for (size_t ci = 0; ci < cin; ++ci) {
+                const float* xr = x + ci * xs + t;
+                size_t wo = ci * k;
+                for (size_t j = 0; j < k; ++j) {
+                    __m128 x0 = _mm_loadu_ps(xr + j * d), x1 = _mm_loadu_ps(xr + j * d + 4);
+                    __m128 c0 = _mm_set1_ps(w0[wo + j]);
+                    a00 = _mm_add_ps(a00, _mm_mul_ps(c0, x0));
+                    a01 = _mm_add_ps(a01, _mm_mul_ps(c0, x1));
+                    __m128 c1 = _mm_set1_ps(w1[wo + j]);
+                    a10 = _mm_add_ps(a10, _mm_mul_ps(c1, x0));
+                    a11 = _mm_add_ps(a11, _mm_mul_ps(c1, x1));
+                    __m128 c2 = _mm_set1_ps(w2[wo + j]);
+                    a20 = _mm_add_ps(a20, _mm_mul_ps(c2, x0));
+                    a21 = _mm_add_ps(a21, _mm_mul_ps(c2, x1));
+                    __m128 c3 = _mm_set1_ps(w3[wo + j]);
+                    a30 = _mm_add_ps(a30, _mm_mul_ps(c3, x0));
+                    a31 = _mm_add_ps(a31, _mm_mul_ps(c3, x1));
+                }
+            }
+            float* yr = y + co * ys + t;
+            _mm_storeu_ps(yr, a00);
+            _mm_storeu_ps(yr + 4, a01);
+            _mm_storeu_ps(yr + ys, a10);
+            _mm_storeu_ps(yr + ys + 4, a11);
+            _mm_storeu_ps(yr + 2 * ys, a20);
+            _mm_storeu_ps(yr + 2 * ys + 4, a21);
+            _mm_storeu_ps(yr + 3 * ys, a30);
+            _mm_storeu_ps(yr + 3 * ys + 4, a31);
+        }
+        /* time tail for this channel block */
+        for (size_t c = co; c < co + FAHREN_C1D_CO; ++c) {
+            for (size_t tt = t; tt < t1; ++tt) {
+                float acc = b ? b[c] : 0.0f;
+                for (size_t ci = 0; ci < cin; ++ci) {
+                    const float* wr = w + (c * cin + ci) * k;
+                    const float* xr = x + ci * xs + tt;
+                    for (size_t j = 0; j < k; ++j) acc += wr[j] * xr[j * d];
+                }
+                y[c * ys + tt] = acc;
+            }
+        }
+    }
+#endif
+    /* remaining output channels: one row at a time, vectorized as axpys */
+    for (; co < co1; ++co) {
+        float* yr = y + co * ys + t0;
+        size_t n = t1 - t0;
+        float bias = b ? b[co] : 0.0f;
+        for (size_t t = 0; t < n; ++t) yr[t] = bias;
+        for (size_t ci = 0; ci < cin; ++ci) {
+            const float* wr = w + (co * cin + ci) * k;
+            const float* xr = x + ci * xs + t0;
+            for (size_t j = 0; j < k; ++j) fahren_axpy_f32(wr[j], xr + j * d, yr, n);
+        }
+    }
+}
+
+FAHRENStatus fahren_conv1d_output_length(const FAHRENConv1DParams* p, size_t length, size_t* out_length) {
+    FahrenC1DGeom g;
+    if (!fahren_c1d_geom(p, &g) || !out_length) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t padded = length + g.left + g.right;
+    size_t span = (g.k - 1) * g.d + 1;
+    if (padded < span) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *out_length = padded - span + 1;
+    return FAHREN_SUCCESS;
+}
+
+typedef struct FahrenC1DJob {
+    const FahrenC1DGeom* g;
+    const float* xpad;   /* N x cin x padded */
+    size_t padded;
+    const float* w;
+    const float* b;
+    float* y;
+    size_t out_len;
+    size_t co_blocks, t_tiles;
+} FahrenC1DJob;
+
+static void fahren_c1d_tasks(void* ctx, size_t begin, size_t end) {
+    FahrenC1DJob* job = (FahrenC1DJob*)ctx;
+    const FahrenC1DGeom* g = job->g;
+    for (size_t task = begin; task < end; ++task) {
+        size_t tile = task % job->t_tiles;
+        size_t cb = (task / job->t_tiles) % job->co_blocks;
+        size_t n = task / (job->t_tiles * job->co_blocks);
+        size_t co0 = cb * FAHREN_C1D_CO;
+        size_t co1 = co0 + FAHREN_C1D_CO < g->cout ? co0 + FAHREN_C1D_CO : g->cout;
+        size_t t0 = tile * FAHREN_C1D_TILE;
+        size_t t1 = t0 + FAHREN_C1D_TILE < job->out_len ? t0 + FAHREN_C1D_TILE : job->out_len;
+        fahren_c1d_kernel(g, job->xpad + n * g->cin * job->padded, job->padded, job->w, job->b,
+                          job->y + n * g->cout * job->out_len, job->out_len, co0, co1, t0, t1);
+    }
+}
+
+FAHRENStatus fahren_conv1d_forward(const FAHRENConv1DParams* p, size_t batch, size_t length,
+                                   const float* x, const float* weights, const float* bias,
+                                   float* y) {
+    FahrenC1DGeom g;
+    size_t out_len;
+    if (!x || !weights || !y || !fahren_c1d_geom(p, &g)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (fahren_conv1d_output_length(p, length, &out_len) != FAHREN_SUCCESS) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (batch == 0 || out_len == 0) return FAHREN_SUCCESS;
+
+    size_t padded = length + g.left + g.right;
+    float* xpad = (float*)malloc(batch * g.cin * padded * sizeof(float));
+    if (!xpad) return FAHREN_ERROR_PROCESSING_FAILED;
+    for (size_t r = 0; r < batch * g.cin; ++r) {
+        float* row = xpad + r * padded;
+        memset(row, 0, g.left * sizeof(float));
+        memcpy(row + g.left, x + r * length, length * sizeof(float));
+        memset(row + g.left + length, 0, g.right * sizeof(float));
+    }
+
+    /* long kernels: same cost model as fahren_conv2d_forward */
+    FahrenConvGeom fg;
+    memset(&fg, 0, sizeof(fg));
+    fg.channels = g.cin;
+    fg.height = 1;
+    fg.width = padded;
+    fg.kernel_h = 1;
+    fg.kernel_w = g.k;
+    fg.stride_h = fg.stride_w = 1;
+    fg.dilation_h = 1;
+    fg.dilation_w = g.d;
+    fg.out_h = 1;
+    fg.out_w = out_len;
+    double fft = fahren_conv_fft_cost(&fg, g.cout);
+    if (fft > 0.0 && fft < 2.0 * (double)g.cout * (double)(g.cin * g.k) * (double)out_len) {
+        FAHRENStatus st = fahren_conv_fft_forward(&fg, g.cout, batch, xpad, weights, bias, y);
+        free(xpad);
+        return st;
+    }
+
+    FahrenC1DJob job;
+    job.g = &g;
+    job.xpad = xpad;
+    job.padded = padded;
+    job.w = weights;
+    job.b = bias;
+    job.y = y;
+    job.out_len = out_len;
+    job.co_blocks = (g.cout + FAHREN_C1D_CO - 1) / FAHREN_C1D_CO;
+    job.t_tiles = (out_len + FAHREN_C1D_TILE - 1) / FAHREN_C1D_TILE;
+    fahren_parallel_for(batch * job.co_blocks * job.t_tiles, 1, fahren_c1d_tasks, &job);
+    free(xpad);
+    return FAHREN_SUCCESS;
+}
+
+/* ---- streaming -------------------------------------------------------- */
+
+/* Each input channel keeps a linear buffer of `cap` samples whose last
+ * `hist` samples before `fill` are the receptive-field history. New
+ * frames are appended after them; when a push would overflow, the history
+ * is slid back to the front. With cap >= 2 * hist that slide happens at
+ * most once every `hist` frames, so history upkeep is O(1) per frame and a
+ * frame's cost is its own outputs. */
+struct FAHRENConv1DStream {
+    FahrenC1DGeom g;
+    const float* w;
+    const float* b;
+    size_t hist;
+    size_t cap;
+    size_t fill;    /* samples in use per channel row, >= hist */
+    float* buf;     /* cin x cap */
+};
+
+FAHRENConv1DStream* fahren_conv1d_stream_create(const FAHRENConv1DParams* p, const float* weights,
+                                                const float* bias) {
+    FAHRENConv1DParams causal;
+    if (!p || !weights) return NULL;
+    causal = *p;
+    causal.causal = 1;
+    FAHRENConv1DStream* s = (FAHRENConv1DStream*)calloc(1, sizeof(FAHRENConv1DStream));
+    if (!s) return NULL;
+    if (!fahren_c1d_geom(&causal, &s->g)) {
+        free(s);
+        return NULL;
+    }
+    s->w = weights;
+    s->b = bias;
+    s->hist = (s->g.k - 1) * s->g.d;
+    s->cap = 2 * s->hist + 256;
+    s->buf = (float*)malloc(s->g.cin * s->cap * sizeof(float));
+    if (!s->buf) {
+        free(s);
+        return NULL;
+    }
+    fahren_conv1d_stream_reset(s);
+    return s;
+}
+
+void fahren_conv1d_stream_destroy(FAHRENConv1DStream* s) {
+    if (!s) return;
+    free(s->buf);
+    free(s);
+}
+
+void fahren_conv1d_stream_reset(FAHRENConv1DStream* s) {
+    if (!s) return;
+    for (size_t c = 0; c < s->g.cin; ++c) memset(s->buf + c * s->cap, 0, s->hist * sizeof(float));
+    s->fill = s->hist;
+}
+
+FAHRENStatus fahren_conv1d_stream_push(FAHRENConv1DStream* s, const float* x, size_t frames, float* y) {
+    if (!s || (!x && frames) || (!y && frames)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t done = 0;
+    while (done < frames) {
+        if (s->fill == s->cap) {
+            for (size_t c = 0; c < s->g.cin; ++c) {
+                float* row = s->buf + c * s->cap;
+                memmove(row, row + s->fill - s->hist, s->hist * sizeof(float));
+            }
+            s->fill = s->hist;
+        }
+        size_t n = frames - done;
+        if (n > s->cap - s->fill) n = s->cap - s->fill;
+        for (size_t c = 0; c < s->g.cin; ++c) {
+            memcpy(s->buf + c * s->cap + s->fill, x + c * frames + done, n * sizeof(float));
+        }
+        /* outputs for the n new frames start `hist` samples back */
+        const float* window = s->buf + (s->fill - s->hist);
+        fahren_c1d_kernel(&s->g, window, s->cap, s->w, s->b, y + done, frames, 0, s->g.cout, 0, n);
+        s->fill += n;
+        done += n;
+    }
+    return FAHREN_SUCCESS;
+}
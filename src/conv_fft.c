@@ -0,0 +1,402 @@
+/* FFT convolution behind fahren_conv2d_forward / fahren_conv1d_forward.
+ * See include/fahren/conv.h.
+ * Each padded input plane is embedded in a Ph x Pw grid with Ph and Pw at
+ * least the padded image size, so the circular correlation never wraps
+ * into an output that is kept. Kernels are stored flipped in the grid and
+ * two output channels share one complex spectrum (the first in the real
+ * part, the second in the imaginary part): since the input is real, one
+ * inverse transform of sum_ci X_ci * K_ci then yields both channels.
+ * 2D spectra are kept transposed (Pw x Ph) to skip a transpose per pass.
+ * Kernel spectra are cached, keyed by geometry, weights pointer and a
+ * hash of the weight values, so updated weights are never served stale. */
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fahren/conv.h>
+#include <fahren/fft.h>
+#include "fahren_internal.h"
+#include "fahren_simd.h"
+
+#define FAHREN_FFT_CACHE_SLOTS 8
+/* AUTO never picks FFT when the kernel spectra would exceed this. */
+#define FAHREN_FFT_SPECTRA_LIMIT ((size_t)256 << 20)
+/* FFT flops run slower than the register-blocked direct/GEMM kernels. */
+#define FAHREN_FFT_COST_FACTOR 2.5
+
+typedef struct FahrenFFTKernel {
+    size_t cin, cout, kh, kw, dh, dw;
+    size_t ph, pw;
+    const float* weights;
+    uint64_t hash;
+    FAHRENFFTPlan* plan_h;
+    FAHRENFFTPlan* plan_w;
+    float* spectra;  /* pairs x cin x (re[P], im[P]), Pw x Ph layout */
+    unsigned refs;
+    unsigned long long used;
+    int cached;
+} FahrenFFTKernel;
+
+static pthread_mutex_t fahren_fft_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static FahrenFFTKernel* fahren_fft_cache[FAHREN_FFT_CACHE_SLOTS];
+static unsigned long long fahren_fft_cache_tick;
+
+static void fahren_fft_grid(const FahrenConvGeom* g, size_t* ph, size_t* pw) {
+    *ph = fahren_fft_good_size(g->height + 2 * g->pad_h);
+    *pw = fahren_fft_good_size(g->width + 2 * g->pad_w);
+}
+
+static size_t fahren_fft_spectra_bytes(const FahrenConvGeom* g, size_t cout, size_t ph, size_t pw) {
+    return (cout + 1) / 2 * g->channels * 2 * ph * pw * sizeof(float);
+}
+
+double fahren_conv_fft_cost(const FahrenConvGeom* g, size_t cout) {
+    size_t ph, pw;
+    fahren_fft_grid(g, &ph, &pw);
+    if (fahren_fft_spectra_bytes(g, cout, ph, pw) > FAHREN_FFT_SPECTRA_LIMIT) return 0.0;
+    double p = (double)ph * (double)pw;
+    double fft = 5.0 * p * log2(p > 2.0 ? p : 2.0);
+    double pairs = (double)((cout + 1) / 2);
+    double cin = (double)g->channels;
+    return FAHREN_FFT_COST_FACTOR * ((cin + pairs) * fft + 8.0 * cin * pairs * p);
+}
+
+/* ---- 2D transforms ---------------------------------------------------- */
+
+static void fahren_fft_transpose(const float* src, size_t rows, size_t cols, float* dst) {
+    for (size_t r0 = 0; r0 < rows; r0 += 8) {
+        size_t r1 = r0 + 8 < rows ? r0 + 8 : rows;
+        for (size_t c0 = 0; c0 < cols; c0 += 8) {
+            size_t c1 = c0 + 8 < cols ? c0 + 8 : cols;
+            for (size_t r = r0; r < r1; ++r) {
+                for (size_t c = c0; c < c1; ++c) dst[c * rows + r] = src[r * cols + c];
+            }
+        }
+    }
+}
+
+/* Forward 2D FFT of the Ph x Pw plane (re, im), of which only the first
+ * `rows` rows may be non-zero. The Pw x Ph result lands in (tre, tim). */
+static void fahren_fft2d_forward(const FahrenFFTKernel* k, float* re, float* im, size_t rows,
+                                 float* tre, float* tim, float* work) {
+    for (size_t r = 0; r < rows; ++r) {
+        fahren_fft_execute(k->plan_w, re + r * k->pw, im + r * k->pw, work, 0);
+    }
+    fahren_fft_transpose(re, k->ph, k->pw, tre);
+    fahren_fft_transpose(im, k->ph, k->pw, tim);
+    if (k->ph > 1) {
+        for (size_t c = 0; c < k->pw; ++c) {
+            fahren_fft_execute(k->plan_h, tre + c * k->ph, tim + c * k->ph, work, 0);
+        }
+    }
+}
+
+/* Inverse of the above, unscaled. (tre, tim) is consumed; only the rows of
+ * (re, im) listed by `row0 + i * row_step`, i < rows, are completed. */
+static void fahren_fft2d_inverse(const FahrenFFTKernel* k, float* tre, float* tim, float* re, float* im,
+                                 size_t row0, size_t row_step, size_t rows, float* work) {
+    if (k->ph > 1) {
+        for (size_t c = 0; c < k->pw; ++c) {
+            fahren_fft_execute(k->plan_h, tre + c * k->ph, tim + c * k->ph, work, 1);
+        }
+    }
+    fahren_fft_transpose(tre, k->pw, k->ph, re);
+    fahren_fft_transpose(tim, k->pw, k->ph, im);
+    for (size_t i = 0; i < rows; ++i) {
+        size_t r = row0 + i * row_step;
+        fahren_fft_execute(k->plan_w, re + r * k->pw, im + r * k->pw, work, 1);
+    }
+}
+
+/* acc += x * w over n complex values */
+static void fahren_fft_cmac(const float* xr, const float* xi, const float* wr, const float* wi,
+                            float* ar, float* ai, size_t n) {
+    size_t i = 0;
+#if defined(FAHREN_HAVE_SSE2)
+    for (; i + 4 <= n; i += 4) {
+        __m128 a = _mm_loadu_ps(xr + i), b = _mm_loadu_ps(xi + i);
+        __m128 c = _mm_loadu_ps(wr + i), d = _mm_loadu_ps(wi + i);
+        _mm_storeu_ps(ar + i, _mm_add_ps(_mm_loadu_ps(ar + i), _mm_sub_ps(_mm_mul_ps(a, c), _mm_mul_ps(b, d))));
+        _mm_storeu_ps(ai + i, _mm_add_ps(_mm_loadu_ps(ai + i), _mm_add_ps(_mm_mul_ps(a, d), _mm_mul_ps(b, c))));
+    }
+#endif
+    for (; i < n; ++i) {
+        ar[i] += xr[i] * wr[i] - xi[i] * wi[i];
+        ai[i] += xr[i] * wi[i] + xi[i] * wr[i];
+    }
+}
+
+/* ---- kernel spectra cache --------------------------------------------- */
+
+static uint64_t fahren_fft_hash(const float* w, size_t n) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t bits;
+        memcpy(&bits, w + i, sizeof(bits));
+        h = (h ^ bits) * 1099511628211ULL;
+    }
+    return h;
+}
+
+static int fahren_fft_kernel_matches(const FahrenFFTKernel* k, const FahrenFFTKernel* key) {
+    return k->cin == key->cin && k->cout == key->cout && k->kh == key->kh && k->kw == key->kw &&
+           k->dh == key->dh && k->dw == key->dw && k->ph == key->ph && k->pw == key->pw &&
+           k->weights == key->weights && k->hash == key->hash;
+}
+
+static void fahren_fft_kernel_free(FahrenFFTKernel* k) {
+    if (!k) return;
+    fahren_fft_plan_destroy(k->plan_h);
+    fahren_fft_plan_destroy(k->plan_w);
+    free(k->spectra);
+    free(k);
+}
+
+typedef struct FahrenFFTSpectraJob {
+    FahrenFFTKernel* k;
+    int failed;
+} FahrenFFTSpectraJob;
+
+static void fahren_fft_spectra_tasks(void* ctx, size_t begin, size_t end) {
+    FahrenFFTSpectraJob* job = (FahrenFFTSpectraJob*)ctx;
+    FahrenFFTKernel* k = job->k;
+    size_t p = k->ph * k->pw, taps = k->kh * k->kw;
+    size_t maxlen = k->ph > k->pw ? k->ph : k->pw;
+    float* buf = (float*)malloc((2 * p + 2 * maxlen) * sizeof(float));
+    if (!buf) {
+        job->failed = 1;
+        return;
+    }
+    float* re = buf;
+    float* im = buf + p;
+    float* work = buf + 2 * p;
+    for (size_t t = begin; t < end; ++t) {
+        size_t pair = t / k->cin, ci = t % k->cin;
+        size_t co0 = 2 * pair, co1 = co0 + 1;
+        memset(buf, 0, 2 * p * sizeof(float));
+        for (size_t ky = 0; ky < k->kh; ++ky) {
+            size_t y = (k->ph - (ky * k->dh) % k->ph) % k->ph;
+            for (size_t kx = 0; kx < k->kw; ++kx) {
+                size_t x = (k->pw - (kx * k->dw) % k->pw) % k->pw;
+                re[y * k->pw + x] = k->weights[(co0 * k->cin + ci) * taps + ky * k->kw + kx];
+                if (co1 < k->cout) im[y * k->pw + x] = k->weights[(co1 * k->cin + ci) * taps + ky * k->kw + kx];
+            }
+        }
+        float* out = k->spectra + t * 2 * p;
+        fahren_fft2d_forward(k, re, im, k->ph, out, out + p, work);
+    }
+    free(buf);
+}
+
+static FahrenFFTKernel* fahren_fft_kernel_build(const FahrenFFTKernel* key) {
+    FahrenFFTKernel* k = (FahrenFFTKernel*)calloc(1, sizeof(FahrenFFTKernel));
+    if (!k) return NULL;
+    *k = *key;
+    size_t pairs = (k->cout + 1) / 2;
+    k->plan_h = fahren_fft_plan_create(k->ph);
+    k->plan_w = fahren_fft_plan_create(k->pw);
+    k->spectra = (float*)malloc(pairs * k->cin * 2 * k->ph * k->pw * sizeof(float));
+    if (!k->plan_h || !k->plan_w || !k->spectra) {
+        fahren_fft_kernel_free(k);
+        return NULL;
+    }
+    FahrenFFTSpectraJob job = {k, 0};
+    fahren_parallel_for(pairs * k->cin, 1, fahren_fft_spectra_tasks, &job);
+    if (job.failed) {
+        fahren_fft_kernel_free(k);
+        return NULL;
+    }
+    return k;
+}
+
+static FahrenFFTKernel* fahren_fft_cache_find(const FahrenFFTKernel* key) {
+    for (size_t i = 0; i < FAHREN_FFT_CACHE_SLOTS; ++i) {
+        FahrenFFTKernel* k = fahren_fft_cache[i];
+        if (k && fahren_fft_kernel_matches(k, key)) {
+            k->refs++;
+            k->used = ++fahren_fft_cache_tick;
+            return k;
+        }
+    }
+    return NULL;
+}
+
+static FahrenFFTKernel* fahren_fft_kernel_acquire(const FahrenConvGeom* g, size_t cout, const float* weights) {
+    FahrenFFTKernel key;
+    memset(&key, 0, sizeof(key));
+    key.cin = g->channels;
+    key.cout = cout;
+    key.kh = g->kernel_h;
+    key.kw = g->kernel_w;
+    key.dh = g->dilation_h;
+    key.dw = g->dilation_w;
+    fahren_fft_grid(g, &key.ph, &key.pw);
+    key.weights = weights;
+    key.hash = fahren_fft_hash(weights, cout * g->channels * g->kernel_h * g->kernel_w);
+
+    pthread_mutex_lock(&fahren_fft_cache_lock);
+    FahrenFFTKernel* hit = fahren_fft_cache_find(&key);
+    pthread_mutex_unlock(&fahren_fft_cache_lock);
+    if (hit) return hit;
+
+    FahrenFFTKernel* k = fahren_fft_kernel_build(&key);
+    if (!k) return NULL;
+    pthread_mutex_lock(&fahren_fft_cache_lock);
+    hit = fahren_fft_cache_find(&key); /* another caller may have won the race */
+    if (hit) {
+        pthread_mutex_unlock(&fahren_fft_cache_lock);
+        fahren_fft_kernel_free(k);
+        return hit;
+    }
+    size_t victim = FAHREN_FFT_CACHE_SLOTS;
+    for (size_t i = 0; i < FAHREN_FFT_CACHE_SLOTS; ++i) {
+        FahrenFFTKernel* c = fahren_fft_cache[i];
+        if (!c) {
+            victim = i;
+            break;
+        }
+        if (c->refs == 0 && (victim == FAHREN_FFT_CACHE_SLOTS || c->used < fahren_fft_cache[victim]->used)) {
+            victim = i;
+        }
+    }
+    k->refs = 1;
+    k->used = ++fahren_fft_cache_tick;
+    if (victim < FAHREN_FFT_CACHE_SLOTS) {
+        fahren_fft_kernel_free(fahren_fft_cache[victim]);
+        fahren_fft_cache[victim] = k;
+        k->cached = 1;
+    }
+    pthread_mutex_unlock(&fahren_fft_cache_lock);
+    return k;
+}
+
+static void fahren_fft_kernel_release(FahrenFFTKernel* k) {
+    pthread_mutex_lock(&fahren_fft_cache_lock);
+    int drop = --k->refs == 0 && !k->cached;
+    pthread_mutex_unlock(&fahren_fft_cache_lock);
+    if (drop) fahren_fft_kernel_free(k);
+}
+
+void fahren_conv_fft_cache_clear(void) {
+    pthread_mutex_lock(&fahren_fft_cache_lock);
+    for (size_t i = 0; i < FAHREN_FFT_CACHE_SLOTS; ++i) {
+        FahrenFFTKernel* k = fahren_fft_cache[i];
+        if (!k) continue;
+        fahren_fft_cache[i] = NULL;
+        if (k->refs == 0) {
+            fahren_fft_kernel_free(k);
+        } else {
+            k->cached = 0; /* freed by its last user */
+        }
+    }
+    pthread_mutex_unlock(&fahren_fft_cache_lock);
+}
+
+/* ---- convolution ------------------------------------------------------ */
+
+typedef struct FahrenFFTConvJob {
+    const FahrenConvGeom* g;
+    const FahrenFFTKernel* k;
+    const float* x;      /* one image */
+    float* spectra;      /* cin x (re[P], im[P]) */
+    const float* bias;
+    float* y;            /* one image */
+    int failed;
+} FahrenFFTConvJob;
+
+static float* fahren_fft_scratch(const FahrenFFTKernel* k, size_t planes) {
+    size_t maxlen = k->ph > k->pw ? k->ph : k->pw;
+    return (float*)malloc((planes * k->ph * k->pw + 2 * maxlen) * sizeof(float));
+}
+
+static void fahren_fft_input_tasks(void* ctx, size_t begin, size_t end) {
+    FahrenFFTConvJob* job = (FahrenFFTConvJob*)ctx;
+    const FahrenConvGeom* g = job->g;
+    const FahrenFFTKernel* k = job->k;
+    size_t p = k->ph * k->pw;
+    float* buf = fahren_fft_scratch(k, 2);
+    if (!buf) {
+        job->failed = 1;
+        return;
+    }
+    float* re = buf;
+    float* im = buf + p;
+    for (size_t ci = begin; ci < end; ++ci) {
+        memset(buf, 0, 2 * p * sizeof(float));
+        const float* src = job->x + ci * g->height * g->width;
+        for (size_t iy = 0; iy < g->height; ++iy) {
+            memcpy(re + (g->pad_h + iy) * k->pw + g->pad_w, src + iy * g->width, g->width * sizeof(float));
+        }
+        float* out = job->spectra + ci * 2 * p;
+        fahren_fft2d_forward(k, re, im, g->height + g->pad_h, out, out + p, buf + 2 * p);
+    }
+    free(buf);
+}
+
+static void fahren_fft_output_tasks(void* ctx, size_t begin, size_t end) {
+    FahrenFFTConvJob* job = (FahrenFFTConvJob*)ctx;
+    const FahrenConvGeom* g = job->g;
+    const FahrenFFTKernel* k = job->k;
+    size_t p = k->ph * k->pw;
+    size_t plane = g->out_h * g->out_w;
+    float scale = 1.0f / (float)p;
+    float* buf = fahren_fft_scratch(k, 4);
+    if (!buf) {
+        job->failed = 1;
+        return;
+    }
+    float* ar = buf;
+    float* ai = buf + p;
+    float* re = buf + 2 * p;
+    float* im = buf + 3 * p;
+    for (size_t pair = begin; pair < end; ++pair) {
+        memset(buf, 0, 2 * p * sizeof(float));
+        for (size_t ci = 0; ci < k->cin; ++ci) {
+            const float* xs = job->spectra + ci * 2 * p;
+            const float* ks = k->spectra + (pair * k->cin + ci) * 2 * p;
+            fahren_fft_cmac(xs, xs + p, ks, ks + p, ar, ai, p);
+        }
+        fahren_fft2d_inverse(k, ar, ai, re, im, 0, g->stride_h, g->out_h, buf + 4 * p);
+        for (size_t half = 0; half < 2; ++half) {
+            size_t co = 2 * pair + half;
+            if (co >= k->cout) break;
+            const float* src = half ? im : re;
+            float b = job->bias ? job->bias[co] : 0.0f;
+            float* dst = job->y + co * plane;
+            for (size_t oy = 0; oy < g->out_h; ++oy) {
+                const float* row = src + oy * g->stride_h * k->pw;
+                for (size_t ox = 0; ox < g->out_w; ++ox) dst[oy * g->out_w + ox] = row[ox * g->stride_w] * scale + b;
+            }
+        }
+    }
+    free(buf);
+}
+
+FAHRENStatus fahren_conv_fft_forward(const FahrenConvGeom* g, size_t cout, size_t batch, const float* x,
+                                     const float* weights, const float* bias, float* y) {
+    FahrenFFTKernel* k = fahren_fft_kernel_acquire(g, cout, weights);
+    if (!k) return FAHREN_ERROR_PROCESSING_FAILED;
+    size_t p = k->ph * k->pw;
+    float* spectra = (float*)malloc(g->channels * 2 * p * sizeof(float));
+    if (!spectra) {
+        fahren_fft_kernel_release(k);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    FahrenFFTConvJob job;
+    memset(&job, 0, sizeof(job));
+    job.g = g;
+    job.k = k;
+    job.spectra = spectra;
+    job.bias = bias;
+    for (size_t n = 0; n < batch && !job.failed; ++n) {
+        job.x = x + n * g->channels * g->height * g->width;
+        job.y = y + n * cout * g->out_h * g->out_w;
+        fahren_parallel_for(g->channels, 1, fahren_fft_input_tasks, &job);
+        if (job.failed) break;
+        fahren_parallel_for((cout + 1) / 2, 1, fahren_fft_output_tasks, &job);
+    }
+    free(spectra);
+    fahren_fft_kernel_release(k);
+    return job.failed ? FAHREN_ERROR_PROCESSING_FAILED : FAHREN_SUCCESS;
+}
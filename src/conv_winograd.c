@@ -0,0 +1,178 @@
+/* Winograd F(2x2, 3x3) convolution for 3x3, stride-1, undilated kernels.
+ * See include/fahren/conv.h.
+ * Each 4x4 input tile (stride 2) and each 3x3 kernel is mapped to the
+ * 4x4 Winograd domain, where the channel reduction becomes 16 independent
+ * GEMMs M[xi] (Cout x T) = U[xi] (Cout x Cin) * V[xi] (Cin x T) over the T
+ * tiles of an image; the inverse transform turns each 4x4 result into a
+ * 2x2 output block. That is 16 multiplies per 4 outputs instead of 36. */
+#include <stdlib.h>
+#include <string.h>
+
+#include <fahren/conv.h>
+#include "fahren_internal.h"
+
+/* U = G g G^T with G = [1 0 0; .5 .5 .5; .5 -.5 .5; 0 0 1] */
+static void fahren_wino_kernel(const float* g, float* u) {
+    float t[4][3];
+    for (size_t c = 0; c < 3; ++c) {
+        float a = g[c], b = g[3 + c], d = g[6 + c];
+        t[0][c] = a;
+        t[1][c] = 0.5f * (a + b + d);
+        t[2][c] = 0.5f * (a - b + d);
+        t[3][c] = d;
+    }
+    for (size_t r = 0; r < 4; ++r) {
+        float a = t[r][0], b = t[r][1], d = t[r][2];
+        u[r * 4 + 0] = a;
+        u[r * 4 + 1] = 0.5f * (a + b + d);
+        u[r * 4 + 2] = 0.5f * (a - b + d);
+        u[r * 4 + 3] = d;
+    }
+}
+
+/* V = B^T d B with B^T = [1 0 -1 0; 0 1 1 0; 0 -1 1 0; 0 1 0 -1] */
+static void fahren_wino_input(const float* d, float* v) {
+    float t[4][4];
+    for (size_t c = 0; c < 4; ++c) {
+        float d0 = d[c], d1 = d[4 + c], d2 = d[8 + c], d3 = d[12 + c];
+        t[0][c] = d0 - d2;
+        t[1][c] = d1 + d2;
+        t[2][c] = d2 - d1;
+        t[3][c] = d1 - d3;
+    }
+    for (size_t r = 0; r < 4; ++r) {
+        v[r * 4 + 0] = t[r][0] - t[r][2];
+        v[r * 4 + 1] = t[r][1] + t[r][2];
+        v[r * 4 + 2] = t[r][2] - t[r][1];
+        v[r * 4 + 3] = t[r][1] - t[r][3];
+    }
+}
+
+/* Y = A^T m A with A^T = [1 1 1 0; 0 1 -1 -1] */
+static void fahren_wino_output(const float* m, float* y) {
+    float t[2][4];
+    for (size_t c = 0; c < 4; ++c) {
+        t[0][c] = m[c] + m[4 + c] + m[8 + c];
+        t[1][c] = m[4 + c] - m[8 + c] - m[12 + c];
+    }
+    for (size_t r = 0; r < 2; ++r) {
+        y[r * 2 + 0] = t[r][0] + t[r][1] + t[r][2];
+        y[r * 2 + 1] = t[r][1] - t[r][2] - t[r][3];
+    }
+}
+
+typedef struct FahrenWinoJob {
+    const FahrenConvGeom* g;
+    size_t cout;
+    size_t tiles_h, tiles_w, tiles;
+    const float* weights;
+    const float* x;     /* one image */
+    const float* bias;
+    float* y;           /* one image */
+    float* u;           /* 16 x cout x cin */
+    float* v;           /* 16 x cin x tiles */
+    float* m;           /* 16 x cout x tiles */
+} FahrenWinoJob;
+
+static void fahren_wino_kernel_tasks(void* ctx, size_t begin, size_t end) {
+    FahrenWinoJob* job = (FahrenWinoJob*)ctx;
+    size_t cin = job->g->channels, pairs = job->cout * cin;
+    for (size_t kc = begin; kc < end; ++kc) {
+        float u[16];
+        fahren_wino_kernel(job->weights + kc * 9, u);
+        for (size_t xi = 0; xi < 16; ++xi) job->u[xi * pairs + kc] = u[xi];
+    }
+}
+
+static void fahren_wino_input_tasks(void* ctx, size_t begin, size_t end) {
+    FahrenWinoJob* job = (FahrenWinoJob*)ctx;
+    const FahrenConvGeom* g = job->g;
+    size_t plane = g->channels * job->tiles;
+    for (size_t c = begin; c < end; ++c) {
+        const float* img = job->x + c * g->height * g->width;
+        for (size_t ty = 0; ty < job->tiles_h; ++ty) {
+            for (size_t tx = 0; tx < job->tiles_w; ++tx) {
+                float d[16], v[16];
+                long y0 = (long)(2 * ty) - (long)g->pad_h, x0 = (long)(2 * tx) - (long)g->pad_w;
+                for (size_t r = 0; r < 4; ++r) {
+                    long iy = y0 + (long)r;
+                    for (size_t q = 0; q < 4; ++q) {
+                        long ix = x0 + (long)q;
+                        int inside = iy >= 0 && iy < (long)g->height && ix >= 0 && ix < (long)g->width;
+                        d[r * 4 + q] = inside ? img[(size_t)iy * g->width + (size_t)ix] : 0.0f;
+                    }
+                }
+                fahren_wino_input(d, v);
+                size_t t = ty * job->tiles_w + tx;
+                for (size_t xi = 0; xi < 16; ++xi) job->v[xi * plane + c * job->tiles + t] = v[xi];
+            }
+        }
+    }
+}
+
+static void fahren_wino_output_tasks(void* ctx, size_t begin, size_t end) {
+    FahrenWinoJob* job = (FahrenWinoJob*)ctx;
+    const FahrenConvGeom* g = job->g;
+    size_t plane = job->cout * job->tiles;
+    for (size_t k = begin; k < end; ++k) {
+        float b = job->bias ? job->bias[k] : 0.0f;
+        float* out = job->y + k * g->out_h * g->out_w;
+        for (size_t ty = 0; ty < job->tiles_h; ++ty) {
+            for (size_t tx = 0; tx < job->tiles_w; ++tx) {
+                float m[16], y[4];
+                size_t t = ty * job->tiles_w + tx;
+                for (size_t xi = 0; xi < 16; ++xi) m[xi] = job->m[xi * plane + k * job->tiles + t];
+                fahren_wino_output(m, y);
+                for (size_t r = 0; r < 2 && 2 * ty + r < g->out_h; ++r) {
+                    for (size_t q = 0; q < 2 && 2 * tx + q < g->out_w; ++q) {
+                        out[(2 * ty + r) * g->out_w + 2 * tx + q] = y[r * 2 + q] + b;
+                    }
+                }
+            }
+        }
+    }
+}
+
+FAHRENStatus fahren_conv_winograd_forward(const FahrenConvGeom* g, size_t cout, size_t batch, const float* x,
+                                          const float* weights, const float* bias, float* y) {
+    size_t cin = g->channels;
+    FahrenWinoJob job;
+    memset(&job, 0, sizeof(job));
+    job.g = g;
+    job.cout = cout;
+    job.tiles_h = (g->out_h + 1) / 2;
+    job.tiles_w = (g->out_w + 1) / 2;
+    job.tiles = job.tiles_h * job.tiles_w;
+    job.weights = weights;
+    job.bias = bias;
+    job.u = (float*)malloc(16 * cout * cin * sizeof(float));
+    job.v = (float*)malloc(16 * cin * job.tiles * sizeof(float));
+    job.m = (float*)malloc(16 * cout * job.tiles * sizeof(float));
+    if (!job.u || !job.v || !job.m) {
+        free(job.u);
+        free(job.v);
+        free(job.m);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    fahren_parallel_for(cout * cin, 16, fahren_wino_kernel_tasks, &job);
+
+    FAHRENStatus st = FAHREN_SUCCESS;
+    for (size_t n = 0; n < batch && st == FAHREN_SUCCESS; ++n) {
+        job.x = x + n * cin * g->height * g->width;
+        job.y = y + n * cout * g->out_h * g->out_w;
+        fahren_parallel_for(cin, 1, fahren_wino_input_tasks, &job);
+        for (size_t xi = 0; xi < 16; ++xi) {
+            if (!fahren_sgemm(0, 0, cout, job.tiles, cin, 1.0f, job.u + xi * cout * cin, cin,
+                              job.v + xi * cin * job.tiles, job.tiles, 0.0f,
+                              job.m + xi * cout * job.tiles, job.tiles)) {
+                st = FAHREN_ERROR_PROCESSING_FAILED;
+                break;
+            }
+        }
+        if (st == FAHREN_SUCCESS) fahren_parallel_for(cout, 1, fahren_wino_output_tasks, &job);
+    }
+    free(job.u);
+    free(job.v);
+    free(job.m);
+    return st;
+}
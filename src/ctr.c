@@ -0,0 +1,273 @@
+/* Factorization machine and DCN cross layer kernels. See
+ * include/fahren/ctr.h.
+ *
+ * FM forward uses the sum-of-squares identity so each row costs one pass
+ * over its non-zeros with the factor loop vectorized. FM backward
+ * scatters into feature rows of dV; to keep threads from colliding on
+ * shared features the work is split by feature range, and every shard
+ * walks the (small) sparse batch picking out the entries it owns. Cross
+ * layer parameter gradients are reduced from per-chunk partials. Error
+ * flags raised by workers are relaxed atomics, read after the loop. */
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <fahren/ctr.h>
+#include "fahren_internal.h"
+#include "fahren_simd.h"
+
+static int fahren_sparse_valid(const FAHRENSparseBatch* x) {
+    return x && x->row_ptr && (x->indices || x->row_ptr[x->rows] == 0);
+}
+
+/* ---- factorization machine -------------------------------------------- */
+
+typedef struct FahrenFMJob {
+    const FAHRENSparseBatch* x;
+    size_t features;
+    size_t factors;
+    float w0;
+    const float* w;
+    const float* V;
+    float* y;
+    float* sums;
+    /* backward only */
+    const float* saved_sums;
+    const float* dy;
+    float* dw;
+    float* dV;
+    size_t shards;
+    atomic_int bad_index;
+    atomic_int failed;
+} FahrenFMJob;
+
+static void fahren_fm_forward_rows(void* ctx, size_t begin, size_t end) {
+    FahrenFMJob* job = (FahrenFMJob*)ctx;
+    const FAHRENSparseBatch* x = job->x;
+    size_t k = job->factors;
+    float* sq = k ? (float*)calloc(k, sizeof(float)) : NULL;
+    if (k && !sq) {
+        atomic_store_explicit(&job->failed, 1, memory_order_relaxed);
+        return;
+    }
+
+    for (size_t r = begin; r < end; ++r) {
+        float* sum = job->sums + r * k;
+        memset(sum, 0, k * sizeof(float));
+        if (k) memset(sq, 0, k * sizeof(float));
+        float linear = job->w0;
+        for (int64_t e = x->row_ptr[r]; e < x->row_ptr[r + 1]; ++e) {
+            int32_t i = x->indices[e];
+            if (i < 0 || (size_t)i >= job->features) {
+                atomic_store_explicit(&job->bad_index, 1, memory_order_relaxed);
+                continue;
+            }
+            float xi = x->values ? x->values[e] : 1.0f;
+            const float* v = job->V + (size_t)i * k;
+            linear += job->w[i] * xi;
+            fahren_axpy_f32(xi, v, sum, k);
+            /* sq[f] += (v[f] * xi)^2, vectorized like axpy */
+            size_t f = 0;
+#if defined(FAHREN_HAVE_SSE2)
+            __m128 vx = _mm_set1_ps(xi);
+            for (; f + 4 <= k; f += 4) {
+                __m128 t = _mm_mul_ps(_mm_loadu_ps(v + f), vx);
+                _mm_storeu_ps(sq + f, _mm_add_ps(_mm_loadu_ps(sq + f), _mm_mul_ps(t, t)));
+            }
+#endif
+            for (; f < k; ++f) {
+                float t = v[f] * xi;
+                sq[f] += t * t;
+            }
+        }
+        float pair = fahren_dot_f32(sum, sum, k);
+        for (size_t f = 0; f < k; ++f) pair -= sq[f];
+        job->y[r] = linear + 0.5f * pair;
+    }
+    free(sq);
+}
+
+FAHRENStatus fahren_fm_forward(const FAHRENSparseBatch* x, size_t features, size_t factors,
+                               float w0, const float* w, const float* V,
+                               float* y, float* sums) {
+    if (!fahren_sparse_valid(x) || !w || !y || features == 0) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (factors && (!V || !sums)) return FAHREN_ERROR_INVALID_ARGUMENT;
+
+    FahrenFMJob job;
+    memset(&job, 0, sizeof(job));
+    job.x = x;
+    job.features = features;
+    job.factors = factors;
+    job.w0 = w0;
+    job.w = w;
+    job.V = V;
+    job.y = y;
+    job.sums = sums;
+    atomic_init(&job.bad_index, 0);
+    atomic_init(&job.failed, 0);
+    fahren_parallel_for(x->rows, 16, fahren_fm_forward_rows, &job);
+    if (atomic_load_explicit(&job.failed, memory_order_relaxed)) return FAHREN_ERROR_PROCESSING_FAILED;
+    return atomic_load_explicit(&job.bad_index, memory_order_relaxed) ? FAHREN_ERROR_INVALID_ARGUMENT : FAHREN_SUCCESS;
+}
+
+/* dL/dV[i,f] = dy * (x_i * sums[f] - V[i,f] * x_i^2); dL/dw[i] = dy * x_i */
+static void fahren_fm_backward_shards(void* ctx, size_t begin, size_t end) {
+    FahrenFMJob* job = (FahrenFMJob*)ctx;
+    const FAHRENSparseBatch* x = job->x;
+    size_t k = job->factors;
+    size_t span = (job->features + job->shards - 1) / job->shards;
+
+    for (size_t s = begin; s < end; ++s) {
+        size_t lo = s * span;
+        size_t hi = lo + span < job->features ? lo + span : job->features;
+        for (size_t r = 0; r < x->rows; ++r) {
+            float g = job->dy[r];
+            const float* sum = job->saved_sums + r * k;
+            for (int64_t e = x->row_ptr[r]; e < x->row_ptr[r + 1]; ++e) {
+                int32_t i = x->indices[e];
+                if (i < 0 || (size_t)i < lo || (size_t)i >= hi) continue;
+                float xi = x->values ? x->values[e] : 1.0f;
+                job->dw[i] += g * xi;
+                const float* v = job->V + (size_t)i * k;
+                float* dv = job->dV + (size_t)i * k;
+                fahren_axpy_f32(g * xi, sum, dv, k);
+                fahren_axpy_f32(-g * xi * xi, v, dv, k);
+            }
+        }
+    }
+}
+
+FAHRENStatus fahren_fm_backward(const FAHRENSparseBatch* x, size_t features, size_t factors,
+                                const float* V, const float* sums, const float* dy,
+                                float* dw0, float* dw, float* dV) {
+    if (!fahren_sparse_valid(x) || !dy || !dw0 || !dw || features == 0) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (factors && (!V || !sums || !dV)) return FAHREN_ERROR_INVALID_ARGUMENT;
+
+    float g0 = 0.0f;
+    for (size_t r = 0; r < x->rows; ++r) g0 += dy[r];
+    *dw0 += g0;
+
+    FahrenFMJob job;
+    memset(&job, 0, sizeof(job));
+    job.x = x;
+    job.features = features;
+    job.factors = factors;
+    job.V = V;
+    job.saved_sums = sums;
+    job.dy = dy;
+    job.dw = dw;
+    job.dV = dV;
+    job.shards = fahren_thread_count();
+    if (job.shards > features) job.shards = features;
+    fahren_parallel_for(job.shards, 1, fahren_fm_backward_shards, &job);
+    return FAHREN_SUCCESS;
+}
+
+/* ---- cross layer ------------------------------------------------------ */
+
+typedef struct FahrenCrossJob {
+    const float* x0;
+    const float* xl;
+    size_t dim;
+    const float* w;
+    const float* b;
+    float* out;
+    float* dots;
+    /* backward only */
+    const float* saved_dots;
+    const float* dout;
+    float* dx0;
+    float* dxl;
+    float* dw;
+    float* db;
+    pthread_mutex_t lock;
+    atomic_int failed;
+} FahrenCrossJob;
+
+static void fahren_cross_forward_rows(void* ctx, size_t begin, size_t end) {
+    FahrenCrossJob* job = (FahrenCrossJob*)ctx;
+    size_t d = job->dim;
+    for (size_t r = begin; r < end; ++r) {
+        const float* x0 = job->x0 + r * d;
+        const float* xl = job->xl + r * d;
+        float* out = job->out + r * d;
+        float s = fahren_dot_f32(xl, job->w, d);
+        job->dots[r] = s;
+        for (size_t j = 0; j < d; ++j) out[j] = xl[j] + job->b[j];
+        fahren_axpy_f32(s, x0, out, d);
+    }
+}
+
+FAHRENStatus fahren_cross_forward(const float* x0, const float* xl, size_t rows, size_t dim,
+                                  const float* w, const float* b, float* out, float* dots) {
+    if (!x0 || !xl || !w || !b || !out || !dots || dim == 0) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenCrossJob job;
+    memset(&job, 0, sizeof(job));
+    job.x0 = x0;
+    job.xl = xl;
+    job.dim = dim;
+    job.w = w;
+    job.b = b;
+    job.out = out;
+    job.dots = dots;
+    fahren_parallel_for(rows, 32, fahren_cross_forward_rows, &job);
+    return FAHREN_SUCCESS;
+}
+
+static void fahren_cross_backward_rows(void* ctx, size_t begin, size_t end) {
+    FahrenCrossJob* job = (FahrenCrossJob*)ctx;
+    size_t d = job->dim;
+    float* part = (float*)calloc(2 * d, sizeof(float)); /* dw | db partials */
+    if (!part) {
+        atomic_store_explicit(&job->failed, 1, memory_order_relaxed);
+        return;
+    }
+    float* pdw = part;
+    float* pdb = part + d;
+
+    for (size_t r = begin; r < end; ++r) {
+        const float* x0 = job->x0 + r * d;
+        const float* xl = job->xl + r * d;
+        const float* g = job->dout + r * d;
+        float* dxl = job->dxl + r * d;
+        float s = job->saved_dots[r];
+        float ds = fahren_dot_f32(g, x0, d);
+        fahren_axpy_f32(s, g, job->dx0 + r * d, d);
+        fahren_axpy_f32(ds, xl, pdw, d);
+        fahren_axpy_f32(1.0f, g, pdb, d);
+        if (dxl != g) memcpy(dxl, g, d * sizeof(float));
+        fahren_axpy_f32(ds, job->w, dxl, d);
+    }
+
+    pthread_mutex_lock(&job->lock);
+    fahren_axpy_f32(1.0f, pdw, job->dw, d);
+    fahren_axpy_f32(1.0f, pdb, job->db, d);
+    pthread_mutex_unlock(&job->lock);
+    free(part);
+}
+
+FAHRENStatus fahren_cross_backward(const float* x0, const float* xl, size_t rows, size_t dim,
+                                   const float* w, const float* dots, const float* dout,
+                                   float* dx0, float* dxl, float* dw, float* db) {
+    if (!x0 || !xl || !w || !dots || !dout || !dx0 || !dxl || !dw || !db || dim == 0) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    FahrenCrossJob job;
+    memset(&job, 0, sizeof(job));
+    job.x0 = x0;
+    job.xl = xl;
+    job.dim = dim;
+    job.w = w;
+    job.saved_dots = dots;
+    job.dout = dout;
+    job.dx0 = dx0;
+    job.dxl = dxl;
+    job.dw = dw;
+    job.db = db;
+    pthread_mutex_init(&job.lock, NULL);
+    atomic_init(&job.failed, 0);
+    fahren_parallel_for(rows, 32, fahren_cross_backward_rows, &job);
+    pthread_mutex_destroy(&job.lock);
+    return atomic_load_explicit(&job.failed, memory_order_relaxed) ? FAHREN_ERROR_PROCESSING_FAILED : FAHREN_SUCCESS;
+}
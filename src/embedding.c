@@ -0,0 +1,557 @@
+/* Quantized, tiered embedding store. See include/fahren/embedding.h.
+ *
+ * File layout ('FAHE'): a 64-byte header followed by `rows` fixed-size
+ * records of [float scale][float offset][codes], codes packed low nibble
+ * first for 4-bit tables. value = offset + scale * code.
+ *
+ * The RAM tier is split into shards by row hash. Each shard has its own
+ * lock, a linear-probing index from row id to cache slot, and a
+ * count-min sketch of recent access frequency (TinyLFU style: counters
+ * are halved periodically so old popularity fades). A cold row is
+ * promoted when its estimated frequency beats the coldest of a few
+ * randomly sampled cached rows. Misses are dequantized with no lock
+ * held; the shard lock is only retaken to publish the row. */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <fahren/embedding.h>
+#include "fahren_simd.h"
+
+#define FAHREN_EMB_MAGIC 0x46414845u /* 'FAHE' */
+#define FAHREN_EMB_VERSION 1u
+#define FAHREN_EMB_HEADER_SIZE 64
+#define FAHREN_EMB_SHARDS 16
+#define FAHREN_EMB_SKETCH_DEPTH 4
+#define FAHREN_EMB_VICTIM_SAMPLES 8
+#define FAHREN_EMB_QUEUE 4096
+
+typedef struct FahrenEmbHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t rows;
+    uint32_t dim;
+    uint32_t bits;
+    uint64_t row_bytes;
+} FahrenEmbHeader;
+
+typedef struct FahrenEmbShard {
+    pthread_mutex_t lock;
+    /* cache slots */
+    size_t slot_count;
+    int64_t* slot_row;     /* -1 when free */
+    float* slot_data;      /* slot_count x dim */
+    size_t* free_slots;
+    size_t free_count;
+    /* row id -> slot index, linear probing, power-of-two size */
+    int64_t* index_key;    /* -1 when empty */
+    uint32_t* index_slot;
+    size_t index_mask;
+    /* frequency sketch */
+    uint16_t* sketch;      /* depth x width */
+    size_t sketch_mask;
+    size_t sketch_adds;
+    size_t sketch_reset_at;
+    uint64_t rng;
+    /* stats */
+    uint64_t hits, misses, promotions;
+} FahrenEmbShard;
+
+struct FAHRENEmbeddingStore {
+    size_t rows;
+    size_t dim;
+    int bits;
+    size_t row_bytes;
+    const unsigned char* map;
+    size_t map_size;
+    FahrenEmbShard shards[FAHREN_EMB_SHARDS];
+    int caching;
+
+    /* prefetcher */
+    int prefetch_running;
+    pthread_t prefetch_thread;
+    pthread_mutex_t queue_lock;
+    pthread_cond_t queue_cv;
+    int64_t* queue;
+    size_t queue_head, queue_count;
+    int stopping;
+    uint64_t prefetched;
+};
+
+static inline uint64_t fahren_emb_mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+static size_t fahren_emb_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+/* ---- quantization ----------------------------------------------------- */
+
+static void fahren_emb_quantize_row(const float* x, size_t dim, int bits, unsigned char* rec) {
+    float lo = x[0], hi = x[0];
+    for (size_t i = 1; i < dim; ++i) {
+        lo = x[i] < lo ? x[i] : lo;
+        hi = x[i] > hi ? x[i] : hi;
+    }
+    float levels = bits == 8 ? 255.0f : 15.0f;
+    float scale = hi > lo ? (hi - lo) / levels : 1.0f;
+    float inv = 1.0f / scale;
+    memcpy(rec, &scale, sizeof(float));
+    memcpy(rec + 4, &lo, sizeof(float));
+    unsigned char* codes = rec + 8;
+    if (bits == 8) {
+        for (size_t i = 0; i < dim; ++i) codes[i] = (unsigned char)lrintf((x[i] - lo) * inv);
+    } else {
+        memset(codes, 0, (dim + 1) / 2);
+        for (size_t i = 0; i < dim; ++i) {
+            unsigned q = (unsigned)lrintf((x[i] - lo) * inv) & 0xF;
+            codes[i / 2] |= (unsigned char)(i & 1 ? q << 4 : q);
+        }
+    }
+}
+
+static void fahren_emb_dequantize_row(const unsigned char* rec, size_t dim, int bits, float* out) {
+    float scale, offset;
+    memcpy(&scale, rec, sizeof(float));
+    memcpy(&offset, rec + 4, sizeof(float));
+    const unsigned char* codes = rec + 8;
+    size_t i = 0;
+    if (bits == 8) {
+#if defined(FAHREN_HAVE_SSE2)
+        __m128 vs = _mm_set1_ps(scale), vo = _mm_set1_ps(offset);
+        __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= dim; i += 16) {
+            __m128i b = _mm_loadu_si128((const __m128i*)(codes + i));
+            __m128i lo16 = _mm_unpacklo_epi8(b, zero), hi16 = _mm_unpackhi_epi8(b, zero);
+            __m128i q0 = _mm_unpacklo_epi16(lo16, zero), q1 = _mm_unpackhi_epi16(lo16, zero);
+            __m128i q2 = _mm_unpacklo_epi16(hi16, zero), q3 = _mm_unpackhi_epi16(hi16, zero);
+            _mm_storeu_ps(out + i, _mm_add_ps(vo, _mm_mul_ps(vs, _mm_cvtepi32_ps(q0))));
+            _mm_storeu_ps(out + i + 4, _mm_add_ps(vo, _mm_mul_ps(vs, _mm_cvtepi32_ps(q1))));
+            _mm_storeu_ps(out + i + 8, _mm_add_ps(vo, _mm_mul_ps(vs, _mm_cvtepi32_ps(q2))));
+            _mm_storeu_ps(out + i + 12, _mm_add_ps(vo, _mm_mul_ps(vs, _mm_cvtepi32_ps(q3))));
+        }
+#endif
+        for (; i < dim; ++i) out[i] = offset + scale * (float)codes[i];
+    } else {
+        for (; i + 2 <= dim; i += 2) {
+            unsigned char b = codes[i / 2];
+            out[i] = offset + scale * (float)(b & 0xF);
+            out[i + 1] = offset + scale * (float)(b >> 4);
+        }
+        if (i < dim) out[i] = offset + scale * (float)(codes[i / 2] & 0xF);
+    }
+}
+
+static size_t fahren_emb_row_bytes(size_t dim, int bits) {
+    size_t code_bytes = bits == 8 ? dim : (dim + 1) / 2;
+    return (8 + code_bytes + 3) & ~(size_t)3; /* keep scale/offset aligned */
+}
+
+FAHRENStatus fahren_embedding_write_quantized(const float* table, size_t rows, size_t dim,
+                                              int bits, const char* path) {
+    if (!table || !path || rows == 0 || dim == 0 || dim > UINT32_MAX) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (bits != 8 && bits != 4) return FAHREN_ERROR_INVALID_ARGUMENT;
+
+    size_t row_bytes = fahren_emb_row_bytes(dim, bits);
+    unsigned char header[FAHREN_EMB_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    FahrenEmbHeader h = {FAHREN_EMB_MAGIC, FAHREN_EMB_VERSION, (uint64_t)rows,
+                         (uint32_t)dim, (uint32_t)bits, (uint64_t)row_bytes};
+    memcpy(header, &h, sizeof(h));
+
+    unsigned char* rec = (unsigned char*)calloc(1, row_bytes);
+    if (!rec) return FAHREN_ERROR_PROCESSING_FAILED;
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        free(rec);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    if (fwrite(header, sizeof(header), 1, f) != 1) goto io_error;
+    for (size_t r = 0; r < rows; ++r) {
+        fahren_emb_quantize_row(table + r * dim, dim, bits, rec);
+        if (fwrite(rec, row_bytes, 1, f) != 1) goto io_error;
+    }
+    free(rec);
+    return fclose(f) == 0 ? FAHREN_SUCCESS : FAHREN_ERROR_PROCESSING_FAILED;
+
+io_error:
+    fclose(f);
+    free(rec);
+    return FAHREN_ERROR_PROCESSING_FAILED;
+}
+
+/* ---- shard cache ------------------------------------------------------ */
+
+static int fahren_emb_shard_init(FahrenEmbShard* s, size_t slots, size_t dim, uint64_t seed) {
+    memset(s, 0, sizeof(*s));
+    pthread_mutex_init(&s->lock, NULL);
+    s->rng = seed | 1;
+    if (slots == 0) return 1;
+    /* slot numbers are stored as uint32_t; the index holds 2x slots and
+     * the data slots x dim floats */
+    if (slots > UINT32_MAX || slots > SIZE_MAX / 4 / sizeof(int64_t) || dim > SIZE_MAX / sizeof(float) / slots) {
+        return 0;
+    }
+
+    s->slot_count = slots;
+    s->slot_row = (int64_t*)malloc(slots * sizeof(int64_t));
+    s->slot_data = (float*)malloc(slots * dim * sizeof(float));
+    s->free_slots = (size_t*)malloc(slots * sizeof(size_t));
+    size_t index_size = fahren_emb_pow2(slots * 2);
+    s->index_key = (int64_t*)malloc(index_size * sizeof(int64_t));
+    s->index_slot = (uint32_t*)malloc(index_size * sizeof(uint32_t));
+    s->index_mask = index_size - 1;
+    size_t width = fahren_emb_pow2(slots * 4 < 256 ? 256 : slots * 4);
+    if (width > 65536) width = 65536; /* each row hash yields 16 bits per sketch row */
+    s->sketch = (uint16_t*)calloc(FAHREN_EMB_SKETCH_DEPTH * width, sizeof(uint16_t));
+    s->sketch_mask = width - 1;
+    s->sketch_reset_at = width * 10;
+    if (!s->slot_row || !s->slot_data || !s->free_slots || !s->index_key || !s->index_slot || !s->sketch) {
+        return 0;
+    }
+    for (size_t i = 0; i < slots; ++i) {
+        s->slot_row[i] = -1;
+        s->free_slots[i] = slots - 1 - i;
+    }
+    s->free_count = slots;
+    for (size_t i = 0; i <= s->index_mask; ++i) s->index_key[i] = -1;
+    return 1;
+}
+
+static void fahren_emb_shard_free(FahrenEmbShard* s) {
+    free(s->slot_row);
+    free(s->slot_data);
+    free(s->free_slots);
+    free(s->index_key);
+    free(s->index_slot);
+    free(s->sketch);
+    pthread_mutex_destroy(&s->lock);
+}
+
+static long fahren_emb_index_find(const FahrenEmbShard* s, int64_t row) {
+    size_t i = (size_t)fahren_emb_mix((uint64_t)row) & s->index_mask;
+    while (s->index_key[i] != -1) {
+        if (s->index_key[i] == row) return (long)s->index_slot[i];
+        i = (i + 1) & s->index_mask;
+    }
+    return -1;
+}
+
+static void fahren_emb_index_insert(FahrenEmbShard* s, int64_t row, size_t slot) {
+    size_t i = (size_t)fahren_emb_mix((uint64_t)row) & s->index_mask;
+    while (s->index_key[i] != -1) i = (i + 1) & s->index_mask;
+    s->index_key[i] = row;
+    s->index_slot[i] = (uint32_t)slot;
+}
+
+/* Linear-probing delete with backward shift, so no tombstones pile up. */
+static void fahren_emb_index_remove(FahrenEmbShard* s, int64_t row) {
+    size_t i = (size_t)fahren_emb_mix((uint64_t)row) & s->index_mask;
+    while (s->index_key[i] != row) {
+        if (s->index_key[i] == -1) return;
+        i = (i + 1) & s->index_mask;
+    }
+    size_t j = i;
+    for (;;) {
+        s->index_key[i] = -1;
+        for (;;) {
+            j = (j + 1) & s->index_mask;
+            if (s->index_key[j] == -1) return;
+            size_t home = (size_t)fahren_emb_mix((uint64_t)s->index_key[j]) & s->index_mask;
+            /* move j back to i unless its home lies cyclically in (i, j] */
+            if (i <= j ? (i < home && home <= j) : (i < home || home <= j)) continue;
+            break;
+        }
+        s->index_key[i] = s->index_key[j];
+        s->index_slot[i] = s->index_slot[j];
+        i = j;
+    }
+}
+
+static uint32_t fahren_emb_sketch_estimate(const FahrenEmbShard* s, int64_t row) {
+    uint64_t h = fahren_emb_mix((uint64_t)row);
+    uint32_t est = UINT16_MAX;
+    for (int d = 0; d < FAHREN_EMB_SKETCH_DEPTH; ++d) {
+        size_t col = (size_t)(h >> (16 * d)) & s->sketch_mask;
+        uint16_t c = s->sketch[(size_t)d * (s->sketch_mask + 1) + col];
+        est = c < est ? c : est;
+    }
+    return est;
+}
+
+static void fahren_emb_sketch_add(FahrenEmbShard* s, int64_t row) {
+    uint64_t h = fahren_emb_mix((uint64_t)row);
+    for (int d = 0; d < FAHREN_EMB_SKETCH_DEPTH; ++d) {
+        size_t col = (size_t)(h >> (16 * d)) & s->sketch_mask;
+        uint16_t* c = &s->sketch[(size_t)d * (s->sketch_mask + 1) + col];
+        if (*c < UINT16_MAX) ++*c;
+    }
+    if (++s->sketch_adds >= s->sketch_reset_at) {
+        size_t n = FAHREN_EMB_SKETCH_DEPTH * (s->sketch_mask + 1);
+        for (size_t i = 0; i < n; ++i) s->sketch[i] >>= 1;
+        s->sketch_adds /= 2;
+    }
+}
+
+/* Try to bring `row`, already dequantized into `values`, into the shard
+ * (lock held; the row must not be cached). Returns whether it was
+ * admitted. */
+static int fahren_emb_promote(FAHRENEmbeddingStore* st, FahrenEmbShard* s, int64_t row, const float* values) {
+    size_t slot;
+    if (s->free_count > 0) {
+        slot = s->free_slots[--s->free_count];
+    } else {
+        uint32_t freq = fahren_emb_sketch_estimate(s, row);
+        size_t victim = 0;
+        uint32_t victim_freq = UINT32_MAX;
+        for (int k = 0; k < FAHREN_EMB_VICTIM_SAMPLES; ++k) {
+            s->rng ^= s->rng << 13;
+            s->rng ^= s->rng >> 7;
+            s->rng ^= s->rng << 17;
+            size_t cand = (size_t)(s->rng % s->slot_count);
+            uint32_t f = fahren_emb_sketch_estimate(s, s->slot_row[cand]);
+            if (f < victim_freq) {
+                victim_freq = f;
+                victim = cand;
+            }
+        }
+        if (freq <= victim_freq) return 0;
+        fahren_emb_index_remove(s, s->slot_row[victim]);
+        slot = victim;
+    }
+    memcpy(s->slot_data + slot * st->dim, values, st->dim * sizeof(float));
+    s->slot_row[slot] = row;
+    fahren_emb_index_insert(s, row, slot);
+    s->promotions++;
+    return 1;
+}
+
+/* ---- store ------------------------------------------------------------ */
+
+static inline FahrenEmbShard* fahren_emb_shard_of(FAHRENEmbeddingStore* st, int64_t row) {
+    return &st->shards[fahren_emb_mix((uint64_t)row ^ 0x5bd1e995u) % FAHREN_EMB_SHARDS];
+}
+
+static inline const unsigned char* fahren_emb_record(const FAHRENEmbeddingStore* st, int64_t row) {
+    return st->map + FAHREN_EMB_HEADER_SIZE + (size_t)row * st->row_bytes;
+}
+
+static void fahren_emb_willneed(const FAHRENEmbeddingStore* st, int64_t row) {
+    long page = sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)fahren_emb_record(st, row);
+    uintptr_t end = start + st->row_bytes;
+    start &= ~(uintptr_t)(page - 1);
+    (void)madvise((void*)start, end - start, MADV_WILLNEED);
+}
+
+static void* fahren_emb_prefetch_main(void* arg) {
+    FAHRENEmbeddingStore* st = (FAHRENEmbeddingStore*)arg;
+    int64_t batch[256];
+    /* without room to dequantize into, rows are only faulted in */
+    float* values = st->caching ? (float*)malloc(st->dim * sizeof(float)) : NULL;
+    for (;;) {
+        pthread_mutex_lock(&st->queue_lock);
+        while (st->queue_count == 0 && !st->stopping) pthread_cond_wait(&st->queue_cv, &st->queue_lock);
+        if (st->stopping) {
+            pthread_mutex_unlock(&st->queue_lock);
+            break;
+        }
+        size_t n = 0;
+        while (st->queue_count > 0 && n < 256) {
+            batch[n++] = st->queue[st->queue_head];
+            st->queue_head = (st->queue_head + 1) % FAHREN_EMB_QUEUE;
+            st->queue_count--;
+        }
+        pthread_mutex_unlock(&st->queue_lock);
+
+        for (size_t i = 0; i < n; ++i) {
+            int64_t row = batch[i];
+            FahrenEmbShard* s = fahren_emb_shard_of(st, row);
+            const unsigned char* rec = fahren_emb_record(st, row);
+            /* Touch the record so the fault happens here, not in lookup. */
+            volatile unsigned char sink = rec[0];
+            sink ^= rec[st->row_bytes - 1];
+            (void)sink;
+            if (values) {
+                pthread_mutex_lock(&s->lock);
+                int cached = fahren_emb_index_find(s, row) >= 0;
+                pthread_mutex_unlock(&s->lock);
+                if (!cached) {
+                    fahren_emb_dequantize_row(rec, st->dim, st->bits, values);
+                    pthread_mutex_lock(&s->lock);
+                    if (fahren_emb_index_find(s, row) < 0) (void)fahren_emb_promote(st, s, row, values);
+                    pthread_mutex_unlock(&s->lock);
+                }
+            }
+            __atomic_add_fetch(&st->prefetched, 1, __ATOMIC_RELAXED);
+        }
+    }
+    free(values);
+    return NULL;
+}
+
+FAHRENEmbeddingStore* fahren_embedding_open(const char* path, const FAHRENEmbeddingConfig* config) {
+    if (!path) return NULL;
+    FAHRENEmbeddingConfig cfg = {0, 0};
+    if (config) cfg = *config;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat sb;
+    FahrenEmbHeader h;
+    if (fstat(fd, &sb) != 0 || (size_t)sb.st_size < FAHREN_EMB_HEADER_SIZE ||
+        pread(fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h)) {
+        close(fd);
+        return NULL;
+    }
+    if (h.magic != FAHREN_EMB_MAGIC || h.version != FAHREN_EMB_VERSION || (h.bits != 8 && h.bits != 4) ||
+        h.dim == 0 || h.row_bytes != fahren_emb_row_bytes(h.dim, (int)h.bits) ||
+        h.rows > ((uint64_t)sb.st_size - FAHREN_EMB_HEADER_SIZE) / h.row_bytes) {
+        close(fd);
+        return NULL;
+    }
+    void* map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+    (void)madvise(map, (size_t)sb.st_size, MADV_RANDOM); /* no readahead on sparse gathers */
+
+    FAHRENEmbeddingStore* st = (FAHRENEmbeddingStore*)calloc(1, sizeof(FAHRENEmbeddingStore));
+    if (!st) {
+        munmap(map, (size_t)sb.st_size);
+        return NULL;
+    }
+    st->rows = (size_t)h.rows;
+    st->dim = h.dim;
+    st->bits = (int)h.bits;
+    st->row_bytes = (size_t)h.row_bytes;
+    st->map = (const unsigned char*)map;
+    st->map_size = (size_t)sb.st_size;
+
+    size_t per_shard = cfg.cache_rows / FAHREN_EMB_SHARDS + (cfg.cache_rows % FAHREN_EMB_SHARDS != 0);
+    st->caching = per_shard > 0;
+    int ok = 1;
+    for (int i = 0; i < FAHREN_EMB_SHARDS; ++i) {
+        ok &= fahren_emb_shard_init(&st->shards[i], per_shard, st->dim, fahren_emb_mix((uint64_t)i + 1));
+    }
+    pthread_mutex_init(&st->queue_lock, NULL);
+    pthread_cond_init(&st->queue_cv, NULL);
+    if (ok && cfg.prefetch_thread) {
+        st->queue = (int64_t*)malloc(FAHREN_EMB_QUEUE * sizeof(int64_t));
+        ok = st->queue && pthread_create(&st->prefetch_thread, NULL, fahren_emb_prefetch_main, st) == 0;
+        st->prefetch_running = ok;
+    }
+    if (!ok) {
+        fahren_embedding_close(st);
+        return NULL;
+    }
+    return st;
+}
+
+void fahren_embedding_close(FAHRENEmbeddingStore* st) {
+    if (!st) return;
+    if (st->prefetch_running) {
+        pthread_mutex_lock(&st->queue_lock);
+        st->stopping = 1;
+        pthread_cond_signal(&st->queue_cv);
+        pthread_mutex_unlock(&st->queue_lock);
+        pthread_join(st->prefetch_thread, NULL);
+    }
+    for (int i = 0; i < FAHREN_EMB_SHARDS; ++i) fahren_emb_shard_free(&st->shards[i]);
+    pthread_mutex_destroy(&st->queue_lock);
+    pthread_cond_destroy(&st->queue_cv);
+    free(st->queue);
+    munmap((void*)st->map, st->map_size);
+    free(st);
+}
+
+size_t fahren_embedding_rows(const FAHRENEmbeddingStore* st) {
+    return st ? st->rows : 0;
+}
+
+size_t fahren_embedding_dim(const FAHRENEmbeddingStore* st) {
+    return st ? st->dim : 0;
+}
+
+FAHRENStatus fahren_embedding_lookup(FAHRENEmbeddingStore* st, const int64_t* ids,
+                                     size_t count, float* out) {
+    if (!st || (!ids && count) || (!out && count)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    for (size_t i = 0; i < count; ++i) {
+        if (ids[i] < 0 || (uint64_t)ids[i] >= st->rows) return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+
+    size_t dim = st->dim;
+    for (size_t i = 0; i < count; ++i) {
+        int64_t row = ids[i];
+        float* dst = out + i * dim;
+        const unsigned char* rec = fahren_emb_record(st, row);
+        if (!st->caching) {
+            fahren_emb_dequantize_row(rec, dim, st->bits, dst);
+            continue;
+        }
+        FahrenEmbShard* s = fahren_emb_shard_of(st, row);
+        pthread_mutex_lock(&s->lock);
+        fahren_emb_sketch_add(s, row);
+        long slot = fahren_emb_index_find(s, row);
+        if (slot >= 0) {
+            memcpy(dst, s->slot_data + (size_t)slot * dim, dim * sizeof(float));
+            s->hits++;
+            pthread_mutex_unlock(&s->lock);
+            continue;
+        }
+        s->misses++;
+        pthread_mutex_unlock(&s->lock);
+        /* dequantize unlocked, then publish unless another thread beat us */
+        fahren_emb_dequantize_row(rec, dim, st->bits, dst);
+        pthread_mutex_lock(&s->lock);
+        if (fahren_emb_index_find(s, row) < 0) (void)fahren_emb_promote(st, s, row, dst);
+        pthread_mutex_unlock(&s->lock);
+    }
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_embedding_prefetch(FAHRENEmbeddingStore* st, const int64_t* ids, size_t count) {
+    if (!st || (!ids && count)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (!st->prefetch_running) {
+        for (size_t i = 0; i < count; ++i) {
+            if (ids[i] >= 0 && (uint64_t)ids[i] < st->rows) fahren_emb_willneed(st, ids[i]);
+        }
+        return FAHREN_SUCCESS;
+    }
+    pthread_mutex_lock(&st->queue_lock);
+    for (size_t i = 0; i < count && st->queue_count < FAHREN_EMB_QUEUE; ++i) {
+        if (ids[i] < 0 || (uint64_t)ids[i] >= st->rows) continue;
+        st->queue[(st->queue_head + st->queue_count) % FAHREN_EMB_QUEUE] = ids[i];
+        st->queue_count++;
+    }
+    pthread_cond_signal(&st->queue_cv);
+    pthread_mutex_unlock(&st->queue_lock);
+    return FAHREN_SUCCESS;
+}
+
+void fahren_embedding_stats(FAHRENEmbeddingStore* st, FAHRENEmbeddingStats* out) {
+    if (!st || !out) return;
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < FAHREN_EMB_SHARDS; ++i) {
+        FahrenEmbShard* s = &st->shards[i];
+        pthread_mutex_lock(&s->lock);
+        out->hits += s->hits;
+        out->misses += s->misses;
+        out->promotions += s->promotions;
+        out->cached_rows += s->slot_count - s->free_count;
+        pthread_mutex_unlock(&s->lock);
+    }
+    out->prefetched = __atomic_load_n(&st->prefetched, __ATOMIC_RELAXED);
+}
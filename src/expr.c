@@ -0,0 +1,251 @@
+/* Fused elementwise expressions. See include/fahren/expr.h.
+ * Evaluation walks the data in tiles of FAHREN_EXPR_TILE floats: the tile
+ * is loaded once into a stack buffer, every recorded op runs over it as a
+ * tight SIMD loop while it sits in L1, and the result is stored once. Op
+ * dispatch is paid per tile, not per element, so a chain of ops reads and
+ * writes main memory no more than a single op does. Tiles are split
+ * across the thread pool in chunks of FAHREN_EXPR_GRAIN tiles. The
+ * activations use the runtime's formulas, so an expression computes the
+ * same values a layer would. */
+#include <math.h>
+#include <string.h>
+
+#include <fahren/expr.h>
+#include "fahren_internal.h"
+#include "fahren_simd.h"
+
+#define FAHREN_EXPR_TILE 512  /* floats; 2 KiB stays in L1 */
+#define FAHREN_EXPR_GRAIN 16  /* tiles per parallel chunk */
+
+/* ---- recording ---------------------------------------------------------- */
+
+void fahren_expr_init(FAHRENExpr* e) {
+    if (e) memset(e, 0, sizeof(*e));
+}
+
+static FAHRENExprOp* fahren_expr_last(FAHRENExpr* e, FAHRENExprOpKind kind) {
+    if (e->op_count == 0 || e->ops[e->op_count - 1].kind != kind) return NULL;
+    return &e->ops[e->op_count - 1];
+}
+
+static FAHRENStatus fahren_expr_push(FAHRENExpr* e, FAHRENExprOp op) {
+    if (e->op_count == FAHREN_EXPR_MAX_OPS) {
+        e->error = 1;
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    e->ops[e->op_count++] = op;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_expr_affine(FAHRENExpr* e, float scale, float shift) {
+    if (!e) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (e->error) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FAHRENExprOp* last = fahren_expr_last(e, FAHREN_EXPR_AFFINE);
+    if (last) {
+        /* (v * a + b) * scale + shift */
+        last->a *= scale;
+        last->b = last->b * scale + shift;
+        return FAHREN_SUCCESS;
+    }
+    FAHRENExprOp op = {FAHREN_EXPR_AFFINE, FAHREN_ACTIVATION_NONE, scale, shift, NULL};
+    return fahren_expr_push(e, op);
+}
+
+FAHRENStatus fahren_expr_scale(FAHRENExpr* e, float scale) {
+    return fahren_expr_affine(e, scale, 0.0f);
+}
+
+FAHRENStatus fahren_expr_shift(FAHRENExpr* e, float shift) {
+    return fahren_expr_affine(e, 1.0f, shift);
+}
+
+FAHRENStatus fahren_expr_clip(FAHRENExpr* e, float lo, float hi) {
+    if (!e) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (e->error || !(lo <= hi)) {
+        e->error = 1;
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    FAHRENExprOp* last = fahren_expr_last(e, FAHREN_EXPR_CLIP);
+    if (last) {
+        /* clip(clip(v, a, b), lo, hi) keeps [a, b] ∩ [lo, hi], or pins
+         * every value to the nearer end when they are disjoint */
+        float a = last->a > lo ? last->a : lo;
+        float b = last->b < hi ? last->b : hi;
+        if (a > b) a = b = last->b < lo ? lo : hi;
+        last->a = a;
+        last->b = b;
+        return FAHREN_SUCCESS;
+    }
+    FAHRENExprOp op = {FAHREN_EXPR_CLIP, FAHREN_ACTIVATION_NONE, lo, hi, NULL};
+    return fahren_expr_push(e, op);
+}
+
+FAHRENStatus fahren_expr_activation(FAHRENExpr* e, FAHRENActivation act) {
+    if (!e) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (e->error || (unsigned)act > FAHREN_ACTIVATION_TANH) {
+        e->error = 1;
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    if (act == FAHREN_ACTIVATION_NONE) return FAHREN_SUCCESS;
+    FAHRENExprOp* last = fahren_expr_last(e, FAHREN_EXPR_ACTIVATION);
+    if (last && last->act == FAHREN_ACTIVATION_RELU && act == FAHREN_ACTIVATION_RELU) return FAHREN_SUCCESS;
+    FAHRENExprOp op = {FAHREN_EXPR_ACTIVATION, act, 0.0f, 0.0f, NULL};
+    return fahren_expr_push(e, op);
+}
+
+FAHRENStatus fahren_expr_exp(FAHRENExpr* e) {
+    if (!e || e->error) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FAHRENExprOp op = {FAHREN_EXPR_EXP, FAHREN_ACTIVATION_NONE, 0.0f, 0.0f, NULL};
+    return fahren_expr_push(e, op);
+}
+
+static FAHRENStatus fahren_expr_binary(FAHRENExpr* e, FAHRENExprOpKind kind, const float* src) {
+    if (!e) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (e->error || !src) {
+        e->error = 1;
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    FAHRENExprOp op = {kind, FAHREN_ACTIVATION_NONE, 0.0f, 0.0f, src};
+    return fahren_expr_push(e, op);
+}
+
+FAHRENStatus fahren_expr_add(FAHRENExpr* e, const float* src) {
+    return fahren_expr_binary(e, FAHREN_EXPR_ADD, src);
+}
+
+FAHRENStatus fahren_expr_mul(FAHRENExpr* e, const float* src) {
+    return fahren_expr_binary(e, FAHREN_EXPR_MUL, src);
+}
+
+/* ---- tile kernels ------------------------------------------------------- */
+
+static void fahren_expr_affine_tile(float* t, size_t n, float a, float b) {
+    size_t i = 0;
+#if defined(FAHREN_HAVE_SSE2)
+    __m128 va = _mm_set1_ps(a), vb = _mm_set1_ps(b);
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(t + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(t + i), va), vb));
+#endif
+    for (; i < n; ++i) t[i] = t[i] * a + b;
+}
+
+static void fahren_expr_clip_tile(float* t, size_t n, float lo, float hi) {
+    size_t i = 0;
+#if defined(FAHREN_HAVE_SSE2)
+    __m128 vl = _mm_set1_ps(lo), vh = _mm_set1_ps(hi);
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(t + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(t + i), vl), vh));
+#endif
+    for (; i < n; ++i) {
+        float v = t[i] > lo ? t[i] : lo;
+        t[i] = v < hi ? v : hi;
+    }
+}
+
+/* v = exp(v * k) */
+static void fahren_expr_exp_tile(float* t, size_t n, float k) {
+    size_t i = 0;
+#if defined(FAHREN_HAVE_SSE2)
+    __m128 vk = _mm_set1_ps(k);
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(t + i, fahren_exp_ps(_mm_mul_ps(_mm_loadu_ps(t + i), vk)));
+#endif
+    for (; i < n; ++i) t[i] = fahren_expf_approx(t[i] * k);
+}
+
+/* v = s / (1 + v) + c, after an exp pass */
+static void fahren_expr_recip_tile(float* t, size_t n, float s, float c) {
+    size_t i = 0;
+#if defined(FAHREN_HAVE_SSE2)
+    __m128 vs = _mm_set1_ps(s), vc = _mm_set1_ps(c), one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(t + i, _mm_add_ps(_mm_div_ps(vs, _mm_add_ps(one, _mm_loadu_ps(t + i))), vc));
+    }
+#endif
+    for (; i < n; ++i) t[i] = s / (1.0f + t[i]) + c;
+}
+
+static void fahren_expr_activation_tile(float* t, size_t n, FAHRENActivation act) {
+    switch (act) {
+    case FAHREN_ACTIVATION_RELU:
+        fahren_expr_clip_tile(t, n, 0.0f, INFINITY);
+        break;
+    case FAHREN_ACTIVATION_SIGMOID: /* 1 / (1 + e^-v) */
+        fahren_expr_exp_tile(t, n, -1.0f);
+        fahren_expr_recip_tile(t, n, 1.0f, 0.0f);
+        break;
+    case FAHREN_ACTIVATION_TANH: /* 2 / (1 + e^-2v) - 1 */
+        fahren_expr_exp_tile(t, n, -2.0f);
+        fahren_expr_recip_tile(t, n, 2.0f, -1.0f);
+        break;
+    default:
+        break;
+    }
+}
+
+static void fahren_expr_binary_tile(float* t, const float* s, size_t n, int mul) {
+    size_t i = 0;
+#if defined(FAHREN_HAVE_SSE2)
+    if (mul) {
+        for (; i + 4 <= n; i += 4) _mm_storeu_ps(t + i, _mm_mul_ps(_mm_loadu_ps(t + i), _mm_loadu_ps(s + i)));
+    } else {
+        for (; i + 4 <= n; i += 4) _mm_storeu_ps(t + i, _mm_add_ps(_mm_loadu_ps(t + i), _mm_loadu_ps(s + i)));
+    }
+#endif
+    if (mul) {
+        for (; i < n; ++i) t[i] *= s[i];
+    } else {
+        for (; i < n; ++i) t[i] += s[i];
+    }
+}
+
+/* ---- evaluation --------------------------------------------------------- */
+
+typedef struct FahrenExprJob {
+    const FAHRENExpr* e;
+    const float* x;
+    float* y;
+    size_t n;
+} FahrenExprJob;
+
+static void fahren_expr_tiles(void* ctx, size_t begin, size_t end) {
+    const FahrenExprJob* job = (const FahrenExprJob*)ctx;
+    float t[FAHREN_EXPR_TILE];
+    for (size_t tile = begin; tile < end; ++tile) {
+        size_t i0 = tile * FAHREN_EXPR_TILE;
+        size_t n = job->n - i0 < FAHREN_EXPR_TILE ? job->n - i0 : FAHREN_EXPR_TILE;
+        memcpy(t, job->x + i0, n * sizeof(float));
+        for (size_t k = 0; k < job->e->op_count; ++k) {
+            const FAHRENExprOp* op = &job->e->ops[k];
+            switch (op->kind) {
+            case FAHREN_EXPR_AFFINE:
+                fahren_expr_affine_tile(t, n, op->a, op->b);
+                break;
+            case FAHREN_EXPR_CLIP:
+                fahren_expr_clip_tile(t, n, op->a, op->b);
+                break;
+            case FAHREN_EXPR_ACTIVATION:
+                fahren_expr_activation_tile(t, n, op->act);
+                break;
+            case FAHREN_EXPR_EXP:
+                fahren_expr_exp_tile(t, n, 1.0f);
+                break;
+            case FAHREN_EXPR_ADD:
+            case FAHREN_EXPR_MUL:
+                fahren_expr_binary_tile(t, op->src + i0, n, op->kind == FAHREN_EXPR_MUL);
+                break;
+            }
+        }
+        memcpy(job->y + i0, t, n * sizeof(float));
+    }
+}
+
+FAHRENStatus fahren_expr_eval(const FAHRENExpr* e, const float* x, float* y, size_t n) {
+    if (!e || e->error || (n && (!x || !y))) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (n == 0) return FAHREN_SUCCESS;
+    if (e->op_count == 0) {
+        if (y != x) memmove(y, x, n * sizeof(float));
+        return FAHREN_SUCCESS;
+    }
+    FahrenExprJob job = {e, x, y, n};
+    size_t tiles = (n + FAHREN_EXPR_TILE - 1) / FAHREN_EXPR_TILE;
+    fahren_parallel_for(tiles, FAHREN_EXPR_GRAIN, fahren_expr_tiles, &job);
+    return FAHREN_SUCCESS;
+}
@@ -0,0 +1,97 @@
+/* Internal helpers shared between the FAHREN implementation files.
+ * Nothing in here is part of the public API; keep declarations small and
+ * keep the implementations next to the code that owns them. */
+#ifndef FAHREN_INTERNAL_H
+#define FAHREN_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <fahren/executor.h>
+#include <fahren/fahren.h>
+#include <fahren/format.h>
+
+/* Run `fn` over [0, n) on the installed executor, or the built-in thread
+ * pool when there is none, handing out chunks of at least `grain`
+ * indices. The call returns once every chunk is done. Calls made from
+ * inside a loop body run inline, so nested loops cannot deadlock. */
+void fahren_parallel_for(size_t n, size_t grain, fahren_range_fn fn, void* ctx);
+
+/* Number of threads (including the caller) fahren_parallel_for may use. */
+size_t fahren_thread_count(void);
+
+/* Non-zero while a host executor is installed (see fahren_init_ex). */
+int fahren_executor_installed(void);
+
+/* NUMA support (src/numa.c). Node-local allocations come from mmap and
+ * must be released with fahren_numa_free. fahren_numa_parallel runs
+ * fn(ctx, node, begin, end) over [0, n[node]) for every node, using only
+ * threads pinned to that node, and returns when all nodes are done. */
+#define FAHREN_NUMA_MAX_NODES 8
+typedef void (*fahren_node_fn)(void* ctx, size_t node, size_t begin, size_t end);
+size_t fahren_numa_node_count(void);
+void* fahren_numa_alloc(size_t bytes, size_t node);
+void fahren_numa_free(void* mem, size_t bytes);
+void fahren_numa_parallel(const size_t* n, size_t grain, fahren_node_fn fn, void* ctx);
+
+/* Row-major SGEMM: C = alpha * op(A) * op(B) + beta * C with op(A) M x K
+ * and op(B) K x N; a non-zero trans flag means the operand is stored
+ * transposed. Parallel over row blocks of C. Returns 0 if scratch
+ * allocation failed. */
+int fahren_sgemm(int trans_a, int trans_b, size_t M, size_t N, size_t K,
+                 float alpha, const float* A, size_t lda, const float* B, size_t ldb,
+                 float beta, float* C, size_t ldc);
+
+/* Files written in place (src/format.c): fahren_out_open creates a new
+ * `path`.tmp.<pid>.<n>, unique to this writer, preallocates `bytes` and
+ * maps it shared for writing; fahren_out_commit unmaps it, syncs it and
+ * renames it over `path`, and fahren_out_abort removes it. Both release
+ * the temporary either way. Return 0 on failure. */
+typedef struct FahrenOutFile {
+    int fd;
+    void* map;
+    size_t bytes;
+    char* tmp;
+} FahrenOutFile;
+int fahren_out_open(FahrenOutFile* out, const char* path, size_t bytes);
+int fahren_out_commit(FahrenOutFile* out, const char* path);
+void fahren_out_abort(FahrenOutFile* out);
+
+/* Number of weights and biases `layer` stores in a model blob (see
+ * src/posix.c). Returns 0 on overflow or an invalid layer. */
+int fahren_layer_param_counts(const FAHRENLayer* layer, size_t* weights, size_t* biases);
+
+/* Geometry shared by im2col/col2im: a channels x height x width image and
+ * the out_h x out_w grid of kernel positions sliding over it. */
+typedef struct FahrenConvGeom {
+    size_t channels, height, width;
+    size_t kernel_h, kernel_w;
+    size_t stride_h, stride_w;
+    size_t pad_h, pad_w;
+    size_t dilation_h, dilation_w;
+    size_t out_h, out_w;
+} FahrenConvGeom;
+
+/* cols[(c * kernel_h + ky) * kernel_w + kx][oy * out_w + ox] = image pixel
+ * under that kernel tap, or 0 in the padding. */
+void fahren_im2col(const FahrenConvGeom* g, const float* img, float* cols);
+
+/* Adjoint of im2col: adds every column entry back onto its image pixel.
+ * `img` is accumulated into, not overwritten. */
+void fahren_col2im(const FahrenConvGeom* g, const float* cols, float* img);
+
+/* FFT convolution (src/conv_fft.c): images are channels x height x
+ * width, weights cout x channels x kernel_h x kernel_w, any stride.
+ * fahren_conv_fft_cost estimates its work in the same units as the
+ * 2 * MACs of a direct convolution, or returns 0 when the kernel spectra
+ * would be too large to consider. */
+double fahren_conv_fft_cost(const FahrenConvGeom* g, size_t cout);
+FAHRENStatus fahren_conv_fft_forward(const FahrenConvGeom* g, size_t cout, size_t batch, const float* x,
+                                     const float* weights, const float* bias, float* y);
+
+/* Winograd F(2x2, 3x3) (src/conv_winograd.c) for 3x3, stride-1,
+ * undilated kernels; same layouts as fahren_conv_fft_forward. */
+FAHRENStatus fahren_conv_winograd_forward(const FahrenConvGeom* g, size_t cout, size_t batch, const float* x,
+                                          const float* weights, const float* bias, float* y);
+
+#endif /* FAHREN_INTERNAL_H */
@@ -0,0 +1,157 @@
+/* Small SIMD helpers shared by the vector kernels.
+ * SSE2 is part of the x86-64 baseline, so the vector paths are always on
+ * there; other targets fall back to plain loops with identical math. */
+#ifndef FAHREN_SIMD_H
+#define FAHREN_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define FAHREN_HAVE_SSE2 1
+#endif
+
+/* Cephes-style exp: range reduction by ln2 and a degree-6 polynomial.
+ * Relative error is below 2e-7 over the clamped range, which is plenty for
+ * softmax and activations. The scalar and vector versions run the same
+ * steps, so tail elements agree with their vectorized neighbours. */
+#define FAHREN_EXP_HI 88.0f
+#define FAHREN_EXP_LO -87.3365478515625f
+
+static inline float fahren_expf_approx(float x) {
+    if (x > FAHREN_EXP_HI) x = FAHREN_EXP_HI;
+    if (x < FAHREN_EXP_LO) x = FAHREN_EXP_LO;
+    float fx = x * 1.44269504088896341f + 0.5f;
+    int32_t n = (int32_t)fx;
+    if ((float)n > fx) n -= 1; /* floor */
+    float r = x - (float)n * 0.693359375f + (float)n * 2.12194440e-4f;
+    float y = 1.9875691500e-4f;
+    y = y * r + 1.3981999507e-3f;
+    y = y * r + 8.3334519073e-3f;
+    y = y * r + 4.1665795894e-2f;
+    y = y * r + 1.6666665459e-1f;
+    y = y * r + 5.0000001201e-1f;
+    y = y * r * r + r + 1.0f;
+    uint32_t bits = (uint32_t)(n + 127) << 23;
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return y * scale;
+}
+
+#if defined(FAHREN_HAVE_SSE2)
+static inline __m128 fahren_exp_ps(__m128 x) {
+    x = _mm_min_ps(x, _mm_set1_ps(FAHREN_EXP_HI));
+    x = _mm_max_ps(x, _mm_set1_ps(FAHREN_EXP_LO));
+    __m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+    __m128i n = _mm_cvttps_epi32(fx);
+    __m128 nf = _mm_cvtepi32_ps(n);
+    /* truncation rounds toward zero; step down where that overshot */
+    __m128 over = _mm_cmpgt_ps(nf, fx);
+    n = _mm_add_epi32(n, _mm_castps_si128(over)); /* mask is -1 */
+    nf = _mm_cvtepi32_ps(n);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(nf, _mm_set1_ps(0.693359375f)));
+    r = _mm_add_ps(r, _mm_mul_ps(nf, _mm_set1_ps(2.12194440e-4f)));
+    __m128 y = _mm_set1_ps(1.9875691500e-4f);
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(1.3981999507e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(8.3334519073e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(4.1665795894e-2f));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(1.6666665459e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(5.0000001201e-1f));
+    y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, r), r), r), _mm_set1_ps(1.0f));
+    __m128i e = _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(y, _mm_castsi128_ps(e));
+}
+
+static inline float fahren_hmax_ps(__m128 v) {
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+static inline float fahren_hsum_ps(__m128 v) {
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+#endif
+
+/* Largest element of x[0..n). n must be > 0. */
+static inline float fahren_max_f32(const float* x, size_t n) {
+    size_t i = 0;
+    float m = x[0];
+#if defined(FAHREN_HAVE_SSE2)
+    if (n >= 8) {
+        __m128 m0 = _mm_loadu_ps(x), m1 = _mm_loadu_ps(x + 4);
+        for (i = 8; i + 8 <= n; i += 8) {
+            m0 = _mm_max_ps(m0, _mm_loadu_ps(x + i));
+            m1 = _mm_max_ps(m1, _mm_loadu_ps(x + i + 4));
+        }
+        m = fahren_hmax_ps(_mm_max_ps(m0, m1));
+    }
+#endif
+    for (; i < n; ++i) m = x[i] > m ? x[i] : m;
+    return m;
+}
+
+/* Index of the first largest element of x[0..n). n must be > 0. */
+static inline size_t fahren_argmax_f32(const float* x, size_t n) {
+    float m = fahren_max_f32(x, n);
+    for (size_t i = 0; i < n; ++i) {
+        if (x[i] == m) return i;
+    }
+    return 0;
+}
+
+/* out[i] = exp((x[i] - shift) * scale); returns the sum of out. `out` may
+ * alias `x`. This is the fused temperature + softmax-numerator pass. */
+static inline float fahren_exp_scaled_f32(const float* x, float* out, size_t n, float shift, float scale) {
+    size_t i = 0;
+    float sum = 0.0f;
+#if defined(FAHREN_HAVE_SSE2)
+    __m128 vs = _mm_set1_ps(shift), vk = _mm_set1_ps(scale);
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 e = fahren_exp_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(x + i), vs), vk));
+        _mm_storeu_ps(out + i, e);
+        acc = _mm_add_ps(acc, e);
+    }
+    sum = fahren_hsum_ps(acc);
+#endif
+    for (; i < n; ++i) {
+        out[i] = fahren_expf_approx((x[i] - shift) * scale);
+        sum += out[i];
+    }
+    return sum;
+}
+
+/* Dot product of x[0..n) and y[0..n). */
+static inline float fahren_dot_f32(const float* x, const float* y, size_t n) {
+    size_t i = 0;
+    float sum = 0.0f;
+#if defined(FAHREN_HAVE_SSE2)
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(y + i + 4)));
+    }
+    sum = fahren_hsum_ps(_mm_add_ps(a0, a1));
+#endif
+    for (; i < n; ++i) sum += x[i] * y[i];
+    return sum;
+}
+
+/* y[i] += a * x[i] */
+static inline void fahren_axpy_f32(float a, const float* x, float* y, size_t n) {
+    size_t i = 0;
+#if defined(FAHREN_HAVE_SSE2)
+    __m128 va = _mm_set1_ps(a);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(va, _mm_loadu_ps(x + i))));
+    }
+#endif
+    for (; i < n; ++i) y[i] += a * x[i];
+}
+
+#endif /* FAHREN_SIMD_H */
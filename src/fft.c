@@ -0,0 +1,361 @@
+/* Mixed-radix FFT. See include/fahren/fft.h.
+ * Stockham autosort formulation: every pass reads one buffer and writes
+ * the other in natural order, so there is no bit-reversal step. Pass i
+ * with radix r and stride s (the product of the earlier radices) combines
+ * x[q + s * (p + j * m)] for j < r into y[q + s * (r * p + j)]. Once s is a
+ * multiple of 4 the q loop is vectorized; the first pass (s = 1) of a
+ * radix-4 or radix-2 plan is vectorized over p instead and transposes its
+ * results into place. Radix-4 passes come first so that holds for every
+ * length fahren_fft_good_size returns. */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fahren/fft.h>
+#include "fahren_simd.h"
+
+#define FAHREN_FFT_MAX_STAGES 64
+
+#define FAHREN_FFT_S3 0.86602540378443864676f  /* sin(2 pi / 3) */
+#define FAHREN_FFT_C51 0.30901699437494742410f /* cos(2 pi / 5) */
+#define FAHREN_FFT_C52 -0.80901699437494742410f
+#define FAHREN_FFT_S51 0.95105651629515357212f
+#define FAHREN_FFT_S52 0.58778525229247312917f
+
+typedef struct FahrenFFTStage {
+    size_t radix;
+    size_t stride;     /* s */
+    size_t m;          /* remaining length / radix */
+    const float* twr;  /* (radix - 1) x m twiddles exp(-2 pi i j p / (radix m)) */
+    const float* twi;
+} FahrenFFTStage;
+
+struct FAHRENFFTPlan {
+    size_t n;
+    size_t stages;
+    FahrenFFTStage stage[FAHREN_FFT_MAX_STAGES];
+    float* twiddles;
+};
+
+/* ---- butterflies ------------------------------------------------------ */
+
+/* In-place length-r DFT of a[0..r) with exp(-2 pi i / r) as the root. */
+static inline void fahren_fft_bf(size_t r, float* ar, float* ai) {
+    switch (r) {
+    case 2: {
+        float tr = ar[0] - ar[1], ti = ai[0] - ai[1];
+        ar[0] += ar[1];
+        ai[0] += ai[1];
+        ar[1] = tr;
+        ai[1] = ti;
+        break;
+    }
+    case 3: {
+        float tr = ar[1] + ar[2], ti = ai[1] + ai[2];
+        float dr = FAHREN_FFT_S3 * (ar[1] - ar[2]), di = FAHREN_FFT_S3 * (ai[1] - ai[2]);
+        float mr = ar[0] - 0.5f * tr, mi = ai[0] - 0.5f * ti;
+        ar[0] += tr;
+        ai[0] += ti;
+        ar[1] = mr + di;
+        ai[1] = mi - dr;
+        ar[2] = mr - di;
+        ai[2] = mi + dr;
+        break;
+    }
+    case 4: {
+        float t0r = ar[0] + ar[2], t0i = ai[0] + ai[2];
+        float t1r = ar[0] - ar[2], t1i = ai[0] - ai[2];
+        float t2r = ar[1] + ar[3], t2i = ai[1] + ai[3];
+        float t3r = ar[1] - ar[3], t3i = ai[1] - ai[3];
+        ar[0] = t0r + t2r;
+        ai[0] = t0i + t2i;
+        ar[2] = t0r - t2r;
+        ai[2] = t0i - t2i;
+        ar[1] = t1r + t3i;
+        ai[1] = t1i - t3r;
+        ar[3] = t1r - t3i;
+        ai[3] = t1i + t3r;
+        break;
+    }
+    case 5: {
+        float t1r = ar[1] + ar[4], t1i = ai[1] + ai[4];
+        float t2r = ar[2] + ar[3], t2i = ai[2] + ai[3];
+        float t3r = ar[1] - ar[4], t3i = ai[1] - ai[4];
+        float t4r = ar[2] - ar[3], t4i = ai[2] - ai[3];
+        float b1r = ar[0] + FAHREN_FFT_C51 * t1r + FAHREN_FFT_C52 * t2r;
+        float b1i = ai[0] + FAHREN_FFT_C51 * t1i + FAHREN_FFT_C52 * t2i;
+        float b2r = ar[0] + FAHREN_FFT_C52 * t1r + FAHREN_FFT_C51 * t2r;
+        float b2i = ai[0] + FAHREN_FFT_C52 * t1i + FAHREN_FFT_C51 * t2i;
+        float e1r = FAHREN_FFT_S51 * t3r + FAHREN_FFT_S52 * t4r;
+        float e1i = FAHREN_FFT_S51 * t3i + FAHREN_FFT_S52 * t4i;
+        float e2r = FAHREN_FFT_S52 * t3r - FAHREN_FFT_S51 * t4r;
+        float e2i = FAHREN_FFT_S52 * t3i - FAHREN_FFT_S51 * t4i;
+        ar[0] += t1r + t2r;
+        ai[0] += t1i + t2i;
+        ar[1] = b1r + e1i;
+        ai[1] = b1i - e1r;
+        ar[4] = b1r - e1i;
+        ai[4] = b1i + e1r;
+        ar[2] = b2r + e2i;
+        ai[2] = b2i - e2r;
+        ar[3] = b2r - e2i;
+        ai[3] = b2i + e2r;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+#if defined(FAHREN_HAVE_SSE2)
+/* Four independent butterflies, same steps as fahren_fft_bf. */
+static inline void fahren_fft_bf_ps(size_t r, __m128* ar, __m128* ai) {
+    switch (r) {
+    case 2: {
+        __m128 tr = _mm_sub_ps(ar[0], ar[1]), ti = _mm_sub_ps(ai[0], ai[1]);
+        ar[0] = _mm_add_ps(ar[0], ar[1]);
+        ai[0] = _mm_add_ps(ai[0], ai[1]);
+        ar[1] = tr;
+        ai[1] = ti;
+        break;
+    }
+    case 3: {
+        __m128 s3 = _mm_set1_ps(FAHREN_FFT_S3), half = _mm_set1_ps(0.5f);
+        __m128 tr = _mm_add_ps(ar[1], ar[2]), ti = _mm_add_ps(ai[1], ai[2]);
+        __m128 dr = _mm_mul_ps(s3, _mm_sub_ps(ar[1], ar[2]));
+        __m128 di = _mm_mul_ps(s3, _mm_sub_ps(ai[1], ai[2]));
+        __m128 mr = _mm_sub_ps(ar[0], _mm_mul_ps(half, tr));
+        __m128 mi = _mm_sub_ps(ai[0], _mm_mul_ps(half, ti));
+        ar[0] = _mm_add_ps(ar[0], tr);
+        ai[0] = _mm_add_ps(ai[0], ti);
+        ar[1] = _mm_add_ps(mr, di);
+        ai[1] = _mm_sub_ps(mi, dr);
+        ar[2] = _mm_sub_ps(mr, di);
+        ai[2] = _mm_add_ps(mi, dr);
+        break;
+    }
+    case 4: {
+        __m128 t0r = _mm_add_ps(ar[0], ar[2]), t0i = _mm_add_ps(ai[0], ai[2]);
+        __m128 t1r = _mm_sub_ps(ar[0], ar[2]), t1i = _mm_sub_ps(ai[0], ai[2]);
+        __m128 t2r = _mm_add_ps(ar[1], ar[3]), t2i = _mm_add_ps(ai[1], ai[3]);
+        __m128 t3r = _mm_sub_ps(ar[1], ar[3]), t3i = _mm_sub_ps(ai[1], ai[3]);
+        ar[0] = _mm_add_ps(t0r, t2r);
+        ai[0] = _mm_add_ps(t0i, t2i);
+        ar[2] = _mm_sub_ps(t0r, t2r);
+        ai[2] = _mm_sub_ps(t0i, t2i);
+        ar[1] = _mm_add_ps(t1r, t3i);
+        ai[1] = _mm_sub_ps(t1i, t3r);
+        ar[3] = _mm_sub_ps(t1r, t3i);
+        ai[3] = _mm_add_ps(t1i, t3r);
+        break;
+    }
+    case 5: {
+        __m128 c1 = _mm_set1_ps(FAHREN_FFT_C51), c2 = _mm_set1_ps(FAHREN_FFT_C52);
+        __m128 s1 = _mm_set1_ps(FAHREN_FFT_S51), s2 = _mm_set1_ps(FAHREN_FFT_S52);
+        __m128 t1r = _mm_add_ps(ar[1], ar[4]), t1i = _mm_add_ps(ai[1], ai[4]);
+        __m128 t2r = _mm_add_ps(ar[2], ar[3]), t2i = _mm_add_ps(ai[2], ai[3]);
+        __m128 t3r = _mm_sub_ps(ar[1], ar[4]), t3i = _mm_sub_ps(ai[1], ai[4]);
+        __m128 t4r = _mm_sub_ps(ar[2], ar[3]), t4i = _mm_sub_ps(ai[2], ai[3]);
+        __m128 b1r = _mm_add_ps(ar[0], _mm_add_ps(_mm_mul_ps(c1, t1r), _mm_mul_ps(c2, t2r)));
+        __m128 b1i = _mm_add_ps(ai[0], _mm_add_ps(_mm_mul_ps(c1, t1i), _mm_mul_ps(c2, t2i)));
+        __m128 b2r = _mm_add_ps(ar[0], _mm_add_ps(_mm_mul_ps(c2, t1r), _mm_mul_ps(c1, t2r)));
+        __m128 b2i = _mm_add_ps(ai[0], _mm_add_ps(_mm_mul_ps(c2, t1i), _mm_mul_ps(c1, t2i)));
+        __m128 e1r = _mm_add_ps(_mm_mul_ps(s1, t3r), _mm_mul_ps(s2, t4r));
+        __m128 e1i = _mm_add_ps(_mm_mul_ps(s1, t3i), _mm_mul_ps(s2, t4i));
+        __m128 e2r = _mm_sub_ps(_mm_mul_ps(s2, t3r), _mm_mul_ps(s1, t4r));
+        __m128 e2i = _mm_sub_ps(_mm_mul_ps(s2, t3i), _mm_mul_ps(s1, t4i));
+        ar[0] = _mm_add_ps(ar[0], _mm_add_ps(t1r, t2r));
+        ai[0] = _mm_add_ps(ai[0], _mm_add_ps(t1i, t2i));
+        ar[1] = _mm_add_ps(b1r, e1i);
+        ai[1] = _mm_sub_ps(b1i, e1r);
+        ar[4] = _mm_sub_ps(b1r, e1i);
+        ai[4] = _mm_add_ps(b1i, e1r);
+        ar[2] = _mm_add_ps(b2r, e2i);
+        ai[2] = _mm_sub_ps(b2i, e2r);
+        ar[3] = _mm_sub_ps(b2r, e2i);
+        ai[3] = _mm_add_ps(b2i, e2r);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static inline void fahren_fft_twiddle_ps(__m128* br, __m128* bi, __m128 wr, __m128 wi) {
+    __m128 r = _mm_sub_ps(_mm_mul_ps(*br, wr), _mm_mul_ps(*bi, wi));
+    *bi = _mm_add_ps(_mm_mul_ps(*br, wi), _mm_mul_ps(*bi, wr));
+    *br = r;
+}
+#endif
+
+/* ---- passes ----------------------------------------------------------- */
+
+static void fahren_fft_pass(const FahrenFFTStage* st, const float* xr, const float* xi,
+                            float* yr, float* yi) {
+    size_t r = st->radix, s = st->stride, m = st->m;
+#if defined(FAHREN_HAVE_SSE2)
+    if (s % 4 == 0) {
+        for (size_t p = 0; p < m; ++p) {
+            __m128 wr[5], wi[5];
+            for (size_t j = 1; j < r; ++j) {
+                wr[j] = _mm_set1_ps(st->twr[(j - 1) * m + p]);
+                wi[j] = _mm_set1_ps(st->twi[(j - 1) * m + p]);
+            }
+            for (size_t q = 0; q < s; q += 4) {
+                __m128 ar[5], ai[5];
+                for (size_t j = 0; j < r; ++j) {
+                    ar[j] = _mm_loadu_ps(xr + q + s * (p + j * m));
+                    ai[j] = _mm_loadu_ps(xi + q + s * (p + j * m));
+                }
+                fahren_fft_bf_ps(r, ar, ai);
+                for (size_t j = 1; j < r; ++j) fahren_fft_twiddle_ps(&ar[j], &ai[j], wr[j], wi[j]);
+                for (size_t j = 0; j < r; ++j) {
+                    _mm_storeu_ps(yr + q + s * (r * p + j), ar[j]);
+                    _mm_storeu_ps(yi + q + s * (r * p + j), ai[j]);
+                }
+            }
+        }
+        return;
+    }
+    if (s == 1 && (r == 4 || r == 2) && m % 4 == 0) {
+        for (size_t p = 0; p < m; p += 4) {
+            __m128 ar[4], ai[4];
+            for (size_t j = 0; j < r; ++j) {
+                ar[j] = _mm_loadu_ps(xr + p + j * m);
+                ai[j] = _mm_loadu_ps(xi + p + j * m);
+            }
+            fahren_fft_bf_ps(r, ar, ai);
+            for (size_t j = 1; j < r; ++j) {
+                fahren_fft_twiddle_ps(&ar[j], &ai[j], _mm_loadu_ps(st->twr + (j - 1) * m + p),
+                                      _mm_loadu_ps(st->twi + (j - 1) * m + p));
+            }
+            if (r == 4) {
+                _MM_TRANSPOSE4_PS(ar[0], ar[1], ar[2], ar[3]);
+                _MM_TRANSPOSE4_PS(ai[0], ai[1], ai[2], ai[3]);
+                for (size_t j = 0; j < 4; ++j) {
+                    _mm_storeu_ps(yr + 4 * p + 4 * j, ar[j]);
+                    _mm_storeu_ps(yi + 4 * p + 4 * j, ai[j]);
+                }
+            } else {
+                _mm_storeu_ps(yr + 2 * p, _mm_unpacklo_ps(ar[0], ar[1]));
+                _mm_storeu_ps(yr + 2 * p + 4, _mm_unpackhi_ps(ar[0], ar[1]));
+                _mm_storeu_ps(yi + 2 * p, _mm_unpacklo_ps(ai[0], ai[1]));
+                _mm_storeu_ps(yi + 2 * p + 4, _mm_unpackhi_ps(ai[0], ai[1]));
+            }
+        }
+        return;
+    }
+#endif
+    for (size_t p = 0; p < m; ++p) {
+        for (size_t q = 0; q < s; ++q) {
+            float ar[5], ai[5];
+            for (size_t j = 0; j < r; ++j) {
+                ar[j] = xr[q + s * (p + j * m)];
+                ai[j] = xi[q + s * (p + j * m)];
+            }
+            fahren_fft_bf(r, ar, ai);
+            for (size_t j = 0; j < r; ++j) {
+                float br = ar[j], bi = ai[j];
+                if (j > 0) {
+                    float wr = st->twr[(j - 1) * m + p], wi = st->twi[(j - 1) * m + p];
+                    br = ar[j] * wr - ai[j] * wi;
+                    bi = ar[j] * wi + ai[j] * wr;
+                }
+                yr[q + s * (r * p + j)] = br;
+                yi[q + s * (r * p + j)] = bi;
+            }
+        }
+    }
+}
+
+/* ---- plans ------------------------------------------------------------ */
+
+static int fahren_fft_smooth(size_t n) {
+    static const size_t primes[3] = {2, 3, 5};
+    if (n == 0) return 0;
+    for (size_t i = 0; i < 3; ++i) {
+        while (n % primes[i] == 0) n /= primes[i];
+    }
+    return n == 1;
+}
+
+size_t fahren_fft_good_size(size_t n) {
+    if (n <= 1) return 1;
+    if (n <= 3) return n;
+    size_t m = (n + 3) & ~(size_t)3;
+    while (!fahren_fft_smooth(m)) m += 4;
+    return m;
+}
+
+FAHRENFFTPlan* fahren_fft_plan_create(size_t n) {
+    if (!fahren_fft_smooth(n)) return NULL;
+    FAHRENFFTPlan* plan = (FAHRENFFTPlan*)calloc(1, sizeof(FAHRENFFTPlan));
+    if (!plan) return NULL;
+    plan->n = n;
+
+    size_t rest = n, stride = 1, tw_count = 0;
+    while (rest > 1) {
+        size_t r = rest % 4 == 0 ? 4 : rest % 2 == 0 ? 2 : rest % 3 == 0 ? 3 : 5;
+        FahrenFFTStage* st = &plan->stage[plan->stages++];
+        st->radix = r;
+        st->stride = stride;
+        st->m = rest / r;
+        tw_count += (r - 1) * st->m;
+        stride *= r;
+        rest /= r;
+    }
+    plan->twiddles = (float*)malloc((2 * tw_count + 1) * sizeof(float));
+    if (!plan->twiddles) {
+        free(plan);
+        return NULL;
+    }
+    float* tw = plan->twiddles;
+    for (size_t i = 0; i < plan->stages; ++i) {
+        FahrenFFTStage* st = &plan->stage[i];
+        size_t count = (st->radix - 1) * st->m;
+        double step = -2.0 * M_PI / (double)(st->radix * st->m);
+        st->twr = tw;
+        st->twi = tw + count;
+        for (size_t j = 1; j < st->radix; ++j) {
+            for (size_t p = 0; p < st->m; ++p) {
+                double a = step * (double)(j * p);
+                tw[(j - 1) * st->m + p] = (float)cos(a);
+                tw[count + (j - 1) * st->m + p] = (float)sin(a);
+            }
+        }
+        tw += 2 * count;
+    }
+    return plan;
+}
+
+void fahren_fft_plan_destroy(FAHRENFFTPlan* plan) {
+    if (!plan) return;
+    free(plan->twiddles);
+    free(plan);
+}
+
+size_t fahren_fft_plan_length(const FAHRENFFTPlan* plan) {
+    return plan ? plan->n : 0;
+}
+
+FAHRENStatus fahren_fft_execute(const FAHRENFFTPlan* plan, float* re, float* im, float* work, int inverse) {
+    if (!plan || !re || !im || (!work && plan->stages)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    /* inverse(x) = swap(forward(swap(x))), swapping real and imaginary parts */
+    if (inverse) {
+        float* t = re;
+        re = im;
+        im = t;
+    }
+    float* br[2] = {re, work};
+    float* bi[2] = {im, work + plan->n};
+    int cur = 0;
+    for (size_t i = 0; i < plan->stages; ++i) {
+        fahren_fft_pass(&plan->stage[i], br[cur], bi[cur], br[1 - cur], bi[1 - cur]);
+        cur = 1 - cur;
+    }
+    if (cur) {
+        memcpy(re, br[1], plan->n * sizeof(float));
+        memcpy(im, bi[1], plan->n * sizeof(float));
+    }
+    return FAHREN_SUCCESS;
+}
@@ -0,0 +1,589 @@
+/* Model blob files. See include/fahren/format.h.
+ * Everything here works on mappings: reading maps the file read-only and
+ * hands out pointers into it, writing preallocates the output under a
+ * temporary name and fills the shared mapping in place. Checksums, value
+ * statistics and conversion split the payload across the thread pool in
+ * fixed-size pieces whose partial results are combined in piece order, so
+ * the output never depends on the thread count. */
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <fahren/format.h>
+#include "fahren_internal.h"
+
+#define FAHREN_CHECKSUM_BLOCK ((size_t)1 << 20) /* bytes per hashed block */
+#define FAHREN_FORMAT_CHUNK ((size_t)1 << 16)   /* values per stats/convert chunk */
+
+/* ---- output files ------------------------------------------------------- */
+
+/* Writers in one process told apart; the pid tells processes apart. */
+static unsigned fahren_out_counter;
+
+int fahren_out_open(FahrenOutFile* out, const char* path, size_t bytes) {
+    memset(out, 0, sizeof(*out));
+    out->fd = -1;
+    if ((uint64_t)bytes > (uint64_t)INT64_MAX || bytes == 0) return 0;
+    /* Temporary next to the target, so the rename stays on one file
+     * system; O_EXCL makes sure no other writer shares it */
+    size_t path_len = strlen(path);
+    out->tmp = (char*)malloc(path_len + 48);
+    if (!out->tmp) return 0;
+    for (int attempt = 0; attempt < 16 && out->fd < 0; ++attempt) {
+        unsigned n = __atomic_fetch_add(&fahren_out_counter, 1, __ATOMIC_RELAXED);
+        snprintf(out->tmp, path_len + 48, "%s.tmp.%ld.%u", path, (long)getpid(), n);
+        out->fd = open(out->tmp, O_RDWR | O_CREAT | O_EXCL, 0666);
+        if (out->fd < 0 && errno != EEXIST) break; /* EEXIST: left by a dead process with our pid */
+    }
+    if (out->fd < 0) {
+        free(out->tmp);
+        out->tmp = NULL;
+        return 0;
+    }
+    int err = posix_fallocate(out->fd, 0, (off_t)bytes);
+    if (err == EINVAL || err == EOPNOTSUPP) err = ftruncate(out->fd, (off_t)bytes) == 0 ? 0 : errno;
+    void* map = err ? MAP_FAILED : mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, out->fd, 0);
+    if (map == MAP_FAILED) {
+        fahren_out_abort(out);
+        return 0;
+    }
+    out->map = map;
+    out->bytes = bytes;
+    return 1;
+}
+
+void fahren_out_abort(FahrenOutFile* out) {
+    if (out->map) munmap(out->map, out->bytes);
+    if (out->fd >= 0) close(out->fd);
+    if (out->tmp) (void)unlink(out->tmp);
+    free(out->tmp);
+    memset(out, 0, sizeof(*out));
+    out->fd = -1;
+}
+
+int fahren_out_commit(FahrenOutFile* out, const char* path) {
+    int ok = munmap(out->map, out->bytes) == 0;
+    out->map = NULL;
+    /* the data must be on disk before the name is, or a crash could leave
+     * the new name on a partly written file */
+    ok = ok && fsync(out->fd) == 0;
+    ok = close(out->fd) == 0 && ok;
+    out->fd = -1;
+    ok = ok && rename(out->tmp, path) == 0;
+    if (!ok) (void)unlink(out->tmp);
+    free(out->tmp);
+    out->tmp = NULL;
+    return ok;
+}
+
+/* ---- reading ------------------------------------------------------------ */
+
+/* a + b * c into *out, or 0 on overflow */
+static int fahren_size_madd(uint64_t a, uint64_t b, uint64_t c, uint64_t* out) {
+    if (c && b > (UINT64_MAX - a) / c) return 0;
+    *out = a + b * c;
+    return 1;
+}
+
+static int fahren_model_check(FAHRENModelView* v) {
+    uint32_t magic;
+    memcpy(&magic, v->base, sizeof(magic));
+    uint64_t expected = 0;
+    if (magic == FAHREN_MODEL_MAGIC) {
+        FAHRENModelHeader h;
+        memcpy(&h, v->base, sizeof(h));
+        v->format = 1;
+        v->version_major = h.version_major;
+        v->version_minor = h.version_minor;
+        v->version_patch = h.version_patch;
+        v->dtype = FAHREN_DTYPE_F32;
+        v->layout = FAHREN_LAYOUT_SPLIT;
+        v->weight_count = h.weight_count;
+        v->bias_count = h.bias_count;
+        v->payload = (const unsigned char*)v->base + sizeof(h);
+        if (h.bias_count > UINT64_MAX - h.weight_count) return 0;
+        return fahren_size_madd(sizeof(h), h.weight_count + h.bias_count, sizeof(float), &expected) &&
+               expected == v->size;
+    }
+    if (magic != FAHREN_MODEL_MAGIC_V2 || v->size < sizeof(FAHRENModelHeaderV2)) return 0;
+    FAHRENModelHeaderV2 h;
+    memcpy(&h, v->base, sizeof(h));
+    size_t esize = fahren_dtype_size((FAHRENDType)h.dtype);
+    if (!esize || h.layout > FAHREN_LAYOUT_INTERLEAVED) return 0;
+    if (h.layout == FAHREN_LAYOUT_INTERLEAVED && h.layer_count == 0) return 0;
+    if (h.layer_count > (v->size - sizeof(h)) / (2 * sizeof(uint64_t))) return 0;
+    v->format = 2;
+    v->version_major = h.version_major;
+    v->version_minor = h.version_minor;
+    v->version_patch = h.version_patch;
+    v->dtype = (FAHRENDType)h.dtype;
+    v->layout = (FAHRENModelLayout)h.layout;
+    v->weight_count = h.weight_count;
+    v->bias_count = h.bias_count;
+    v->layer_count = h.layer_count;
+    v->checksum = h.checksum;
+    const unsigned char* table = (const unsigned char*)v->base + sizeof(h);
+    v->layer_counts = h.layer_count ? (const uint64_t*)table : NULL;
+    v->payload = table + h.layer_count * 2 * sizeof(uint64_t);
+    uint64_t w = 0, b = 0;
+    for (uint64_t i = 0; i < h.layer_count; ++i) {
+        if (v->layer_counts[2 * i] > UINT64_MAX - w || v->layer_counts[2 * i + 1] > UINT64_MAX - b) return 0;
+        w += v->layer_counts[2 * i];
+        b += v->layer_counts[2 * i + 1];
+    }
+    if (h.layer_count && (w != h.weight_count || b != h.bias_count)) return 0;
+    if (h.bias_count > UINT64_MAX - h.weight_count) return 0;
+    uint64_t header = (uint64_t)((const unsigned char*)v->payload - (const unsigned char*)v->base);
+    return fahren_size_madd(header, h.weight_count + h.bias_count, esize, &expected) && expected == v->size;
+}
+
+FAHRENStatus fahren_model_open(const char* path, FAHRENModelView* view) {
+    if (!path || !view) return FAHREN_ERROR_INVALID_ARGUMENT;
+    memset(view, 0, sizeof(*view));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return FAHREN_ERROR_PROCESSING_FAILED;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    if (!S_ISREG(st.st_mode) || (uint64_t)st.st_size < sizeof(FAHRENModelHeader) ||
+        (uint64_t)st.st_size > (uint64_t)SIZE_MAX) {
+        close(fd);
+        return S_ISREG(st.st_mode) ? FAHREN_ERROR_INVALID_ARGUMENT : FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return FAHREN_ERROR_PROCESSING_FAILED;
+    view->base = map;
+    view->size = size;
+    if (!fahren_model_check(view)) {
+        munmap(map, size);
+        memset(view, 0, sizeof(*view));
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    return FAHREN_SUCCESS;
+}
+
+void fahren_model_close(FAHRENModelView* view) {
+    if (!view) return;
+    if (view->base) munmap((void*)view->base, view->size);
+    memset(view, 0, sizeof(*view));
+}
+
+FAHRENStatus fahren_model_layer_counts(const FAHRENLayer* layers, size_t layer_count, uint64_t* counts) {
+    if ((!layers || !counts) && layer_count) return FAHREN_ERROR_INVALID_ARGUMENT;
+    for (size_t i = 0; i < layer_count; ++i) {
+        size_t w, b;
+        if (!fahren_layer_param_counts(&layers[i], &w, &b)) return FAHREN_ERROR_INVALID_ARGUMENT;
+        counts[2 * i] = w;
+        counts[2 * i + 1] = b;
+    }
+    return FAHREN_SUCCESS;
+}
+
+/* ---- checksum ----------------------------------------------------------- */
+
+static inline uint64_t fahren_rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t fahren_mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+/* Four independent multiply-rotate lanes over 8-byte words, so the
+ * multiplies of neighbouring words overlap instead of forming one long
+ * dependency chain. */
+static uint64_t fahren_block_hash(const unsigned char* p, size_t n, uint64_t index) {
+    const uint64_t k = 0x9E3779B97F4A7C15ull;
+    uint64_t h[4];
+    for (int l = 0; l < 4; ++l) h[l] = fahren_mix64(index * 4 + (uint64_t)l + 1);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        uint64_t w[4];
+        memcpy(w, p + i, sizeof(w));
+        for (int l = 0; l < 4; ++l) h[l] = fahren_rotl64((h[l] ^ w[l]) * k, 31);
+    }
+    if (i < n) {
+        uint64_t w[4] = {0, 0, 0, 0};
+        memcpy(w, p + i, n - i);
+        for (int l = 0; l < 4; ++l) h[l] = fahren_rotl64((h[l] ^ w[l]) * k, 31);
+    }
+    return fahren_mix64(h[0] ^ fahren_rotl64(h[1], 16) ^ fahren_rotl64(h[2], 32) ^ fahren_rotl64(h[3], 48) ^ n);
+}
+
+typedef struct FahrenChecksumJob {
+    const unsigned char* data;
+    size_t bytes;
+    uint64_t* hashes;
+} FahrenChecksumJob;
+
+static void fahren_checksum_blocks(void* ctx, size_t begin, size_t end) {
+    const FahrenChecksumJob* job = (const FahrenChecksumJob*)ctx;
+    for (size_t b = begin; b < end; ++b) {
+        size_t off = b * FAHREN_CHECKSUM_BLOCK;
+        size_t n = job->bytes - off < FAHREN_CHECKSUM_BLOCK ? job->bytes - off : FAHREN_CHECKSUM_BLOCK;
+        job->hashes[b] = fahren_block_hash(job->data + off, n, b);
+    }
+}
+
+uint64_t fahren_model_checksum(const void* data, size_t bytes) {
+    uint64_t sum = fahren_mix64(bytes ^ FAHREN_MODEL_MAGIC_V2);
+    if (!data || bytes == 0) return sum;
+    size_t blocks = (bytes + FAHREN_CHECKSUM_BLOCK - 1) / FAHREN_CHECKSUM_BLOCK;
+    uint64_t stack[16];
+    uint64_t* hashes = blocks <= 16 ? stack : (uint64_t*)malloc(blocks * sizeof(uint64_t));
+    if (!hashes) {
+        /* same result, one block at a time */
+        for (size_t b = 0; b < blocks; ++b) {
+            size_t n = bytes - b * FAHREN_CHECKSUM_BLOCK;
+            if (n > FAHREN_CHECKSUM_BLOCK) n = FAHREN_CHECKSUM_BLOCK;
+            uint64_t h = fahren_block_hash((const unsigned char*)data + b * FAHREN_CHECKSUM_BLOCK, n, b);
+            sum = fahren_mix64(sum ^ h) + b;
+        }
+        return sum;
+    }
+    FahrenChecksumJob job = {(const unsigned char*)data, bytes, hashes};
+    fahren_parallel_for(blocks, 1, fahren_checksum_blocks, &job);
+    for (size_t b = 0; b < blocks; ++b) sum = fahren_mix64(sum ^ hashes[b]) + b;
+    if (hashes != stack) free(hashes);
+    return sum;
+}
+
+static size_t fahren_model_header_bytes(const FAHRENModelView* view) {
+    return (size_t)((const unsigned char*)view->payload - (const unsigned char*)view->base) -
+           (view->format == 2 ? (size_t)view->layer_count * 2 * sizeof(uint64_t) : 0);
+}
+
+FAHRENStatus fahren_model_verify(const FAHRENModelView* view, uint64_t* actual) {
+    if (!view || !view->base) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t header = fahren_model_header_bytes(view);
+    uint64_t sum = fahren_model_checksum((const unsigned char*)view->base + header, view->size - header);
+    if (actual) *actual = sum;
+    if (view->format != 2) return FAHREN_ERROR_INVALID_ARGUMENT;
+    return sum == view->checksum ? FAHREN_SUCCESS : FAHREN_ERROR_PROCESSING_FAILED;
+}
+
+/* ---- values ------------------------------------------------------------- */
+
+static inline uint32_t fahren_f32_bits(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    return x;
+}
+
+static inline float fahren_bits_f32(uint32_t x) {
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+static inline uint16_t fahren_f32_to_f16(float f) {
+    uint32_t x = fahren_f32_bits(f);
+    uint32_t sign = (x >> 16) & 0x8000u, exp = (x >> 23) & 0xFFu, mant = x & 0x7FFFFFu;
+    if (exp == 0xFF) return (uint16_t)(sign | 0x7C00u | (mant ? 0x200u | (mant >> 13) : 0)); /* inf, quiet NaN */
+    int32_t e = (int32_t)exp - 127 + 15;
+    if (e >= 0x1F) return (uint16_t)(sign | 0x7C00u);
+    uint32_t h, rem, half;
+    if (e <= 0) {
+        /* subnormal half: the implicit bit joins the shifted-out mantissa */
+        if (e < -10) return (uint16_t)sign;
+        mant |= 0x800000u;
+        uint32_t shift = (uint32_t)(14 - e);
+        h = mant >> shift;
+        rem = mant & ((1u << shift) - 1);
+        half = 1u << (shift - 1);
+    } else {
+        h = ((uint32_t)e << 10) | (mant >> 13);
+        rem = mant & 0x1FFFu;
+        half = 0x1000u;
+    }
+    if (rem > half || (rem == half && (h & 1))) ++h; /* a carry into the exponent rounds up to inf correctly */
+    return (uint16_t)(sign | h);
+}
+
+static inline float fahren_f16_to_f32(uint16_t v) {
+    uint32_t sign = (uint32_t)(v & 0x8000u) << 16, exp = (v >> 10) & 0x1Fu, mant = v & 0x3FFu;
+    if (exp == 0x1F) return fahren_bits_f32(sign | 0x7F800000u | (mant << 13));
+    if (exp) return fahren_bits_f32(sign | ((exp + 112) << 23) | (mant << 13));
+    if (!mant) return fahren_bits_f32(sign);
+    exp = 113;
+    while (!(mant & 0x400u)) {
+        mant <<= 1;
+        --exp;
+    }
+    return fahren_bits_f32(sign | (exp << 23) | ((mant & 0x3FFu) << 13));
+}
+
+static inline uint16_t fahren_f32_to_bf16(float f) {
+    uint32_t x = fahren_f32_bits(f);
+    if ((x & 0x7FFFFFFFu) > 0x7F800000u) return (uint16_t)((x >> 16) | 0x40u); /* keep NaN a quiet NaN */
+    x += 0x7FFFu + ((x >> 16) & 1u);
+    return (uint16_t)(x >> 16);
+}
+
+static inline float fahren_bf16_to_f32(uint16_t v) {
+    return fahren_bits_f32((uint32_t)v << 16);
+}
+
+static inline float fahren_model_load(const unsigned char* p, FAHRENDType dtype, size_t i) {
+    if (dtype == FAHREN_DTYPE_F32) {
+        float f;
+        memcpy(&f, p + i * sizeof(float), sizeof(f));
+        return f;
+    }
+    uint16_t v;
+    memcpy(&v, p + i * sizeof(uint16_t), sizeof(v));
+    return dtype == FAHREN_DTYPE_F16 ? fahren_f16_to_f32(v) : fahren_bf16_to_f32(v);
+}
+
+static inline void fahren_model_store(unsigned char* p, FAHRENDType dtype, size_t i, float f) {
+    if (dtype == FAHREN_DTYPE_F32) {
+        memcpy(p + i * sizeof(float), &f, sizeof(f));
+        return;
+    }
+    uint16_t v = dtype == FAHREN_DTYPE_F16 ? fahren_f32_to_f16(f) : fahren_f32_to_bf16(f);
+    memcpy(p + i * sizeof(uint16_t), &v, sizeof(v));
+}
+
+/* A run of values that is contiguous in both the source and the
+ * destination ordering; positions are in values from the payload start. */
+typedef struct FahrenModelPiece {
+    uint64_t src, dst, count;
+} FahrenModelPiece;
+
+/* Position of layer `l`'s weights (bias = 0) or biases (bias = 1) */
+static uint64_t fahren_model_position(FAHRENModelLayout layout, const uint64_t* counts, size_t l, int bias,
+                                      uint64_t weight_prefix, uint64_t bias_prefix, uint64_t weight_count) {
+    if (layout == FAHREN_LAYOUT_SPLIT) return bias ? weight_count + bias_prefix : weight_prefix;
+    return weight_prefix + bias_prefix + (bias ? counts[2 * l] : 0);
+}
+
+/* The weight pieces, then the bias pieces, in layer order: one each when
+ * there is no table. `pieces` holds 2 * max(layer_count, 1) entries. */
+static size_t fahren_model_pieces(uint64_t weight_count, uint64_t bias_count, const uint64_t* counts,
+                                  size_t layer_count, FAHRENModelLayout src_layout, FAHRENModelLayout dst_layout,
+                                  FahrenModelPiece* pieces) {
+    if (!counts || layer_count == 0) {
+        pieces[0] = (FahrenModelPiece){0, 0, weight_count};
+        pieces[1] = (FahrenModelPiece){weight_count, weight_count, bias_count};
+        return 2;
+    }
+    for (int bias = 0; bias < 2; ++bias) {
+        uint64_t wp = 0, bp = 0;
+        for (size_t l = 0; l < layer_count; ++l) {
+            FahrenModelPiece* piece = &pieces[(size_t)bias * layer_count + l];
+            piece->src = fahren_model_position(src_layout, counts, l, bias, wp, bp, weight_count);
+            piece->dst = fahren_model_position(dst_layout, counts, l, bias, wp, bp, weight_count);
+            piece->count = counts[2 * l + (size_t)bias];
+            wp += counts[2 * l];
+            bp += counts[2 * l + 1];
+        }
+    }
+    return 2 * layer_count;
+}
+
+/* ---- statistics --------------------------------------------------------- */
+
+typedef struct FahrenStatsPartial {
+    uint64_t count, nonfinite;
+    double min, max, sum, sumsq;
+} FahrenStatsPartial;
+
+typedef struct FahrenStatsJob {
+    const unsigned char* payload;
+    FAHRENDType dtype;
+    uint64_t first, count; /* values of the current piece */
+    FahrenStatsPartial* partials;
+} FahrenStatsJob;
+
+static void fahren_stats_chunks(void* ctx, size_t begin, size_t end) {
+    const FahrenStatsJob* job = (const FahrenStatsJob*)ctx;
+    for (size_t c = begin; c < end; ++c) {
+        uint64_t lo = (uint64_t)c * FAHREN_FORMAT_CHUNK;
+        uint64_t hi = job->count - lo < FAHREN_FORMAT_CHUNK ? job->count : lo + FAHREN_FORMAT_CHUNK;
+        FahrenStatsPartial p = {0, 0, INFINITY, -INFINITY, 0.0, 0.0};
+        for (uint64_t i = lo; i < hi; ++i) {
+            float v = fahren_model_load(job->payload, job->dtype, (size_t)(job->first + i));
+            if (!isfinite(v)) {
+                ++p.nonfinite;
+                continue;
+            }
+            ++p.count;
+            if (v < p.min) p.min = v;
+            if (v > p.max) p.max = v;
+            p.sum += v;
+            p.sumsq += (double)v * v;
+        }
+        job->partials[c] = p;
+    }
+}
+
+static FAHRENStatus fahren_model_piece_stats(const FAHRENModelView* view, const FahrenModelPiece* pieces,
+                                             size_t piece_count, FAHRENModelStats* out) {
+    FahrenStatsPartial total = {0, 0, INFINITY, -INFINITY, 0.0, 0.0};
+    for (size_t k = 0; k < piece_count; ++k) {
+        if (pieces[k].count == 0) continue;
+        size_t chunks = (size_t)((pieces[k].count + FAHREN_FORMAT_CHUNK - 1) / FAHREN_FORMAT_CHUNK);
+        FahrenStatsPartial* partials = (FahrenStatsPartial*)malloc(chunks * sizeof(*partials));
+        if (!partials) return FAHREN_ERROR_PROCESSING_FAILED;
+        FahrenStatsJob job = {(const unsigned char*)view->payload, view->dtype, pieces[k].src, pieces[k].count,
+                              partials};
+        fahren_parallel_for(chunks, 1, fahren_stats_chunks, &job);
+        for (size_t c = 0; c < chunks; ++c) {
+            total.count += partials[c].count;
+            total.nonfinite += partials[c].nonfinite;
+            if (partials[c].min < total.min) total.min = partials[c].min;
+            if (partials[c].max > total.max) total.max = partials[c].max;
+            total.sum += partials[c].sum;
+            total.sumsq += partials[c].sumsq;
+        }
+        free(partials);
+    }
+    out->count = total.count;
+    out->nonfinite = total.nonfinite;
+    out->min = total.count ? total.min : 0.0;
+    out->max = total.count ? total.max : 0.0;
+    out->mean = total.count ? total.sum / (double)total.count : 0.0;
+    out->rms = total.count ? sqrt(total.sumsq / (double)total.count) : 0.0;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_model_stats(const FAHRENModelView* view, FAHRENModelStats* weights, FAHRENModelStats* biases) {
+    if (!view || !view->base) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t layers = view->layer_counts ? (size_t)view->layer_count : 0;
+    FahrenModelPiece* pieces = (FahrenModelPiece*)malloc(2 * (layers ? layers : 1) * sizeof(*pieces));
+    if (!pieces) return FAHREN_ERROR_PROCESSING_FAILED;
+    size_t n = fahren_model_pieces(view->weight_count, view->bias_count, view->layer_counts, layers, view->layout,
+                                   view->layout, pieces);
+    FAHRENStatus st = FAHREN_SUCCESS;
+    if (weights) st = fahren_model_piece_stats(view, pieces, n / 2, weights);
+    if (st == FAHREN_SUCCESS && biases) st = fahren_model_piece_stats(view, pieces + n / 2, n / 2, biases);
+    free(pieces);
+    return st;
+}
+
+/* ---- conversion --------------------------------------------------------- */
+
+typedef struct FahrenConvertJob {
+    const unsigned char* src;
+    FAHRENDType src_dtype;
+    unsigned char* dst;
+    FAHRENDType dst_dtype;
+    FahrenModelPiece piece;
+} FahrenConvertJob;
+
+static void fahren_convert_chunks(void* ctx, size_t begin, size_t end) {
+    const FahrenConvertJob* job = (const FahrenConvertJob*)ctx;
+    uint64_t lo = (uint64_t)begin * FAHREN_FORMAT_CHUNK;
+    uint64_t hi = (uint64_t)end * FAHREN_FORMAT_CHUNK;
+    if (hi > job->piece.count) hi = job->piece.count;
+    size_t s = (size_t)(job->piece.src + lo), d = (size_t)(job->piece.dst + lo), n = (size_t)(hi - lo);
+    if (job->src_dtype == job->dst_dtype) {
+        size_t esize = fahren_dtype_size(job->src_dtype);
+        memcpy(job->dst + d * esize, job->src + s * esize, n * esize);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        fahren_model_store(job->dst, job->dst_dtype, d + i, fahren_model_load(job->src, job->src_dtype, s + i));
+    }
+}
+
+FAHRENStatus fahren_model_convert(const FAHRENModelView* src, const char* path,
+                                  const FAHRENModelConvertOptions* options) {
+    if (!src || !src->base || !path || !options) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t esize = fahren_dtype_size(options->dtype);
+    if (!esize || options->layout > FAHREN_LAYOUT_INTERLEAVED) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (options->format == 1) {
+        if (options->dtype != FAHREN_DTYPE_F32 || options->layout != FAHREN_LAYOUT_SPLIT) {
+            return FAHREN_ERROR_INVALID_ARGUMENT;
+        }
+    } else if (options->format != 2) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* Per-layer counts: the caller's must agree with the source's totals,
+     * and with its table when it has one */
+    const uint64_t* counts = src->layer_counts;
+    size_t layers = counts ? (size_t)src->layer_count : 0;
+    if (options->layer_counts && options->layer_count) {
+        uint64_t w = 0, b = 0;
+        for (size_t i = 0; i < options->layer_count; ++i) {
+            if (options->layer_counts[2 * i] > UINT64_MAX - w || options->layer_counts[2 * i + 1] > UINT64_MAX - b) {
+                return FAHREN_ERROR_INVALID_ARGUMENT;
+            }
+            w += options->layer_counts[2 * i];
+            b += options->layer_counts[2 * i + 1];
+        }
+        if (w != src->weight_count || b != src->bias_count) return FAHREN_ERROR_INVALID_ARGUMENT;
+        if (counts && (layers != options->layer_count ||
+                       memcmp(counts, options->layer_counts, 2 * layers * sizeof(uint64_t)) != 0)) {
+            return FAHREN_ERROR_INVALID_ARGUMENT;
+        }
+        counts = options->layer_counts;
+        layers = options->layer_count;
+    }
+    if (options->layout == FAHREN_LAYOUT_INTERLEAVED && !layers) return FAHREN_ERROR_INVALID_ARGUMENT;
+
+    size_t header = options->format == 1 ? sizeof(FAHRENModelHeader) : sizeof(FAHRENModelHeaderV2);
+    size_t table = options->format == 2 ? layers * 2 * sizeof(uint64_t) : 0;
+    uint64_t values = src->weight_count + src->bias_count, bytes;
+    if (!fahren_size_madd(header + table, values, esize, &bytes) || bytes > (uint64_t)SIZE_MAX) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+
+    FahrenModelPiece* pieces = (FahrenModelPiece*)malloc(2 * (layers ? layers : 1) * sizeof(*pieces));
+    if (!pieces) return FAHREN_ERROR_PROCESSING_FAILED;
+    size_t piece_count = fahren_model_pieces(src->weight_count, src->bias_count, counts, layers, src->layout,
+                                             options->layout, pieces);
+    FahrenOutFile out;
+    if (!fahren_out_open(&out, path, (size_t)bytes)) {
+        free(pieces);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    unsigned char* map = (unsigned char*)out.map;
+    unsigned char* payload = map + header + table;
+    for (size_t k = 0; k < piece_count; ++k) {
+        if (pieces[k].count == 0) continue;
+        FahrenConvertJob job = {(const unsigned char*)src->payload, src->dtype, payload, options->dtype, pieces[k]};
+        size_t chunks = (size_t)((pieces[k].count + FAHREN_FORMAT_CHUNK - 1) / FAHREN_FORMAT_CHUNK);
+        fahren_parallel_for(chunks, 1, fahren_convert_chunks, &job);
+    }
+    free(pieces);
+
+    if (options->format == 1) {
+        FAHRENModelHeader h = {FAHREN_MODEL_MAGIC, src->version_major, src->version_minor, src->version_patch,
+                               src->weight_count, src->bias_count};
+        memcpy(map, &h, sizeof(h));
+    } else {
+        if (table) memcpy(map + header, counts, table);
+        FAHRENModelHeaderV2 h;
+        memset(&h, 0, sizeof(h));
+        h.magic = FAHREN_MODEL_MAGIC_V2;
+        h.version_major = src->version_major;
+        h.version_minor = src->version_minor;
+        h.version_patch = src->version_patch;
+        h.weight_count = src->weight_count;
+        h.bias_count = src->bias_count;
+        h.dtype = (uint32_t)options->dtype;
+        h.layout = (uint32_t)options->layout;
+        h.layer_count = table ? layers : 0;
+        h.checksum = fahren_model_checksum(map + header, (size_t)bytes - header);
+        memcpy(map, &h, sizeof(h));
+    }
+    return fahren_out_commit(&out, path) ? FAHREN_SUCCESS : FAHREN_ERROR_PROCESSING_FAILED;
+}
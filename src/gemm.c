@@ -0,0 +1,189 @@
+/* Single-precision GEMM used by the convolution and dense kernels.
+ * Classic Goto-style blocking: B is packed into 8-column panels per
+ * (K, N) block, each thread packs its own 4-row panels of A, and a 4x8
+ * register-blocked SSE micro-kernel does the multiply-adds. Packing
+ * absorbs the transposes, so all four op() combinations share one kernel. */
+#include <stdlib.h>
+#include <string.h>
+
+#include "fahren_internal.h"
+#include "fahren_simd.h"
+
+#define FAHREN_GEMM_MR 4
+#define FAHREN_GEMM_NR 8
+#define FAHREN_GEMM_MC 64
+#define FAHREN_GEMM_KC 256
+#define FAHREN_GEMM_NC 1024
+
+static inline float fahren_gemm_a(int trans, const float* A, size_t lda, size_t i, size_t p) {
+    return trans ? A[p * lda + i] : A[i * lda + p];
+}
+
+static inline float fahren_gemm_b(int trans, const float* B, size_t ldb, size_t p, size_t j) {
+    return trans ? B[j * ldb + p] : B[p * ldb + j];
+}
+
+/* Pack op(B)[pc:pc+kc, jc:jc+nc] as consecutive kc x NR panels,
+ * zero-padding the last panel. */
+static void fahren_gemm_pack_b(int trans, const float* B, size_t ldb, size_t pc, size_t kc,
+                               size_t jc, size_t nc, float* dst) {
+    for (size_t j = 0; j < nc; j += FAHREN_GEMM_NR) {
+        size_t nr = nc - j < FAHREN_GEMM_NR ? nc - j : FAHREN_GEMM_NR;
+        for (size_t p = 0; p < kc; ++p) {
+            if (!trans && nr == FAHREN_GEMM_NR) {
+                memcpy(dst, B + (pc + p) * ldb + jc + j, FAHREN_GEMM_NR * sizeof(float));
+            } else {
+                for (size_t q = 0; q < FAHREN_GEMM_NR; ++q) {
+                    dst[q] = q < nr ? fahren_gemm_b(trans, B, ldb, pc + p, jc + j + q) : 0.0f;
+                }
+            }
+            dst += FAHREN_GEMM_NR;
+        }
+    }
+}
+
+/* Pack op(A)[ic:ic+mc, pc:pc+kc] as consecutive kc x MR panels. */
+static void fahren_gemm_pack_a(int trans, const float* A, size_t lda, size_t ic, size_t mc,
+                               size_t pc, size_t kc, float* dst) {
+    for (size_t i = 0; i < mc; i += FAHREN_GEMM_MR) {
+        size_t mr = mc - i < FAHREN_GEMM_MR ? mc - i : FAHREN_GEMM_MR;
+        for (size_t p = 0; p < kc; ++p) {
+            for (size_t r = 0; r < FAHREN_GEMM_MR; ++r) {
+                dst[r] = r < mr ? fahren_gemm_a(trans, A, lda, ic + i + r, pc + p) : 0.0f;
+            }
+            dst += FAHREN_GEMM_MR;
+        }
+    }
+}
+
+/* acc(4x8) = sum_p a[p][0..3] (x) b[p][0..7]; then C += alpha * acc. */
+static void fahren_gemm_micro(size_t kc, const float* a, const float* b, float alpha,
+                              float* C, size_t ldc, size_t mr, size_t nr) {
+    float acc[FAHREN_GEMM_MR * FAHREN_GEMM_NR];
+#if defined(FAHREN_HAVE_SSE2)
+    __m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps();
+    __m128 c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+    __m128 c20 = _mm_setzero_ps(), c21 = _mm_setzero_ps();
+    __m128 c30 = _mm_setzero_ps(), c31 = _mm_setzero_ps();
+    for (size_t p = 0; p < kc; ++p) {
+        __m128 b0 = _mm_loadu_ps(b), b1 = _mm_loadu_ps(b + 4);
+        __m128 a0 = _mm_set1_ps(a[0]);
+        c00 = _mm_add_ps(c00, _mm_mul_ps(a0, b0));
+        c01 = _mm_add_ps(c01, _mm_mul_ps(a0, b1));
+        __m128 a1 = _mm_set1_ps(a[1]);
+        c10 = _mm_add_ps(c10, _mm_mul_ps(a1, b0));
+        c11 = _mm_add_ps(c11, _mm_mul_ps(a1, b1));
+        __m128 a2 = _mm_set1_ps(a[2]);
+        c20 = _mm_add_ps(c20, _mm_mul_ps(a2, b0));
+        c21 = _mm_add_ps(c21, _mm_mul_ps(a2, b1));
+        __m128 a3 = _mm_set1_ps(a[3]);
+        c30 = _mm_add_ps(c30, _mm_mul_ps(a3, b0));
+        c31 = _mm_add_ps(c31, _mm_mul_ps(a3, b1));
+        a += FAHREN_GEMM_MR;
+        b += FAHREN_GEMM_NR;
+    }
+    _mm_storeu_ps(acc + 0, c00);
+    _mm_storeu_ps(acc + 4, c01);
+    _mm_storeu_ps(acc + 8, c10);
+    _mm_storeu_ps(acc + 12, c11);
+    _mm_storeu_ps(acc + 16, c20);
+    _mm_storeu_ps(acc + 20, c21);
+    _mm_storeu_ps(acc + 24, c30);
+    _mm_storeu_ps(acc + 28, c31);
+#else
+    memset(acc, 0, sizeof(acc));
+    for (size_t p = 0; p < kc; ++p) {
+        for (size_t r = 0; r < FAHREN_GEMM_MR; ++r) {
+            for (size_t q = 0; q < FAHREN_GEMM_NR; ++q) acc[r * FAHREN_GEMM_NR + q] += a[r] * b[q];
+        }
+        a += FAHREN_GEMM_MR;
+        b += FAHREN_GEMM_NR;
+    }
+#endif
+    for (size_t r = 0; r < mr; ++r) {
+        float* c = C + r * ldc;
+        for (size_t q = 0; q < nr; ++q) c[q] += alpha * acc[r * FAHREN_GEMM_NR + q];
+    }
+}
+
+typedef struct FahrenGemmJob {
+    int trans_a;
+    const float* A;
+    size_t lda;
+    float alpha;
+    float* C;
+    size_t ldc;
+    size_t M;
+    size_t jc, nc, pc, kc;
+    const float* packed_b;
+} FahrenGemmJob;
+
+static void fahren_gemm_rows(void* ctx, size_t begin, size_t end) {
+    FahrenGemmJob* job = (FahrenGemmJob*)ctx;
+    float packed_a[FAHREN_GEMM_MC * FAHREN_GEMM_KC];
+    for (size_t blk = begin; blk < end; ++blk) {
+        size_t ic = blk * FAHREN_GEMM_MC;
+        size_t mc = job->M - ic < FAHREN_GEMM_MC ? job->M - ic : FAHREN_GEMM_MC;
+        fahren_gemm_pack_a(job->trans_a, job->A, job->lda, ic, mc, job->pc, job->kc, packed_a);
+        for (size_t j = 0; j < job->nc; j += FAHREN_GEMM_NR) {
+            size_t nr = job->nc - j < FAHREN_GEMM_NR ? job->nc - j : FAHREN_GEMM_NR;
+            const float* bp = job->packed_b + j * job->kc;
+            for (size_t i = 0; i < mc; i += FAHREN_GEMM_MR) {
+                size_t mr = mc - i < FAHREN_GEMM_MR ? mc - i : FAHREN_GEMM_MR;
+                fahren_gemm_micro(job->kc, packed_a + i * job->kc, bp, job->alpha,
+                                  job->C + (ic + i) * job->ldc + job->jc + j, job->ldc, mr, nr);
+            }
+        }
+    }
+}
+
+int fahren_sgemm(int trans_a, int trans_b, size_t M, size_t N, size_t K,
+                 float alpha, const float* A, size_t lda, const float* B, size_t ldb,
+                 float beta, float* C, size_t ldc) {
+    if (M == 0 || N == 0) return 1;
+    if (beta != 1.0f) {
+        for (size_t i = 0; i < M; ++i) {
+            float* c = C + i * ldc;
+            if (beta == 0.0f) {
+                memset(c, 0, N * sizeof(float));
+            } else {
+                for (size_t j = 0; j < N; ++j) c[j] *= beta;
+            }
+        }
+    }
+    if (K == 0 || alpha == 0.0f) return 1;
+
+    size_t nc_max = N < FAHREN_GEMM_NC ? N : FAHREN_GEMM_NC;
+    size_t panel_cols = (nc_max + FAHREN_GEMM_NR - 1) / FAHREN_GEMM_NR * FAHREN_GEMM_NR;
+    size_t kc_max = K < FAHREN_GEMM_KC ? K : FAHREN_GEMM_KC;
+    float* packed_b = (float*)malloc(panel_cols * kc_max * sizeof(float));
+    if (!packed_b) return 0;
+
+    FahrenGemmJob job;
+    job.trans_a = trans_a;
+    job.A = A;
+    job.lda = lda;
+    job.alpha = alpha;
+    job.C = C;
+    job.ldc = ldc;
+    job.M = M;
+    job.packed_b = packed_b;
+    size_t row_blocks = (M + FAHREN_GEMM_MC - 1) / FAHREN_GEMM_MC;
+
+    for (size_t jc = 0; jc < N; jc += FAHREN_GEMM_NC) {
+        size_t nc = N - jc < FAHREN_GEMM_NC ? N - jc : FAHREN_GEMM_NC;
+        for (size_t pc = 0; pc < K; pc += FAHREN_GEMM_KC) {
+            size_t kc = K - pc < FAHREN_GEMM_KC ? K - pc : FAHREN_GEMM_KC;
+            fahren_gemm_pack_b(trans_b, B, ldb, pc, kc, jc, nc, packed_b);
+            job.jc = jc;
+            job.nc = nc;
+            job.pc = pc;
+            job.kc = kc;
+            /* small problems are not worth waking the pool for */
+            size_t grain = M * nc * kc < (size_t)1 << 18 ? row_blocks : 1;
+            fahren_parallel_for(row_blocks, grain, fahren_gemm_rows, &job);
+        }
+    }
+    free(packed_b);
+    return 1;
+}
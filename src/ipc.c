@@ -0,0 +1,647 @@
+/* Shared-memory request ring between client processes and one server.
+ * See include/fahren/ipc.h.
+ * The segment holds a header, a bounded MPSC ring of slot numbers
+ * (Vyukov-style: each cell carries a sequence number, producers claim a
+ * position with a CAS on the tail), one control block per slot and the
+ * slots' input/output areas. A slot moves FREE -> CLAIMED (client) ->
+ * SUBMITTED (client, then pushed on the ring) -> RUNNING (server, by CAS,
+ * so a slot pushed twice is batched once) -> DONE (server) -> FREE.
+ * A claimed slot records its owner's pid; the server hands slots held by
+ * a process that has died back to FREE, and clients that found every
+ * slot busy sleep on the header's release word until one frees up.
+ * Everything in the segment is writable by any client, so the server
+ * works from its own copy of the geometry and checks what it reads from
+ * a slot (index, state, rows) before trusting it.
+ * The server sleeps on the header's doorbell word and a client on its
+ * slot's state word; each side sets a waiting flag before FUTEX_WAIT and
+ * the other only issues FUTEX_WAKE when it sees the flag, so the common
+ * spin-and-catch path is syscall free. The futexes are process-shared
+ * (no FUTEX_PRIVATE_FLAG). */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <fahren/ipc.h>
+
+#define FAHREN_IPC_MAGIC 0x46414849u /* "FAHI" */
+#define FAHREN_IPC_VERSION 3u
+#define FAHREN_IPC_LINE 64
+#define FAHREN_IPC_DEFAULT_SLOTS 64
+#define FAHREN_IPC_MAX_SLOTS 4096
+#define FAHREN_IPC_CLIENT_SPIN_NS 20000
+#define FAHREN_IPC_SERVER_SPIN_NS 50000
+#define FAHREN_IPC_WAIT_SLICE_NS 50000000 /* re-check for shutdown this often while asleep */
+#define FAHREN_IPC_REAP_NS 100000000      /* look for slots of dead clients this often */
+
+enum {
+    FAHREN_SLOT_FREE = 0,
+    FAHREN_SLOT_CLAIMED = 1,
+    FAHREN_SLOT_SUBMITTED = 2,
+    FAHREN_SLOT_DONE = 3,
+    FAHREN_SLOT_RUNNING = 4
+};
+
+typedef struct FahrenIpcHeader {
+    _Atomic uint32_t magic; /* stored last by the server */
+    uint32_t version;
+    uint32_t in_dim, out_dim;
+    uint32_t slots, max_rows;
+    uint32_t ring_mask;
+    int32_t server_pid;
+    uint64_t cells_offset, ctl_offset, data_offset, slot_stride, total_bytes;
+
+    _Alignas(FAHREN_IPC_LINE) _Atomic uint32_t doorbell; /* bumped on every submit */
+    _Atomic uint32_t server_waiting;
+    _Atomic uint32_t stopping;
+    _Alignas(FAHREN_IPC_LINE) _Atomic uint32_t released; /* bumped whenever a slot turns FREE */
+    _Atomic uint32_t claim_waiting;                      /* clients asleep on `released` */
+    _Alignas(FAHREN_IPC_LINE) _Atomic uint64_t tail; /* producers */
+    _Alignas(FAHREN_IPC_LINE) _Atomic uint64_t head; /* the server */
+} FahrenIpcHeader;
+
+typedef struct FahrenIpcCell {
+    _Atomic uint64_t seq;
+    uint32_t slot;
+    uint32_t pad;
+} FahrenIpcCell;
+
+typedef struct FahrenIpcSlot {
+    _Alignas(FAHREN_IPC_LINE) _Atomic uint32_t state; /* futex word the owner sleeps on */
+    _Atomic uint32_t waiting;
+    _Atomic int32_t owner; /* pid of the claiming process; 0 while FREE */
+    uint32_t rows;
+    int32_t status;
+} FahrenIpcSlot;
+
+typedef struct FahrenIpcMap {
+    FahrenIpcHeader* h;
+    size_t bytes;
+    FahrenIpcCell* cells;
+    FahrenIpcSlot* ctl;
+    unsigned char* data;
+    long spin_ns;
+    /* geometry copied out of the header when mapped */
+    uint32_t in_dim, out_dim, slots, max_rows, ring_mask;
+    size_t stride;
+} FahrenIpcMap;
+
+struct FAHRENIpcServer {
+    FahrenIpcMap m;
+    char name[NAME_MAX];
+    FAHRENRuntime* rt;
+    size_t max_batch_rows;
+    unsigned batch_window_us;
+    float* batch_in;
+    float* batch_out;
+    uint32_t* batch;
+    uint32_t* batch_n; /* rows of each batched slot, read once from the slot */
+    size_t batch_count, batch_rows;
+    long next_reap_ns;
+    int has_carry;
+    uint32_t carry, carry_rows;
+};
+
+struct FAHRENIpcClient {
+    FahrenIpcMap m;
+    uint32_t next_slot;
+    int32_t pid;
+};
+
+/* ---- helpers ------------------------------------------------------------ */
+
+static inline void fahren_ipc_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static long fahren_ipc_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void fahren_ipc_futex_wait(_Atomic uint32_t* word, uint32_t expected, long timeout_ns) {
+    struct timespec ts = {timeout_ns / 1000000000L, timeout_ns % 1000000000L};
+    (void)syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, expected, &ts, NULL, 0);
+}
+
+static void fahren_ipc_futex_wake(_Atomic uint32_t* word) {
+    (void)syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/* Spinning only pays when the other side can run at the same time. */
+static long fahren_ipc_spin_budget(long ns) {
+    return sysconf(_SC_NPROCESSORS_ONLN) > 1 ? ns : 0;
+}
+
+static int fahren_ipc_shm_name(const char* name, char* out, size_t cap) {
+    if (!name || !*name || strchr(name + 1, '/')) return 0;
+    int len = snprintf(out, cap, "%s%s", name[0] == '/' ? "" : "/", name);
+    return len > 1 && (size_t)len < cap;
+}
+
+static size_t fahren_ipc_round(size_t v) {
+    return (v + FAHREN_IPC_LINE - 1) & ~(size_t)(FAHREN_IPC_LINE - 1);
+}
+
+static void fahren_ipc_bind(FahrenIpcMap* m) {
+    unsigned char* base = (unsigned char*)m->h;
+    m->cells = (FahrenIpcCell*)(base + m->h->cells_offset);
+    m->ctl = (FahrenIpcSlot*)(base + m->h->ctl_offset);
+    m->data = base + m->h->data_offset;
+    m->in_dim = m->h->in_dim;
+    m->out_dim = m->h->out_dim;
+    m->slots = m->h->slots;
+    m->max_rows = m->h->max_rows;
+    m->ring_mask = m->h->ring_mask;
+    m->stride = (size_t)m->h->slot_stride;
+}
+
+static float* fahren_ipc_slot_input(const FahrenIpcMap* m, uint32_t slot) {
+    return (float*)(m->data + (size_t)slot * m->stride);
+}
+
+static float* fahren_ipc_slot_output(const FahrenIpcMap* m, uint32_t slot) {
+    return fahren_ipc_slot_input(m, slot) + (size_t)m->max_rows * m->in_dim;
+}
+
+/* Hand a slot back and wake clients waiting for one. */
+static void fahren_ipc_release(FahrenIpcMap* m, uint32_t slot) {
+    atomic_store_explicit(&m->ctl[slot].owner, 0, memory_order_relaxed);
+    atomic_store_explicit(&m->ctl[slot].state, FAHREN_SLOT_FREE, memory_order_release);
+    atomic_fetch_add(&m->h->released, 1);
+    if (atomic_load(&m->h->claim_waiting)) fahren_ipc_futex_wake(&m->h->released);
+}
+
+static int fahren_ipc_pid_dead(int32_t pid) {
+    return pid > 0 && kill((pid_t)pid, 0) != 0 && errno == ESRCH;
+}
+
+static void fahren_ipc_push(FahrenIpcMap* m, uint32_t slot) {
+    FahrenIpcHeader* h = m->h;
+    uint64_t pos = atomic_load_explicit(&h->tail, memory_order_relaxed);
+    for (;;) {
+        FahrenIpcCell* cell = &m->cells[pos & m->ring_mask];
+        uint64_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int64_t dif = (int64_t)(seq - pos);
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&h->tail, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                cell->slot = slot;
+                atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+                return;
+            }
+        } else {
+            /* the ring has a cell per slot, so it is never full; dif > 0
+             * only means another producer moved the tail */
+            pos = atomic_load_explicit(&h->tail, memory_order_relaxed);
+        }
+    }
+}
+
+static int fahren_ipc_pop(FahrenIpcMap* m, uint32_t* slot) {
+    FahrenIpcHeader* h = m->h;
+    uint64_t pos = atomic_load_explicit(&h->head, memory_order_relaxed);
+    FahrenIpcCell* cell = &m->cells[pos & m->ring_mask];
+    if (atomic_load_explicit(&cell->seq, memory_order_acquire) != pos + 1) return 0;
+    *slot = cell->slot;
+    atomic_store_explicit(&cell->seq, pos + m->ring_mask + 1, memory_order_release);
+    atomic_store_explicit(&h->head, pos + 1, memory_order_relaxed);
+    return 1;
+}
+
+/* ---- server ------------------------------------------------------------- */
+
+FAHRENStatus fahren_ipc_server_create(const char* name, FAHRENRuntime* rt, const FAHRENIpcServerConfig* config,
+                                      FAHRENIpcServer** out) {
+    if (!rt || !out) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *out = NULL;
+    size_t in_dim = fahren_runtime_input_dim(rt), out_dim = fahren_runtime_output_dim(rt);
+    size_t slots = config && config->slots ? config->slots : FAHREN_IPC_DEFAULT_SLOTS;
+    size_t max_rows = config && config->max_rows ? config->max_rows : 1;
+    size_t max_batch = config && config->max_batch_rows ? config->max_batch_rows : slots * max_rows;
+    if (in_dim == 0 || out_dim == 0 || slots > FAHREN_IPC_MAX_SLOTS || max_batch < max_rows ||
+        max_batch > slots * max_rows) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+
+    FAHRENIpcServer* s = (FAHRENIpcServer*)calloc(1, sizeof(FAHRENIpcServer));
+    if (!s) return FAHREN_ERROR_PROCESSING_FAILED;
+    if (!fahren_ipc_shm_name(name, s->name, sizeof(s->name))) {
+        free(s);
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    s->rt = rt;
+    s->max_batch_rows = max_batch;
+    s->batch_window_us = config ? config->batch_window_us : 0;
+    s->batch_in = (float*)malloc(max_batch * in_dim * sizeof(float));
+    s->batch_out = (float*)malloc(max_batch * out_dim * sizeof(float));
+    s->batch = (uint32_t*)malloc(slots * sizeof(uint32_t));
+    s->batch_n = (uint32_t*)malloc(slots * sizeof(uint32_t));
+    if (!s->batch_in || !s->batch_out || !s->batch || !s->batch_n) {
+        fahren_ipc_server_destroy(s);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+
+    size_t ring = 1;
+    while (ring < slots) ring <<= 1;
+    size_t cells_off = fahren_ipc_round(sizeof(FahrenIpcHeader));
+    size_t ctl_off = fahren_ipc_round(cells_off + ring * sizeof(FahrenIpcCell));
+    size_t data_off = fahren_ipc_round(ctl_off + slots * sizeof(FahrenIpcSlot));
+    size_t stride = fahren_ipc_round(max_rows * (in_dim + out_dim) * sizeof(float));
+    size_t bytes = data_off + slots * stride;
+
+    (void)shm_unlink(s->name); /* a segment left by a server that died */
+    int fd = shm_open(s->name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        s->name[0] = '\0';
+        fahren_ipc_server_destroy(s);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    void* mem = MAP_FAILED;
+    if (ftruncate(fd, (off_t)bytes) == 0) mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        fahren_ipc_server_destroy(s);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    s->m.bytes = bytes;
+    s->m.h = (FahrenIpcHeader*)mem;
+    s->m.spin_ns = fahren_ipc_spin_budget(FAHREN_IPC_SERVER_SPIN_NS);
+
+    FahrenIpcHeader* h = s->m.h;
+    h->version = FAHREN_IPC_VERSION;
+    h->in_dim = (uint32_t)in_dim;
+    h->out_dim = (uint32_t)out_dim;
+    h->slots = (uint32_t)slots;
+    h->max_rows = (uint32_t)max_rows;
+    h->ring_mask = (uint32_t)(ring - 1);
+    h->server_pid = (int32_t)getpid();
+    h->cells_offset = cells_off;
+    h->ctl_offset = ctl_off;
+    h->data_offset = data_off;
+    h->slot_stride = stride;
+    h->total_bytes = bytes;
+    fahren_ipc_bind(&s->m);
+    for (size_t i = 0; i < ring; ++i) atomic_init(&s->m.cells[i].seq, i);
+    atomic_store_explicit(&h->magic, FAHREN_IPC_MAGIC, memory_order_release);
+    *out = s;
+    return FAHREN_SUCCESS;
+}
+
+/* Complete a slot without running it (server side). */
+static void fahren_ipc_complete(FahrenIpcMap* m, uint32_t slot, FAHRENStatus st) {
+    FahrenIpcSlot* c = &m->ctl[slot];
+    c->status = (int32_t)st;
+    atomic_store(&c->state, FAHREN_SLOT_DONE);
+    if (atomic_load(&c->waiting)) fahren_ipc_futex_wake(&c->state);
+}
+
+/* Add a taken request to the batch, or park it for the next one. The
+ * batch arrays hold one entry per slot, which fahren_ipc_take's claim
+ * guarantees is enough; the count check keeps them safe regardless. */
+static int fahren_ipc_add(FAHRENIpcServer* s, uint32_t slot, uint32_t rows) {
+    if (s->batch_count && (s->batch_rows + rows > s->max_batch_rows || s->batch_count >= s->m.slots)) {
+        s->carry = slot;
+        s->carry_rows = rows;
+        s->has_carry = 1;
+        return 0;
+    }
+    s->batch[s->batch_count] = slot;
+    s->batch_n[s->batch_count++] = rows;
+    s->batch_rows += rows;
+    return 1;
+}
+
+/* The slot number and row count of a popped request come from shared
+ * memory. A slot that is out of range, or that cannot be moved from
+ * SUBMITTED to RUNNING (never submitted, or pushed again while already
+ * taken), is dropped; one with a bad row count is failed. Neither reaches
+ * the batch buffers. */
+static int fahren_ipc_take(FAHRENIpcServer* s, uint32_t slot) {
+    uint32_t expected = FAHREN_SLOT_SUBMITTED;
+    if (slot >= s->m.slots || !atomic_compare_exchange_strong(&s->m.ctl[slot].state, &expected, FAHREN_SLOT_RUNNING)) {
+        return 1;
+    }
+    uint32_t rows = *(volatile uint32_t*)&s->m.ctl[slot].rows;
+    if (rows == 0 || rows > s->m.max_rows) {
+        fahren_ipc_complete(&s->m, slot, FAHREN_ERROR_INVALID_ARGUMENT);
+        return 1;
+    }
+    return fahren_ipc_add(s, slot, rows);
+}
+
+static void fahren_ipc_collect(FAHRENIpcServer* s) {
+    uint32_t slot;
+    if (s->has_carry) {
+        s->has_carry = 0;
+        if (!fahren_ipc_add(s, s->carry, s->carry_rows)) return;
+    }
+    while (s->batch_rows < s->max_batch_rows && s->batch_count < s->m.slots && fahren_ipc_pop(&s->m, &slot)) {
+        if (!fahren_ipc_take(s, slot)) return;
+    }
+}
+
+static int fahren_ipc_ready(const FahrenIpcMap* m) {
+    uint64_t head = atomic_load_explicit(&m->h->head, memory_order_relaxed);
+    return atomic_load_explicit(&m->cells[head & m->ring_mask].seq, memory_order_acquire) == head + 1;
+}
+
+static void fahren_ipc_idle(FAHRENIpcServer* s) {
+    FahrenIpcHeader* h = s->m.h;
+    long deadline = fahren_ipc_now_ns() + s->m.spin_ns;
+    for (unsigned i = 0;; ++i) {
+        if (fahren_ipc_ready(&s->m) || atomic_load_explicit(&h->stopping, memory_order_relaxed)) return;
+        if ((i & 63) == 0 && fahren_ipc_now_ns() >= deadline) break;
+        fahren_ipc_relax();
+    }
+    atomic_store(&h->server_waiting, 1);
+    uint32_t seen = atomic_load(&h->doorbell);
+    if (!fahren_ipc_ready(&s->m) && !atomic_load(&h->stopping)) {
+        fahren_ipc_futex_wait(&h->doorbell, seen, FAHREN_IPC_WAIT_SLICE_NS);
+    }
+    atomic_store(&h->server_waiting, 0);
+}
+
+/* Free slots left CLAIMED or DONE by clients that died. SUBMITTED ones
+ * are run first and picked up here once DONE. The owner is cleared with
+ * a CAS before the slot is released, so a slot a live client has just
+ * claimed (owner still 0) is never taken. */
+static void fahren_ipc_reap(FAHRENIpcServer* s) {
+    FahrenIpcMap* m = &s->m;
+    for (uint32_t slot = 0; slot < m->slots; ++slot) {
+        uint32_t state = atomic_load_explicit(&m->ctl[slot].state, memory_order_acquire);
+        if (state != FAHREN_SLOT_CLAIMED && state != FAHREN_SLOT_DONE) continue;
+        int32_t owner = atomic_load_explicit(&m->ctl[slot].owner, memory_order_relaxed);
+        if (!fahren_ipc_pid_dead(owner)) continue;
+        if (atomic_compare_exchange_strong(&m->ctl[slot].owner, &owner, 0)) fahren_ipc_release(m, slot);
+    }
+}
+
+static void fahren_ipc_execute(FAHRENIpcServer* s) {
+    FahrenIpcMap* m = &s->m;
+    size_t in_dim = m->in_dim, out_dim = m->out_dim;
+    FAHRENStatus st;
+    if (s->batch_count == 1) {
+        /* nothing to coalesce: run straight out of and into the slot */
+        uint32_t slot = s->batch[0];
+        st = fahren_runtime_forward(s->rt, fahren_ipc_slot_input(m, slot), s->batch_n[0],
+                                    fahren_ipc_slot_output(m, slot));
+    } else {
+        size_t row = 0;
+        for (size_t i = 0; i < s->batch_count; ++i) {
+            uint32_t slot = s->batch[i];
+            size_t rows = s->batch_n[i];
+            memcpy(s->batch_in + row * in_dim, fahren_ipc_slot_input(m, slot), rows * in_dim * sizeof(float));
+            row += rows;
+        }
+        st = fahren_runtime_forward(s->rt, s->batch_in, row, s->batch_out);
+        row = 0;
+        for (size_t i = 0; i < s->batch_count && st == FAHREN_SUCCESS; ++i) {
+            uint32_t slot = s->batch[i];
+            size_t rows = s->batch_n[i];
+            memcpy(fahren_ipc_slot_output(m, slot), s->batch_out + row * out_dim, rows * out_dim * sizeof(float));
+            row += rows;
+        }
+    }
+    for (size_t i = 0; i < s->batch_count; ++i) fahren_ipc_complete(m, s->batch[i], st);
+    s->batch_count = 0;
+    s->batch_rows = 0;
+}
+
+FAHRENStatus fahren_ipc_server_run(FAHRENIpcServer* s) {
+    if (!s || !s->m.h) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenIpcHeader* h = s->m.h;
+    while (!atomic_load_explicit(&h->stopping, memory_order_relaxed)) {
+        long now = fahren_ipc_now_ns();
+        if (now >= s->next_reap_ns) {
+            fahren_ipc_reap(s);
+            s->next_reap_ns = now + FAHREN_IPC_REAP_NS;
+        }
+        fahren_ipc_collect(s);
+        if (s->batch_count == 0) {
+            fahren_ipc_idle(s);
+            continue;
+        }
+        if (s->batch_window_us && !s->has_carry && s->batch_rows < s->max_batch_rows) {
+            long deadline = fahren_ipc_now_ns() + (long)s->batch_window_us * 1000L;
+            while (!s->has_carry && s->batch_rows < s->max_batch_rows && fahren_ipc_now_ns() < deadline) {
+                fahren_ipc_collect(s);
+                fahren_ipc_relax();
+            }
+        }
+        fahren_ipc_execute(s);
+    }
+    return FAHREN_SUCCESS;
+}
+
+void fahren_ipc_server_stop(FAHRENIpcServer* s) {
+    if (!s || !s->m.h) return;
+    atomic_store(&s->m.h->stopping, 1);
+    fahren_ipc_futex_wake(&s->m.h->doorbell);
+}
+
+void fahren_ipc_server_destroy(FAHRENIpcServer* s) {
+    if (!s) return;
+    if (s->m.h) {
+        /* wake clients blocked on us so they see the shutdown */
+        atomic_store(&s->m.h->stopping, 1);
+        for (uint32_t i = 0; i < s->m.slots; ++i) fahren_ipc_futex_wake(&s->m.ctl[i].state);
+        fahren_ipc_futex_wake(&s->m.h->released);
+        munmap(s->m.h, s->m.bytes);
+    }
+    if (s->name[0]) (void)shm_unlink(s->name);
+    free(s->batch_in);
+    free(s->batch_out);
+    free(s->batch);
+    free(s->batch_n);
+    free(s);
+}
+
+/* ---- client ------------------------------------------------------------- */
+
+FAHRENStatus fahren_ipc_connect(const char* name, FAHRENIpcClient** out) {
+    char shm[NAME_MAX];
+    if (!out) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *out = NULL;
+    if (!fahren_ipc_shm_name(name, shm, sizeof(shm))) return FAHREN_ERROR_INVALID_ARGUMENT;
+    int fd = shm_open(shm, O_RDWR, 0);
+    if (fd < 0) return FAHREN_ERROR_NOT_INITIALIZED;
+    struct stat sb;
+    void* mem = MAP_FAILED;
+    if (fstat(fd, &sb) == 0 && (size_t)sb.st_size >= sizeof(FahrenIpcHeader)) {
+        mem = mmap(NULL, (size_t)sb.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mem == MAP_FAILED) return FAHREN_ERROR_NOT_INITIALIZED;
+    FahrenIpcHeader* h = (FahrenIpcHeader*)mem;
+    if (atomic_load_explicit(&h->magic, memory_order_acquire) != FAHREN_IPC_MAGIC ||
+        h->version != FAHREN_IPC_VERSION || h->total_bytes != (uint64_t)sb.st_size || h->slots == 0 ||
+        h->slots > FAHREN_IPC_MAX_SLOTS || h->data_offset + (uint64_t)h->slots * h->slot_stride > h->total_bytes) {
+        munmap(mem, (size_t)sb.st_size);
+        return FAHREN_ERROR_NOT_INITIALIZED;
+    }
+    FAHRENIpcClient* c = (FAHRENIpcClient*)calloc(1, sizeof(FAHRENIpcClient));
+    if (!c) {
+        munmap(mem, (size_t)sb.st_size);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    c->m.h = h;
+    c->m.bytes = (size_t)sb.st_size;
+    c->m.spin_ns = fahren_ipc_spin_budget(FAHREN_IPC_CLIENT_SPIN_NS);
+    fahren_ipc_bind(&c->m);
+    c->pid = (int32_t)getpid();
+    c->next_slot = (uint32_t)c->pid % c->m.slots; /* spread clients over the slots */
+    *out = c;
+    return FAHREN_SUCCESS;
+}
+
+void fahren_ipc_disconnect(FAHRENIpcClient* c) {
+    if (!c) return;
+    munmap(c->m.h, c->m.bytes);
+    free(c);
+}
+
+size_t fahren_ipc_input_dim(const FAHRENIpcClient* c) {
+    return c ? c->m.in_dim : 0;
+}
+
+size_t fahren_ipc_output_dim(const FAHRENIpcClient* c) {
+    return c ? c->m.out_dim : 0;
+}
+
+static int fahren_ipc_server_gone(const FahrenIpcHeader* h) {
+    return atomic_load_explicit(&h->stopping, memory_order_relaxed) || fahren_ipc_pid_dead(h->server_pid);
+}
+
+static int fahren_ipc_valid(const FAHRENIpcClient* c, const FAHRENIpcRequest* req) {
+    return c && req && req->slot < c->m.slots && req->input == fahren_ipc_slot_input(&c->m, req->slot);
+}
+
+static int fahren_ipc_claim(FAHRENIpcClient* c, FAHRENIpcRequest* req) {
+    for (uint32_t i = 0; i < c->m.slots; ++i) {
+        uint32_t slot = (c->next_slot + i) % c->m.slots;
+        uint32_t expected = FAHREN_SLOT_FREE;
+        if (atomic_load_explicit(&c->m.ctl[slot].state, memory_order_relaxed) == FAHREN_SLOT_FREE &&
+            atomic_compare_exchange_strong(&c->m.ctl[slot].state, &expected, FAHREN_SLOT_CLAIMED)) {
+            atomic_store_explicit(&c->m.ctl[slot].owner, c->pid, memory_order_relaxed);
+            c->next_slot = (slot + 1) % c->m.slots;
+            req->slot = slot;
+            req->input = fahren_ipc_slot_input(&c->m, slot);
+            req->output = fahren_ipc_slot_output(&c->m, slot);
+            req->max_rows = c->m.max_rows;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+FAHRENStatus fahren_ipc_request_begin(FAHRENIpcClient* c, FAHRENIpcRequest* req) {
+    if (!c || !req) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenIpcHeader* h = c->m.h;
+    while (!fahren_ipc_claim(c, req)) {
+        if (fahren_ipc_server_gone(h)) return FAHREN_ERROR_NOT_INITIALIZED;
+        /* every slot is busy: sleep until one is released, re-scanning
+         * after announcing ourselves so a release in between is not lost */
+        atomic_fetch_add(&h->claim_waiting, 1);
+        uint32_t seen = atomic_load(&h->released);
+        if (fahren_ipc_claim(c, req)) {
+            atomic_fetch_sub(&h->claim_waiting, 1);
+            break;
+        }
+        fahren_ipc_futex_wait(&h->released, seen, FAHREN_IPC_WAIT_SLICE_NS);
+        atomic_fetch_sub(&h->claim_waiting, 1);
+    }
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_ipc_request_submit(FAHRENIpcClient* c, FAHRENIpcRequest* req, size_t rows) {
+    if (!fahren_ipc_valid(c, req) || rows == 0 || rows > c->m.max_rows) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenIpcHeader* h = c->m.h;
+    FahrenIpcSlot* ctl = &c->m.ctl[req->slot];
+    if (atomic_load_explicit(&ctl->state, memory_order_relaxed) != FAHREN_SLOT_CLAIMED) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    ctl->rows = (uint32_t)rows;
+    atomic_store_explicit(&ctl->state, FAHREN_SLOT_SUBMITTED, memory_order_relaxed);
+    fahren_ipc_push(&c->m, req->slot);
+    atomic_fetch_add(&h->doorbell, 1);
+    if (atomic_load(&h->server_waiting)) fahren_ipc_futex_wake(&h->doorbell);
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_ipc_request_wait(FAHRENIpcClient* c, FAHRENIpcRequest* req) {
+    if (!fahren_ipc_valid(c, req)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenIpcSlot* ctl = &c->m.ctl[req->slot];
+    uint32_t state = atomic_load_explicit(&ctl->state, memory_order_acquire);
+    if (state != FAHREN_SLOT_SUBMITTED && state != FAHREN_SLOT_RUNNING && state != FAHREN_SLOT_DONE) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+
+    long deadline = c->m.spin_ns ? fahren_ipc_now_ns() + c->m.spin_ns : 0;
+    for (unsigned i = 0; state != FAHREN_SLOT_DONE; ++i) {
+        if ((i & 63) == 0 && fahren_ipc_now_ns() >= deadline) break;
+        fahren_ipc_relax();
+        state = atomic_load_explicit(&ctl->state, memory_order_acquire);
+    }
+    while (state != FAHREN_SLOT_DONE) {
+        atomic_store(&ctl->waiting, 1);
+        state = atomic_load(&ctl->state);
+        if (state != FAHREN_SLOT_DONE) fahren_ipc_futex_wait(&ctl->state, state, FAHREN_IPC_WAIT_SLICE_NS);
+        atomic_store(&ctl->waiting, 0);
+        state = atomic_load_explicit(&ctl->state, memory_order_acquire);
+        if (state != FAHREN_SLOT_DONE && fahren_ipc_server_gone(c->m.h)) return FAHREN_ERROR_NOT_INITIALIZED;
+    }
+    return (FAHRENStatus)ctl->status;
+}
+
+void fahren_ipc_request_end(FAHRENIpcClient* c, FAHRENIpcRequest* req) {
+    if (!fahren_ipc_valid(c, req)) return;
+    FahrenIpcSlot* ctl = &c->m.ctl[req->slot];
+    uint32_t state = atomic_load_explicit(&ctl->state, memory_order_acquire);
+    /* the server may still be writing an in-flight request's outputs */
+    if ((state == FAHREN_SLOT_SUBMITTED || state == FAHREN_SLOT_RUNNING) &&
+        fahren_ipc_request_wait(c, req) == FAHREN_ERROR_NOT_INITIALIZED) {
+        return;
+    }
+    if (state != FAHREN_SLOT_FREE) fahren_ipc_release(&c->m, req->slot);
+    memset(req, 0, sizeof(*req));
+}
+
+FAHRENStatus fahren_ipc_infer(FAHRENIpcClient* c, const float* x, size_t rows, float* y) {
+    if (!c || !x || !y) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t in_dim = c->m.in_dim, out_dim = c->m.out_dim;
+    FAHRENIpcRequest req;
+    /* requests larger than a slot go through in slot-sized pieces */
+    while (rows > 0) {
+        size_t n = rows < c->m.max_rows ? rows : c->m.max_rows;
+        FAHRENStatus st = fahren_ipc_request_begin(c, &req);
+        if (st != FAHREN_SUCCESS) return st;
+        memcpy(req.input, x, n * in_dim * sizeof(float));
+        st = fahren_ipc_request_submit(c, &req, n);
+        if (st == FAHREN_SUCCESS) st = fahren_ipc_request_wait(c, &req);
+        if (st == FAHREN_SUCCESS) memcpy(y, req.output, n * out_dim * sizeof(float));
+        fahren_ipc_request_end(c, &req);
+        if (st != FAHREN_SUCCESS) return st;
+        x += n * in_dim;
+        y += n * out_dim;
+        rows -= n;
+    }
+    return FAHREN_SUCCESS;
+}
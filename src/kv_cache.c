@@ -0,0 +1,233 @@
+/* Paged, reference-counted key/value cache. See include/fahren/kv_cache.h.
+ * Blocks are allocated one at a time as sequences grow and parked on a
+ * free list when their last reference goes away, so steady-state decoding
+ * does not touch the allocator. Not thread-safe: one decoder owns a cache. */
+#include <stdlib.h>
+#include <string.h>
+
+#include <fahren/kv_cache.h>
+
+typedef struct FahrenKVSeq {
+    int live;
+    size_t length;      /* tokens written */
+    int32_t* blocks;    /* block table */
+    size_t block_count;
+    size_t block_cap;
+} FahrenKVSeq;
+
+struct FAHRENKVCache {
+    size_t block_tokens;
+    size_t token_floats;
+    size_t max_blocks;
+
+    float** block_data;   /* indexed by block id; NULL until first use */
+    uint32_t* refcount;
+    size_t block_cap;     /* entries in block_data/refcount */
+    size_t block_total;   /* ids handed out so far */
+    int32_t* free_ids;    /* ids with refcount 0 and storage kept */
+    size_t free_count;
+
+    FahrenKVSeq* seqs;
+    size_t seq_cap;
+
+    FAHRENKVCacheStats stats;
+};
+
+FAHRENKVCache* fahren_kv_cache_create(size_t block_tokens, size_t token_floats, size_t max_blocks) {
+    if (block_tokens == 0 || token_floats == 0) return NULL;
+    if (token_floats > SIZE_MAX / sizeof(float) / block_tokens) return NULL;
+    FAHRENKVCache* c = (FAHRENKVCache*)calloc(1, sizeof(FAHRENKVCache));
+    if (!c) return NULL;
+    c->block_tokens = block_tokens;
+    c->token_floats = token_floats;
+    c->max_blocks = max_blocks;
+    return c;
+}
+
+void fahren_kv_cache_destroy(FAHRENKVCache* c) {
+    if (!c) return;
+    for (size_t i = 0; i < c->block_total; ++i) free(c->block_data[i]);
+    for (size_t i = 0; i < c->seq_cap; ++i) free(c->seqs[i].blocks);
+    free(c->block_data);
+    free(c->refcount);
+    free(c->free_ids);
+    free(c->seqs);
+    free(c);
+}
+
+static int fahren_kv_valid_seq(const FAHRENKVCache* c, int seq) {
+    return c && seq >= 0 && (size_t)seq < c->seq_cap && c->seqs[seq].live;
+}
+
+/* Get a block with refcount 1, reusing a freed one when possible. */
+static int32_t fahren_kv_block_alloc(FAHRENKVCache* c) {
+    if (c->free_count > 0) {
+        int32_t id = c->free_ids[--c->free_count];
+        c->refcount[id] = 1;
+        c->stats.blocks_cached--;
+        c->stats.blocks_in_use++;
+        return id;
+    }
+    if (c->max_blocks && c->block_total >= c->max_blocks) return -1;
+    if (c->block_total >= INT32_MAX) return -1;
+    if (c->block_total == c->block_cap) {
+        size_t cap = c->block_cap ? c->block_cap * 2 : 64;
+        float** data = (float**)realloc(c->block_data, cap * sizeof(float*));
+        if (!data) return -1;
+        c->block_data = data;
+        uint32_t* refs = (uint32_t*)realloc(c->refcount, cap * sizeof(uint32_t));
+        if (!refs) return -1;
+        c->refcount = refs;
+        int32_t* ids = (int32_t*)realloc(c->free_ids, cap * sizeof(int32_t));
+        if (!ids) return -1;
+        c->free_ids = ids;
+        c->block_cap = cap;
+    }
+    float* data = (float*)malloc(c->block_tokens * c->token_floats * sizeof(float));
+    if (!data) return -1;
+    int32_t id = (int32_t)c->block_total++;
+    c->block_data[id] = data;
+    c->refcount[id] = 1;
+    c->stats.blocks_in_use++;
+    return id;
+}
+
+static void fahren_kv_block_release(FAHRENKVCache* c, int32_t id) {
+    if (--c->refcount[id] == 0) {
+        c->free_ids[c->free_count++] = id;
+        c->stats.blocks_in_use--;
+        c->stats.blocks_cached++;
+    }
+}
+
+static FAHRENStatus fahren_kv_seq_slot(FAHRENKVCache* c, int* out_seq) {
+    for (size_t i = 0; i < c->seq_cap; ++i) {
+        if (!c->seqs[i].live) {
+            *out_seq = (int)i;
+            return FAHREN_SUCCESS;
+        }
+    }
+    if (c->seq_cap >= INT32_MAX / 2) return FAHREN_ERROR_PROCESSING_FAILED;
+    size_t cap = c->seq_cap ? c->seq_cap * 2 : 16;
+    FahrenKVSeq* seqs = (FahrenKVSeq*)realloc(c->seqs, cap * sizeof(FahrenKVSeq));
+    if (!seqs) return FAHREN_ERROR_PROCESSING_FAILED;
+    memset(seqs + c->seq_cap, 0, (cap - c->seq_cap) * sizeof(FahrenKVSeq));
+    *out_seq = (int)c->seq_cap;
+    c->seqs = seqs;
+    c->seq_cap = cap;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_kv_seq_new(FAHRENKVCache* c, int* out_seq) {
+    if (!c || !out_seq) return FAHREN_ERROR_INVALID_ARGUMENT;
+    int id;
+    FAHRENStatus st = fahren_kv_seq_slot(c, &id);
+    if (st != FAHREN_SUCCESS) return st;
+    FahrenKVSeq* s = &c->seqs[id];
+    s->live = 1;
+    s->length = 0;
+    s->block_count = 0;
+    c->stats.sequences++;
+    *out_seq = id;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_kv_seq_fork(FAHRENKVCache* c, int src_seq, int* out_seq) {
+    if (!fahren_kv_valid_seq(c, src_seq) || !out_seq) return FAHREN_ERROR_INVALID_ARGUMENT;
+    int id;
+    FAHRENStatus st = fahren_kv_seq_slot(c, &id);
+    if (st != FAHREN_SUCCESS) return st;
+    FahrenKVSeq* src = &c->seqs[src_seq]; /* after slot(): seqs may have moved */
+    FahrenKVSeq* dst = &c->seqs[id];
+    if (dst->block_cap < src->block_count) {
+        int32_t* blocks = (int32_t*)realloc(dst->blocks, src->block_count * sizeof(int32_t));
+        if (!blocks) return FAHREN_ERROR_PROCESSING_FAILED;
+        dst->blocks = blocks;
+        dst->block_cap = src->block_count;
+    }
+    if (src->block_count) memcpy(dst->blocks, src->blocks, src->block_count * sizeof(int32_t));
+    for (size_t i = 0; i < src->block_count; ++i) c->refcount[src->blocks[i]]++;
+    dst->block_count = src->block_count;
+    dst->length = src->length;
+    dst->live = 1;
+    c->stats.sequences++;
+    *out_seq = id;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_kv_seq_free(FAHRENKVCache* c, int seq) {
+    if (!fahren_kv_valid_seq(c, seq)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenKVSeq* s = &c->seqs[seq];
+    for (size_t i = 0; i < s->block_count; ++i) fahren_kv_block_release(c, s->blocks[i]);
+    s->block_count = 0;
+    s->length = 0;
+    s->live = 0;
+    c->stats.sequences--;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_kv_seq_append(FAHRENKVCache* c, int seq, float** out_slot) {
+    if (!fahren_kv_valid_seq(c, seq) || !out_slot) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenKVSeq* s = &c->seqs[seq];
+    size_t row = s->length % c->block_tokens;
+
+    if (row == 0) {
+        /* previous block is full (or there is none): start a fresh one */
+        if (s->block_count == s->block_cap) {
+            size_t cap = s->block_cap ? s->block_cap * 2 : 8;
+            int32_t* blocks = (int32_t*)realloc(s->blocks, cap * sizeof(int32_t));
+            if (!blocks) return FAHREN_ERROR_PROCESSING_FAILED;
+            s->blocks = blocks;
+            s->block_cap = cap;
+        }
+        int32_t id = fahren_kv_block_alloc(c);
+        if (id < 0) return FAHREN_ERROR_PROCESSING_FAILED;
+        s->blocks[s->block_count++] = id;
+    } else {
+        int32_t last = s->blocks[s->block_count - 1];
+        if (c->refcount[last] > 1) {
+            /* copy-on-write: only the rows written so far need copying */
+            int32_t id = fahren_kv_block_alloc(c);
+            if (id < 0) return FAHREN_ERROR_PROCESSING_FAILED;
+            memcpy(c->block_data[id], c->block_data[last], row * c->token_floats * sizeof(float));
+            fahren_kv_block_release(c, last);
+            s->blocks[s->block_count - 1] = id;
+            c->stats.cow_copies++;
+        }
+    }
+
+    int32_t block = s->blocks[s->block_count - 1];
+    *out_slot = c->block_data[block] + row * c->token_floats;
+    s->length++;
+    return FAHREN_SUCCESS;
+}
+
+size_t fahren_kv_seq_length(const FAHRENKVCache* c, int seq) {
+    return fahren_kv_valid_seq(c, seq) ? c->seqs[seq].length : 0;
+}
+
+FAHRENStatus fahren_kv_seq_blocks(const FAHRENKVCache* c, int seq,
+                                  const int32_t** out_blocks, size_t* out_count) {
+    if (!fahren_kv_valid_seq(c, seq) || !out_blocks || !out_count) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *out_blocks = c->seqs[seq].blocks;
+    *out_count = c->seqs[seq].block_count;
+    return FAHREN_SUCCESS;
+}
+
+const float* fahren_kv_block_data(const FAHRENKVCache* c, int32_t block) {
+    if (!c || block < 0 || (size_t)block >= c->block_total) return NULL;
+    return c->block_data[block];
+}
+
+size_t fahren_kv_cache_block_tokens(const FAHRENKVCache* c) {
+    return c ? c->block_tokens : 0;
+}
+
+size_t fahren_kv_cache_token_floats(const FAHRENKVCache* c) {
+    return c ? c->token_floats : 0;
+}
+
+void fahren_kv_cache_stats(const FAHRENKVCache* c, FAHRENKVCacheStats* out) {
+    if (!c || !out) return;
+    *out = c->stats;
+}
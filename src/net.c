@@ -0,0 +1,849 @@
+/* Socket inference server and client. See include/fahren/net.h.
+ * Each loop owns an epoll set, a batch input/output buffer pair and the
+ * connections it accepted. A connection reads frame headers into a small
+ * buffer; once a header is in, the request's rows are reserved in the
+ * batch and the payload is read directly into them, with the next header
+ * picked up by the same readv. When the batch is out of room the
+ * connection is parked (edge-triggered: its socket is left undrained)
+ * and resumed after the next forward pass. A pass runs over every
+ * complete request in the batch; requests still arriving are moved to
+ * the front of the buffer and carry on into the next batch.
+ *
+ * Because rows are reserved when the header arrives, a client that sends
+ * headers and then no payload could hold the batch forever. While other
+ * connections are parked, any request whose payload is more than
+ * FAHREN_NET_PAYLOAD_NS (or the batch window, if that is longer) behind
+ * its header has its connection dropped. A connection whose unsent
+ * responses reach FAHREN_NET_OUT_CAP bytes is not read again until the
+ * socket takes them, so a client that never reads stops being served
+ * instead of growing the server's memory. */
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <fahren/net.h>
+
+#define FAHREN_NET_EVENTS 64
+#define FAHREN_NET_DEFAULT_ROWS 64
+#define FAHREN_NET_DEFAULT_BATCH 256
+#define FAHREN_NET_PAYLOAD_NS 100000000L /* payload may lag its header this long while the batch is full */
+#define FAHREN_NET_OUT_CAP (1u << 20)     /* queued response bytes before reading pauses */
+#define FAHREN_NET_INFER_WINDOW 64        /* pieces fahren_net_infer keeps in flight */
+
+enum { FAHREN_NET_LISTEN = 0, FAHREN_NET_CONN = 1, FAHREN_NET_WAKE = 2 };
+
+typedef struct FahrenNetSource {
+    int kind;
+    int fd;
+} FahrenNetSource;
+
+typedef struct FahrenNetConn {
+    FahrenNetSource src;
+    int closed;
+    int stalled;
+    int paused;                    /* response backlog full: not read until it drains */
+    size_t inflight;               /* batch entries that point here */
+    unsigned char hdr[sizeof(FAHRENNetFrame)];
+    size_t hdr_have;
+    size_t entry;                  /* batch entry receiving the payload */
+    unsigned char* dst;
+    size_t want, have;
+    unsigned char* out;            /* response bytes the socket did not take */
+    size_t out_len, out_off, out_cap;
+    struct FahrenNetConn* next_stalled;
+    struct FahrenNetConn* prev;
+    struct FahrenNetConn* next;
+} FahrenNetConn;
+
+typedef struct FahrenNetEntry {
+    FahrenNetConn* conn;
+    uint32_t id;
+    size_t row0, rows;
+    long since_ns; /* when the header arrived */
+    int complete;
+} FahrenNetEntry;
+
+typedef struct FahrenNetLoop {
+    FAHRENNetServer* server;
+    size_t index;
+    int epfd;
+    FahrenNetSource tcp;
+    float* batch_in;
+    float* batch_out;
+    FahrenNetEntry* entries;
+    size_t entry_count, batch_rows, complete_count;
+    long first_ns;
+    int evicted; /* laggards were dropped: their rows want a flush */
+    FahrenNetConn* stalled_head;
+    FahrenNetConn* stalled_tail;
+    FahrenNetConn* conns;
+    pthread_t thread;
+} FahrenNetLoop;
+
+struct FAHRENNetServer {
+    FAHRENRuntime* rt;
+    size_t in_dim, out_dim, max_rows, max_batch;
+    unsigned window_us;
+    int tcp_port;
+    FahrenNetSource unix_src;
+    FahrenNetSource wake;
+    char unix_path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+    atomic_int stopping;
+    size_t loop_count;
+    FahrenNetLoop* loops;
+};
+
+struct FAHRENNetClient {
+    int fd;
+    FAHRENNetHello hello;
+};
+
+static long fahren_net_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/* Split "unix:PATH", "[tcp:]host:port" or "port" into its parts. */
+static int fahren_net_parse_address(const char* address, char* host, size_t host_cap, int* port,
+                                    const char** unix_path) {
+    *unix_path = NULL;
+    if (strncmp(address, "unix:", 5) == 0) {
+        *unix_path = address + 5;
+        return **unix_path != '\0';
+    }
+    if (strncmp(address, "tcp:", 4) == 0) address += 4;
+    const char* colon = strrchr(address, ':');
+    const char* port_str = colon ? colon + 1 : address;
+    size_t host_len = colon ? (size_t)(colon - address) : 0;
+    char* end;
+    long p = strtol(port_str, &end, 10);
+    if (end == port_str || *end || p < 0 || p > 65535 || host_len >= host_cap) return 0;
+    if (host_len) memcpy(host, address, host_len);
+    else host_len = (size_t)snprintf(host, host_cap, "127.0.0.1");
+    host[host_len] = '\0';
+    *port = (int)p;
+    return 1;
+}
+
+/* ---- server: connections ------------------------------------------------ */
+
+static void fahren_net_conn_free(FahrenNetLoop* l, FahrenNetConn* c) {
+    if (c->prev) c->prev->next = c->next;
+    else l->conns = c->next;
+    if (c->next) c->next->prev = c->prev;
+    free(c->out);
+    free(c);
+}
+
+/* Freed as soon as no batch entry and no stall list points at it. */
+static void fahren_net_conn_release(FahrenNetLoop* l, FahrenNetConn* c) {
+    if (c->closed && c->inflight == 0 && !c->stalled) fahren_net_conn_free(l, c);
+}
+
+static void fahren_net_conn_close(FahrenNetLoop* l, FahrenNetConn* c) {
+    if (c->closed) return;
+    epoll_ctl(l->epfd, EPOLL_CTL_DEL, c->src.fd, NULL);
+    close(c->src.fd);
+    c->src.fd = -1;
+    c->closed = 1;
+}
+
+/* writev that reports a hung-up peer as EPIPE instead of raising SIGPIPE */
+static ssize_t fahren_net_sendv(int fd, struct iovec* iov, int cnt) {
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = (size_t)cnt;
+    return sendmsg(fd, &msg, MSG_NOSIGNAL);
+}
+
+static void fahren_net_conn_flush(FahrenNetLoop* l, FahrenNetConn* c) {
+    while (!c->closed && c->out_off < c->out_len) {
+        ssize_t n = send(c->src.fd, c->out + c->out_off, c->out_len - c->out_off, MSG_NOSIGNAL);
+        if (n > 0) {
+            c->out_off += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (n < 0 && errno == EAGAIN) return; /* EPOLLOUT resumes */
+            fahren_net_conn_close(l, c);
+        }
+    }
+    c->out_off = c->out_len = 0;
+}
+
+/* Send a response, directly when nothing is queued ahead of it. */
+static void fahren_net_conn_send(FahrenNetLoop* l, FahrenNetConn* c, const void* a, size_t a_len, const void* b,
+                                 size_t b_len) {
+    if (c->closed) return;
+    size_t sent = 0;
+    if (c->out_len == c->out_off) {
+        struct iovec iov[2] = {{(void*)a, a_len}, {(void*)b, b_len}};
+        for (;;) {
+            ssize_t n = fahren_net_sendv(c->src.fd, iov, b_len ? 2 : 1);
+            if (n >= 0) {
+                sent = (size_t)n;
+            } else if (errno == EINTR) {
+                continue;
+            } else if (errno != EAGAIN) {
+                fahren_net_conn_close(l, c);
+                return;
+            }
+            break;
+        }
+        if (sent == a_len + b_len) return;
+        c->out_off = c->out_len = 0;
+    }
+    size_t need = c->out_len + a_len + b_len - sent;
+    if (need > c->out_cap) {
+        size_t cap = c->out_cap ? c->out_cap : 4096;
+        while (cap < need) cap *= 2;
+        unsigned char* out = (unsigned char*)realloc(c->out, cap);
+        if (!out) {
+            fahren_net_conn_close(l, c);
+            return;
+        }
+        c->out = out;
+        c->out_cap = cap;
+    }
+    if (sent < a_len) {
+        memcpy(c->out + c->out_len, (const unsigned char*)a + sent, a_len - sent);
+        c->out_len += a_len - sent;
+        sent = 0;
+    } else {
+        sent -= a_len;
+    }
+    memcpy(c->out + c->out_len, (const unsigned char*)b + sent, b_len - sent);
+    c->out_len += b_len - sent;
+}
+
+static void fahren_net_stall(FahrenNetLoop* l, FahrenNetConn* c) {
+    if (c->stalled) return;
+    c->stalled = 1;
+    c->next_stalled = NULL;
+    if (l->stalled_tail) l->stalled_tail->next_stalled = c;
+    else l->stalled_head = c;
+    l->stalled_tail = c;
+}
+
+/* A full header is in: reserve the payload's rows in the batch. */
+static int fahren_net_begin_frame(FahrenNetLoop* l, FahrenNetConn* c) {
+    FAHRENNetServer* s = l->server;
+    FAHRENNetFrame f;
+    memcpy(&f, c->hdr, sizeof(f));
+    if (f.rows == 0 || f.rows > s->max_rows) {
+        fahren_net_conn_close(l, c);
+        return 0;
+    }
+    if (l->batch_rows + f.rows > s->max_batch) {
+        fahren_net_stall(l, c);
+        return 0;
+    }
+    long now = fahren_net_now_ns();
+    if (l->entry_count == 0) l->first_ns = now;
+    FahrenNetEntry* e = &l->entries[l->entry_count];
+    e->conn = c;
+    e->id = f.id;
+    e->row0 = l->batch_rows;
+    e->rows = f.rows;
+    e->since_ns = now;
+    e->complete = 0;
+    c->entry = l->entry_count++;
+    c->inflight++;
+    c->dst = (unsigned char*)(l->batch_in + e->row0 * s->in_dim);
+    c->want = f.rows * s->in_dim * sizeof(float);
+    c->have = 0;
+    c->hdr_have = 0;
+    l->batch_rows += f.rows;
+    return 1;
+}
+
+static void fahren_net_conn_read(FahrenNetLoop* l, FahrenNetConn* c) {
+    while (!c->closed) {
+        c->paused = c->want == 0 && c->out_len - c->out_off >= FAHREN_NET_OUT_CAP;
+        if (c->paused) return; /* resumed by fahren_net_conn_flush's caller */
+        if (c->want == 0 && c->hdr_have == sizeof(c->hdr)) {
+            if (!fahren_net_begin_frame(l, c)) return;
+        }
+        struct iovec iov[2];
+        int cnt = 0;
+        if (c->want) {
+            iov[cnt].iov_base = c->dst + c->have;
+            iov[cnt++].iov_len = c->want - c->have;
+        }
+        iov[cnt].iov_base = c->hdr + c->hdr_have;
+        iov[cnt++].iov_len = sizeof(c->hdr) - c->hdr_have;
+        ssize_t n = readv(c->src.fd, iov, cnt);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) return;
+        if (n <= 0) {
+            fahren_net_conn_close(l, c);
+            return;
+        }
+        size_t got = (size_t)n;
+        if (c->want) {
+            size_t take = got < c->want - c->have ? got : c->want - c->have;
+            c->have += take;
+            got -= take;
+            if (c->have == c->want) {
+                l->entries[c->entry].complete = 1;
+                l->complete_count++;
+                c->want = c->have = 0;
+                c->dst = NULL;
+            }
+        }
+        c->hdr_have += got;
+    }
+}
+
+static void fahren_net_accept(FahrenNetLoop* l, int listen_fd) {
+    FAHRENNetServer* s = l->server;
+    for (;;) {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return; /* EAGAIN, or out of descriptors: try again on the next event */
+        }
+        int one = 1;
+        (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); /* fails harmlessly on AF_UNIX */
+        FahrenNetConn* c = (FahrenNetConn*)calloc(1, sizeof(FahrenNetConn));
+        if (!c) {
+            close(fd);
+            continue;
+        }
+        c->src.kind = FAHREN_NET_CONN;
+        c->src.fd = fd;
+        c->next = l->conns;
+        if (l->conns) l->conns->prev = c;
+        l->conns = c;
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = &c->src;
+        if (epoll_ctl(l->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            fahren_net_conn_free(l, c);
+            continue;
+        }
+        FAHRENNetHello hello = {FAHREN_NET_MAGIC, FAHREN_NET_VERSION, (uint32_t)s->in_dim, (uint32_t)s->out_dim,
+                                (uint32_t)s->max_rows};
+        fahren_net_conn_send(l, c, &hello, sizeof(hello), NULL, 0);
+        fahren_net_conn_release(l, c);
+    }
+}
+
+/* ---- server: batching --------------------------------------------------- */
+
+static void fahren_net_flush(FahrenNetLoop* l) {
+    FAHRENNetServer* s = l->server;
+    size_t in_dim = s->in_dim, out_dim = s->out_dim;
+
+    /* one forward pass per run of consecutive complete requests; a
+     * request still arriving in the middle splits the batch, and requests
+     * whose client has already hung up are not computed at all */
+    for (size_t i = 0; i < l->entry_count;) {
+        if (!l->entries[i].complete || l->entries[i].conn->closed) {
+            ++i;
+            continue;
+        }
+        size_t j = i, rows = 0;
+        while (j < l->entry_count && l->entries[j].complete && !l->entries[j].conn->closed) {
+            rows += l->entries[j++].rows;
+        }
+        size_t row0 = l->entries[i].row0;
+        FAHRENStatus st =
+            fahren_runtime_forward(s->rt, l->batch_in + row0 * in_dim, rows, l->batch_out + row0 * out_dim);
+        for (; i < j; ++i) {
+            FahrenNetEntry* e = &l->entries[i];
+            FAHRENNetFrame f = {e->id, (uint16_t)(st == FAHREN_SUCCESS ? e->rows : 0), (uint16_t)st};
+            size_t bytes = st == FAHREN_SUCCESS ? e->rows * out_dim * sizeof(float) : 0;
+            fahren_net_conn_send(l, e->conn, &f, sizeof(f), l->batch_out + e->row0 * out_dim, bytes);
+        }
+    }
+
+    size_t kept = 0, rows = 0;
+    for (size_t i = 0; i < l->entry_count; ++i) {
+        FahrenNetEntry e = l->entries[i];
+        FahrenNetConn* c = e.conn;
+        if (e.complete || c->closed) {
+            c->inflight--;
+            if (!e.complete) c->want = c->have = 0;
+            fahren_net_conn_release(l, c);
+            continue;
+        }
+        if (e.row0 != rows) {
+            memmove(l->batch_in + rows * in_dim, l->batch_in + e.row0 * in_dim, c->have);
+            c->dst = (unsigned char*)(l->batch_in + rows * in_dim);
+        }
+        e.row0 = rows;
+        rows += e.rows;
+        c->entry = kept;
+        l->entries[kept++] = e;
+    }
+    l->entry_count = kept;
+    l->batch_rows = rows;
+    l->complete_count = 0;
+    l->evicted = 0;
+    if (kept) l->first_ns = fahren_net_now_ns();
+}
+
+static long fahren_net_payload_ns(const FAHRENNetServer* s) {
+    long window = (long)s->window_us * 1000L;
+    return window > FAHREN_NET_PAYLOAD_NS ? window : FAHREN_NET_PAYLOAD_NS;
+}
+
+/* The batch is full and connections are parked: drop the ones whose
+ * payload is overdue, so their rows come free at the next flush. */
+static void fahren_net_evict(FahrenNetLoop* l) {
+    long now = fahren_net_now_ns(), limit = fahren_net_payload_ns(l->server);
+    for (size_t i = 0; i < l->entry_count; ++i) {
+        FahrenNetEntry* e = &l->entries[i];
+        if (e->complete) continue;
+        if (!e->conn->closed && now - e->since_ns >= limit) fahren_net_conn_close(l, e->conn);
+        if (e->conn->closed) l->evicted = 1;
+    }
+}
+
+static int fahren_net_due(const FahrenNetLoop* l) {
+    const FAHRENNetServer* s = l->server;
+    if (l->complete_count == 0 && !l->evicted) return 0;
+    return s->window_us == 0 || l->stalled_head || l->batch_rows >= s->max_batch ||
+           fahren_net_now_ns() - l->first_ns >= (long)s->window_us * 1000L;
+}
+
+/* epoll timeout in ms: block when idle, poll while a window is open or
+ * until the oldest payload is overdue while connections are parked */
+static int fahren_net_timeout(const FahrenNetLoop* l) {
+    const FAHRENNetServer* s = l->server;
+    long now = fahren_net_now_ns(), left = LONG_MAX;
+    if (l->complete_count) left = (long)s->window_us * 1000L - (now - l->first_ns);
+    for (size_t i = 0; l->stalled_head && i < l->entry_count; ++i) {
+        if (l->entries[i].complete) continue;
+        long overdue = fahren_net_payload_ns(s) - (now - l->entries[i].since_ns); /* entries are oldest first */
+        if (overdue < left) left = overdue;
+        break;
+    }
+    if (left == LONG_MAX) return -1;
+    return left >= 1000000L ? (int)(left / 1000000L) : 0;
+}
+
+static void* fahren_net_loop_run(void* arg) {
+    FahrenNetLoop* l = (FahrenNetLoop*)arg;
+    FAHRENNetServer* s = l->server;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 1 && s->loop_count <= (size_t)cpus) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET((int)l->index, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    struct epoll_event events[FAHREN_NET_EVENTS];
+    while (!atomic_load_explicit(&s->stopping, memory_order_relaxed)) {
+        int n = epoll_wait(l->epfd, events, FAHREN_NET_EVENTS, fahren_net_timeout(l));
+        for (int i = 0; i < n; ++i) {
+            FahrenNetSource* src = (FahrenNetSource*)events[i].data.ptr;
+            if (src->kind == FAHREN_NET_LISTEN) {
+                fahren_net_accept(l, src->fd);
+            } else if (src->kind == FAHREN_NET_CONN) {
+                FahrenNetConn* c = (FahrenNetConn*)src;
+                if (events[i].events & EPOLLOUT) fahren_net_conn_flush(l, c);
+                if (c->paused || (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+                    fahren_net_conn_read(l, c);
+                }
+                fahren_net_conn_release(l, c);
+            }
+        }
+        if (l->stalled_head) fahren_net_evict(l);
+        while (fahren_net_due(l)) {
+            fahren_net_flush(l);
+            /* parked connections go first into the fresh batch */
+            FahrenNetConn* c = l->stalled_head;
+            l->stalled_head = l->stalled_tail = NULL;
+            while (c) {
+                FahrenNetConn* next = c->next_stalled;
+                c->stalled = 0;
+                fahren_net_conn_read(l, c);
+                fahren_net_conn_release(l, c);
+                c = next;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* ---- server: setup ------------------------------------------------------ */
+
+static int fahren_net_tcp_listen(const char* host, int port) {
+    struct addrinfo hints, *res = NULL;
+    char port_str[16];
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    snprintf(port_str, sizeof(port_str), "%d", port);
+    if (getaddrinfo(host, port_str, &hints, &res) != 0) return -1;
+    int fd = socket(res->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    if (fd >= 0 && (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+                    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0 ||
+                    bind(fd, res->ai_addr, res->ai_addrlen) != 0 || listen(fd, SOMAXCONN) != 0)) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+static int fahren_net_bound_port(int fd) {
+    struct sockaddr_storage ss;
+    socklen_t len = sizeof(ss);
+    if (getsockname(fd, (struct sockaddr*)&ss, &len) != 0) return -1;
+    if (ss.ss_family == AF_INET) return ntohs(((struct sockaddr_in*)&ss)->sin_port);
+    if (ss.ss_family == AF_INET6) return ntohs(((struct sockaddr_in6*)&ss)->sin6_port);
+    return -1;
+}
+
+static int fahren_net_unix_listen(const char* path, char* saved, size_t cap) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path) || strlen(path) >= cap) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    (void)unlink(path); /* left behind by a previous server */
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    strcpy(saved, path);
+    return fd;
+}
+
+static int fahren_net_watch(int epfd, FahrenNetSource* src, uint32_t events) {
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.ptr = src;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, src->fd, &ev);
+}
+
+FAHRENStatus fahren_net_server_create(FAHRENRuntime* rt, const FAHRENNetServerConfig* config,
+                                      FAHRENNetServer** out) {
+    if (!rt || !config || !out || (!config->tcp_address && !config->unix_path)) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    *out = NULL;
+    size_t max_rows = config->max_rows ? config->max_rows : FAHREN_NET_DEFAULT_ROWS;
+    size_t max_batch = config->max_batch_rows ? config->max_batch_rows : FAHREN_NET_DEFAULT_BATCH;
+    if (max_rows > FAHREN_NET_MAX_ROWS || max_batch < max_rows) return FAHREN_ERROR_INVALID_ARGUMENT;
+    char host[256];
+    int port = 0;
+    const char* unused;
+    if (config->tcp_address &&
+        (!fahren_net_parse_address(config->tcp_address, host, sizeof(host), &port, &unused) || unused)) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+
+    FAHRENNetServer* s = (FAHRENNetServer*)calloc(1, sizeof(FAHRENNetServer));
+    if (!s) return FAHREN_ERROR_PROCESSING_FAILED;
+    s->rt = rt;
+    s->in_dim = fahren_runtime_input_dim(rt);
+    s->out_dim = fahren_runtime_output_dim(rt);
+    s->max_rows = max_rows;
+    s->max_batch = max_batch;
+    s->window_us = config->batch_window_us;
+    s->unix_src.kind = FAHREN_NET_LISTEN;
+    s->unix_src.fd = -1;
+    s->wake.kind = FAHREN_NET_WAKE;
+    s->wake.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    s->loop_count = config->loops ? config->loops : (cpus > 0 ? (size_t)cpus : 1);
+    s->loops = (FahrenNetLoop*)calloc(s->loop_count, sizeof(FahrenNetLoop));
+    if (!s->loops || s->wake.fd < 0) {
+        fahren_net_server_destroy(s);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    for (size_t i = 0; i < s->loop_count; ++i) {
+        s->loops[i].epfd = -1;
+        s->loops[i].tcp.fd = -1;
+    }
+
+    FAHRENStatus st = FAHREN_SUCCESS;
+    if (config->unix_path) {
+        s->unix_src.fd = fahren_net_unix_listen(config->unix_path, s->unix_path, sizeof(s->unix_path));
+        if (s->unix_src.fd < 0) st = FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    for (size_t i = 0; i < s->loop_count && st == FAHREN_SUCCESS; ++i) {
+        FahrenNetLoop* l = &s->loops[i];
+        l->server = s;
+        l->index = i;
+        l->epfd = epoll_create1(EPOLL_CLOEXEC);
+        l->batch_in = (float*)calloc(max_batch * s->in_dim, sizeof(float));
+        l->batch_out = (float*)malloc(max_batch * s->out_dim * sizeof(float));
+        l->entries = (FahrenNetEntry*)malloc(max_batch * sizeof(FahrenNetEntry));
+        if (l->epfd < 0 || !l->batch_in || !l->batch_out || !l->entries ||
+            fahren_net_watch(l->epfd, &s->wake, EPOLLIN) != 0) {
+            st = FAHREN_ERROR_PROCESSING_FAILED;
+            break;
+        }
+        if (config->tcp_address) {
+            /* the first bind settles the port when 0 was asked for */
+            l->tcp.kind = FAHREN_NET_LISTEN;
+            l->tcp.fd = fahren_net_tcp_listen(host, i ? s->tcp_port : port);
+            if (l->tcp.fd < 0 || fahren_net_watch(l->epfd, &l->tcp, EPOLLIN) != 0) {
+                st = FAHREN_ERROR_PROCESSING_FAILED;
+                break;
+            }
+            if (i == 0) s->tcp_port = fahren_net_bound_port(l->tcp.fd);
+        }
+        if (s->unix_src.fd >= 0 && fahren_net_watch(l->epfd, &s->unix_src, EPOLLIN | EPOLLEXCLUSIVE) != 0) {
+            st = FAHREN_ERROR_PROCESSING_FAILED;
+        }
+    }
+    if (st != FAHREN_SUCCESS) {
+        fahren_net_server_destroy(s);
+        return st;
+    }
+    *out = s;
+    return FAHREN_SUCCESS;
+}
+
+int fahren_net_server_tcp_port(const FAHRENNetServer* s) {
+    return s && s->tcp_port > 0 ? s->tcp_port : 0;
+}
+
+FAHRENStatus fahren_net_server_run(FAHRENNetServer* s) {
+    if (!s) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t started = 1;
+    for (; started < s->loop_count; ++started) {
+        if (pthread_create(&s->loops[started].thread, NULL, fahren_net_loop_run, &s->loops[started]) != 0) break;
+    }
+    /* loops that could not be started are simply absent; their TCP
+     * listeners stay in the reuseport group, so close them */
+    for (size_t i = started; i < s->loop_count; ++i) {
+        if (s->loops[i].tcp.fd >= 0) close(s->loops[i].tcp.fd);
+        s->loops[i].tcp.fd = -1;
+    }
+    fahren_net_loop_run(&s->loops[0]);
+    for (size_t i = 1; i < started; ++i) pthread_join(s->loops[i].thread, NULL);
+    return FAHREN_SUCCESS;
+}
+
+void fahren_net_server_stop(FAHRENNetServer* s) {
+    if (!s) return;
+    atomic_store(&s->stopping, 1);
+    uint64_t one = 1;
+    ssize_t r = write(s->wake.fd, &one, sizeof(one)); /* level-triggered: wakes every loop */
+    (void)r;
+}
+
+void fahren_net_server_destroy(FAHRENNetServer* s) {
+    if (!s) return;
+    for (size_t i = 0; s->loops && i < s->loop_count; ++i) {
+        FahrenNetLoop* l = &s->loops[i];
+        while (l->conns) {
+            FahrenNetConn* c = l->conns;
+            if (!c->closed) close(c->src.fd);
+            fahren_net_conn_free(l, c);
+        }
+        if (l->tcp.fd >= 0) close(l->tcp.fd);
+        if (l->epfd >= 0) close(l->epfd);
+        free(l->batch_in);
+        free(l->batch_out);
+        free(l->entries);
+    }
+    if (s->unix_src.fd >= 0) {
+        close(s->unix_src.fd);
+        unlink(s->unix_path);
+    }
+    if (s->wake.fd >= 0) close(s->wake.fd);
+    free(s->loops);
+    free(s);
+}
+
+/* ---- client ------------------------------------------------------------- */
+
+static int fahren_net_read_full(int fd, void* buf, size_t len) {
+    unsigned char* p = (unsigned char*)buf;
+    while (len) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+static int fahren_net_write_full(int fd, struct iovec* iov, int cnt) {
+    while (cnt) {
+        ssize_t n = fahren_net_sendv(fd, iov, cnt);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return 0;
+        size_t left = (size_t)n;
+        while (cnt && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            ++iov;
+            --cnt;
+        }
+        if (cnt) {
+            iov->iov_base = (unsigned char*)iov->iov_base + left;
+            iov->iov_len -= left;
+        }
+    }
+    return 1;
+}
+
+FAHRENStatus fahren_net_connect(const char* address, FAHRENNetClient** out) {
+    if (!address || !out) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *out = NULL;
+    char host[256];
+    int port = 0;
+    const char* unix_path;
+    if (!fahren_net_parse_address(address, host, sizeof(host), &port, &unix_path)) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    int fd = -1;
+    if (unix_path) {
+        struct sockaddr_un addr;
+        if (strlen(unix_path) >= sizeof(addr.sun_path)) return FAHREN_ERROR_INVALID_ARGUMENT;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, unix_path);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    } else {
+        struct addrinfo hints, *res = NULL;
+        char port_str[16];
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_NUMERICSERV;
+        snprintf(port_str, sizeof(port_str), "%d", port);
+        if (getaddrinfo(host, port_str, &hints, &res) != 0) return FAHREN_ERROR_NOT_INITIALIZED;
+        fd = socket(res->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+        freeaddrinfo(res);
+        int one = 1;
+        if (fd >= 0) (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    if (fd < 0) return FAHREN_ERROR_NOT_INITIALIZED;
+
+    FAHRENNetClient* c = (FAHRENNetClient*)calloc(1, sizeof(FAHRENNetClient));
+    if (!c) {
+        close(fd);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    c->fd = fd;
+    if (!fahren_net_read_full(fd, &c->hello, sizeof(c->hello)) || c->hello.magic != FAHREN_NET_MAGIC ||
+        c->hello.version != FAHREN_NET_VERSION || c->hello.max_rows == 0) {
+        fahren_net_disconnect(c);
+        return FAHREN_ERROR_NOT_INITIALIZED;
+    }
+    *out = c;
+    return FAHREN_SUCCESS;
+}
+
+void fahren_net_disconnect(FAHRENNetClient* c) {
+    if (!c) return;
+    close(c->fd);
+    free(c);
+}
+
+size_t fahren_net_input_dim(const FAHRENNetClient* c) {
+    return c ? c->hello.input_dim : 0;
+}
+
+size_t fahren_net_output_dim(const FAHRENNetClient* c) {
+    return c ? c->hello.output_dim : 0;
+}
+
+size_t fahren_net_max_rows(const FAHRENNetClient* c) {
+    return c ? c->hello.max_rows : 0;
+}
+
+FAHRENStatus fahren_net_send(FAHRENNetClient* c, uint32_t id, const float* x, size_t rows) {
+    if (!c || !x || rows == 0 || rows > c->hello.max_rows) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FAHRENNetFrame f = {id, (uint16_t)rows, 0};
+    struct iovec iov[2] = {{&f, sizeof(f)}, {(void*)x, rows * c->hello.input_dim * sizeof(float)}};
+    return fahren_net_write_full(c->fd, iov, 2) ? FAHREN_SUCCESS : FAHREN_ERROR_PROCESSING_FAILED;
+}
+
+FAHRENStatus fahren_net_recv(FAHRENNetClient* c, uint32_t* id, float* y, size_t* rows) {
+    if (!c || !y) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FAHRENNetFrame f;
+    if (!fahren_net_read_full(c->fd, &f, sizeof(f)) || f.rows > c->hello.max_rows ||
+        !fahren_net_read_full(c->fd, y, f.rows * c->hello.output_dim * sizeof(float))) {
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    if (id) *id = f.id;
+    if (rows) *rows = f.rows;
+    return (FAHRENStatus)f.status;
+}
+
+FAHRENStatus fahren_net_infer(FAHRENNetClient* c, const float* x, size_t rows, float* y) {
+    if (!c || !x || !y) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t max_rows = c->hello.max_rows, in_dim = c->hello.input_dim, out_dim = c->hello.output_dim;
+    size_t pieces = (rows + max_rows - 1) / max_rows;
+    if (pieces > UINT32_MAX) return FAHREN_ERROR_INVALID_ARGUMENT;
+    /* Pipeline a bounded window of pieces: the server stops reading a
+     * connection once FAHREN_NET_OUT_CAP bytes of responses wait unread,
+     * so sending everything before reading anything would deadlock on a
+     * large call. A quarter of the cap keeps well clear of it. */
+    size_t piece_bytes = sizeof(FAHRENNetFrame) + max_rows * out_dim * sizeof(float);
+    size_t window = FAHREN_NET_OUT_CAP / 4 / piece_bytes;
+    if (window > FAHREN_NET_INFER_WINDOW) window = FAHREN_NET_INFER_WINDOW;
+    if (window == 0) window = 1;
+    unsigned char seen[FAHREN_NET_INFER_WINDOW] = {0}; /* by id % window, for ids in [base, sent) */
+    size_t base = 0, sent = 0;
+    FAHRENStatus result = FAHREN_SUCCESS;
+    while (base < pieces) {
+        for (; sent < pieces && sent < base + window; ++sent) {
+            size_t n = rows - sent * max_rows < max_rows ? rows - sent * max_rows : max_rows;
+            FAHRENStatus st = fahren_net_send(c, (uint32_t)sent, x + sent * max_rows * in_dim, n);
+            if (st != FAHREN_SUCCESS) return st;
+        }
+        /* responses are placed by id; an id that is not outstanding, or a
+         * row count that does not match its piece, means the stream is
+         * out of step and nothing after it can be trusted */
+        FAHRENNetFrame f;
+        if (!fahren_net_read_full(c->fd, &f, sizeof(f))) return FAHREN_ERROR_PROCESSING_FAILED;
+        size_t id = f.id;
+        if (id < base || id >= sent || seen[id % window]) return FAHREN_ERROR_PROCESSING_FAILED;
+        size_t n = rows - id * max_rows < max_rows ? rows - id * max_rows : max_rows;
+        if (f.status == FAHREN_SUCCESS ? f.rows != n : f.rows != 0) return FAHREN_ERROR_PROCESSING_FAILED;
+        if (!fahren_net_read_full(c->fd, y + id * max_rows * out_dim, f.rows * out_dim * sizeof(float))) {
+            return FAHREN_ERROR_PROCESSING_FAILED;
+        }
+        if (f.status == FAHREN_ERROR_PROCESSING_FAILED) return FAHREN_ERROR_PROCESSING_FAILED;
+        if (f.status != FAHREN_SUCCESS && result == FAHREN_SUCCESS) result = (FAHRENStatus)f.status;
+        seen[id % window] = 1;
+        while (base < sent && seen[base % window]) seen[base++ % window] = 0;
+    }
+    return result;
+}
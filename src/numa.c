@@ -0,0 +1,273 @@
+/* NUMA topology, node-local memory and node-pinned worker groups.
+ * Topology comes from /sys/devices/system/node; without it the machine
+ * is one node. FAHREN_NUMA_NODES overrides the node count (extra logical
+ * nodes reuse the real ones round-robin), which is handy for exercising
+ * split layers on a single-socket box. Each node gets its own workers
+ * pinned to that node's CPUs; a node loop hands every node its own index
+ * range and only that node's workers take chunks from it, so a node's
+ * data is only ever touched from its own CPUs. With a host executor
+ * installed the pinned workers are never started: node loops run as one
+ * flat fahren_parallel_for over the concatenated ranges, trading
+ * locality for not oversubscribing the host's cores. */
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "fahren_internal.h"
+
+#define FAHREN_NUMA_MPOL_BIND 2
+#define FAHREN_NUMA_MF_MOVE (1 << 1)
+
+typedef struct FahrenNodeJob {
+    fahren_node_fn fn;
+    void* ctx;
+    size_t n[FAHREN_NUMA_MAX_NODES];
+    size_t chunk[FAHREN_NUMA_MAX_NODES];
+    atomic_size_t next[FAHREN_NUMA_MAX_NODES];
+    size_t pending;  /* workers that have not finished this loop (under lock) */
+} FahrenNodeJob;
+
+typedef struct FahrenNumaPool {
+    size_t nodes;
+    int os_node[FAHREN_NUMA_MAX_NODES];     /* kernel node id backing each logical node */
+    cpu_set_t cpus[FAHREN_NUMA_MAX_NODES];
+    size_t threads[FAHREN_NUMA_MAX_NODES];
+    size_t total_threads;
+    int started;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;
+    pthread_cond_t done_cv;
+    pthread_mutex_t job_lock;
+    uint64_t generation;
+    FahrenNodeJob* job;
+} FahrenNumaPool;
+
+typedef struct FahrenNodeWorker {
+    FahrenNumaPool* pool;
+    size_t node;
+} FahrenNodeWorker;
+
+static FahrenNumaPool g_numa;
+static pthread_once_t g_numa_topology_once = PTHREAD_ONCE_INIT;
+static pthread_once_t g_numa_pool_once = PTHREAD_ONCE_INIT;
+
+/* Parse a sysfs cpulist such as "0-3,8-11". */
+static int fahren_numa_parse_cpulist(const char* path, cpu_set_t* set) {
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    char buf[4096];
+    size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[len] = '\0';
+    CPU_ZERO(set);
+    char* p = buf;
+    while (*p) {
+        char* end;
+        long a = strtol(p, &end, 10);
+        if (end == p) break;
+        long b = a;
+        p = end;
+        if (*p == '-') {
+            b = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long c = a; c <= b && c < CPU_SETSIZE; ++c) CPU_SET((int)c, set);
+        if (*p == ',') ++p;
+        else break;
+    }
+    return CPU_COUNT(set) > 0;
+}
+
+static void fahren_numa_discover(void) {
+    FahrenNumaPool* p = &g_numa;
+    int real_ids[FAHREN_NUMA_MAX_NODES];
+    cpu_set_t real_cpus[FAHREN_NUMA_MAX_NODES];
+    size_t real = 0;
+    for (int id = 0; id < 256 && real < FAHREN_NUMA_MAX_NODES; ++id) {
+        char path[96];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", id);
+        if (fahren_numa_parse_cpulist(path, &real_cpus[real])) real_ids[real++] = id;
+    }
+    if (real == 0) {
+        if (sched_getaffinity(0, sizeof(cpu_set_t), &real_cpus[0]) != 0 || CPU_COUNT(&real_cpus[0]) == 0) {
+            CPU_ZERO(&real_cpus[0]);
+            CPU_SET(0, &real_cpus[0]);
+        }
+        real_ids[0] = -1; /* unknown: no memory binding */
+        real = 1;
+    }
+    size_t nodes = real;
+    const char* env = getenv("FAHREN_NUMA_NODES");
+    if (env && atoi(env) > 0) nodes = (size_t)atoi(env);
+    if (nodes > FAHREN_NUMA_MAX_NODES) nodes = FAHREN_NUMA_MAX_NODES;
+    p->nodes = nodes;
+    for (size_t i = 0; i < nodes; ++i) {
+        p->os_node[i] = real_ids[i % real];
+        p->cpus[i] = real_cpus[i % real];
+        p->threads[i] = (size_t)CPU_COUNT(&p->cpus[i]);
+        if (p->threads[i] == 0) p->threads[i] = 1;
+    }
+}
+
+size_t fahren_numa_node_count(void) {
+    pthread_once(&g_numa_topology_once, fahren_numa_discover);
+    return g_numa.nodes;
+}
+
+void* fahren_numa_alloc(size_t bytes, size_t node) {
+    fahren_numa_node_count();
+    if (bytes == 0) bytes = 1;
+    void* mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return NULL;
+#if defined(SYS_mbind)
+    if (node < g_numa.nodes && g_numa.os_node[node] >= 0 && g_numa.os_node[node] < 64) {
+        unsigned long mask = 1UL << g_numa.os_node[node];
+        /* best effort: without it first touch from the node's workers still
+         * places the pages locally */
+        (void)syscall(SYS_mbind, mem, bytes, FAHREN_NUMA_MPOL_BIND, &mask, 64UL, FAHREN_NUMA_MF_MOVE);
+    }
+#else
+    (void)node;
+#endif
+    return mem;
+}
+
+void fahren_numa_free(void* mem, size_t bytes) {
+    if (!mem) return;
+    munmap(mem, bytes ? bytes : 1);
+}
+
+static void fahren_node_drain(FahrenNodeJob* job, size_t node) {
+    for (;;) {
+        size_t begin = atomic_fetch_add(&job->next[node], job->chunk[node]);
+        if (begin >= job->n[node]) break;
+        size_t end = job->n[node] - begin > job->chunk[node] ? begin + job->chunk[node] : job->n[node];
+        job->fn(job->ctx, node, begin, end);
+    }
+}
+
+static void* fahren_node_worker(void* arg) {
+    FahrenNodeWorker* w = (FahrenNodeWorker*)arg;
+    FahrenNumaPool* p = w->pool;
+    size_t node = w->node;
+    free(w);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &p->cpus[node]);
+    uint64_t seen = 0;
+    for (;;) {
+        pthread_mutex_lock(&p->lock);
+        while (p->generation == seen) pthread_cond_wait(&p->work_cv, &p->lock);
+        seen = p->generation;
+        FahrenNodeJob* job = p->job;
+        pthread_mutex_unlock(&p->lock);
+        if (!job) continue;
+
+        fahren_node_drain(job, node);
+
+        pthread_mutex_lock(&p->lock);
+        if (--job->pending == 0) pthread_cond_signal(&p->done_cv);
+        pthread_mutex_unlock(&p->lock);
+    }
+    return NULL;
+}
+
+static void fahren_numa_pool_create(void) {
+    FahrenNumaPool* p = &g_numa;
+    fahren_numa_node_count();
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_mutex_init(&p->job_lock, NULL);
+    pthread_cond_init(&p->work_cv, NULL);
+    pthread_cond_init(&p->done_cv, NULL);
+    for (size_t node = 0; node < p->nodes; ++node) {
+        size_t started = 0;
+        for (size_t t = 0; t < p->threads[node]; ++t) {
+            FahrenNodeWorker* w = (FahrenNodeWorker*)malloc(sizeof(FahrenNodeWorker));
+            pthread_t th;
+            if (!w) break;
+            w->pool = p;
+            w->node = node;
+            if (pthread_create(&th, NULL, fahren_node_worker, w) != 0) {
+                free(w);
+                break;
+            }
+            pthread_detach(th);
+            started++;
+        }
+        p->threads[node] = started;
+        p->total_threads += started;
+    }
+    p->started = 1;
+}
+
+typedef struct FahrenFlatJob {
+    fahren_node_fn fn;
+    void* ctx;
+    size_t nodes;
+    size_t first[FAHREN_NUMA_MAX_NODES + 1];  /* flat index each node starts at */
+} FahrenFlatJob;
+
+/* Split a flat chunk back into per-node ranges. */
+static void fahren_numa_flat_range(void* arg, size_t begin, size_t end) {
+    const FahrenFlatJob* job = (const FahrenFlatJob*)arg;
+    for (size_t node = 0; node < job->nodes && begin < end; ++node) {
+        if (begin >= job->first[node + 1]) continue;
+        size_t stop = end < job->first[node + 1] ? end : job->first[node + 1];
+        job->fn(job->ctx, node, begin - job->first[node], stop - job->first[node]);
+        begin = stop;
+    }
+}
+
+void fahren_numa_parallel(const size_t* n, size_t grain, fahren_node_fn fn, void* ctx) {
+    if (!fn) return;
+    if (fahren_executor_installed()) {
+        FahrenFlatJob flat;
+        flat.fn = fn;
+        flat.ctx = ctx;
+        flat.nodes = fahren_numa_node_count();
+        flat.first[0] = 0;
+        for (size_t node = 0; node < flat.nodes; ++node) flat.first[node + 1] = flat.first[node] + n[node];
+        fahren_parallel_for(flat.first[flat.nodes], grain, fahren_numa_flat_range, &flat);
+        return;
+    }
+    pthread_once(&g_numa_pool_once, fahren_numa_pool_create);
+    FahrenNumaPool* p = &g_numa;
+    if (grain == 0) grain = 1;
+
+    FahrenNodeJob job;
+    job.fn = fn;
+    job.ctx = ctx;
+    for (size_t node = 0; node < FAHREN_NUMA_MAX_NODES; ++node) {
+        size_t count = node < p->nodes ? n[node] : 0;
+        size_t threads = node < p->nodes && p->threads[node] ? p->threads[node] : 1;
+        job.n[node] = count;
+        job.chunk[node] = count / (threads * 4) > grain ? count / (threads * 4) : grain;
+        atomic_init(&job.next[node], 0);
+    }
+    if (p->total_threads == 0) {
+        /* no workers could be started: run everything here */
+        for (size_t node = 0; node < p->nodes; ++node) fahren_node_drain(&job, node);
+        return;
+    }
+    job.pending = p->total_threads;
+
+    pthread_mutex_lock(&p->job_lock);
+    pthread_mutex_lock(&p->lock);
+    p->job = &job;
+    p->generation++;
+    pthread_cond_broadcast(&p->work_cv);
+    while (job.pending != 0) pthread_cond_wait(&p->done_cv, &p->lock);
+    p->job = NULL;
+    pthread_mutex_unlock(&p->lock);
+    /* a node whose workers all failed to start is run by the caller */
+    for (size_t node = 0; node < p->nodes; ++node) {
+        if (p->threads[node] == 0) fahren_node_drain(&job, node);
+    }
+    pthread_mutex_unlock(&p->job_lock);
+}
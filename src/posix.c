@@ -15,11 +15,14 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <signal.h>
 #include <time.h>
 
 #include <fahren/fahren.h>
 #include <math.h>
 
+#include "fahren_internal.h"
+
 /* RNG helper local to the implementation. Returns float in [-0.5, 0.5]. */
 static inline float fahren_random_weight(void) {
 #if defined(__APPLE__) || defined(HAVE_ARC4RANDOM)
@@ -29,8 +32,151 @@ static inline float fahren_random_weight(void) {
 #endif
 }
 
-/* forward declaration for function defined later in this file */
-FAHRENStatus fahren_write_random_weights(FAHREN* cm, const char* path);
+/* Seed for one blob, drawn from the stream above so srand48 still makes
+ * runs reproducible. */
+static uint64_t fahren_random_seed(void) {
+    uint64_t hi = (uint64_t)((double)(fahren_random_weight() + 0.5f) * 4294967296.0);
+    uint64_t lo = (uint64_t)((double)(fahren_random_weight() + 0.5f) * 4294967296.0);
+    return hi << 32 ^ lo;
+}
+
+/* Counter-based generator (SplitMix64 output function): draw `i` depends
+ * only on the seed and i, so fills can be split across threads in any
+ * way and still produce the same blob. */
+static inline uint64_t fahren_counter_rng(uint64_t seed, uint64_t i) {
+    uint64_t x = seed + (i + 1) * 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/* Uniform in [0, 1). */
+static inline double fahren_counter_unit(uint64_t seed, uint64_t i) {
+    return (double)(fahren_counter_rng(seed, i) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* NORMAL fills draw from their own stream, seeded seed ^ this, so their
+ * two draws per element never reuse a UNIFORM fill's counters. */
+#define FAHREN_NORMAL_STREAM 0xD1B54A32D192ED03ull
+
+typedef enum FahrenFillKind {
+    FAHREN_FILL_CONST = 0,   /* value */
+    FAHREN_FILL_UNIFORM = 1, /* uniform in [-value, value) */
+    FAHREN_FILL_NORMAL = 2   /* standard normal (Box-Muller) */
+} FahrenFillKind;
+
+typedef struct FahrenFillJob {
+    float* dst;
+    uint64_t seed;
+    uint64_t first; /* blob-wide index of dst[0], the generator counter */
+    FahrenFillKind kind;
+    float value;
+} FahrenFillJob;
+
+#define FAHREN_FILL_GRAIN 65536
+
+static void fahren_fill_range(void* ctx, size_t begin, size_t end) {
+    const FahrenFillJob* job = (const FahrenFillJob*)ctx;
+    for (size_t i = begin; i < end; ++i) {
+        uint64_t n = job->first + i;
+        if (job->kind == FAHREN_FILL_CONST) {
+            job->dst[i] = job->value;
+        } else if (job->kind == FAHREN_FILL_UNIFORM) {
+            job->dst[i] = (float)((2.0 * fahren_counter_unit(job->seed, n) - 1.0) * job->value);
+        } else {
+            uint64_t stream = job->seed ^ FAHREN_NORMAL_STREAM;
+            double u1 = 1.0 - fahren_counter_unit(stream, 2 * n); /* (0, 1] */
+            double u2 = fahren_counter_unit(stream, 2 * n + 1);
+            job->dst[i] = (float)(sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2));
+        }
+    }
+}
+
+static void fahren_fill(float* dst, size_t n, uint64_t seed, uint64_t first, FahrenFillKind kind, float value) {
+    FahrenFillJob job = {dst, seed, first, kind, value};
+    if (n) fahren_parallel_for(n, FAHREN_FILL_GRAIN, fahren_fill_range, &job);
+}
+
+typedef struct FahrenOrthoJob {
+    float* w;
+    size_t len, step, next; /* as in fahren_orthogonalize */
+    size_t pivot;           /* the vector normalized last */
+} FahrenOrthoJob;
+
+#define FAHREN_ORTHO_WORK 16384 /* elements per parallel chunk */
+
+/* Remove the pivot's component from vectors pivot + 1 + [begin, end). */
+static void fahren_orthogonalize_range(void* ctx, size_t begin, size_t end) {
+    const FahrenOrthoJob* job = (const FahrenOrthoJob*)ctx;
+    size_t len = job->len, step = job->step;
+    const float* u = job->w + job->pivot * job->next;
+    for (size_t j = job->pivot + 1 + begin; j < job->pivot + 1 + end; ++j) {
+        float* v = job->w + j * job->next;
+        double dot = 0.0;
+        for (size_t k = 0; k < len; ++k) dot += (double)v[k * step] * u[k * step];
+        for (size_t k = 0; k < len; ++k) v[k * step] -= (float)dot * u[k * step];
+    }
+}
+
+/* Make the rows of the rows x cols matrix w orthonormal when rows <= cols,
+ * else its columns (modified Gram-Schmidt over Gaussian draws). Each
+ * vector is normalized in turn and its component then removed from all
+ * later ones in parallel; every vector still sees the same operations in
+ * the same order, so the result does not depend on the thread count. */
+static void fahren_orthogonalize(float* w, size_t rows, size_t cols) {
+    int by_row = rows <= cols;
+    size_t count = by_row ? rows : cols, len = by_row ? cols : rows;
+    size_t step = by_row ? 1 : cols;  /* between elements of one vector */
+    size_t next = by_row ? cols : 1;  /* between vectors */
+    FahrenOrthoJob job = {w, len, step, next, 0};
+    size_t grain = len < FAHREN_ORTHO_WORK ? FAHREN_ORTHO_WORK / len : 1;
+    for (size_t i = 0; i < count; ++i) {
+        float* v = w + i * next;
+        double norm = 0.0;
+        for (size_t k = 0; k < len; ++k) norm += (double)v[k * step] * v[k * step];
+        float inv = norm > 0.0 ? (float)(1.0 / sqrt(norm)) : 0.0f;
+        for (size_t k = 0; k < len; ++k) v[k * step] *= inv;
+        job.pivot = i;
+        if (i + 1 < count) fahren_parallel_for(count - i - 1, grain, fahren_orthogonalize_range, &job);
+    }
+}
+
+/* Fill one layer's weights and biases according to layer->init and
+ * layer->zero_bias. `w_first` and `b_first` are the blob-wide indices of
+ * w[0] and b[0], which keep every element's draws distinct (NORMAL fills
+ * use a stream of their own; see FAHREN_NORMAL_STREAM). */
+static void fahren_init_layer(const FAHRENLayer* layer, uint64_t seed, float* w, size_t nw, uint64_t w_first,
+                              float* b, size_t nb, uint64_t b_first) {
+    int identity = layer->init != FAHREN_INIT_UNIFORM && !layer->previous_layer;
+    if (identity) {
+        fahren_fill(w, nw, seed, w_first, FAHREN_FILL_CONST, 1.0f);
+    } else {
+        size_t in_dim = layer->previous_layer ? (size_t)layer->previous_layer->density : 1;
+        size_t out_dim = layer->density > 0 ? (size_t)layer->density : 1;
+        size_t k = layer->kernel_size > 0 ? (size_t)layer->kernel_size : 3;
+        size_t receptive = 1;
+        if (layer->layer_type == FAHREN_LAYER_CONVOLUTIONAL || layer->layer_type == FAHREN_LAYER_CONV_TRANSPOSE) {
+            receptive = k * k;
+        } else if (layer->layer_type == FAHREN_LAYER_CONV1D) {
+            receptive = k;
+        }
+        double fan_in = (double)in_dim * (double)receptive;
+        double fan_out = (double)out_dim * (double)receptive;
+        double limit = 0.5;
+        if (layer->init == FAHREN_INIT_XAVIER) limit = sqrt(6.0 / (fan_in + fan_out));
+        else if (layer->init == FAHREN_INIT_HE) limit = sqrt(6.0 / fan_in);
+
+        if (layer->init == FAHREN_INIT_ORTHOGONAL) {
+            size_t cols = in_dim * receptive;
+            fahren_fill(w, nw, seed, w_first, FAHREN_FILL_NORMAL, 0.0f);
+            if (cols && nw % cols == 0) fahren_orthogonalize(w, nw / cols, cols);
+        } else {
+            fahren_fill(w, nw, seed, w_first, FAHREN_FILL_UNIFORM, (float)limit);
+        }
+    }
+    if (layer->zero_bias || identity) fahren_fill(b, nb, seed, b_first, FAHREN_FILL_CONST, 0.0f);
+    else fahren_fill(b, nb, seed, b_first, FAHREN_FILL_UNIFORM, 0.5f);
+}
 
 FAHRENStatus fahren_init(FAHREN* cm, FAHRENModelType model_type, size_t layer_count, FAHRENLayer* layers) {
     if (!cm || !layers || layer_count == 0) {
@@ -56,6 +202,18 @@ FAHRENLayer* fahren_alloc_layers(size_t count) {
     return p;
 }
 
+/* Whether `name` is a fahren_out_open temporary ("<path>.tmp.<pid>.<n>")
+ * whose writer is still running. */
+static int fahren_tmp_in_use(const char* name) {
+    const char* tag = NULL;
+    for (const char* p = strstr(name, ".tmp."); p; p = strstr(p + 1, ".tmp.")) tag = p;
+    if (!tag) return 0;
+    char* end;
+    long pid = strtol(tag + 5, &end, 10);
+    if (end == tag + 5 || *end != '.' || pid <= 0) return 0;
+    return kill((pid_t)pid, 0) == 0 || errno == EPERM;
+}
+
 FAHRENStatus fahren_shutdown(FAHREN* cm) {
     if (!cm) return FAHREN_ERROR_INVALID_ARGUMENT;
     if (!cm->initialized) return FAHREN_ERROR_NOT_INITIALIZED;
@@ -73,7 +231,8 @@ FAHRENStatus fahren_shutdown(FAHREN* cm) {
 
     /* Cleanup transient files created by the library. Preserve model
      * binaries ending in .bin; remove files starting with 'fahren_' that
-     * are not .bin. Ignore remove errors. */
+     * are not .bin, except temporaries a live process (this one included)
+     * is still writing. Ignore remove errors. */
     DIR* d = opendir(".");
     if (d) {
         struct dirent* ent;
@@ -83,6 +242,7 @@ FAHRENStatus fahren_shutdown(FAHREN* cm) {
             if (strncmp(name, "fahren_", 7) != 0) continue;
             size_t len = strlen(name);
             if (len >= 4 && strcmp(name + len - 4, ".bin") == 0) continue; /* keep binaries */
+            if (fahren_tmp_in_use(name)) continue;
             (void)unlink(name);
         }
         closedir(d);
@@ -95,13 +255,65 @@ FAHRENStatus fahren_shutdown(FAHREN* cm) {
  * public API minimal. Examples should implement their own simple text
  * handling when needed. */
 
-/* Compute total number of weights for the model, allocate a float buffer,
- * fill it with random values in [-0.5,0.5] using fahr en_random_weight(), and
- * write the raw floats to `path` as a binary blob. The weight-counting rule
- * is heuristic: for dense and recurrent layers we use previous->density *
- * layer->density; for convolutional layers we multiply that by a 3x3 kernel
- * factor (9). If a layer has no `previous_layer` we treat input dim as 1.
- */
+/* Number of weights and biases one layer stores. The rule is heuristic
+ * for dense and recurrent layers: previous->density * layer->density
+ * weights; 2D (and transposed) convolutional layers multiply that by
+ * kernel_size^2 and 1D convolutions by kernel_size (default 3), and
+ * upsampling layers store nothing.
+ * A factorization machine keeps a linear weight plus `factors` latent
+ * weights per input feature and a single global bias; a cross layer keeps
+ * one weight and one bias per input feature. If a layer has no
+ * `previous_layer` we treat input dim as 1. Returns 0 on overflow. */
+int fahren_layer_param_counts(const FAHRENLayer* layer, size_t* weights, size_t* biases) {
+    size_t in_dim = layer->previous_layer ? (size_t)layer->previous_layer->density : 1;
+    size_t out_dim = (size_t)layer->density;
+    size_t per_input = out_dim;
+    size_t bias_count = out_dim; /* one bias per output unit/filter */
+    size_t k = layer->kernel_size > 0 ? (size_t)layer->kernel_size : 3;
+
+    if (layer->kernel_size < 0) return 0;
+    switch (layer->layer_type) {
+    case FAHREN_LAYER_CONVOLUTIONAL:
+    case FAHREN_LAYER_CONV_TRANSPOSE:
+        if (k > SIZE_MAX / k || out_dim > SIZE_MAX / (k * k)) return 0;
+        per_input = out_dim * k * k;
+        break;
+    case FAHREN_LAYER_CONV1D:
+        if (out_dim > SIZE_MAX / k) return 0;
+        per_input = out_dim * k;
+        break;
+    case FAHREN_LAYER_FACTORIZATION_MACHINE:
+        if (layer->factors < 0) return 0;
+        per_input = 1 + (size_t)layer->factors;
+        bias_count = 1;
+        break;
+    case FAHREN_LAYER_CROSS:
+        per_input = 1;
+        bias_count = in_dim;
+        break;
+    case FAHREN_LAYER_UPSAMPLE:
+        per_input = 0;
+        bias_count = 0;
+        break;
+    default:
+        break;
+    }
+    if (per_input != 0 && in_dim > SIZE_MAX / per_input) return 0;
+    *weights = in_dim * per_input;
+    *biases = bias_count;
+    return 1;
+}
+
+/* Write a fresh blob for `cm` to `path`: the header, then every layer's
+ * weights in layer order, then every layer's biases, each layer filled by
+ * fahren_init_layer above (the default is uniform in [-0.5,0.5]). Sizes
+ * come from fahren_layer_param_counts(). The final size is known up
+ * front, so the file is preallocated under a temporary name, mapped
+ * (fahren_out_open) and filled in place by parallel workers: the floats
+ * are written once, straight into the page cache, with no heap copy and
+ * no stdio buffer. The temporary is renamed over `path` only when
+ * complete, so readers see the old blob or the new one, never a partial
+ * file. */
 FAHRENStatus fahren_write_random_weights(FAHREN* cm, const char* path) {
     if (!cm || !path) return FAHREN_ERROR_INVALID_ARGUMENT;
     if (!cm->initialized) return FAHREN_ERROR_NOT_INITIALIZED;
@@ -109,92 +321,50 @@ FAHRENStatus fahren_write_random_weights(FAHREN* cm, const char* path) {
     size_t total_weights = 0;
     size_t total_biases = 0;
     for (size_t i = 0; i < cm->layer_count; ++i) {
-        FAHRENLayer* layer = &cm->layers[i];
-        size_t in_dim = layer->previous_layer ? (size_t)layer->previous_layer->density : 1;
-        size_t out_dim = (size_t)layer->density;
-        size_t layer_weights = in_dim * out_dim;
-        if (layer->layer_type == FAHREN_LAYER_CONVOLUTIONAL) {
-            layer_weights *= 9; /* assume 3x3 kernels */
+        size_t layer_weights, layer_biases;
+        if (!fahren_layer_param_counts(&cm->layers[i], &layer_weights, &layer_biases)) {
+            return FAHREN_ERROR_PROCESSING_FAILED;
         }
         if (layer_weights > SIZE_MAX - total_weights) return FAHREN_ERROR_PROCESSING_FAILED;
         total_weights += layer_weights;
 
-        if (out_dim > SIZE_MAX - total_biases) return FAHREN_ERROR_PROCESSING_FAILED;
-        total_biases += out_dim; /* one bias per output unit/filter */
+        if (layer_biases > SIZE_MAX - total_biases) return FAHREN_ERROR_PROCESSING_FAILED;
+        total_biases += layer_biases;
     }
+    size_t max_floats = (SIZE_MAX - sizeof(FAHRENModelHeader)) / sizeof(float);
+    if (total_biases > max_floats || total_weights > max_floats - total_biases) return FAHREN_ERROR_PROCESSING_FAILED;
+    size_t bytes = sizeof(FAHRENModelHeader) + (total_weights + total_biases) * sizeof(float);
+    if ((uint64_t)bytes > (uint64_t)INT64_MAX) return FAHREN_ERROR_PROCESSING_FAILED;
 
-    /* Prepare buffers */
-    float* weights = NULL;
-    float* biases = NULL;
-    if (total_weights > 0) {
-        weights = (float*)malloc(total_weights * sizeof(float));
-        if (!weights) return FAHREN_ERROR_PROCESSING_FAILED;
-    }
-    if (total_biases > 0) {
-        biases = (float*)malloc(total_biases * sizeof(float));
-        if (!biases) {
-            free(weights);
-            return FAHREN_ERROR_PROCESSING_FAILED;
-        }
-    }
+    FahrenOutFile out;
+    if (!fahren_out_open(&out, path, bytes)) return FAHREN_ERROR_PROCESSING_FAILED;
+    void* map = out.map;
+
+    /* header */
+    FAHRENModelHeader header;
+    header.magic = FAHREN_MODEL_MAGIC;
+    header.version_major = FAHREN_VERSION_MAJOR;
+    header.version_minor = FAHREN_VERSION_MINOR;
+    header.version_patch = FAHREN_VERSION_PATCH;
+    header.weight_count = (uint64_t)total_weights;
+    header.bias_count = (uint64_t)total_biases;
+    memcpy(map, &header, sizeof(header));
 
-    /* Fill random values */
+    /* weights then biases, filled in the mapping */
+    float* weights = (float*)((char*)map + sizeof(header));
+    float* biases = weights + total_weights;
+    uint64_t seed = fahren_random_seed();
     size_t widx = 0, bidx = 0;
     for (size_t i = 0; i < cm->layer_count; ++i) {
-        FAHRENLayer* layer = &cm->layers[i];
-        size_t in_dim = layer->previous_layer ? (size_t)layer->previous_layer->density : 1;
-        size_t out_dim = (size_t)layer->density;
-        size_t layer_weights = in_dim * out_dim;
-        if (layer->layer_type == FAHREN_LAYER_CONVOLUTIONAL) layer_weights *= 9;
-        for (size_t k = 0; k < layer_weights; ++k) {
-            weights[widx++] = fahren_random_weight();
-        }
-        for (size_t k = 0; k < out_dim; ++k) {
-            biases[bidx++] = fahren_random_weight();
-        }
-    }
-
-    /* Write binary blob with a small header: magic, version, counts */
-    FILE* f = fopen(path, "wb");
-    if (!f) {
-        free(weights);
-        free(biases);
-        return FAHREN_ERROR_PROCESSING_FAILED;
-    }
-
-    /* header */
-    uint32_t magic = 0x4641484E; /* 'FAHN' */
-    uint32_t ver_major = FAHREN_VERSION_MAJOR;
-    uint32_t ver_minor = FAHREN_VERSION_MINOR;
-    uint32_t ver_patch = FAHREN_VERSION_PATCH;
-    uint64_t wcount = (uint64_t)total_weights;
-    uint64_t bcount = (uint64_t)total_biases;
-
-    if (fwrite(&magic, sizeof(magic), 1, f) != 1) goto io_error;
-    if (fwrite(&ver_major, sizeof(ver_major), 1, f) != 1) goto io_error;
-    if (fwrite(&ver_minor, sizeof(ver_minor), 1, f) != 1) goto io_error;
-    if (fwrite(&ver_patch, sizeof(ver_patch), 1, f) != 1) goto io_error;
-    if (fwrite(&wcount, sizeof(wcount), 1, f) != 1) goto io_error;
-    if (fwrite(&bcount, sizeof(bcount), 1, f) != 1) goto io_error;
-
-    /* weights then biases */
-    if (total_weights > 0) {
-        if (fwrite(weights, sizeof(float), total_weights, f) != total_weights) goto io_error;
+        size_t layer_weights = 0, layer_biases = 0;
+        (void)fahren_layer_param_counts(&cm->layers[i], &layer_weights, &layer_biases);
+        fahren_init_layer(&cm->layers[i], seed, weights + widx, layer_weights, widx, biases + bidx, layer_biases,
+                          total_weights + bidx);
+        widx += layer_weights;
+        bidx += layer_biases;
     }
-    if (total_biases > 0) {
-        if (fwrite(biases, sizeof(float), total_biases, f) != total_biases) goto io_error;
-    }
-
-    fclose(f);
-    free(weights);
-    free(biases);
-    return FAHREN_SUCCESS;
 
-io_error:
-    fclose(f);
-    free(weights);
-    free(biases);
-    return FAHREN_ERROR_PROCESSING_FAILED;
+    return fahren_out_commit(&out, path) ? FAHREN_SUCCESS : FAHREN_ERROR_PROCESSING_FAILED;
 }
 
 /* Train a simple linear softmax model via SGD and write to `path`.
@@ -0,0 +1,478 @@
+/* Sequential dense runtime. See include/fahren/runtime.h.
+ * Small batches are bandwidth-bound GEMVs, so each output row is a dot
+ * product over the row's weights against every batch item while the row
+ * is hot in cache; from FAHREN_RT_GEMM_BATCH rows on, the packed SGEMM
+ * wins. NUMA-split layers always use the row kernel, on node-pinned
+ * threads, reading only weights that live on their own node.
+ * Every model starts with the elementwise input layer, so strided inputs
+ * cost nothing extra: that layer reads any layout while it writes the
+ * packed activations the dense layers need. Dense layers write rows at
+ * any row stride, which lets the last layer fill a slice of a larger
+ * buffer in place; only an output with a non-unit inner stride goes
+ * through scratch and a strided copy. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fahren/runtime.h>
+#include "fahren_internal.h"
+#include "fahren_simd.h"
+
+#define FAHREN_RT_GEMM_BATCH 4
+#define FAHREN_RT_ROW_GRAIN 16
+
+typedef struct FahrenRtLayer {
+    size_t in_dim, out_dim;
+    FAHRENActivation act;
+    int input_layer;         /* per-feature scale and shift */
+    float* weights;          /* unsplit: out x in */
+    float* bias;
+    size_t parts;            /* NUMA slices, 0 when unsplit */
+    size_t row0[FAHREN_NUMA_MAX_NODES + 1];
+    float* part_mem[FAHREN_NUMA_MAX_NODES];   /* slice rows, then slice biases */
+    size_t part_bytes[FAHREN_NUMA_MAX_NODES];
+} FahrenRtLayer;
+
+struct FAHRENRuntime {
+    size_t layer_count;
+    FahrenRtLayer* layers;
+    size_t max_dim;
+};
+
+static _Thread_local float* t_rt_scratch = NULL;
+static _Thread_local size_t t_rt_scratch_cap = 0;
+
+static inline float fahren_rt_act(FAHRENActivation act, float v) {
+    switch (act) {
+    case FAHREN_ACTIVATION_RELU:
+        return v > 0.0f ? v : 0.0f;
+    case FAHREN_ACTIVATION_SIGMOID:
+        return 1.0f / (1.0f + fahren_expf_approx(-v));
+    case FAHREN_ACTIVATION_TANH:
+        return 2.0f / (1.0f + fahren_expf_approx(-2.0f * v)) - 1.0f;
+    default:
+        return v;
+    }
+}
+
+/* y[b * ldy + r] = act(dot(w[r], x[b]) + bias[r]) for r < rows, b < batch */
+static void fahren_rt_rows(const float* w, const float* bias, size_t in_dim, size_t rows,
+                           const float* x, size_t batch, float* y, size_t ldy, FAHRENActivation act) {
+    for (size_t r = 0; r < rows; ++r) {
+        const float* wr = w + r * in_dim;
+        for (size_t b = 0; b < batch; ++b) {
+            y[b * ldy + r] = fahren_rt_act(act, fahren_dot_f32(wr, x + b * in_dim, in_dim) + bias[r]);
+        }
+    }
+}
+
+/* ---- forward ---------------------------------------------------------- */
+
+typedef struct FahrenRtJob {
+    const FahrenRtLayer* layer;
+    const float* x;
+    size_t batch;
+    float* y;
+    size_t ldy;
+} FahrenRtJob;
+
+static void fahren_rt_row_tasks(void* ctx, size_t begin, size_t end) {
+    FahrenRtJob* job = (FahrenRtJob*)ctx;
+    const FahrenRtLayer* l = job->layer;
+    fahren_rt_rows(l->weights + begin * l->in_dim, l->bias + begin, l->in_dim, end - begin, job->x,
+                   job->batch, job->y + begin, job->ldy, l->act);
+}
+
+static void fahren_rt_node_tasks(void* ctx, size_t node, size_t begin, size_t end) {
+    FahrenRtJob* job = (FahrenRtJob*)ctx;
+    const FahrenRtLayer* l = job->layer;
+    size_t rows = l->row0[node + 1] - l->row0[node];
+    const float* w = l->part_mem[node];
+    const float* bias = w + rows * l->in_dim;
+    fahren_rt_rows(w + begin * l->in_dim, bias + begin, l->in_dim, end - begin, job->x, job->batch,
+                   job->y + l->row0[node] + begin, job->ldy, l->act);
+}
+
+/* Input layer, with x[b * xs0 + i * xs1] and y[b * ys0 + i * ys1]. */
+static void fahren_rt_input_forward(const FahrenRtLayer* l, const float* x, ptrdiff_t xs0, ptrdiff_t xs1,
+                                    size_t batch, float* y, ptrdiff_t ys0, ptrdiff_t ys1) {
+    for (size_t b = 0; b < batch; ++b) {
+        const float* xb = x + (ptrdiff_t)b * xs0;
+        float* yb = y + (ptrdiff_t)b * ys0;
+        if (xs1 == 1 && ys1 == 1) {
+            for (size_t i = 0; i < l->out_dim; ++i) yb[i] = fahren_rt_act(l->act, xb[i] * l->weights[i] + l->bias[i]);
+        } else {
+            for (size_t i = 0; i < l->out_dim; ++i) {
+                yb[(ptrdiff_t)i * ys1] = fahren_rt_act(l->act, xb[(ptrdiff_t)i * xs1] * l->weights[i] + l->bias[i]);
+            }
+        }
+    }
+}
+
+/* Dense layer over packed x; output rows are `ldy` floats apart. */
+static FAHRENStatus fahren_rt_dense_forward(const FahrenRtLayer* l, const float* x, size_t batch, float* y,
+                                            size_t ldy) {
+    FahrenRtJob job = {l, x, batch, y, ldy};
+    if (l->parts) {
+        size_t n[FAHREN_NUMA_MAX_NODES] = {0};
+        for (size_t k = 0; k < l->parts; ++k) n[k] = l->row0[k + 1] - l->row0[k];
+        fahren_numa_parallel(n, FAHREN_RT_ROW_GRAIN, fahren_rt_node_tasks, &job);
+        return FAHREN_SUCCESS;
+    }
+    if (batch < FAHREN_RT_GEMM_BATCH) {
+        fahren_parallel_for(l->out_dim, FAHREN_RT_ROW_GRAIN, fahren_rt_row_tasks, &job);
+        return FAHREN_SUCCESS;
+    }
+    for (size_t b = 0; b < batch; ++b) memcpy(y + b * ldy, l->bias, l->out_dim * sizeof(float));
+    /* y (batch x out) += x (batch x in) * W^T */
+    if (!fahren_sgemm(0, 1, batch, l->out_dim, l->in_dim, 1.0f, x, l->in_dim, l->weights, l->in_dim,
+                      1.0f, y, ldy)) {
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    if (l->act != FAHREN_ACTIVATION_NONE) {
+        for (size_t b = 0; b < batch; ++b) {
+            float* yb = y + b * ldy;
+            for (size_t i = 0; i < l->out_dim; ++i) yb[i] = fahren_rt_act(l->act, yb[i]);
+        }
+    }
+    return FAHREN_SUCCESS;
+}
+
+/* One layer from packed x to packed y. */
+static FAHRENStatus fahren_rt_layer_forward(const FahrenRtLayer* l, const float* x, size_t batch, float* y) {
+    if (l->input_layer) {
+        fahren_rt_input_forward(l, x, (ptrdiff_t)l->out_dim, 1, batch, y, (ptrdiff_t)l->out_dim, 1);
+        return FAHREN_SUCCESS;
+    }
+    return fahren_rt_dense_forward(l, x, batch, y, l->out_dim);
+}
+
+static int fahren_rt_reserve(size_t need) {
+    if (need <= t_rt_scratch_cap) return 1;
+    float* grown = (float*)realloc(t_rt_scratch, need * sizeof(float));
+    if (!grown) return 0;
+    t_rt_scratch = grown;
+    t_rt_scratch_cap = need;
+    return 1;
+}
+
+/* Forward with x[b * xs0 + i * xs1] and y[b * ys0 + o * ys1]. */
+static FAHRENStatus fahren_rt_forward_strided(FAHRENRuntime* rt, const float* x, ptrdiff_t xs0, ptrdiff_t xs1,
+                                              size_t batch, float* y, ptrdiff_t ys0, ptrdiff_t ys1) {
+    size_t plane = batch * rt->max_dim;
+    size_t out_dim = rt->layers[rt->layer_count - 1].out_dim;
+    if (rt->layer_count == 1) {
+        fahren_rt_input_forward(&rt->layers[0], x, xs0, xs1, batch, y, ys0, ys1);
+        return FAHREN_SUCCESS;
+    }
+    /* the last layer writes y itself when y's rows are packed floats */
+    int direct = ys1 == 1 && ys0 >= 0 && (batch == 1 || (size_t)ys0 >= out_dim);
+    if (!fahren_rt_reserve(2 * plane)) return FAHREN_ERROR_PROCESSING_FAILED;
+
+    fahren_rt_input_forward(&rt->layers[0], x, xs0, xs1, batch, t_rt_scratch, (ptrdiff_t)rt->layers[0].out_dim, 1);
+    const float* cur = t_rt_scratch;
+    for (size_t i = 1; i < rt->layer_count; ++i) {
+        int last = i + 1 == rt->layer_count;
+        float* out = last && direct ? y : t_rt_scratch + (i % 2) * plane;
+        size_t ldy = last && direct ? (size_t)ys0 : rt->layers[i].out_dim;
+        FAHRENStatus st = fahren_rt_dense_forward(&rt->layers[i], cur, batch, out, ldy);
+        if (st != FAHREN_SUCCESS) return st;
+        cur = out;
+    }
+    if (!direct) {
+        for (size_t b = 0; b < batch; ++b) {
+            for (size_t o = 0; o < out_dim; ++o) y[(ptrdiff_t)b * ys0 + (ptrdiff_t)o * ys1] = cur[b * out_dim + o];
+        }
+    }
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_runtime_forward(FAHRENRuntime* rt, const float* x, size_t batch, float* y) {
+    if (!rt || !x || !y) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (batch == 0) return FAHREN_SUCCESS;
+    size_t in_dim = rt->layers[0].out_dim, out_dim = rt->layers[rt->layer_count - 1].out_dim;
+    return fahren_rt_forward_strided(rt, x, (ptrdiff_t)in_dim, 1, batch, y, (ptrdiff_t)out_dim, 1);
+}
+
+FAHRENStatus fahren_runtime_forward_tensor(FAHRENRuntime* rt, const FAHRENTensor* x, const FAHRENTensor* y) {
+    if (!rt || !x || !y || x->dtype != FAHREN_DTYPE_F32 || y->dtype != FAHREN_DTYPE_F32 || x->rank != 2 ||
+        y->rank != 2 || x->shape[0] != y->shape[0] || x->shape[1] != fahren_runtime_input_dim(rt) ||
+        y->shape[1] != fahren_runtime_output_dim(rt)) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    const float* xd = (const float*)fahren_tensor_data(x);
+    float* yd = (float*)fahren_tensor_data(y);
+    if (!xd || !yd) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (x->shape[0] == 0) return FAHREN_SUCCESS;
+    return fahren_rt_forward_strided(rt, xd, x->strides[0], x->strides[1], x->shape[0], yd, y->strides[0],
+                                     y->strides[1]);
+}
+
+void fahren_cancel(FAHRENCancelToken* token) {
+    if (token) __atomic_store_n(&token->cancelled, 1, __ATOMIC_RELEASE);
+}
+
+int fahren_cancelled(const FAHRENCancelToken* token) {
+    return token && __atomic_load_n(&token->cancelled, __ATOMIC_ACQUIRE);
+}
+
+/* Drop groups whose token fired since the last check. `src` holds the
+ * rows of every group still live before this call, in group order. The
+ * tokens are checked first; only when one has fired are the survivors
+ * packed into `dst` (which may be `src`) and *dropped set, so nothing is
+ * copied while every group is live. Returns the live row count. */
+static size_t fahren_rt_compact(FAHRENForwardGroup* groups, size_t count, const float* src, float* dst,
+                                size_t width, int* dropped) {
+    size_t live = 0, first = 0;
+    for (; first < count; ++first) {
+        if (groups[first].cancelled) continue;
+        if (fahren_cancelled(groups[first].cancel)) break;
+        live += groups[first].rows;
+    }
+    if (first == count) return live;
+    *dropped = 1;
+    size_t from = 0, to = 0;
+    for (size_t g = 0; g < count; ++g) {
+        if (groups[g].cancelled) continue;
+        size_t n = groups[g].rows * width;
+        if (fahren_cancelled(groups[g].cancel)) {
+            groups[g].cancelled = 1;
+        } else {
+            if (dst != src || to != from) memmove(dst + to, src + from, n * sizeof(float));
+            to += n;
+        }
+        from += n;
+    }
+    return to / (width ? width : 1);
+}
+
+FAHRENStatus fahren_runtime_forward_groups(FAHRENRuntime* rt, const float* x, FAHRENForwardGroup* groups,
+                                           size_t group_count, float* y) {
+    if (!rt || !x || !y || (!groups && group_count)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t batch = 0;
+    for (size_t g = 0; g < group_count; ++g) {
+        groups[g].cancelled = 0;
+        batch += groups[g].rows;
+    }
+    size_t plane = batch * rt->max_dim;
+    if (!fahren_rt_reserve(2 * plane)) return FAHREN_ERROR_PROCESSING_FAILED;
+
+    /* the input is only copied if a group is gone before the first layer */
+    int dropped = 0;
+    size_t live = fahren_rt_compact(groups, group_count, x, t_rt_scratch + plane, rt->layers[0].out_dim, &dropped);
+    const float* cur = dropped ? t_rt_scratch + plane : x;
+    for (size_t i = 0; i < rt->layer_count; ++i) {
+        if (i > 0) {
+            int before = dropped;
+            dropped = 0;
+            live = fahren_rt_compact(groups, group_count, cur, (float*)cur, rt->layers[i - 1].out_dim, &dropped);
+            dropped |= before;
+        }
+        if (live == 0) return FAHREN_ERROR_CANCELLED;
+        /* until something is dropped, the last layer writes y in place */
+        float* out = i + 1 == rt->layer_count && !dropped ? y : t_rt_scratch + (i % 2) * plane;
+        if (out == cur) out = t_rt_scratch + ((i + 1) % 2) * plane;
+        FAHRENStatus st = fahren_rt_layer_forward(&rt->layers[i], cur, live, out);
+        if (st != FAHREN_SUCCESS) return st;
+        cur = out;
+    }
+    if (cur != y) {
+        size_t width = rt->layers[rt->layer_count - 1].out_dim, from = 0, at = 0;
+        for (size_t g = 0; g < group_count; ++g) {
+            size_t n = groups[g].rows * width;
+            if (!groups[g].cancelled) {
+                memcpy(y + at, cur + from, n * sizeof(float));
+                from += n;
+            }
+            at += n;
+        }
+    }
+    return FAHREN_SUCCESS;
+}
+
+/* ---- loading ---------------------------------------------------------- */
+
+typedef struct FahrenRtCopyJob {
+    FahrenRtLayer* layer;
+    const float* weights;  /* staged out x in */
+    const float* bias;
+} FahrenRtCopyJob;
+
+/* First touch of each slice happens on its own node. */
+static void fahren_rt_copy_tasks(void* ctx, size_t node, size_t begin, size_t end) {
+    FahrenRtCopyJob* job = (FahrenRtCopyJob*)ctx;
+    FahrenRtLayer* l = job->layer;
+    size_t row0 = l->row0[node], rows = l->row0[node + 1] - row0;
+    float* w = l->part_mem[node];
+    memcpy(w + begin * l->in_dim, job->weights + (row0 + begin) * l->in_dim,
+           (end - begin) * l->in_dim * sizeof(float));
+    memcpy(w + rows * l->in_dim + begin, job->bias + row0 + begin, (end - begin) * sizeof(float));
+}
+
+static void fahren_rt_layer_free(FahrenRtLayer* l) {
+    free(l->weights);
+    free(l->bias);
+    for (size_t k = 0; k < l->parts; ++k) fahren_numa_free(l->part_mem[k], l->part_bytes[k]);
+}
+
+/* Move a staged dense layer into per-node slices. */
+static int fahren_rt_split(FahrenRtLayer* l, size_t nodes) {
+    l->parts = nodes;
+    for (size_t k = 0; k <= nodes; ++k) l->row0[k] = k * l->out_dim / nodes;
+    for (size_t k = 0; k < nodes; ++k) {
+        size_t rows = l->row0[k + 1] - l->row0[k];
+        l->part_bytes[k] = rows * (l->in_dim + 1) * sizeof(float);
+        l->part_mem[k] = (float*)fahren_numa_alloc(l->part_bytes[k], k);
+        if (!l->part_mem[k]) return 0;
+    }
+    FahrenRtCopyJob job = {l, l->weights, l->bias};
+    size_t n[FAHREN_NUMA_MAX_NODES] = {0};
+    for (size_t k = 0; k < nodes; ++k) n[k] = l->row0[k + 1] - l->row0[k];
+    fahren_numa_parallel(n, FAHREN_RT_ROW_GRAIN, fahren_rt_copy_tasks, &job);
+    free(l->weights);
+    free(l->bias);
+    l->weights = NULL;
+    l->bias = NULL;
+    return 1;
+}
+
+static int fahren_rt_read_at(FILE* f, long offset, float* dst, size_t count) {
+    if (count == 0) return 1;
+    if (fseek(f, offset, SEEK_SET) != 0) return 0;
+    return fread(dst, sizeof(float), count, f) == count;
+}
+
+size_t fahren_runtime_numa_nodes(void) {
+    return fahren_numa_node_count();
+}
+
+FAHRENStatus fahren_runtime_create(const FAHREN* cm, const char* weights_path, FAHRENRuntime** out) {
+    if (!cm || !weights_path || !out) return FAHREN_ERROR_INVALID_ARGUMENT;
+    if (!cm->initialized || !cm->layers || cm->layer_count == 0) return FAHREN_ERROR_NOT_INITIALIZED;
+    *out = NULL;
+
+    size_t total_w = 0, total_b = 0;
+    for (size_t i = 0; i < cm->layer_count; ++i) {
+        const FAHRENLayer* layer = &cm->layers[i];
+        const FAHRENLayer* expect_prev = i ? &cm->layers[i - 1] : NULL;
+        size_t w, b;
+        if (layer->layer_type != FAHREN_LAYER_DENSE || layer->density <= 0 ||
+            layer->previous_layer != expect_prev || !fahren_layer_param_counts(layer, &w, &b)) {
+            return FAHREN_ERROR_INVALID_ARGUMENT;
+        }
+        total_w += w;
+        total_b += b;
+    }
+
+    FILE* f = fopen(weights_path, "rb");
+    if (!f) return FAHREN_ERROR_PROCESSING_FAILED;
+    FAHRENModelHeader h;
+    if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != FAHREN_MODEL_MAGIC || h.version_major != FAHREN_VERSION_MAJOR ||
+        h.weight_count != total_w || h.bias_count != total_b) {
+        fclose(f);
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+
+    FAHRENRuntime* rt = (FAHRENRuntime*)calloc(1, sizeof(FAHRENRuntime));
+    FahrenRtLayer* layers = (FahrenRtLayer*)calloc(cm->layer_count, sizeof(FahrenRtLayer));
+    if (!rt || !layers) {
+        free(rt);
+        free(layers);
+        fclose(f);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    rt->layers = layers;
+    rt->layer_count = cm->layer_count;
+
+    size_t nodes = fahren_numa_node_count();
+    long wbase = (long)sizeof(h), bbase = wbase + (long)(total_w * sizeof(float));
+    size_t woff = 0, boff = 0;
+    FAHRENStatus st = FAHREN_SUCCESS;
+    for (size_t i = 0; i < cm->layer_count && st == FAHREN_SUCCESS; ++i) {
+        const FAHRENLayer* layer = &cm->layers[i];
+        FahrenRtLayer* l = &layers[i];
+        size_t w, b;
+        (void)fahren_layer_param_counts(layer, &w, &b);
+        l->input_layer = i == 0;
+        l->out_dim = (size_t)layer->density;
+        l->in_dim = l->input_layer ? 1 : (size_t)layer->previous_layer->density;
+        l->act = layer->activation;
+        if (l->out_dim > rt->max_dim) rt->max_dim = l->out_dim;
+        l->weights = (float*)malloc((w ? w : 1) * sizeof(float));
+        l->bias = (float*)malloc((b ? b : 1) * sizeof(float));
+        if (!l->weights || !l->bias) {
+            st = FAHREN_ERROR_PROCESSING_FAILED;
+        } else if (!fahren_rt_read_at(f, wbase + (long)(woff * sizeof(float)), l->weights, w) ||
+                   !fahren_rt_read_at(f, bbase + (long)(boff * sizeof(float)), l->bias, b)) {
+            st = FAHREN_ERROR_PROCESSING_FAILED;
+        } else if (layer->numa_split && !l->input_layer && nodes > 1 && l->out_dim >= nodes) {
+            if (!fahren_rt_split(l, nodes)) st = FAHREN_ERROR_PROCESSING_FAILED;
+        }
+        woff += w;
+        boff += b;
+    }
+    fclose(f);
+    if (st != FAHREN_SUCCESS) {
+        fahren_runtime_destroy(rt);
+        return st;
+    }
+    *out = rt;
+    return FAHREN_SUCCESS;
+}
+
+void fahren_runtime_destroy(FAHRENRuntime* rt) {
+    if (!rt) return;
+    for (size_t i = 0; i < rt->layer_count; ++i) fahren_rt_layer_free(&rt->layers[i]);
+    free(rt->layers);
+    free(rt);
+}
+
+size_t fahren_runtime_input_dim(const FAHRENRuntime* rt) {
+    return rt && rt->layer_count ? rt->layers[0].out_dim : 0;
+}
+
+size_t fahren_runtime_output_dim(const FAHRENRuntime* rt) {
+    return rt && rt->layer_count ? rt->layers[rt->layer_count - 1].out_dim : 0;
+}
+
+FAHRENStatus fahren_runtime_parse_layers(const char* spec, FAHRENLayer** layers, size_t* count) {
+    if (!spec || !layers || !count) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *layers = NULL;
+    *count = 0;
+    size_t n = 1;
+    for (const char* c = spec; *c; ++c) n += *c == ',';
+    FAHRENLayer* out = fahren_alloc_layers(n);
+    if (!out) return FAHREN_ERROR_PROCESSING_FAILED;
+
+    const char* p = spec;
+    for (size_t i = 0; i < n; ++i) {
+        char* end;
+        long width = strtol(p, &end, 10);
+        if (end == p || width <= 0 || width > 1L << 24) goto bad;
+        p = end;
+        out[i].density = (int)width;
+        out[i].layer_type = FAHREN_LAYER_DENSE;
+        out[i].previous_layer = i ? &out[i - 1] : NULL;
+        while (*p == ':') {
+            size_t len = strcspn(++p, ":,");
+            if (len == 4 && strncmp(p, "relu", 4) == 0) out[i].activation = FAHREN_ACTIVATION_RELU;
+            else if (len == 7 && strncmp(p, "sigmoid", 7) == 0) out[i].activation = FAHREN_ACTIVATION_SIGMOID;
+            else if (len == 4 && strncmp(p, "tanh", 4) == 0) out[i].activation = FAHREN_ACTIVATION_TANH;
+            else if (len == 4 && strncmp(p, "numa", 4) == 0) out[i].numa_split = 1;
+            else if (len == 6 && strncmp(p, "xavier", 6) == 0) out[i].init = FAHREN_INIT_XAVIER;
+            else if (len == 2 && strncmp(p, "he", 2) == 0) out[i].init = FAHREN_INIT_HE;
+            else if (len == 10 && strncmp(p, "orthogonal", 10) == 0) out[i].init = FAHREN_INIT_ORTHOGONAL;
+            else if (len == 8 && strncmp(p, "zerobias", 8) == 0) out[i].zero_bias = 1;
+            else goto bad;
+            p += len;
+        }
+        if (*p != (i + 1 < n ? ',' : '\0')) goto bad;
+        ++p;
+    }
+    *layers = out;
+    *count = n;
+    return FAHREN_SUCCESS;
+bad:
+    free(out);
+    return FAHREN_ERROR_INVALID_ARGUMENT;
+}
@@ -0,0 +1,403 @@
+/* Token sampling kernels: Philox RNG, SIMD top-k, radix-select top-p and
+ * a fused temperature/exp pass. See include/fahren/sampling.h.
+ *
+ * Nothing here sorts the vocabulary. Top-k keeps a k-entry min-heap and
+ * uses SIMD compares to skip every block of logits that cannot beat the
+ * current k-th best. Top-p finds its probability cutoff with an MSB-first
+ * radix select over the float bit patterns, weighting buckets by mass
+ * instead of count, so it costs one full pass plus passes over a shrinking
+ * candidate list. */
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <fahren/sampling.h>
+#include "fahren_internal.h"
+#include "fahren_simd.h"
+
+/* ---- counter-based RNG ------------------------------------------------ */
+
+static inline void fahren_mulhilo32(uint32_t a, uint32_t b, uint32_t* hi, uint32_t* lo) {
+    uint64_t p = (uint64_t)a * (uint64_t)b;
+    *hi = (uint32_t)(p >> 32);
+    *lo = (uint32_t)p;
+}
+
+void fahren_philox4x32(const uint32_t counter[4], uint64_t key, uint32_t out[4]) {
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+    for (int round = 0; round < 10; ++round) {
+        uint32_t hi0, lo0, hi1, lo1;
+        fahren_mulhilo32(0xD2511F53u, c0, &hi0, &lo0);
+        fahren_mulhilo32(0xCD9E8D57u, c2, &hi1, &lo1);
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+float fahren_rng_uniform(uint64_t seed, uint64_t stream, uint64_t counter) {
+    uint32_t ctr[4] = {(uint32_t)counter, (uint32_t)(counter >> 32),
+                       (uint32_t)stream, (uint32_t)(stream >> 32)};
+    uint32_t r[4];
+    fahren_philox4x32(ctr, seed, r);
+    return (float)(r[0] >> 8) * (1.0f / 16777216.0f); /* 24 bits -> [0,1) */
+}
+
+/* ---- top-k ------------------------------------------------------------ */
+
+typedef struct FahrenHeapItem {
+    float val;
+    int32_t idx;
+} FahrenHeapItem;
+
+/* Restore the min-heap property below position `i`. */
+static void fahren_heap_sift_down(FahrenHeapItem* h, size_t n, size_t i) {
+    FahrenHeapItem item = h[i];
+    for (;;) {
+        size_t c = 2 * i + 1;
+        if (c >= n) break;
+        if (c + 1 < n && h[c + 1].val < h[c].val) ++c;
+        if (h[c].val >= item.val) break;
+        h[i] = h[c];
+        i = c;
+    }
+    h[i] = item;
+}
+
+static inline void fahren_heap_offer(FahrenHeapItem* h, size_t k, float v, size_t i) {
+    if (v > h[0].val) {
+        h[0].val = v;
+        h[0].idx = (int32_t)i;
+        fahren_heap_sift_down(h, k, 0);
+    }
+}
+
+/* Top-k into a caller-provided heap of k items; leaves it as a min-heap. */
+static void fahren_topk_heap(const float* x, size_t n, size_t k, FahrenHeapItem* h) {
+    for (size_t i = 0; i < k; ++i) {
+        h[i].val = x[i];
+        h[i].idx = (int32_t)i;
+    }
+    for (size_t i = k / 2; i-- > 0;) fahren_heap_sift_down(h, k, i);
+
+    size_t i = k;
+#if defined(FAHREN_HAVE_SSE2)
+    /* Most blocks hold nothing above the current k-th value once the heap
+     * has warmed up; one compare + movemask rejects 8 logits at a time. */
+    for (; i + 8 <= n; i += 8) {
+        __m128 thr = _mm_set1_ps(h[0].val);
+        int mask = _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(x + i), thr)) |
+                   (_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(x + i + 4), thr)) << 4);
+        while (mask) {
+            int b = __builtin_ctz((unsigned)mask);
+            mask &= mask - 1;
+            fahren_heap_offer(h, k, x[i + (size_t)b], i + (size_t)b);
+        }
+    }
+#endif
+    for (; i < n; ++i) fahren_heap_offer(h, k, x[i], i);
+}
+
+/* Pop the min-heap into descending order in place. */
+static void fahren_heap_sort_desc(FahrenHeapItem* h, size_t k) {
+    for (size_t n = k; n > 1; --n) {
+        FahrenHeapItem t = h[0];
+        h[0] = h[n - 1];
+        h[n - 1] = t;
+        fahren_heap_sift_down(h, n - 1, 0);
+    }
+}
+
+size_t fahren_topk_f32(const float* x, size_t n, size_t k, int32_t* idx, float* val) {
+    if (!x || !idx || !val || n == 0 || k == 0) return 0;
+    if (k > n) k = n;
+    FahrenHeapItem* h = (FahrenHeapItem*)malloc(k * sizeof(FahrenHeapItem));
+    if (!h) return 0;
+    fahren_topk_heap(x, n, k, h);
+    fahren_heap_sort_desc(h, k);
+    for (size_t i = 0; i < k; ++i) {
+        idx[i] = h[i].idx;
+        val[i] = h[i].val;
+    }
+    free(h);
+    return k;
+}
+
+/* ---- top-p ------------------------------------------------------------ */
+
+static inline uint32_t fahren_float_key(float v) {
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    return u; /* probabilities are >= 0, so bit order == value order */
+}
+
+/* Find the smallest key T such that entries with key >= T carry at least
+ * `target` mass, by MSB-first radix select over 8-bit digits. `ckey` and
+ * `cmass` are scratch of n entries. Returns T and the kept mass. */
+static uint32_t fahren_top_p_cutoff(const float* p, size_t n, double target,
+                                    uint32_t* ckey, float* cmass, double* kept) {
+    double hist[256];
+    float sub[4][256];
+    uint32_t prefix = 0;
+    double above = 0.0;
+    size_t cand = 0;
+
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        /* Neighbouring probabilities usually share a bucket; four
+         * interleaved sub-histograms keep the adds from serializing. */
+        memset(sub, 0, sizeof(sub));
+        if (shift == 24) {
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                for (int j = 0; j < 4; ++j) sub[j][fahren_float_key(p[i + j]) >> 24] += p[i + j];
+            }
+            for (; i < n; ++i) sub[0][fahren_float_key(p[i]) >> 24] += p[i];
+        } else {
+            for (size_t i = 0; i < cand; ++i) sub[i & 3][(ckey[i] >> shift) & 0xFF] += cmass[i];
+        }
+        for (int d = 0; d < 256; ++d) {
+            hist[d] = (double)sub[0][d] + (double)sub[1][d] + (double)sub[2][d] + (double)sub[3][d];
+        }
+
+        int digit = -1, lowest = -1;
+        for (int d = 255; d >= 0; --d) {
+            if (hist[d] == 0.0) continue;
+            lowest = d;
+            if (above + hist[d] >= target) {
+                digit = d;
+                break;
+            }
+            above += hist[d];
+        }
+        if (digit < 0) {
+            /* rounding left us just short: keep everything */
+            digit = lowest < 0 ? 0 : lowest;
+            above -= lowest < 0 ? 0.0 : hist[lowest];
+        }
+        prefix |= (uint32_t)digit << shift;
+        *kept = above + hist[digit];
+
+        /* Narrow the candidate list to the chosen bucket. */
+        uint32_t mask = 0xFFFFFFFFu << shift;
+        size_t next = 0;
+        if (shift == 24) {
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t key = fahren_float_key(p[i]);
+                if ((key & mask) == prefix) {
+                    ckey[next] = key;
+                    cmass[next] = p[i];
+                    ++next;
+                }
+            }
+        } else {
+            for (size_t i = 0; i < cand; ++i) {
+                if ((ckey[i] & mask) == prefix) {
+                    ckey[next] = ckey[i];
+                    cmass[next] = cmass[i];
+                    ++next;
+                }
+            }
+        }
+        cand = next;
+        if (cand <= 1) break; /* remaining digits cannot split further */
+    }
+    /* If we stopped early the lone candidate's key is the exact cutoff. */
+    return cand == 1 ? ckey[0] : prefix;
+}
+
+/* ---- per-row sampling ------------------------------------------------- */
+
+typedef struct FahrenSampleJob {
+    const float* logits;
+    size_t vocab;
+    const FAHRENSamplingParams* params;
+    uint64_t step;
+    int32_t* out;
+    int failed;
+} FahrenSampleJob;
+
+static int32_t fahren_sample_row(const FahrenSampleJob* job, size_t row, float* probs,
+                                 uint32_t* ckey, float* cmass, FahrenHeapItem* heap) {
+    const FAHRENSamplingParams* sp = job->params;
+    const float* x = job->logits + row * job->vocab;
+    size_t n = job->vocab;
+    size_t k = sp->top_k > 0 ? (size_t)sp->top_k : 0;
+    if (k > n) k = n;
+    int use_p = sp->top_p > 0.0f && sp->top_p < 1.0f;
+
+    if (sp->temperature <= 0.0f) {
+        return (int32_t)fahren_argmax_f32(x, n);
+    }
+    float inv_t = 1.0f / sp->temperature;
+    float u = fahren_rng_uniform(sp->seed, row, job->step);
+
+    if (k > 0) {
+        /* Work on the k survivors only: sorted, so top-p is a prefix. */
+        fahren_topk_heap(x, n, k, heap);
+        fahren_heap_sort_desc(heap, k);
+        float m = heap[0].val;
+        double total = 0.0;
+        for (size_t i = 0; i < k; ++i) {
+            probs[i] = fahren_expf_approx((heap[i].val - m) * inv_t);
+            total += probs[i];
+        }
+        size_t keep = k;
+        double mass = total;
+        if (use_p) {
+            double target = (double)sp->top_p * total, acc = 0.0;
+            for (keep = 0; keep < k;) {
+                acc += probs[keep++];
+                if (acc >= target) break;
+            }
+            mass = acc;
+        }
+        double r = (double)u * mass, acc = 0.0;
+        for (size_t i = 0; i < keep; ++i) {
+            acc += probs[i];
+            if (r < acc) return heap[i].idx;
+        }
+        return heap[keep - 1].idx;
+    }
+
+    float m = fahren_max_f32(x, n);
+    double total = (double)fahren_exp_scaled_f32(x, probs, n, m, inv_t);
+    uint32_t cutoff = 0;
+    double mass = total;
+    if (use_p) {
+        cutoff = fahren_top_p_cutoff(probs, n, (double)sp->top_p * total, ckey, cmass, &mass);
+    }
+
+    /* Walk whole blocks by their kept mass and only look at single
+     * entries inside the block where the draw lands. `last` follows the
+     * last kept entry seen, the answer when rounding leaves r past the
+     * summed mass. */
+    double r = (double)u * mass, acc = 0.0;
+    size_t last = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        float block = 0.0f;
+        for (size_t j = 0; j < 16; ++j) {
+            int kept = fahren_float_key(probs[i + j]) >= cutoff;
+            block += kept ? probs[i + j] : 0.0f;
+            last = kept ? i + j : last;
+        }
+        if (r < acc + (double)block) break;
+        acc += (double)block;
+    }
+    for (; i < n; ++i) {
+        if (fahren_float_key(probs[i]) < cutoff) continue;
+        acc += probs[i];
+        last = i;
+        if (r < acc) return (int32_t)i;
+    }
+    return (int32_t)last;
+}
+
+/* Per-thread scratch, grown on demand and kept for the next call: a 50k
+ * vocabulary needs ~600 KB, and fresh allocations of that size are mmap'd
+ * and page-faulted on every step. It hangs off a pthread key whose
+ * destructor frees it when the thread exits. */
+typedef struct FahrenSampleScratch {
+    size_t vocab;
+    size_t k;
+    float* probs;
+    float* cmass;
+    uint32_t* ckey;
+    FahrenHeapItem* heap;
+} FahrenSampleScratch;
+
+static pthread_key_t g_scratch_key;
+static pthread_once_t g_scratch_once = PTHREAD_ONCE_INIT;
+static int g_scratch_key_ok;
+
+static void fahren_sample_scratch_free(void* p) {
+    FahrenSampleScratch* s = (FahrenSampleScratch*)p;
+    free(s->probs);
+    free(s->cmass);
+    free(s->ckey);
+    free(s->heap);
+    free(s);
+}
+
+static void fahren_sample_scratch_key(void) {
+    g_scratch_key_ok = pthread_key_create(&g_scratch_key, fahren_sample_scratch_free) == 0;
+}
+
+/* This thread's scratch with room for `vocab` entries and a k-heap, or
+ * NULL when it cannot be had. */
+static FahrenSampleScratch* fahren_sample_scratch_reserve(size_t vocab, size_t k) {
+    pthread_once(&g_scratch_once, fahren_sample_scratch_key);
+    if (!g_scratch_key_ok) return NULL;
+    FahrenSampleScratch* s = (FahrenSampleScratch*)pthread_getspecific(g_scratch_key);
+    if (!s) {
+        s = (FahrenSampleScratch*)calloc(1, sizeof(FahrenSampleScratch));
+        if (!s) return NULL;
+        if (pthread_setspecific(g_scratch_key, s) != 0) {
+            free(s);
+            return NULL;
+        }
+    }
+    if (vocab > s->vocab) {
+        float* probs = (float*)realloc(s->probs, vocab * sizeof(float));
+        if (probs) s->probs = probs;
+        float* cmass = (float*)realloc(s->cmass, vocab * sizeof(float));
+        if (cmass) s->cmass = cmass;
+        uint32_t* ckey = (uint32_t*)realloc(s->ckey, vocab * sizeof(uint32_t));
+        if (ckey) s->ckey = ckey;
+        if (!probs || !cmass || !ckey) return NULL;
+        s->vocab = vocab;
+    }
+    if (k > s->k) {
+        FahrenHeapItem* heap = (FahrenHeapItem*)realloc(s->heap, k * sizeof(FahrenHeapItem));
+        if (!heap) return NULL;
+        s->heap = heap;
+        s->k = k;
+    }
+    return s;
+}
+
+static void fahren_sample_rows(void* ctx, size_t begin, size_t end) {
+    FahrenSampleJob* job = (FahrenSampleJob*)ctx;
+    size_t n = job->vocab;
+    size_t k = job->params->top_k > 0 ? (size_t)job->params->top_k : 1;
+    if (k > n) k = n;
+
+    FahrenSampleScratch* s = fahren_sample_scratch_reserve(n, k);
+    if (!s) {
+        job->failed = 1;
+        return;
+    }
+    for (size_t row = begin; row < end; ++row) {
+        job->out[row] = fahren_sample_row(job, row, s->probs, s->ckey, s->cmass, s->heap);
+    }
+}
+
+FAHRENStatus fahren_sample_batch(const float* logits, size_t batch, size_t vocab,
+                                 const FAHRENSamplingParams* params, uint64_t step,
+                                 int32_t* out_tokens) {
+    if (!logits || !params || !out_tokens || vocab == 0 || vocab > INT32_MAX) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    if (params->top_k < 0 || isnan(params->temperature) || isnan(params->top_p)) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+
+    FahrenSampleJob job;
+    job.logits = logits;
+    job.vocab = vocab;
+    job.params = params;
+    job.step = step;
+    job.out = out_tokens;
+    job.failed = 0;
+    fahren_parallel_for(batch, 1, fahren_sample_rows, &job);
+    return job.failed ? FAHREN_ERROR_PROCESSING_FAILED : FAHREN_SUCCESS;
+}
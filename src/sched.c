@@ -0,0 +1,664 @@
+/* Earliest-deadline-first scheduler over several runtimes.
+ * See include/fahren/sched.h.
+ * Each model keeps a binary min-heap of pending requests keyed by
+ * (deadline, submission order) and a service-time model
+ * t(rows) = base + rows * row fitted by exponentially decayed least
+ * squares over the batches it has run. A worker picks the model with
+ * the earliest head deadline, sheds heads that cannot make it even
+ * alone, then grows the batch in deadline order while now + t(rows)
+ * still meets the first (nearest) deadline and leaves the other models'
+ * most urgent requests time to run after it.
+ * Admission estimates a new request's wait as the time until the first
+ * worker frees up plus the model's own queue, run in full batches and
+ * spread over the workers. Other models' queues are left out: EDF runs
+ * whichever work is due first, so they are ahead of it only in part.
+ * Batches run through fahren_runtime_forward_groups, one group per
+ * request, so a request cancelled mid-batch stops costing rows at the
+ * next layer; such a batch is not fed to the service-time model.
+ * Requests with a completion callback are chained on a list while the
+ * lock is held and their callbacks run after it is dropped, so a callback
+ * can submit the next request straight away. */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <fahren/sched.h>
+
+#define FAHREN_SCHED_DEFAULT_BATCH 64
+#define FAHREN_SCHED_DECAY 0.9
+#define FAHREN_SCHED_NO_DEADLINE UINT64_MAX
+
+/* NOTIFY: finished, callback not yet entered */
+enum { FAHREN_REQ_IDLE = 0, FAHREN_REQ_QUEUED = 1, FAHREN_REQ_RUNNING = 2, FAHREN_REQ_DONE = 3, FAHREN_REQ_NOTIFY = 4 };
+
+typedef struct FahrenSchedModel {
+    FAHRENRuntime* rt;
+    size_t id, in_dim, out_dim, max_batch;
+    uint64_t default_slo_ns;
+    size_t max_queue_rows;
+    uint64_t max_wait_ns;
+    FAHRENRequest** heap;
+    size_t heap_len, heap_cap;
+    size_t queued_rows;
+    /* decayed regression sums over (rows, ns) */
+    double n, sx, sy, sxx, sxy;
+    double base_ns, row_ns;
+    FAHRENSchedStats stats;
+} FahrenSchedModel;
+
+typedef struct FahrenSchedWorker {
+    FAHRENScheduler* sched;
+    pthread_t thread;
+    int started;
+    uint64_t busy_until;   /* estimated end of the running batch; 0 when idle */
+    FAHRENRequest** batch;
+    FAHRENForwardGroup* groups;
+    size_t batch_cap;
+    float* in;
+    float* out;
+    size_t in_cap, out_cap;
+} FahrenSchedWorker;
+
+struct FAHRENScheduler {
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;
+    pthread_cond_t done_cv;
+    int stopping;
+    uint64_t seq;
+    FahrenSchedModel** models;
+    size_t model_count, model_cap;
+    size_t worker_count;
+    FahrenSchedWorker* workers;
+    fahren_sched_trace_fn trace;
+    void* trace_user;
+    FAHRENRequest* fire;   /* finished requests whose callbacks are due */
+};
+
+uint64_t fahren_sched_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* ---- service-time model ------------------------------------------------- */
+
+static uint64_t fahren_sched_estimate(const FahrenSchedModel* m, size_t rows) {
+    double t = m->base_ns + m->row_ns * (double)rows;
+    return t > 0.0 ? (uint64_t)t : 0;
+}
+
+static void fahren_sched_observe(FahrenSchedModel* m, size_t rows, uint64_t ns) {
+    double x = (double)rows, y = (double)ns;
+    m->n = m->n * FAHREN_SCHED_DECAY + 1.0;
+    m->sx = m->sx * FAHREN_SCHED_DECAY + x;
+    m->sy = m->sy * FAHREN_SCHED_DECAY + y;
+    m->sxx = m->sxx * FAHREN_SCHED_DECAY + x * x;
+    m->sxy = m->sxy * FAHREN_SCHED_DECAY + x * y;
+    double var = m->n * m->sxx - m->sx * m->sx;
+    /* with too little spread in batch sizes only the intercept moves */
+    if (var > 1e-6 * m->n * m->n) {
+        double slope = (m->n * m->sxy - m->sx * m->sy) / var;
+        m->row_ns = slope > 0.0 ? slope : 0.0;
+    }
+    double base = (m->sy - m->row_ns * m->sx) / m->n;
+    m->base_ns = base > 0.0 ? base : 0.0;
+}
+
+/* ---- per-model deadline heap -------------------------------------------- */
+
+static int fahren_sched_before(const FAHRENRequest* a, const FAHRENRequest* b) {
+    if (a->deadline_ns != b->deadline_ns) return a->deadline_ns < b->deadline_ns;
+    return a->internal.seq < b->internal.seq;
+}
+
+static int fahren_sched_push(FahrenSchedModel* m, FAHRENRequest* req) {
+    if (m->heap_len == m->heap_cap) {
+        size_t cap = m->heap_cap ? m->heap_cap * 2 : 64;
+        FAHRENRequest** heap = (FAHRENRequest**)realloc(m->heap, cap * sizeof(FAHRENRequest*));
+        if (!heap) return 0;
+        m->heap = heap;
+        m->heap_cap = cap;
+    }
+    size_t i = m->heap_len++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!fahren_sched_before(req, m->heap[parent])) break;
+        m->heap[i] = m->heap[parent];
+        i = parent;
+    }
+    m->heap[i] = req;
+    m->queued_rows += req->rows;
+    return 1;
+}
+
+/* Place `req` at hole `i` or below it. */
+static void fahren_sched_sift_down(FahrenSchedModel* m, size_t i, FAHRENRequest* req) {
+    size_t n = m->heap_len;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && fahren_sched_before(m->heap[child + 1], m->heap[child])) child++;
+        if (!fahren_sched_before(m->heap[child], req)) break;
+        m->heap[i] = m->heap[child];
+        i = child;
+    }
+    m->heap[i] = req;
+}
+
+static FAHRENRequest* fahren_sched_pop(FahrenSchedModel* m) {
+    FAHRENRequest* top = m->heap[0];
+    FAHRENRequest* last = m->heap[--m->heap_len];
+    if (m->heap_len) fahren_sched_sift_down(m, 0, last);
+    m->queued_rows -= top->rows;
+    return top;
+}
+
+/* ---- completion --------------------------------------------------------- */
+
+/* Record a request's result (lock held). */
+static void fahren_sched_finish(FAHRENScheduler* s, FAHRENRequest* r, FAHRENStatus st) {
+    r->status = st;
+    if (r->on_done) {
+        __atomic_store_n(&r->internal.state, FAHREN_REQ_NOTIFY, __ATOMIC_RELAXED);
+        r->internal.next = s->fire;
+        s->fire = r;
+    } else {
+        __atomic_store_n(&r->internal.state, FAHREN_REQ_DONE, __ATOMIC_RELEASE);
+    }
+}
+
+/* Run the callbacks that are due and wake waiters (lock held; it is
+ * dropped while the callbacks run). */
+static void fahren_sched_fire(FAHRENScheduler* s) {
+    FAHRENRequest* list = s->fire;
+    if (list) {
+        s->fire = NULL;
+        pthread_mutex_unlock(&s->lock);
+        while (list) {
+            FAHRENRequest* r = list;
+            fahren_request_done_fn fn = r->on_done;
+            void* user = r->user;
+            list = r->internal.next;
+            /* DONE goes first: once fn runs it may resubmit or free r, so
+             * the scheduler must not touch r afterwards */
+            __atomic_store_n(&r->internal.state, FAHREN_REQ_DONE, __ATOMIC_RELEASE);
+            fn(r, user);
+        }
+        pthread_mutex_lock(&s->lock);
+    }
+    pthread_cond_broadcast(&s->done_cv);
+}
+
+/* ---- workers ------------------------------------------------------------ */
+
+static void fahren_sched_emit(FAHRENScheduler* s, FAHRENSchedEventType type, const FahrenSchedModel* m,
+                              uint64_t now, size_t requests, size_t rows, uint64_t deadline, int64_t slack,
+                              uint64_t estimated, uint64_t measured) {
+    if (!s->trace) return;
+    FAHRENSchedEvent ev;
+    ev.type = type;
+    ev.model = m->id;
+    ev.time_ns = now;
+    ev.requests = requests;
+    ev.rows = rows;
+    ev.deadline_ns = deadline;
+    ev.slack_ns = slack;
+    ev.estimated_ns = estimated;
+    ev.measured_ns = measured;
+    ev.queued = m->heap_len;
+    s->trace(s->trace_user, &ev);
+}
+
+static int64_t fahren_sched_slack(uint64_t deadline, uint64_t finish) {
+    if (deadline == FAHREN_SCHED_NO_DEADLINE) return INT64_MAX;
+    return deadline >= finish ? (int64_t)(deadline - finish) : -(int64_t)(finish - deadline);
+}
+
+/* Finish a request that never ran because its token fired (lock held). */
+static void fahren_sched_drop_cancelled(FAHRENScheduler* s, FahrenSchedModel* m, FAHRENRequest* r, uint64_t now) {
+    m->stats.cancelled++;
+    fahren_sched_emit(s, FAHREN_SCHED_CANCEL, m, now, 1, r->rows, r->deadline_ns, 0, 0, 0);
+    fahren_sched_finish(s, r, FAHREN_ERROR_CANCELLED);
+}
+
+/* Model whose most urgent request is due first; NULL when all are idle. */
+static FahrenSchedModel* fahren_sched_pick(FAHRENScheduler* s) {
+    FahrenSchedModel* best = NULL;
+    for (size_t i = 0; i < s->model_count; ++i) {
+        FahrenSchedModel* m = s->models[i];
+        if (m->heap_len && (!best || fahren_sched_before(m->heap[0], best->heap[0]))) best = m;
+    }
+    return best;
+}
+
+/* Latest time a batch of another model may finish without making the
+ * most urgent request queued elsewhere miss its deadline. */
+static uint64_t fahren_sched_others_limit(FAHRENScheduler* s, const FahrenSchedModel* m) {
+    uint64_t limit = FAHREN_SCHED_NO_DEADLINE;
+    for (size_t i = 0; i < s->model_count; ++i) {
+        const FahrenSchedModel* o = s->models[i];
+        if (o == m || !o->heap_len || o->heap[0]->deadline_ns == FAHREN_SCHED_NO_DEADLINE) continue;
+        uint64_t need = fahren_sched_estimate(o, o->heap[0]->rows);
+        uint64_t start_by = o->heap[0]->deadline_ns > need ? o->heap[0]->deadline_ns - need : 0;
+        if (start_by < limit) limit = start_by;
+    }
+    return limit;
+}
+
+/* Pop the next batch of `m` into the worker (lock held). The first
+ * request is always taken; later ones only while the batch still ends
+ * before both its own nearest deadline and other models' start-by time. */
+static size_t fahren_sched_form_batch(FAHRENScheduler* s, FahrenSchedModel* m, FahrenSchedWorker* w,
+                                      uint64_t now, size_t* rows_out, uint64_t* deadline_out) {
+    size_t count = 0, rows = 0;
+    uint64_t nearest = FAHREN_SCHED_NO_DEADLINE;
+    uint64_t limit = fahren_sched_others_limit(s, m);
+    while (m->heap_len) {
+        FAHRENRequest* r = m->heap[0];
+        if (fahren_cancelled(r->cancel)) {
+            fahren_sched_pop(m);
+            fahren_sched_drop_cancelled(s, m, r, now);
+            continue;
+        }
+        if (r->deadline_ns != FAHREN_SCHED_NO_DEADLINE && now + fahren_sched_estimate(m, r->rows) > r->deadline_ns) {
+            fahren_sched_pop(m);
+            m->stats.shed++;
+            fahren_sched_emit(s, FAHREN_SCHED_SHED, m, now, 1, r->rows, r->deadline_ns,
+                              fahren_sched_slack(r->deadline_ns, now + fahren_sched_estimate(m, r->rows)),
+                              fahren_sched_estimate(m, r->rows), 0);
+            fahren_sched_finish(s, r, FAHREN_ERROR_DEADLINE_EXCEEDED);
+            continue;
+        }
+        if (count) {
+            if (rows + r->rows > m->max_batch) break;
+            if (now + fahren_sched_estimate(m, rows + r->rows) > limit) break;
+        }
+        fahren_sched_pop(m);
+        if (count == 0) {
+            nearest = r->deadline_ns;
+            if (nearest < limit) limit = nearest;
+        }
+        __atomic_store_n(&r->internal.state, FAHREN_REQ_RUNNING, __ATOMIC_RELAXED);
+        w->batch[count++] = r;
+        rows += r->rows;
+    }
+    *rows_out = rows;
+    *deadline_out = nearest;
+    return count;
+}
+
+static int fahren_sched_reserve(float** buf, size_t* cap, size_t need) {
+    if (need <= *cap) return 1;
+    float* p = (float*)realloc(*buf, need * sizeof(float));
+    if (!p) return 0;
+    *buf = p;
+    *cap = need;
+    return 1;
+}
+
+static FAHRENStatus fahren_sched_execute(FahrenSchedModel* m, FahrenSchedWorker* w, size_t count, size_t rows) {
+    for (size_t i = 0; i < count; ++i) {
+        w->groups[i].rows = w->batch[i]->rows;
+        w->groups[i].cancel = w->batch[i]->cancel;
+    }
+    if (count == 1) return fahren_runtime_forward_groups(m->rt, w->batch[0]->input, w->groups, 1, w->batch[0]->output);
+    if (!fahren_sched_reserve(&w->in, &w->in_cap, rows * m->in_dim) ||
+        !fahren_sched_reserve(&w->out, &w->out_cap, rows * m->out_dim)) {
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    size_t row = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const FAHRENRequest* r = w->batch[i];
+        memcpy(w->in + row * m->in_dim, r->input, r->rows * m->in_dim * sizeof(float));
+        row += r->rows;
+    }
+    FAHRENStatus st = fahren_runtime_forward_groups(m->rt, w->in, w->groups, count, w->out);
+    row = 0;
+    for (size_t i = 0; i < count && st == FAHREN_SUCCESS; ++i) {
+        FAHRENRequest* r = w->batch[i];
+        if (!w->groups[i].cancelled) {
+            memcpy(r->output, w->out + row * m->out_dim, r->rows * m->out_dim * sizeof(float));
+        }
+        row += r->rows;
+    }
+    return st;
+}
+
+static void* fahren_sched_worker(void* arg) {
+    FahrenSchedWorker* w = (FahrenSchedWorker*)arg;
+    FAHRENScheduler* s = w->sched;
+    pthread_mutex_lock(&s->lock);
+    while (!s->stopping) {
+        FahrenSchedModel* m = fahren_sched_pick(s);
+        if (!m) {
+            pthread_cond_wait(&s->work_cv, &s->lock);
+            continue;
+        }
+        if (w->batch_cap < m->max_batch) {
+            FAHRENRequest** b = (FAHRENRequest**)realloc(w->batch, m->max_batch * sizeof(FAHRENRequest*));
+            if (b) w->batch = b;
+            FAHRENForwardGroup* g =
+                (FAHRENForwardGroup*)realloc(w->groups, m->max_batch * sizeof(FAHRENForwardGroup));
+            if (g) w->groups = g;
+            if (!b || !g) {
+                /* fail the head so the queue still drains */
+                fahren_sched_finish(s, fahren_sched_pop(m), FAHREN_ERROR_PROCESSING_FAILED);
+                fahren_sched_fire(s);
+                continue;
+            }
+            w->batch_cap = m->max_batch;
+        }
+        uint64_t now = fahren_sched_now_ns();
+        size_t rows;
+        uint64_t nearest;
+        size_t count = fahren_sched_form_batch(s, m, w, now, &rows, &nearest);
+        /* requests shed or cancelled on the way are reported first */
+        if (s->fire || count == 0) fahren_sched_fire(s);
+        if (count == 0) continue;
+        uint64_t est = fahren_sched_estimate(m, rows);
+        w->busy_until = now + est;
+        fahren_sched_emit(s, FAHREN_SCHED_BATCH_START, m, now, count, rows, nearest,
+                          fahren_sched_slack(nearest, now + est), est, 0);
+        pthread_mutex_unlock(&s->lock);
+
+        FAHRENStatus st = fahren_sched_execute(m, w, count, rows);
+        uint64_t end = fahren_sched_now_ns();
+
+        pthread_mutex_lock(&s->lock);
+        w->busy_until = 0;
+        size_t dropped = 0;
+        for (size_t i = 0; i < count; ++i) {
+            FAHRENRequest* r = w->batch[i];
+            if (w->groups[i].cancelled) {
+                dropped++;
+                fahren_sched_finish(s, r, FAHREN_ERROR_CANCELLED);
+            } else {
+                if (r->deadline_ns < end) m->stats.late++;
+                fahren_sched_finish(s, r, st);
+            }
+        }
+        /* a batch that shrank partway says little about either size */
+        if (!dropped) fahren_sched_observe(m, rows, end - now);
+        m->stats.batches++;
+        m->stats.rows += rows;
+        m->stats.completed += count - dropped;
+        m->stats.cancelled += dropped;
+        fahren_sched_emit(s, FAHREN_SCHED_BATCH_DONE, m, end, count, rows, nearest, fahren_sched_slack(nearest, end),
+                          est, end - now);
+        fahren_sched_fire(s);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+/* ---- public API --------------------------------------------------------- */
+
+FAHRENStatus fahren_scheduler_create(const FAHRENSchedulerConfig* config, FAHRENScheduler** out) {
+    if (!out) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *out = NULL;
+    FAHRENScheduler* s = (FAHRENScheduler*)calloc(1, sizeof(FAHRENScheduler));
+    if (!s) return FAHREN_ERROR_PROCESSING_FAILED;
+    s->worker_count = config && config->workers ? config->workers : 1;
+    s->trace = config ? config->trace : NULL;
+    s->trace_user = config ? config->trace_user : NULL;
+    s->workers = (FahrenSchedWorker*)calloc(s->worker_count, sizeof(FahrenSchedWorker));
+    if (!s->workers) {
+        free(s);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->work_cv, NULL);
+    pthread_cond_init(&s->done_cv, NULL);
+    for (size_t i = 0; i < s->worker_count; ++i) {
+        s->workers[i].sched = s;
+        if (pthread_create(&s->workers[i].thread, NULL, fahren_sched_worker, &s->workers[i]) != 0) break;
+        s->workers[i].started = 1;
+    }
+    if (!s->workers[0].started) {
+        fahren_scheduler_destroy(s);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    *out = s;
+    return FAHREN_SUCCESS;
+}
+
+void fahren_scheduler_destroy(FAHRENScheduler* s) {
+    if (!s) return;
+    pthread_mutex_lock(&s->lock);
+    s->stopping = 1;
+    pthread_cond_broadcast(&s->work_cv);
+    pthread_mutex_unlock(&s->lock);
+    for (size_t i = 0; i < s->worker_count; ++i) {
+        FahrenSchedWorker* w = &s->workers[i];
+        if (w->started) pthread_join(w->thread, NULL);
+        free(w->batch);
+        free(w->groups);
+        free(w->in);
+        free(w->out);
+    }
+    /* Callbacks run before the models go away: one that submits again
+     * still finds them, and is refused because the scheduler is stopping */
+    pthread_mutex_lock(&s->lock);
+    for (size_t i = 0; i < s->model_count; ++i) {
+        FahrenSchedModel* m = s->models[i];
+        while (m->heap_len) fahren_sched_finish(s, fahren_sched_pop(m), FAHREN_ERROR_NOT_INITIALIZED);
+    }
+    fahren_sched_fire(s);
+    pthread_mutex_unlock(&s->lock);
+    for (size_t i = 0; i < s->model_count; ++i) {
+        free(s->models[i]->heap);
+        free(s->models[i]);
+    }
+    pthread_cond_destroy(&s->work_cv);
+    pthread_cond_destroy(&s->done_cv);
+    pthread_mutex_destroy(&s->lock);
+    free(s->models);
+    free(s->workers);
+    free(s);
+}
+
+/* Two timed passes (one row, a full batch) seed the service-time model so
+ * the first real deadlines are judged against something. */
+static FAHRENStatus fahren_sched_calibrate(FahrenSchedModel* m) {
+    size_t rows = m->max_batch;
+    float* x = (float*)calloc(rows * m->in_dim, sizeof(float));
+    float* y = (float*)malloc(rows * m->out_dim * sizeof(float));
+    FAHRENStatus st = x && y ? FAHREN_SUCCESS : FAHREN_ERROR_PROCESSING_FAILED;
+    for (int pass = 0; pass < 2 && st == FAHREN_SUCCESS; ++pass) {
+        size_t sizes[2] = {1, rows};
+        for (size_t k = 0; k < 2 && st == FAHREN_SUCCESS; ++k) {
+            uint64_t t0 = fahren_sched_now_ns();
+            st = fahren_runtime_forward(m->rt, x, sizes[k], y);
+            /* the first pass warms caches and page tables */
+            if (pass) fahren_sched_observe(m, sizes[k], fahren_sched_now_ns() - t0);
+        }
+    }
+    free(x);
+    free(y);
+    return st;
+}
+
+FAHRENStatus fahren_scheduler_add_model(FAHRENScheduler* s, FAHRENRuntime* rt,
+                                        const FAHRENSchedModelConfig* config, size_t* model) {
+    if (!s || !rt || !model) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenSchedModel* m = (FahrenSchedModel*)calloc(1, sizeof(FahrenSchedModel));
+    if (!m) return FAHREN_ERROR_PROCESSING_FAILED;
+    m->rt = rt;
+    m->in_dim = fahren_runtime_input_dim(rt);
+    m->out_dim = fahren_runtime_output_dim(rt);
+    m->max_batch = config && config->max_batch_rows ? config->max_batch_rows : FAHREN_SCHED_DEFAULT_BATCH;
+    m->default_slo_ns = config ? (uint64_t)config->default_slo_us * 1000ull : 0;
+    m->max_queue_rows = config ? config->max_queue_rows : 0;
+    m->max_wait_ns = config ? (uint64_t)config->max_wait_us * 1000ull : 0;
+    FAHRENStatus st = fahren_sched_calibrate(m);
+    if (st != FAHREN_SUCCESS) {
+        free(m);
+        return st;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    if (s->model_count == s->model_cap) {
+        size_t cap = s->model_cap ? s->model_cap * 2 : 8;
+        FahrenSchedModel** models = (FahrenSchedModel**)realloc(s->models, cap * sizeof(FahrenSchedModel*));
+        if (!models) {
+            pthread_mutex_unlock(&s->lock);
+            free(m);
+            return FAHREN_ERROR_PROCESSING_FAILED;
+        }
+        s->models = models;
+        s->model_cap = cap;
+    }
+    m->id = s->model_count;
+    s->models[s->model_count++] = m;
+    *model = m->id;
+    pthread_mutex_unlock(&s->lock);
+    return FAHREN_SUCCESS;
+}
+
+/* Estimated time from now until a request queued behind the model's
+ * current backlog starts running (lock held). */
+static uint64_t fahren_sched_wait(const FAHRENScheduler* s, const FahrenSchedModel* m, uint64_t now) {
+    uint64_t first_free = UINT64_MAX;
+    for (size_t i = 0; i < s->worker_count; ++i) {
+        const FahrenSchedWorker* w = &s->workers[i];
+        if (!w->started) continue;
+        uint64_t left = w->busy_until > now ? w->busy_until - now : 0;
+        if (left < first_free) first_free = left;
+    }
+    if (first_free == UINT64_MAX) first_free = 0;
+    size_t batches = (m->queued_rows + m->max_batch - 1) / m->max_batch;
+    double backlog = (double)batches * m->base_ns + (double)m->queued_rows * m->row_ns;
+    return first_free + (uint64_t)(backlog / (double)s->worker_count);
+}
+
+FAHRENStatus fahren_scheduler_submit(FAHRENScheduler* s, FAHRENRequest* req) {
+    if (!s || !req || !req->input || !req->output || req->rows == 0) return FAHREN_ERROR_INVALID_ARGUMENT;
+    uint64_t now = fahren_sched_now_ns();
+    pthread_mutex_lock(&s->lock);
+    if (s->stopping) {
+        pthread_mutex_unlock(&s->lock);
+        return FAHREN_ERROR_NOT_INITIALIZED;
+    }
+    if (req->model >= s->model_count || req->rows > s->models[req->model]->max_batch ||
+        req->internal.state == FAHREN_REQ_QUEUED || req->internal.state == FAHREN_REQ_RUNNING ||
+        req->internal.state == FAHREN_REQ_NOTIFY) {
+        pthread_mutex_unlock(&s->lock);
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    FahrenSchedModel* m = s->models[req->model];
+    if (fahren_cancelled(req->cancel)) {
+        pthread_mutex_unlock(&s->lock);
+        return FAHREN_ERROR_CANCELLED;
+    }
+    uint64_t deadline = req->deadline_ns;
+    if (deadline == 0) deadline = m->default_slo_ns ? now + m->default_slo_ns : FAHREN_SCHED_NO_DEADLINE;
+    uint64_t wait = fahren_sched_wait(s, m, now);
+    uint64_t finish = now + wait + fahren_sched_estimate(m, req->rows);
+    if ((m->max_queue_rows && m->queued_rows + req->rows > m->max_queue_rows) ||
+        (m->max_wait_ns && wait > m->max_wait_ns) || finish > deadline) {
+        /* the request is left untouched so the caller can retry it as is */
+        m->stats.rejected++;
+        fahren_sched_emit(s, FAHREN_SCHED_REJECT, m, now, 1, req->rows, deadline, fahren_sched_slack(deadline, finish),
+                          finish - now, 0);
+        pthread_mutex_unlock(&s->lock);
+        return FAHREN_ERROR_OVERLOADED;
+    }
+    req->deadline_ns = deadline;
+    req->internal.seq = s->seq++;
+    req->internal.submit_ns = now;
+    if (!fahren_sched_push(m, req)) {
+        pthread_mutex_unlock(&s->lock);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    __atomic_store_n(&req->internal.state, FAHREN_REQ_QUEUED, __ATOMIC_RELAXED);
+    m->stats.submitted++;
+    fahren_sched_emit(s, FAHREN_SCHED_SUBMIT, m, now, 1, req->rows, req->deadline_ns,
+                      fahren_sched_slack(req->deadline_ns, finish), finish - now, 0);
+    pthread_cond_signal(&s->work_cv);
+    pthread_mutex_unlock(&s->lock);
+    return FAHREN_SUCCESS;
+}
+
+void fahren_scheduler_cancel(FAHRENScheduler* s, FAHRENCancelToken* token) {
+    if (!s || !token) return;
+    uint64_t now = fahren_sched_now_ns();
+    pthread_mutex_lock(&s->lock);
+    fahren_cancel(token);
+    for (size_t i = 0; i < s->model_count; ++i) {
+        FahrenSchedModel* m = s->models[i];
+        size_t kept = 0;
+        for (size_t k = 0; k < m->heap_len; ++k) {
+            FAHRENRequest* r = m->heap[k];
+            if (r->cancel == token) {
+                m->queued_rows -= r->rows;
+                fahren_sched_drop_cancelled(s, m, r, now);
+            } else {
+                m->heap[kept++] = r;
+            }
+        }
+        if (kept == m->heap_len) continue;
+        m->heap_len = kept;
+        for (size_t k = kept / 2; k-- > 0;) fahren_sched_sift_down(m, k, m->heap[k]);
+    }
+    fahren_sched_fire(s);
+    pthread_mutex_unlock(&s->lock);
+}
+
+FAHRENStatus fahren_request_wait(FAHRENScheduler* s, FAHRENRequest* req) {
+    if (!s || !req) return FAHREN_ERROR_INVALID_ARGUMENT;
+    pthread_mutex_lock(&s->lock);
+    if (req->internal.state == FAHREN_REQ_IDLE) {
+        pthread_mutex_unlock(&s->lock);
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    while (__atomic_load_n(&req->internal.state, __ATOMIC_ACQUIRE) != FAHREN_REQ_DONE) {
+        pthread_cond_wait(&s->done_cv, &s->lock);
+    }
+    FAHRENStatus st = req->status;
+    pthread_mutex_unlock(&s->lock);
+    return st;
+}
+
+int fahren_request_poll(FAHRENScheduler* s, FAHRENRequest* req, FAHRENStatus* status) {
+    if (!s || !req) return 0;
+    if (__atomic_load_n(&req->internal.state, __ATOMIC_ACQUIRE) != FAHREN_REQ_DONE) return 0;
+    if (status) *status = req->status;
+    return 1;
+}
+
+void fahren_request_signal_eventfd(FAHRENRequest* req, void* user) {
+    (void)req;
+    uint64_t one = 1;
+    for (;;) {
+        ssize_t n = write((int)(intptr_t)user, &one, sizeof(one));
+        /* a full counter or pipe already has a wakeup pending */
+        if (n >= 0 || errno != EINTR) break;
+    }
+}
+
+FAHRENStatus fahren_scheduler_stats(FAHRENScheduler* s, size_t model, FAHRENSchedStats* stats) {
+    if (!s || !stats) return FAHREN_ERROR_INVALID_ARGUMENT;
+    pthread_mutex_lock(&s->lock);
+    if (model >= s->model_count) {
+        pthread_mutex_unlock(&s->lock);
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    FahrenSchedModel* m = s->models[model];
+    *stats = m->stats;
+    stats->base_ns = m->base_ns;
+    stats->row_ns = m->row_ns;
+    pthread_mutex_unlock(&s->lock);
+    return FAHREN_SUCCESS;
+}
+
+FAHRENRuntime* fahren_scheduler_runtime(FAHRENScheduler* s, size_t model) {
+    if (!s) return NULL;
+    pthread_mutex_lock(&s->lock);
+    FAHRENRuntime* rt = model < s->model_count ? s->models[model]->rt : NULL;
+    pthread_mutex_unlock(&s->lock);
+    return rt;
+}
@@ -0,0 +1,218 @@
+/* Strided tensor views. See include/fahren/tensor.h.
+ * Views only rewrite shape, strides and offset. fahren_tensor_reshape
+ * follows the usual no-copy rule: size-1 axes are dropped, then runs of
+ * old and new axes with equal products are matched, and a run can be
+ * re-split only if its old axes are nested (stride[k] = shape[k + 1] *
+ * stride[k + 1]). fahren_tensor_copy walks every position of all but the
+ * last axis in parallel and moves the last axis with memcpy when both
+ * sides are unit-stride there. */
+#include <string.h>
+
+#include <fahren/tensor.h>
+#include "fahren_internal.h"
+
+#define FAHREN_TENSOR_COPY_GRAIN 4096 /* elements per parallel chunk, roughly */
+
+size_t fahren_dtype_size(FAHRENDType dtype) {
+    switch (dtype) {
+    case FAHREN_DTYPE_F32:
+        return sizeof(float);
+    case FAHREN_DTYPE_F16:
+    case FAHREN_DTYPE_BF16:
+        return sizeof(uint16_t);
+    default:
+        return 0;
+    }
+}
+
+static void fahren_tensor_pack_strides(FAHRENTensor* t) {
+    ptrdiff_t stride = 1;
+    for (size_t k = t->rank; k-- > 0;) {
+        t->strides[k] = stride;
+        stride *= (ptrdiff_t)t->shape[k];
+    }
+}
+
+FAHRENStatus fahren_tensor_init(FAHRENTensor* t, FAHRENDType dtype, void* base, size_t offset, size_t rank,
+                                const size_t* shape) {
+    if (!t || fahren_dtype_size(dtype) == 0 || rank > FAHREN_TENSOR_MAX_RANK || (rank && !shape)) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    memset(t, 0, sizeof(*t));
+    t->dtype = dtype;
+    t->rank = rank;
+    for (size_t k = 0; k < rank; ++k) t->shape[k] = shape[k];
+    fahren_tensor_pack_strides(t);
+    t->base = base;
+    t->offset = offset;
+    return FAHREN_SUCCESS;
+}
+
+size_t fahren_tensor_numel(const FAHRENTensor* t) {
+    if (!t) return 0;
+    size_t n = 1;
+    for (size_t k = 0; k < t->rank; ++k) n *= t->shape[k];
+    return n;
+}
+
+int fahren_tensor_is_contiguous(const FAHRENTensor* t) {
+    if (!t) return 0;
+    ptrdiff_t stride = 1;
+    for (size_t k = t->rank; k-- > 0;) {
+        if (t->shape[k] != 1 && t->strides[k] != stride) return 0;
+        stride *= (ptrdiff_t)t->shape[k];
+    }
+    return 1;
+}
+
+void* fahren_tensor_data(const FAHRENTensor* t) {
+    if (!t || !t->base) return NULL;
+    return (char*)t->base + t->offset * fahren_dtype_size(t->dtype);
+}
+
+static void fahren_tensor_move_offset(FAHRENTensor* t, ptrdiff_t delta) {
+    t->offset = (size_t)((ptrdiff_t)t->offset + delta);
+}
+
+FAHRENStatus fahren_tensor_slice(const FAHRENTensor* t, size_t axis, size_t begin, size_t end, FAHRENTensor* out) {
+    if (!t || !out || axis >= t->rank || begin > end || end > t->shape[axis]) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *out = *t;
+    fahren_tensor_move_offset(out, (ptrdiff_t)begin * t->strides[axis]);
+    out->shape[axis] = end - begin;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_tensor_transpose(const FAHRENTensor* t, size_t axis_a, size_t axis_b, FAHRENTensor* out) {
+    if (!t || !out || axis_a >= t->rank || axis_b >= t->rank) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FAHRENTensor r = *t;
+    r.shape[axis_a] = t->shape[axis_b];
+    r.shape[axis_b] = t->shape[axis_a];
+    r.strides[axis_a] = t->strides[axis_b];
+    r.strides[axis_b] = t->strides[axis_a];
+    *out = r;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_tensor_flip(const FAHRENTensor* t, size_t axis, FAHRENTensor* out) {
+    if (!t || !out || axis >= t->rank) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *out = *t;
+    if (t->shape[axis] > 1) fahren_tensor_move_offset(out, (ptrdiff_t)(t->shape[axis] - 1) * t->strides[axis]);
+    out->strides[axis] = -t->strides[axis];
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_tensor_broadcast(const FAHRENTensor* t, size_t axis, size_t size, FAHRENTensor* out) {
+    if (!t || !out || axis >= t->rank || t->shape[axis] != 1) return FAHREN_ERROR_INVALID_ARGUMENT;
+    *out = *t;
+    out->shape[axis] = size;
+    out->strides[axis] = 0;
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_tensor_reshape(const FAHRENTensor* t, size_t rank, const size_t* shape, FAHRENTensor* out) {
+    if (!t || !out || rank > FAHREN_TENSOR_MAX_RANK || (rank && !shape)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    size_t numel = 1;
+    for (size_t k = 0; k < rank; ++k) numel *= shape[k];
+    if (numel != fahren_tensor_numel(t)) return FAHREN_ERROR_INVALID_ARGUMENT;
+
+    FAHRENTensor r = *t;
+    r.rank = rank;
+    for (size_t k = 0; k < rank; ++k) r.shape[k] = shape[k];
+    if (numel == 0) {
+        fahren_tensor_pack_strides(&r);
+        *out = r;
+        return FAHREN_SUCCESS;
+    }
+
+    size_t old_dims[FAHREN_TENSOR_MAX_RANK];
+    ptrdiff_t old_strides[FAHREN_TENSOR_MAX_RANK];
+    size_t old_rank = 0;
+    for (size_t k = 0; k < t->rank; ++k) {
+        if (t->shape[k] == 1) continue;
+        old_dims[old_rank] = t->shape[k];
+        old_strides[old_rank++] = t->strides[k];
+    }
+    size_t ni = 0, nj = 1, oi = 0, oj = 1;
+    while (ni < rank && oi < old_rank) {
+        size_t np = shape[ni], op = old_dims[oi];
+        while (np != op) {
+            if (np < op) np *= shape[nj++];
+            else op *= old_dims[oj++];
+        }
+        for (size_t k = oi; k + 1 < oj; ++k) {
+            if (old_strides[k] != (ptrdiff_t)old_dims[k + 1] * old_strides[k + 1]) return FAHREN_ERROR_INVALID_ARGUMENT;
+        }
+        r.strides[nj - 1] = old_strides[oj - 1];
+        for (size_t k = nj - 1; k > ni; --k) r.strides[k - 1] = r.strides[k] * (ptrdiff_t)shape[k];
+        ni = nj++;
+        oi = oj++;
+    }
+    /* trailing size-1 axes */
+    for (size_t k = ni; k < rank; ++k) r.strides[k] = ni ? r.strides[ni - 1] : 1;
+    *out = r;
+    return FAHREN_SUCCESS;
+}
+
+/* ---- copy --------------------------------------------------------------- */
+
+typedef struct FahrenCopyJob {
+    const FAHRENTensor* src;
+    const FAHRENTensor* dst;
+    const char* s;
+    char* d;
+    size_t esize;
+    size_t outer_rank;  /* all but the last axis */
+    size_t inner;       /* last-axis length */
+} FahrenCopyJob;
+
+static void fahren_tensor_copy_rows(void* ctx, size_t begin, size_t end) {
+    const FahrenCopyJob* job = (const FahrenCopyJob*)ctx;
+    size_t k_last = job->outer_rank;
+    ptrdiff_t ss = job->outer_rank < job->src->rank ? job->src->strides[k_last] : 0;
+    ptrdiff_t ds = job->outer_rank < job->dst->rank ? job->dst->strides[k_last] : 0;
+    for (size_t row = begin; row < end; ++row) {
+        ptrdiff_t so = 0, dof = 0;
+        size_t rest = row;
+        for (size_t k = job->outer_rank; k-- > 0;) {
+            size_t idx = rest % job->src->shape[k];
+            rest /= job->src->shape[k];
+            so += (ptrdiff_t)idx * job->src->strides[k];
+            dof += (ptrdiff_t)idx * job->dst->strides[k];
+        }
+        const char* s = job->s + so * (ptrdiff_t)job->esize;
+        char* d = job->d + dof * (ptrdiff_t)job->esize;
+        if (ss == 1 && ds == 1) {
+            memcpy(d, s, job->inner * job->esize);
+        } else if (job->esize == sizeof(float)) {
+            const float* sf = (const float*)s;
+            float* df = (float*)d;
+            for (size_t i = 0; i < job->inner; ++i) df[(ptrdiff_t)i * ds] = sf[(ptrdiff_t)i * ss];
+        } else {
+            const uint16_t* sh = (const uint16_t*)s;
+            uint16_t* dh = (uint16_t*)d;
+            for (size_t i = 0; i < job->inner; ++i) dh[(ptrdiff_t)i * ds] = sh[(ptrdiff_t)i * ss];
+        }
+    }
+}
+
+FAHRENStatus fahren_tensor_copy(const FAHRENTensor* src, const FAHRENTensor* dst) {
+    if (!src || !dst || src->dtype != dst->dtype || src->rank != dst->rank) return FAHREN_ERROR_INVALID_ARGUMENT;
+    for (size_t k = 0; k < src->rank; ++k) {
+        if (src->shape[k] != dst->shape[k]) return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    size_t numel = fahren_tensor_numel(src);
+    if (numel == 0) return FAHREN_SUCCESS;
+    FahrenCopyJob job;
+    job.src = src;
+    job.dst = dst;
+    job.s = (const char*)fahren_tensor_data(src);
+    job.d = (char*)fahren_tensor_data(dst);
+    job.esize = fahren_dtype_size(src->dtype);
+    if (!job.s || !job.d || job.esize == 0) return FAHREN_ERROR_INVALID_ARGUMENT;
+    job.outer_rank = src->rank ? src->rank - 1 : 0;
+    job.inner = src->rank ? src->shape[src->rank - 1] : 1;
+    size_t rows = numel / job.inner;
+    size_t grain = FAHREN_TENSOR_COPY_GRAIN / job.inner + 1;
+    fahren_parallel_for(rows, grain, fahren_tensor_copy_rows, &job);
+    return FAHREN_SUCCESS;
+}
@@ -0,0 +1,283 @@
+/* Built-in thread pool used by the parallel kernels.
+ * The pool is created lazily on first use and lives until the process
+ * exits. It runs one parallel loop at a time: workers grab chunks from a
+ * shared atomic cursor, the caller helps, and the last worker to detach
+ * wakes the caller. Set FAHREN_NUM_THREADS to override the thread count.
+ * When the host installs an executor (include/fahren/executor.h) loops go
+ * to it instead. Without its own parallel_for, a loop uses the same
+ * chunk cursor: the caller submits helper tasks and drains alongside
+ * them. That job lives on the heap and is reference counted, because a
+ * helper the host schedules late may start after the caller has
+ * returned; the caller waits for claimed chunks to finish, not for every
+ * helper to start. */
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "fahren_internal.h"
+
+/* One parallel loop. Lives on the caller's stack; the caller does not
+ * return until no worker still references it. */
+typedef struct FahrenJob {
+    fahren_range_fn fn;
+    void* ctx;
+    size_t n;
+    size_t chunk;
+    atomic_size_t next;  /* first index of the next unclaimed chunk */
+    size_t active;       /* workers currently attached (under pool lock) */
+} FahrenJob;
+
+typedef struct FahrenPool {
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;
+    pthread_cond_t done_cv;
+    pthread_mutex_t job_lock;  /* serializes callers: one loop at a time */
+    size_t thread_count;       /* workers + calling thread */
+    uint64_t generation;       /* bumped for every new loop */
+    FahrenJob* job;            /* loop in progress or NULL */
+} FahrenPool;
+
+static FahrenPool g_pool;
+static pthread_once_t g_pool_once = PTHREAD_ONCE_INIT;
+static _Thread_local int t_in_pool = 0;
+
+/* The installed executor is published through g_executor_ptr. */
+static FAHRENExecutor g_executor;
+static const FAHRENExecutor* g_executor_ptr;
+
+/* A loop split across executor tasks. `refs` counts the caller plus
+ * every helper submitted; the last one to let go frees it. */
+typedef struct FahrenExecJob {
+    fahren_range_fn fn;
+    void* ctx;
+    size_t n;
+    size_t chunk;
+    atomic_size_t next;
+    atomic_size_t done;  /* indices finished */
+    atomic_size_t refs;
+    pthread_mutex_t lock;
+    pthread_cond_t done_cv;
+} FahrenExecJob;
+
+/* Grab and run chunks until the cursor passes the end. */
+static void fahren_pool_drain(FahrenJob* job) {
+    for (;;) {
+        size_t begin = atomic_fetch_add(&job->next, job->chunk);
+        if (begin >= job->n) break;
+        size_t end = job->n - begin > job->chunk ? begin + job->chunk : job->n;
+        job->fn(job->ctx, begin, end);
+    }
+}
+
+static void* fahren_pool_worker(void* arg) {
+    FahrenPool* p = (FahrenPool*)arg;
+    uint64_t seen = 0;
+    t_in_pool = 1;
+    for (;;) {
+        pthread_mutex_lock(&p->lock);
+        while (p->generation == seen) pthread_cond_wait(&p->work_cv, &p->lock);
+        seen = p->generation;
+        FahrenJob* job = p->job;
+        if (job) job->active++;
+        pthread_mutex_unlock(&p->lock);
+        if (!job) continue;
+
+        fahren_pool_drain(job);
+
+        pthread_mutex_lock(&p->lock);
+        if (--job->active == 0) pthread_cond_signal(&p->done_cv);
+        pthread_mutex_unlock(&p->lock);
+    }
+    return NULL;
+}
+
+static void fahren_pool_create(void) {
+    FahrenPool* p = &g_pool;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_mutex_init(&p->job_lock, NULL);
+    pthread_cond_init(&p->work_cv, NULL);
+    pthread_cond_init(&p->done_cv, NULL);
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    const char* env = getenv("FAHREN_NUM_THREADS");
+    if (env && atoi(env) > 0) cpus = atoi(env);
+    if (cpus < 1) cpus = 1;
+
+    p->thread_count = 1;
+    for (long i = 1; i < cpus; ++i) {
+        pthread_t th;
+        if (pthread_create(&th, NULL, fahren_pool_worker, p) != 0) break;
+        pthread_detach(th);
+        p->thread_count++;
+    }
+}
+
+/* ---- host executor ------------------------------------------------------ */
+
+static void fahren_exec_release(FahrenExecJob* job) {
+    if (atomic_fetch_sub(&job->refs, 1) != 1) return;
+    pthread_cond_destroy(&job->done_cv);
+    pthread_mutex_destroy(&job->lock);
+    free(job);
+}
+
+static void fahren_exec_drain(FahrenExecJob* job) {
+    for (;;) {
+        size_t begin = atomic_fetch_add(&job->next, job->chunk);
+        if (begin >= job->n) break;
+        size_t end = job->n - begin > job->chunk ? begin + job->chunk : job->n;
+        job->fn(job->ctx, begin, end);
+        if (atomic_fetch_add(&job->done, end - begin) + (end - begin) == job->n) {
+            pthread_mutex_lock(&job->lock);
+            pthread_cond_signal(&job->done_cv);
+            pthread_mutex_unlock(&job->lock);
+        }
+    }
+}
+
+static void fahren_exec_helper(void* arg) {
+    FahrenExecJob* job = (FahrenExecJob*)arg;
+    int nested = t_in_pool;
+    t_in_pool = 1;
+    fahren_exec_drain(job);
+    t_in_pool = nested;
+    fahren_exec_release(job);
+}
+
+/* Host parallel_for callbacks see this trampoline, so loops nested in
+ * the body run inline whichever thread the host picked. */
+typedef struct FahrenExecBody {
+    fahren_range_fn fn;
+    void* ctx;
+} FahrenExecBody;
+
+static void fahren_exec_body(void* arg, size_t begin, size_t end) {
+    const FahrenExecBody* body = (const FahrenExecBody*)arg;
+    int nested = t_in_pool;
+    t_in_pool = 1;
+    body->fn(body->ctx, begin, end);
+    t_in_pool = nested;
+}
+
+static void fahren_exec_parallel_for(const FAHRENExecutor* ex, size_t threads, size_t n, size_t grain,
+                                     fahren_range_fn fn, void* ctx) {
+    if (ex->parallel_for) {
+        FahrenExecBody body = {fn, ctx};
+        ex->parallel_for(ex->user, n, grain, fahren_exec_body, &body);
+        return;
+    }
+    size_t chunk = n / (threads * 4);
+    if (chunk < grain) chunk = grain;
+    FahrenExecJob* job = (FahrenExecJob*)malloc(sizeof(FahrenExecJob));
+    if (!job) {
+        fn(ctx, 0, n);
+        return;
+    }
+    job->fn = fn;
+    job->ctx = ctx;
+    job->n = n;
+    job->chunk = chunk;
+    atomic_init(&job->next, 0);
+    atomic_init(&job->done, 0);
+    pthread_mutex_init(&job->lock, NULL);
+    pthread_cond_init(&job->done_cv, NULL);
+
+    size_t chunks = (n + chunk - 1) / chunk;
+    size_t helpers = threads - 1 < chunks - 1 ? threads - 1 : chunks - 1;
+    atomic_init(&job->refs, 1 + helpers);
+    for (size_t i = 0; i < helpers; ++i) {
+        if (ex->submit(ex->user, fahren_exec_helper, job) != 0) fahren_exec_release(job);
+    }
+
+    t_in_pool = 1;
+    fahren_exec_drain(job);
+    t_in_pool = 0;
+
+    pthread_mutex_lock(&job->lock);
+    while (atomic_load(&job->done) != n) pthread_cond_wait(&job->done_cv, &job->lock);
+    pthread_mutex_unlock(&job->lock);
+    fahren_exec_release(job);
+}
+
+FAHRENStatus fahren_init_ex(FAHREN* cm, FAHRENModelType model_type, size_t layer_count, FAHRENLayer* layers,
+                            const FAHRENExecutor* executor) {
+    if (executor && (!executor->worker_count || (!executor->submit && !executor->parallel_for))) {
+        return FAHREN_ERROR_INVALID_ARGUMENT;
+    }
+    FAHRENStatus st = fahren_init(cm, model_type, layer_count, layers);
+    if (st != FAHREN_SUCCESS) return st;
+    if (executor) {
+        g_executor = *executor;
+        __atomic_store_n(&g_executor_ptr, &g_executor, __ATOMIC_RELEASE);
+    } else {
+        __atomic_store_n(&g_executor_ptr, NULL, __ATOMIC_RELEASE);
+    }
+    return FAHREN_SUCCESS;
+}
+
+int fahren_executor_installed(void) {
+    return __atomic_load_n(&g_executor_ptr, __ATOMIC_ACQUIRE) != NULL;
+}
+
+/* ---- dispatch ----------------------------------------------------------- */
+
+static size_t fahren_threads_of(const FAHRENExecutor* ex) {
+    if (ex) {
+        size_t threads = ex->worker_count(ex->user);
+        return threads ? threads : 1;
+    }
+    pthread_once(&g_pool_once, fahren_pool_create);
+    return g_pool.thread_count;
+}
+
+size_t fahren_thread_count(void) {
+    return fahren_threads_of(__atomic_load_n(&g_executor_ptr, __ATOMIC_ACQUIRE));
+}
+
+void fahren_parallel_for(size_t n, size_t grain, fahren_range_fn fn, void* ctx) {
+    if (n == 0 || !fn) return;
+    if (grain == 0) grain = 1;
+
+    const FAHRENExecutor* ex = __atomic_load_n(&g_executor_ptr, __ATOMIC_ACQUIRE);
+    size_t threads = fahren_threads_of(ex);
+    if (t_in_pool || threads == 1 || n <= grain) {
+        fn(ctx, 0, n);
+        return;
+    }
+    if (ex) {
+        fahren_exec_parallel_for(ex, threads, n, grain, fn, ctx);
+        return;
+    }
+
+    /* Aim for a few chunks per thread so uneven rows still balance. */
+    size_t chunk = n / (threads * 4);
+    if (chunk < grain) chunk = grain;
+
+    FahrenJob job;
+    job.fn = fn;
+    job.ctx = ctx;
+    job.n = n;
+    job.chunk = chunk;
+    atomic_init(&job.next, 0);
+    job.active = 0;
+
+    FahrenPool* p = &g_pool;
+    pthread_mutex_lock(&p->job_lock);
+    pthread_mutex_lock(&p->lock);
+    p->job = &job;
+    p->generation++;
+    pthread_cond_broadcast(&p->work_cv);
+    pthread_mutex_unlock(&p->lock);
+
+    t_in_pool = 1;
+    fahren_pool_drain(&job);
+    t_in_pool = 0;
+
+    /* Every chunk is claimed; wait for workers still finishing theirs. */
+    pthread_mutex_lock(&p->lock);
+    while (job.active != 0) pthread_cond_wait(&p->done_cv, &p->lock);
+    p->job = NULL;
+    pthread_mutex_unlock(&p->lock);
+    pthread_mutex_unlock(&p->job_lock);
+}
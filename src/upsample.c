@@ -0,0 +1,270 @@
+/* Nearest and bilinear upsampling with backward passes. See
+ * include/fahren/upsample.h.
+ * Both directions are split into a horizontal step on single rows and a
+ * vertical step that only combines whole rows, so the vertical part is
+ * plain vector adds/axpys and the horizontal part touches each input row
+ * once per output row pair rather than once per output pixel. */
+#include <stdlib.h>
+#include <string.h>
+
+#include <fahren/upsample.h>
+#include "fahren_internal.h"
+#include "fahren_simd.h"
+
+/* ---- nearest ---------------------------------------------------------- */
+
+typedef struct FahrenUpJob {
+    const float* src;
+    float* dst;
+    size_t h, w;
+    size_t oh, ow;
+    size_t sh, sw;
+    /* bilinear tables, shared by every plane */
+    const size_t* x0;
+    const size_t* x1;
+    const float* lx;
+    const size_t* y0;
+    const size_t* y1;
+    const float* ly;
+    int failed;
+} FahrenUpJob;
+
+/* out[i * sw + k] = in[i] for k < sw */
+static void fahren_repeat_row(const float* in, size_t w, size_t sw, float* out) {
+    size_t i = 0;
+#if defined(FAHREN_HAVE_SSE2)
+    if (sw == 2) {
+        for (; i + 4 <= w; i += 4) {
+            __m128 v = _mm_loadu_ps(in + i);
+            _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(v, v));
+            _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(v, v));
+        }
+    }
+#endif
+    for (; i < w; ++i) {
+        for (size_t k = 0; k < sw; ++k) out[i * sw + k] = in[i];
+    }
+}
+
+/* out[i] = sum_k in[i * sw + k] */
+static void fahren_fold_row(const float* in, size_t w, size_t sw, float* out) {
+    size_t i = 0;
+#if defined(FAHREN_HAVE_SSE2)
+    if (sw == 2) {
+        for (; i + 4 <= w; i += 4) {
+            __m128 a = _mm_loadu_ps(in + 2 * i), b = _mm_loadu_ps(in + 2 * i + 4);
+            __m128 even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 odd = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(out + i, _mm_add_ps(even, odd));
+        }
+    }
+#endif
+    for (; i < w; ++i) {
+        float s = 0.0f;
+        for (size_t k = 0; k < sw; ++k) s += in[i * sw + k];
+        out[i] = s;
+    }
+}
+
+static void fahren_nearest_fwd_planes(void* ctx, size_t begin, size_t end) {
+    FahrenUpJob* job = (FahrenUpJob*)ctx;
+    size_t ow = job->w * job->sw;
+    for (size_t p = begin; p < end; ++p) {
+        const float* x = job->src + p * job->h * job->w;
+        float* y = job->dst + p * job->h * job->sh * ow;
+        for (size_t iy = 0; iy < job->h; ++iy) {
+            float* first = y + iy * job->sh * ow;
+            fahren_repeat_row(x + iy * job->w, job->w, job->sw, first);
+            for (size_t k = 1; k < job->sh; ++k) memcpy(first + k * ow, first, ow * sizeof(float));
+        }
+    }
+}
+
+static void fahren_nearest_bwd_planes(void* ctx, size_t begin, size_t end) {
+    FahrenUpJob* job = (FahrenUpJob*)ctx;
+    size_t ow = job->w * job->sw;
+    float* acc = (float*)malloc(ow * sizeof(float));
+    if (!acc) {
+        job->failed = 1;
+        return;
+    }
+    for (size_t p = begin; p < end; ++p) {
+        const float* dy = job->src + p * job->h * job->sh * ow;
+        float* dx = job->dst + p * job->h * job->w;
+        for (size_t iy = 0; iy < job->h; ++iy) {
+            const float* rows = dy + iy * job->sh * ow;
+            memcpy(acc, rows, ow * sizeof(float));
+            for (size_t k = 1; k < job->sh; ++k) fahren_axpy_f32(1.0f, rows + k * ow, acc, ow);
+            fahren_fold_row(acc, job->w, job->sw, dx + iy * job->w);
+        }
+    }
+    free(acc);
+}
+
+static int fahren_up_dims_valid(int h, int w, int a, int b) {
+    return h > 0 && w > 0 && a > 0 && b > 0;
+}
+
+FAHRENStatus fahren_upsample_nearest_forward(const float* x, size_t planes, int h, int w,
+                                             int scale_h, int scale_w, float* y) {
+    if (!x || !y || !fahren_up_dims_valid(h, w, scale_h, scale_w)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenUpJob job;
+    memset(&job, 0, sizeof(job));
+    job.src = x;
+    job.dst = y;
+    job.h = (size_t)h;
+    job.w = (size_t)w;
+    job.sh = (size_t)scale_h;
+    job.sw = (size_t)scale_w;
+    fahren_parallel_for(planes, 1, fahren_nearest_fwd_planes, &job);
+    return FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_upsample_nearest_backward(const float* dy, size_t planes, int h, int w,
+                                              int scale_h, int scale_w, float* dx) {
+    if (!dy || !dx || !fahren_up_dims_valid(h, w, scale_h, scale_w)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenUpJob job;
+    memset(&job, 0, sizeof(job));
+    job.src = dy;
+    job.dst = dx;
+    job.h = (size_t)h;
+    job.w = (size_t)w;
+    job.sh = (size_t)scale_h;
+    job.sw = (size_t)scale_w;
+    fahren_parallel_for(planes, 1, fahren_nearest_bwd_planes, &job);
+    return job.failed ? FAHREN_ERROR_PROCESSING_FAILED : FAHREN_SUCCESS;
+}
+
+/* ---- bilinear --------------------------------------------------------- */
+
+/* Source taps for each output coordinate with half-pixel centres. */
+static void fahren_bilinear_taps(size_t in, size_t out, size_t* i0, size_t* i1, float* lambda) {
+    float scale = (float)in / (float)out;
+    for (size_t o = 0; o < out; ++o) {
+        float src = ((float)o + 0.5f) * scale - 0.5f;
+        if (src < 0.0f) src = 0.0f;
+        size_t a = (size_t)src;
+        if (a > in - 1) a = in - 1;
+        i0[o] = a;
+        i1[o] = a + 1 < in ? a + 1 : in - 1;
+        lambda[o] = src - (float)a;
+    }
+}
+
+static void fahren_bilinear_hrow(const FahrenUpJob* job, const float* in, float* out) {
+    for (size_t ox = 0; ox < job->ow; ++ox) {
+        float a = in[job->x0[ox]], b = in[job->x1[ox]];
+        out[ox] = a + job->lx[ox] * (b - a);
+    }
+}
+
+static void fahren_bilinear_fwd_planes(void* ctx, size_t begin, size_t end) {
+    FahrenUpJob* job = (FahrenUpJob*)ctx;
+    size_t ow = job->ow;
+    float* buf = (float*)malloc(2 * ow * sizeof(float));
+    if (!buf) {
+        job->failed = 1;
+        return;
+    }
+    for (size_t p = begin; p < end; ++p) {
+        const float* x = job->src + p * job->h * job->w;
+        float* y = job->dst + p * job->oh * ow;
+        /* two cached horizontally-resized input rows */
+        float* row[2] = {buf, buf + ow};
+        size_t have[2] = {(size_t)-1, (size_t)-1};
+        for (size_t oy = 0; oy < job->oh; ++oy) {
+            size_t want0 = job->y0[oy], want1 = job->y1[oy];
+            if (have[0] != want0 && have[1] != want0) {
+                int slot = have[1] == want1 ? 0 : 1; /* keep the row tap 1 needs */
+                fahren_bilinear_hrow(job, x + want0 * job->w, row[slot]);
+                have[slot] = want0;
+            }
+            int s0 = have[0] == want0 ? 0 : 1;
+            if (have[0] != want1 && have[1] != want1) {
+                fahren_bilinear_hrow(job, x + want1 * job->w, row[1 - s0]);
+                have[1 - s0] = want1;
+            }
+            int s1 = have[s0] == want1 ? s0 : 1 - s0;
+            const float* top = row[s0];
+            const float* bottom = row[s1];
+            float l = job->ly[oy];
+            float* out = y + oy * ow;
+            for (size_t i = 0; i < ow; ++i) out[i] = top[i] + l * (bottom[i] - top[i]);
+        }
+    }
+    free(buf);
+}
+
+static void fahren_bilinear_bwd_planes(void* ctx, size_t begin, size_t end) {
+    FahrenUpJob* job = (FahrenUpJob*)ctx;
+    float* tmp = (float*)malloc(job->w * sizeof(float));
+    if (!tmp) {
+        job->failed = 1;
+        return;
+    }
+    for (size_t p = begin; p < end; ++p) {
+        const float* dy = job->src + p * job->oh * job->ow;
+        float* dx = job->dst + p * job->h * job->w;
+        memset(dx, 0, job->h * job->w * sizeof(float));
+        for (size_t oy = 0; oy < job->oh; ++oy) {
+            const float* g = dy + oy * job->ow;
+            memset(tmp, 0, job->w * sizeof(float));
+            for (size_t ox = 0; ox < job->ow; ++ox) {
+                tmp[job->x0[ox]] += (1.0f - job->lx[ox]) * g[ox];
+                tmp[job->x1[ox]] += job->lx[ox] * g[ox];
+            }
+            float l = job->ly[oy];
+            fahren_axpy_f32(1.0f - l, tmp, dx + job->y0[oy] * job->w, job->w);
+            fahren_axpy_f32(l, tmp, dx + job->y1[oy] * job->w, job->w);
+        }
+    }
+    free(tmp);
+}
+
+static FAHRENStatus fahren_bilinear_run(const float* src, float* dst, size_t planes, int h, int w,
+                                        int out_h, int out_w, fahren_range_fn fn) {
+    if (!src || !dst || !fahren_up_dims_valid(h, w, out_h, out_w)) return FAHREN_ERROR_INVALID_ARGUMENT;
+    FahrenUpJob job;
+    memset(&job, 0, sizeof(job));
+    job.src = src;
+    job.dst = dst;
+    job.h = (size_t)h;
+    job.w = (size_t)w;
+    job.oh = (size_t)out_h;
+    job.ow = (size_t)out_w;
+
+    size_t* idx = (size_t*)malloc(2 * (job.ow + job.oh) * sizeof(size_t));
+    float* lam = (float*)malloc((job.ow + job.oh) * sizeof(float));
+    if (!idx || !lam) {
+        free(idx);
+        free(lam);
+        return FAHREN_ERROR_PROCESSING_FAILED;
+    }
+    size_t* x0 = idx;
+    size_t* x1 = x0 + job.ow;
+    size_t* y0 = x1 + job.ow;
+    size_t* y1 = y0 + job.oh;
+    fahren_bilinear_taps(job.w, job.ow, x0, x1, lam);
+    fahren_bilinear_taps(job.h, job.oh, y0, y1, lam + job.ow);
+    job.x0 = x0;
+    job.x1 = x1;
+    job.lx = lam;
+    job.y0 = y0;
+    job.y1 = y1;
+    job.ly = lam + job.ow;
+
+    fahren_parallel_for(planes, 1, fn, &job);
+    free(idx);
+    free(lam);
+    return job.failed ? FAHREN_ERROR_PROCESSING_FAILED : FAHREN_SUCCESS;
+}
+
+FAHRENStatus fahren_upsample_bilinear_forward(const float* x, size_t planes, int h, int w,
+                                              int out_h, int out_w, float* y) {
+    return fahren_bilinear_run(x, y, planes, h, w, out_h, out_w, fahren_bilinear_fwd_planes);
+}
+
+FAHRENStatus fahren_upsample_bilinear_backward(const float* dy, size_t planes, int h, int w,
+                                               int out_h, int out_w, float* dx) {
+    return fahren_bilinear_run(dy, dx, planes, h, w, out_h, out_w, fahren_bilinear_bwd_planes);
+}
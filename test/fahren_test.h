@@ -0,0 +1,25 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Minimal checks for the test programs: CHECK records a failure with its
+ * location and carries on, FAHREN_TEST_RESULT is main's return value. */
+#ifndef FAHREN_TEST_H
+#define FAHREN_TEST_H
+
+#include <stdio.h>
+
+static int fahren_test_failures;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            fahren_test_failures++;                                          \
+        }                                                                    \
+    } while (0)
+
+#define FAHREN_TEST_RESULT (fahren_test_failures ? 1 : 0)
+
+#endif /* FAHREN_TEST_H */
@@ -0,0 +1,87 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Recording-time folding of expr.h (adjacent affines into one op, adjacent
+ * clips into their intersection or a pin), the sticky error, and
+ * fahren_expr_eval over several tiles against a scalar reference. */
+#include <math.h>
+#include <stddef.h>
+
+#include <fahren/expr.h>
+
+#include "fahren_test.h"
+
+enum { N = 1283 }; /* a few tiles plus a ragged tail */
+
+int main(void) {
+    FAHRENExpr e;
+
+    /* (v * 2 + 1) * 3 - 4 is the single op v * 6 - 1 */
+    fahren_expr_init(&e);
+    CHECK(fahren_expr_affine(&e, 2.0f, 1.0f) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_scale(&e, 3.0f) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_shift(&e, -4.0f) == FAHREN_SUCCESS);
+    CHECK(e.op_count == 1 && e.ops[0].kind == FAHREN_EXPR_AFFINE && e.ops[0].a == 6.0f && e.ops[0].b == -1.0f);
+
+    /* overlapping clips keep the intersection */
+    fahren_expr_init(&e);
+    CHECK(fahren_expr_clip(&e, -1.0f, 2.0f) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_clip(&e, 0.0f, INFINITY) == FAHREN_SUCCESS);
+    CHECK(e.op_count == 1 && e.ops[0].a == 0.0f && e.ops[0].b == 2.0f);
+
+    /* disjoint clips pin to the end of the second range nearer the first */
+    float v[4] = {-5.0f, 0.5f, 2.5f, 9.0f}, out[4];
+    CHECK(fahren_expr_clip(&e, 3.0f, 4.0f) == FAHREN_SUCCESS);
+    CHECK(e.op_count == 1 && e.ops[0].a == 3.0f && e.ops[0].b == 3.0f);
+    CHECK(fahren_expr_eval(&e, v, out, 4) == FAHREN_SUCCESS);
+    CHECK(out[0] == 3.0f && out[1] == 3.0f && out[2] == 3.0f && out[3] == 3.0f);
+    fahren_expr_init(&e);
+    CHECK(fahren_expr_clip(&e, 2.0f, 3.0f) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_clip(&e, -1.0f, 1.0f) == FAHREN_SUCCESS);
+    CHECK(e.op_count == 1 && e.ops[0].a == 1.0f && e.ops[0].b == 1.0f);
+
+    /* ops of other kinds in between stop folding */
+    fahren_expr_init(&e);
+    CHECK(fahren_expr_scale(&e, 2.0f) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_activation(&e, FAHREN_ACTIVATION_RELU) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_activation(&e, FAHREN_ACTIVATION_RELU) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_scale(&e, 2.0f) == FAHREN_SUCCESS);
+    CHECK(e.op_count == 3);
+
+    /* a bad argument sticks and eval refuses the expression */
+    CHECK(fahren_expr_clip(&e, 1.0f, 0.0f) == FAHREN_ERROR_INVALID_ARGUMENT);
+    CHECK(fahren_expr_scale(&e, 1.0f) == FAHREN_ERROR_INVALID_ARGUMENT);
+    CHECK(fahren_expr_eval(&e, v, out, 4) == FAHREN_ERROR_INVALID_ARGUMENT);
+    fahren_expr_init(&e);
+    for (size_t i = 0; i < FAHREN_EXPR_MAX_OPS; ++i) CHECK(fahren_expr_exp(&e) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_exp(&e) == FAHREN_ERROR_INVALID_ARGUMENT && e.error);
+
+    /* a mixed chain, evaluated in place, against plain scalar math */
+    static float x[N], gain[N], y[N];
+    for (size_t i = 0; i < N; ++i) {
+        x[i] = (float)i;
+        gain[i] = 1.0f + 0.001f * (float)(i % 7);
+    }
+    fahren_expr_init(&e);
+    CHECK(fahren_expr_mul(&e, gain) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_affine(&e, 1.0f / 255, -0.5f) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_scale(&e, 4.0f) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_clip(&e, -1.5f, 1.5f) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_activation(&e, FAHREN_ACTIVATION_TANH) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_add(&e, gain) == FAHREN_SUCCESS);
+    CHECK(fahren_expr_activation(&e, FAHREN_ACTIVATION_SIGMOID) == FAHREN_SUCCESS);
+    CHECK(e.op_count == 6);
+    for (size_t i = 0; i < N; ++i) y[i] = x[i];
+    CHECK(fahren_expr_eval(&e, y, y, N) == FAHREN_SUCCESS);
+    double worst = 0.0;
+    for (size_t i = 0; i < N; ++i) {
+        double r = ((double)x[i] * gain[i] / 255.0 - 0.5) * 4.0;
+        r = r < -1.5 ? -1.5 : r > 1.5 ? 1.5 : r;
+        r = 1.0 / (1.0 + exp(-(tanh(r) + gain[i])));
+        if (fabs(y[i] - r) > worst) worst = fabs(y[i] - r);
+    }
+    CHECK(worst < 1e-4);
+    return FAHREN_TEST_RESULT;
+}
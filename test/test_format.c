@@ -0,0 +1,119 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* fahren_model_convert round trips (format 1 -> format 2 BF16 interleaved
+ * -> format 1 F32), checksum verification catching a flipped byte, and
+ * several threads converting into the same path at once: every writer
+ * gets its own temporary, so each call succeeds, the file left behind is
+ * one whole blob and no temporaries remain. fahren_runtime_create loads
+ * a converted blob but refuses one stamped with another major version. */
+#include <dirent.h>
+#include <math.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fahren/fahren.h>
+#include <fahren/format.h>
+#include <fahren/runtime.h>
+
+#include "fahren_test.h"
+
+enum { WRITERS = 4, ROUNDS = 5 };
+
+static FAHRENModelView src;
+static int writer_failures;
+
+static void* writer(void* arg) {
+    FAHRENModelConvertOptions o = {2, FAHREN_DTYPE_F16, FAHREN_LAYOUT_SPLIT, NULL, 0};
+    (void)arg;
+    for (int i = 0; i < ROUNDS; ++i) {
+        if (fahren_model_convert(&src, "test_format_shared.bin", &o) != FAHREN_SUCCESS)
+            __atomic_add_fetch(&writer_failures, 1, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+int main(void) {
+    FAHRENLayer* layers = NULL;
+    size_t count = 0;
+    CHECK(fahren_runtime_parse_layers("16,32:relu,8", &layers, &count) == FAHREN_SUCCESS);
+    if (!layers) return 1;
+    uint64_t counts[6];
+    CHECK(fahren_model_layer_counts(layers, count, counts) == FAHREN_SUCCESS);
+    FAHREN cm = {0};
+    CHECK(fahren_init(&cm, FAHREN_MODEL_SEQUENTIAL, count, layers) == FAHREN_SUCCESS);
+    CHECK(fahren_model_open("fahren_initial_model.bin", &src) == FAHREN_SUCCESS);
+    size_t n = (size_t)(src.weight_count + src.bias_count);
+
+    /* F32 -> BF16 interleaved -> F32 split loses only BF16 rounding */
+    FAHRENModelConvertOptions to2 = {2, FAHREN_DTYPE_BF16, FAHREN_LAYOUT_INTERLEAVED, counts, count};
+    FAHRENModelConvertOptions to1 = {1, FAHREN_DTYPE_F32, FAHREN_LAYOUT_SPLIT, NULL, 0};
+    FAHRENModelView mid, back;
+    uint64_t actual = 0;
+    CHECK(fahren_model_convert(&src, "test_format_bf16.bin", &to2) == FAHREN_SUCCESS);
+    CHECK(fahren_model_open("test_format_bf16.bin", &mid) == FAHREN_SUCCESS);
+    CHECK(mid.format == 2 && mid.dtype == FAHREN_DTYPE_BF16 && mid.layer_count == count);
+    CHECK(fahren_model_verify(&mid, &actual) == FAHREN_SUCCESS && actual == mid.checksum);
+    CHECK(fahren_model_convert(&mid, "test_format_f32.bin", &to1) == FAHREN_SUCCESS);
+    CHECK(fahren_model_open("test_format_f32.bin", &back) == FAHREN_SUCCESS);
+    CHECK(back.format == 1 && back.weight_count == src.weight_count && back.bias_count == src.bias_count);
+    const float *a = (const float*)src.payload, *b = (const float*)back.payload;
+    size_t off = 0;
+    for (size_t i = 0; i < n; ++i) off += !(fabsf(a[i] - b[i]) <= fabsf(a[i]) * (1.0f / 256));
+    CHECK(off == 0);
+    fahren_model_close(&back);
+
+    /* the runtime loads the round-tripped blob, but not one from another major version */
+    FAHRENRuntime* rt = NULL;
+    CHECK(fahren_runtime_create(&cm, "test_format_f32.bin", &rt) == FAHREN_SUCCESS && rt);
+    fahren_runtime_destroy(rt);
+    FILE* f = fopen("test_format_f32.bin", "r+b");
+    CHECK(f != NULL);
+    if (f) {
+        uint32_t major = FAHREN_VERSION_MAJOR + 1;
+        CHECK(fseek(f, (long)offsetof(FAHRENModelHeader, version_major), SEEK_SET) == 0);
+        CHECK(fwrite(&major, sizeof(major), 1, f) == 1);
+        fclose(f);
+    }
+    rt = NULL;
+    CHECK(fahren_runtime_create(&cm, "test_format_f32.bin", &rt) == FAHREN_ERROR_INVALID_ARGUMENT && !rt);
+
+    /* one flipped payload byte fails verification */
+    f = fopen("test_format_bf16.bin", "r+b");
+    CHECK(f != NULL);
+    if (f) {
+        long at = (long)((const char*)mid.payload - (const char*)mid.base) + 7;
+        unsigned char c = ((const unsigned char*)mid.payload)[7] ^ 0x10;
+        CHECK(fseek(f, at, SEEK_SET) == 0 && fwrite(&c, 1, 1, f) == 1);
+        fclose(f);
+    }
+    fahren_model_close(&mid);
+    CHECK(fahren_model_open("test_format_bf16.bin", &mid) == FAHREN_SUCCESS);
+    CHECK(fahren_model_verify(&mid, &actual) == FAHREN_ERROR_PROCESSING_FAILED);
+    fahren_model_close(&mid);
+
+    /* concurrent converts into one path */
+    pthread_t th[WRITERS];
+    for (int i = 0; i < WRITERS; ++i) CHECK(pthread_create(&th[i], NULL, writer, NULL) == 0);
+    for (int i = 0; i < WRITERS; ++i) pthread_join(th[i], NULL);
+    CHECK(writer_failures == 0);
+    CHECK(fahren_model_open("test_format_shared.bin", &mid) == FAHREN_SUCCESS);
+    CHECK(mid.dtype == FAHREN_DTYPE_F16 && fahren_model_verify(&mid, &actual) == FAHREN_SUCCESS);
+    fahren_model_close(&mid);
+    DIR* dir = opendir(".");
+    CHECK(dir != NULL);
+    for (struct dirent* d; dir && (d = readdir(dir));) CHECK(strstr(d->d_name, "test_format_shared.bin.tmp") == NULL);
+    if (dir) closedir(dir);
+
+    fahren_model_close(&src);
+    remove("test_format_bf16.bin");
+    remove("test_format_f32.bin");
+    remove("test_format_shared.bin");
+    CHECK(fahren_shutdown(&cm) == FAHREN_SUCCESS);
+    return FAHREN_TEST_RESULT;
+}
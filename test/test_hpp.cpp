@@ -0,0 +1,76 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* fahren.hpp: Context::infer through co_await matches Model::forward, and
+ * views whose rows or widths do not fit the model are refused at submit
+ * without suspending, the same shapes Model::forward refuses. */
+#include <atomic>
+#include <coroutine>
+#include <exception>
+
+#include <fahren/fahren.hpp>
+
+#include "fahren_test.h"
+
+namespace {
+
+/* Fire-and-forget coroutine: starts eagerly, frees itself at the end. */
+struct Task {
+    struct promise_type {
+        Task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+struct Result {
+    std::atomic<int> done{0};
+    FAHRENStatus status = FAHREN_SUCCESS;
+};
+
+Task run(const fahren::Context& ctx, std::size_t id, fahren::ConstTensor x, fahren::Tensor y, Result& out) {
+    out.status = co_await ctx.infer(id, x, y);
+    out.done.store(1);
+    out.done.notify_one();
+}
+
+FAHRENStatus infer(const fahren::Context& ctx, std::size_t id, fahren::ConstTensor x, fahren::Tensor y) {
+    Result r;
+    run(ctx, id, x, y, r);
+    r.done.wait(0);
+    return r.status;
+}
+
+} // namespace
+
+int main() {
+    enum { ROWS = 3, IN = 8, OUT = 4 };
+    float x[ROWS * (IN + 1)], y[ROWS * (OUT + 1)], ref[ROWS * OUT];
+    for (int i = 0; i < ROWS * (IN + 1); ++i) x[i] = 0.1f * static_cast<float>(i % 11) - 0.5f;
+
+    fahren::Model model("8,16:relu,4:sigmoid", "fahren_initial_model.bin");
+    fahren::Context ctx(1);
+    std::size_t id = ctx.add(model);
+
+    CHECK(infer(ctx, id, {x, ROWS, IN}, {y, ROWS, OUT}) == FAHREN_SUCCESS);
+    CHECK(model.forward({x, ROWS, IN}, {ref, ROWS, OUT}) == FAHREN_SUCCESS);
+    int wrong = 0;
+    for (int i = 0; i < ROWS * OUT; ++i) wrong += y[i] != ref[i];
+    CHECK(wrong == 0);
+
+    /* every mismatch Model::forward refuses is refused here too */
+    const fahren::ConstTensor bad_x[] = {{x, ROWS, IN + 1}, {x, ROWS, IN}, {x, ROWS - 1, IN}};
+    const fahren::Tensor bad_y[] = {{y, ROWS, OUT}, {y, ROWS, OUT + 1}, {y, ROWS, OUT}};
+    for (int i = 0; i < 3; ++i) {
+        CHECK(model.forward(bad_x[i], bad_y[i]) == FAHREN_ERROR_INVALID_ARGUMENT);
+        Result r;
+        run(ctx, id, bad_x[i], bad_y[i], r); /* refused: already finished on this thread */
+        CHECK(r.done.load() == 1 && r.status == FAHREN_ERROR_INVALID_ARGUMENT);
+    }
+    CHECK(infer(ctx, id + 1, {x, ROWS, IN}, {y, ROWS, OUT}) == FAHREN_ERROR_INVALID_ARGUMENT);
+    return FAHREN_TEST_RESULT;
+}
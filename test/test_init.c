@@ -0,0 +1,85 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* Initializers as written by fahren_init: Xavier and He weights stay
+ * within their fan-based limits, orthogonal rows have a Gram matrix of
+ * about I, ":zerobias" biases are 0, and an input layer under any
+ * initializer other than the default starts at scale 1 and shift 0. */
+#include <math.h>
+#include <stdlib.h>
+
+#include <fahren/fahren.h>
+#include <fahren/format.h>
+#include <fahren/runtime.h>
+
+#include "fahren_test.h"
+
+enum { LAYERS = 4 };
+
+/* Largest |v[i]| over n values. */
+static double max_abs(const float* v, size_t n) {
+    double m = 0.0;
+    for (size_t i = 0; i < n; ++i) m = fabs(v[i]) > m ? fabs(v[i]) : m;
+    return m;
+}
+
+int main(void) {
+    FAHRENLayer* layers = NULL;
+    size_t count = 0;
+    CHECK(fahren_runtime_parse_layers("40:xavier,60:xavier,50:he:zerobias,20:orthogonal", &layers, &count) ==
+          FAHREN_SUCCESS);
+    if (!layers || count != LAYERS) return 1;
+    uint64_t counts[2 * LAYERS];
+    CHECK(fahren_model_layer_counts(layers, count, counts) == FAHREN_SUCCESS);
+    FAHREN cm = {0};
+    CHECK(fahren_init(&cm, FAHREN_MODEL_SEQUENTIAL, count, layers) == FAHREN_SUCCESS);
+
+    FAHRENModelView view;
+    CHECK(fahren_model_open("fahren_initial_model.bin", &view) == FAHREN_SUCCESS);
+    if (view.base) {
+        const float* w[LAYERS];
+        const float* b[LAYERS];
+        const float* at = (const float*)view.payload;
+        for (size_t i = 0; i < LAYERS; ++i) {
+            w[i] = at;
+            at += counts[2 * i];
+        }
+        for (size_t i = 0; i < LAYERS; ++i) {
+            b[i] = at;
+            at += counts[2 * i + 1];
+        }
+        CHECK(counts[2] == 40 * 60 && counts[4] == 60 * 50 && counts[6] == 50 * 20);
+
+        /* input layer: scale 1, shift 0 */
+        size_t off = 0;
+        for (size_t i = 0; i < 40; ++i) off += w[0][i] != 1.0f || b[0][i] != 0.0f;
+        CHECK(off == 0);
+
+        /* Xavier: limit sqrt(6 / (fan_in + fan_out)), and the range is used */
+        double xavier = sqrt(6.0 / (40 + 60));
+        CHECK(max_abs(w[1], 40 * 60) <= xavier && max_abs(w[1], 40 * 60) > 0.9 * xavier);
+        CHECK(max_abs(b[1], 60) <= 0.5);
+
+        /* He: limit sqrt(6 / fan_in); its biases were asked to be zero */
+        double he = sqrt(6.0 / 60);
+        CHECK(max_abs(w[2], 60 * 50) <= he && max_abs(w[2], 60 * 50) > 0.9 * he);
+        CHECK(max_abs(b[2], 50) == 0.0);
+
+        /* orthogonal: the 20 rows of length 50 are orthonormal */
+        double worst = 0.0;
+        for (size_t r = 0; r < 20; ++r) {
+            for (size_t s = 0; s < 20; ++s) {
+                double dot = 0.0;
+                for (size_t k = 0; k < 50; ++k) dot += (double)w[3][r * 50 + k] * w[3][s * 50 + k];
+                double err = fabs(dot - (r == s ? 1.0 : 0.0));
+                worst = err > worst ? err : worst;
+            }
+        }
+        CHECK(worst < 1e-4);
+        fahren_model_close(&view);
+    }
+    CHECK(fahren_shutdown(&cm) == FAHREN_SUCCESS);
+    return FAHREN_TEST_RESULT;
+}
@@ -0,0 +1,106 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* ipc.h end to end in one process: fahren_ipc_infer and several requests
+ * held at once match fahren_runtime_forward, a request submitted twice or
+ * naming a slot outside the segment is refused, and a batch larger than
+ * all slots together is refused at creation. */
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include <fahren/ipc.h>
+#include <fahren/runtime.h>
+
+#include "fahren_test.h"
+
+enum { IN = 8, OUT = 16, SLOTS = 4, MAX_ROWS = 8 };
+
+static const char* const NAME = "/fahren_test_ipc";
+
+static void* serve(void* arg) {
+    fahren_ipc_server_run((FAHRENIpcServer*)arg);
+    return NULL;
+}
+
+static int close_to(const float* a, const float* b, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (fabsf(a[i] - b[i]) > 1e-5f) return 0;
+    }
+    return 1;
+}
+
+int main(void) {
+    FAHRENLayer* layers = NULL;
+    size_t count = 0;
+    FAHRENRuntime* rt = NULL;
+    FAHREN cm = {0};
+    CHECK(fahren_runtime_parse_layers("8,16:tanh", &layers, &count) == FAHREN_SUCCESS);
+    CHECK(fahren_init(&cm, FAHREN_MODEL_SEQUENTIAL, count, layers) == FAHREN_SUCCESS);
+    CHECK(fahren_runtime_create(&cm, "fahren_initial_model.bin", &rt) == FAHREN_SUCCESS);
+    if (!rt) return 1;
+
+    FAHRENIpcServer* server = NULL;
+    FAHRENIpcServerConfig config = {SLOTS, MAX_ROWS, SLOTS * MAX_ROWS + 1, 0};
+    CHECK(fahren_ipc_server_create(NAME, rt, &config, &server) == FAHREN_ERROR_INVALID_ARGUMENT && !server);
+    config.max_batch_rows = MAX_ROWS - 1;
+    CHECK(fahren_ipc_server_create(NAME, rt, &config, &server) == FAHREN_ERROR_INVALID_ARGUMENT && !server);
+    config.max_batch_rows = 0;
+    CHECK(fahren_ipc_server_create(NAME, rt, &config, &server) == FAHREN_SUCCESS);
+    if (!server) return 1;
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, serve, server) == 0);
+
+    float x[SLOTS * MAX_ROWS * IN], y[SLOTS * MAX_ROWS * OUT], ref[SLOTS * MAX_ROWS * OUT];
+    for (size_t i = 0; i < sizeof(x) / sizeof(x[0]); ++i) x[i] = sinf(0.1f * (float)i);
+    CHECK(fahren_runtime_forward(rt, x, SLOTS * MAX_ROWS, ref) == FAHREN_SUCCESS);
+
+    FAHRENIpcClient* client = NULL;
+    CHECK(fahren_ipc_connect(NAME, &client) == FAHREN_SUCCESS);
+    if (client) {
+        CHECK(fahren_ipc_input_dim(client) == IN && fahren_ipc_output_dim(client) == OUT);
+
+        /* the copying wrapper, split into pieces of max_rows */
+        CHECK(fahren_ipc_infer(client, x, 20, y) == FAHREN_SUCCESS);
+        CHECK(close_to(y, ref, 20 * OUT));
+
+        /* every slot in flight at once, batched together */
+        FAHRENIpcRequest req[SLOTS];
+        for (int i = 0; i < SLOTS; ++i) {
+            CHECK(fahren_ipc_request_begin(client, &req[i]) == FAHREN_SUCCESS);
+            for (size_t k = 0; k < MAX_ROWS * IN; ++k) req[i].input[k] = x[i * MAX_ROWS * IN + k];
+            CHECK(fahren_ipc_request_submit(client, &req[i], MAX_ROWS) == FAHREN_SUCCESS);
+            /* a second submit of the same slot is refused, not pushed again */
+            CHECK(fahren_ipc_request_submit(client, &req[i], MAX_ROWS) == FAHREN_ERROR_INVALID_ARGUMENT);
+        }
+        for (int i = 0; i < SLOTS; ++i) {
+            CHECK(fahren_ipc_request_wait(client, &req[i]) == FAHREN_SUCCESS);
+            CHECK(close_to(req[i].output, ref + i * MAX_ROWS * OUT, MAX_ROWS * OUT));
+            fahren_ipc_request_end(client, &req[i]);
+        }
+
+        /* a request naming a slot past the end of the segment */
+        FAHRENIpcRequest forged;
+        CHECK(fahren_ipc_request_begin(client, &forged) == FAHREN_SUCCESS);
+        FAHRENIpcRequest held = forged;
+        forged.slot = SLOTS;
+        CHECK(fahren_ipc_request_submit(client, &forged, 1) == FAHREN_ERROR_INVALID_ARGUMENT);
+        CHECK(fahren_ipc_request_wait(client, &forged) == FAHREN_ERROR_INVALID_ARGUMENT);
+        CHECK(fahren_ipc_request_submit(client, &held, MAX_ROWS + 1) == FAHREN_ERROR_INVALID_ARGUMENT);
+        fahren_ipc_request_end(client, &held);
+
+        /* the segment still serves after the refusals */
+        CHECK(fahren_ipc_infer(client, x, 3, y) == FAHREN_SUCCESS);
+        CHECK(close_to(y, ref, 3 * OUT));
+        fahren_ipc_disconnect(client);
+    }
+    fahren_ipc_server_stop(server);
+    pthread_join(thread, NULL);
+    fahren_ipc_server_destroy(server);
+
+    fahren_runtime_destroy(rt);
+    CHECK(fahren_shutdown(&cm) == FAHREN_SUCCESS);
+    return FAHREN_TEST_RESULT;
+}
@@ -0,0 +1,164 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* net.h end to end over a Unix socket: a round trip matching
+ * fahren_runtime_forward, one fahren_net_infer call whose responses far
+ * exceed what the server queues for an unread connection, and, against a
+ * scripted fake server, responses placed by id when they arrive out of
+ * order and a repeated id refused. */
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <fahren/net.h>
+#include <fahren/runtime.h>
+
+#include "fahren_test.h"
+
+enum { IN = 64, OUT = 256, BIG = 40000 }; /* BIG rows: 40 MB of responses */
+
+static void* serve(void* arg) {
+    fahren_net_server_run((FAHRENNetServer*)arg);
+    return NULL;
+}
+
+static int listen_unix(const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 1) != 0) return -1;
+    return fd;
+}
+
+static int read_all(int fd, void* buf, size_t len) {
+    for (size_t got = 0; got < len;) {
+        ssize_t n = read(fd, (char*)buf + got, len - got);
+        if (n <= 0) return 0;
+        got += (size_t)n;
+    }
+    return 1;
+}
+
+/* Fake server: max_rows 4, input 2, output 1. Reads three requests and
+ * answers them last first with y = x0 + x1, then, when `repeat` is set,
+ * sends the first answer once more instead of the others. */
+typedef struct Fake {
+    int fd;
+    int repeat;
+} Fake;
+
+static void* fake_serve(void* arg) {
+    Fake* fake = (Fake*)arg;
+    int fd = accept(fake->fd, NULL, NULL);
+    FAHRENNetHello hello = {FAHREN_NET_MAGIC, FAHREN_NET_VERSION, 2, 1, 4};
+    if (fd < 0 || send(fd, &hello, sizeof(hello), MSG_NOSIGNAL) != (ssize_t)sizeof(hello)) return NULL;
+    FAHRENNetFrame req[3];
+    float x[3][8], y[3][4];
+    for (int i = 0; i < 3; ++i) {
+        if (!read_all(fd, &req[i], sizeof(req[i])) || req[i].rows > 4 ||
+            !read_all(fd, x[i], req[i].rows * 2 * sizeof(float))) {
+            close(fd);
+            return NULL;
+        }
+        for (int r = 0; r < req[i].rows; ++r) y[i][r] = x[i][2 * r] + x[i][2 * r + 1];
+    }
+    for (int k = 0; k < 3; ++k) {
+        int i = fake->repeat ? 2 : 2 - k;
+        FAHRENNetFrame f = {req[i].id, req[i].rows, 0};
+        if (send(fd, &f, sizeof(f), MSG_NOSIGNAL) < 0 ||
+            send(fd, y[i], req[i].rows * sizeof(float), MSG_NOSIGNAL) < 0) {
+            break; /* the client gave up after the repeat */
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+int main(void) {
+    FAHRENLayer* layers = NULL;
+    size_t count = 0;
+    FAHRENRuntime* rt = NULL;
+    FAHREN cm = {0};
+    CHECK(fahren_runtime_parse_layers("64,256:tanh", &layers, &count) == FAHREN_SUCCESS);
+    CHECK(fahren_init(&cm, FAHREN_MODEL_SEQUENTIAL, count, layers) == FAHREN_SUCCESS);
+    CHECK(fahren_runtime_create(&cm, "fahren_initial_model.bin", &rt) == FAHREN_SUCCESS);
+    if (!rt) return 1;
+
+    FAHRENNetServerConfig config = {NULL, "test_net.sock", 1, 16, 64, 0};
+    FAHRENNetServer* server = NULL;
+    CHECK(fahren_net_server_create(rt, &config, &server) == FAHREN_SUCCESS);
+    if (!server) return 1;
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, serve, server) == 0);
+
+    float* x = (float*)malloc((size_t)BIG * IN * sizeof(float));
+    float* y = (float*)malloc((size_t)BIG * OUT * sizeof(float));
+    float* ref = (float*)malloc((size_t)BIG * OUT * sizeof(float));
+    if (!x || !y || !ref) return 1;
+    for (size_t i = 0; i < (size_t)BIG * IN; ++i) x[i] = sinf(0.01f * (float)i);
+    CHECK(fahren_runtime_forward(rt, x, BIG, ref) == FAHREN_SUCCESS);
+
+    FAHRENNetClient* client = NULL;
+    CHECK(fahren_net_connect("unix:test_net.sock", &client) == FAHREN_SUCCESS);
+    if (client) {
+        CHECK(fahren_net_input_dim(client) == IN && fahren_net_output_dim(client) == OUT);
+        CHECK(fahren_net_max_rows(client) == 16);
+
+        /* one pipelined request and its response */
+        uint32_t id = 0;
+        size_t rows = 0;
+        CHECK(fahren_net_send(client, 7, x, 5) == FAHREN_SUCCESS);
+        CHECK(fahren_net_recv(client, &id, y, &rows) == FAHREN_SUCCESS && id == 7 && rows == 5);
+        CHECK(memcmp(y, ref, 5 * OUT * sizeof(float)) == 0);
+
+        /* far more response bytes than the server queues for a client */
+        memset(y, 0, (size_t)BIG * OUT * sizeof(float));
+        CHECK(fahren_net_infer(client, x, BIG, y) == FAHREN_SUCCESS);
+        CHECK(memcmp(y, ref, (size_t)BIG * OUT * sizeof(float)) == 0);
+        fahren_net_disconnect(client);
+    }
+    fahren_net_server_stop(server);
+    pthread_join(thread, NULL);
+    fahren_net_server_destroy(server);
+
+    /* out-of-order answers land by id; a repeated id is refused */
+    float fx[10 * 2], fy[10];
+    for (int i = 0; i < 20; ++i) fx[i] = (float)i;
+    for (int repeat = 0; repeat < 2; ++repeat) {
+        Fake fake = {listen_unix("test_net_fake.sock"), repeat};
+        CHECK(fake.fd >= 0);
+        pthread_t fake_thread;
+        CHECK(pthread_create(&fake_thread, NULL, fake_serve, &fake) == 0);
+        client = NULL;
+        CHECK(fahren_net_connect("unix:test_net_fake.sock", &client) == FAHREN_SUCCESS);
+        FAHRENStatus st = fahren_net_infer(client, fx, 10, fy);
+        if (repeat) {
+            CHECK(st == FAHREN_ERROR_PROCESSING_FAILED);
+        } else {
+            CHECK(st == FAHREN_SUCCESS);
+            int wrong = 0;
+            for (int r = 0; r < 10; ++r) wrong += fy[r] != fx[2 * r] + fx[2 * r + 1];
+            CHECK(wrong == 0);
+        }
+        fahren_net_disconnect(client);
+        pthread_join(fake_thread, NULL);
+        close(fake.fd);
+    }
+    unlink("test_net_fake.sock");
+
+    free(x);
+    free(y);
+    free(ref);
+    fahren_runtime_destroy(rt);
+    CHECK(fahren_shutdown(&cm) == FAHREN_SUCCESS);
+    return FAHREN_TEST_RESULT;
+}
@@ -0,0 +1,84 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* fahren_sample_batch against the filters it applies: greedy decoding
+ * takes the argmax, top-k never leaves the k best, and top-p never
+ * returns a token outside the nucleus, including for a draw u just
+ * below 1 when the nucleus excludes index 0 and every kept entry lies in
+ * a full 16-wide block. Sampling from many threads that then exit must
+ * not leak their scratch (checked under LeakSanitizer). */
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include <fahren/sampling.h>
+
+#include "fahren_test.h"
+
+enum { VOCAB = 48, VARIANTS = 4096, THREADS = 4 };
+
+/* A (seed, step) whose row-0 draw is the largest float below 1. */
+static const uint64_t SEED = 1, STEP = 8418514;
+
+/* Up to three tokens past index 15 carry all but ~1e-5 of the mass and
+ * the rest sit far below; the values vary with `variant` so that some of
+ * the draws land past the summed block masses by rounding. */
+static void fill(float* x, uint32_t variant) {
+    uint32_t state = variant * 2654435761u + 1;
+    for (size_t i = 0; i < VOCAB; ++i) {
+        state = state * 1664525u + 1013904223u;
+        x[i] = -10.0f + (float)(state >> 22) * 0.001f;
+    }
+    for (int j = 0; j < 3; ++j) {
+        state = state * 1664525u + 1013904223u;
+        x[16 + (state >> 27)] = 5.0f - 0.5f * (float)j + (float)((state >> 12) & 1023) * 0.001f;
+    }
+}
+
+static void* sample_rows(void* arg) {
+    float* x = (float*)arg;
+    FAHRENSamplingParams sp = {1.0f, 0, 0.95f, SEED};
+    int32_t tok[8];
+    for (int i = 0; i < 16; ++i) CHECK(fahren_sample_batch(x, 8, VOCAB, &sp, (uint64_t)i, tok) == FAHREN_SUCCESS);
+    return NULL;
+}
+
+int main(void) {
+    CHECK(fahren_rng_uniform(SEED, 0, STEP) == 1.0f - 1.0f / 16777216.0f);
+
+    float x[VOCAB];
+    int32_t tok = -1;
+    FAHRENSamplingParams greedy = {0.0f, 0, 1.0f, SEED};
+    fill(x, 0);
+    size_t best = 0;
+    for (size_t i = 1; i < VOCAB; ++i) best = x[i] > x[best] ? i : best;
+    CHECK(fahren_sample_batch(x, 1, VOCAB, &greedy, STEP, &tok) == FAHREN_SUCCESS && tok == (int32_t)best);
+
+    size_t outside = 0, top1 = 0;
+    FAHRENSamplingParams nucleus = {1.0f, 0, 0.95f, SEED};
+    FAHRENSamplingParams topk = {1.0f, 1, 1.0f, SEED};
+    for (uint32_t v = 0; v < VARIANTS; ++v) {
+        fill(x, v);
+        best = 0;
+        for (size_t i = 1; i < VOCAB; ++i) best = x[i] > x[best] ? i : best;
+        CHECK(fahren_sample_batch(x, 1, VOCAB, &nucleus, STEP, &tok) == FAHREN_SUCCESS);
+        outside += tok < 16 || tok >= VOCAB || x[tok] < 0.0f;
+        CHECK(fahren_sample_batch(x, 1, VOCAB, &topk, STEP, &tok) == FAHREN_SUCCESS);
+        top1 += tok != (int32_t)best;
+    }
+    CHECK(outside == 0);
+    CHECK(top1 == 0);
+
+    float* rows = (float*)malloc(8 * VOCAB * sizeof(float));
+    if (!rows) return 1;
+    for (uint32_t r = 0; r < 8; ++r) fill(rows + r * VOCAB, r);
+    for (int round = 0; round < 4; ++round) {
+        pthread_t thread[THREADS];
+        for (int i = 0; i < THREADS; ++i) CHECK(pthread_create(&thread[i], NULL, sample_rows, rows) == 0);
+        for (int i = 0; i < THREADS; ++i) pthread_join(thread[i], NULL);
+    }
+    free(rows);
+    return FAHREN_TEST_RESULT;
+}
@@ -0,0 +1,339 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* sched.h with one worker whose forward passes can be held at a gate (a
+ * host executor, installed with fahren_init_ex, that parks every parallel
+ * loop while the gate is closed), so the queue can be arranged while the
+ * worker is busy:
+ * models run in deadline order, a request whose deadline passes while
+ * it waits is shed, and admission turns requests away with
+ * FAHREN_ERROR_OVERLOADED past the queue bound or when they cannot make
+ * their deadline, and cancelled requests complete with
+ * FAHREN_ERROR_CANCELLED whether queued or running. The same gate holds
+ * fahren_runtime_forward_groups mid-batch to check that a group
+ * cancelled there is compacted out while the others are unaffected.
+ * Last, callbacks and their eventfd signal fire exactly once for every
+ * completed request, whatever its outcome, and never for a refused one. */
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <fahren/executor.h>
+#include <fahren/sched.h>
+
+#include "fahren_test.h"
+
+enum { IN = 8, OUT = 4, MODELS = 4 }; /* the last model queues at most 2 rows */
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cv = PTHREAD_COND_INITIALIZER;
+static int g_closed, g_held;
+static size_t g_loops;
+static size_t g_started[16], g_start_count, g_shed_events, g_reject_events;
+
+static size_t gate_workers(void* user) {
+    (void)user;
+    return 2;
+}
+
+static void gate_parallel_for(void* user, size_t n, size_t grain, fahren_range_fn fn, void* ctx) {
+    (void)user;
+    (void)grain;
+    pthread_mutex_lock(&g_lock);
+    g_loops++;
+    g_held++;
+    pthread_cond_broadcast(&g_cv);
+    while (g_closed) pthread_cond_wait(&g_cv, &g_lock);
+    g_held--;
+    pthread_mutex_unlock(&g_lock);
+    fn(ctx, 0, n);
+}
+
+static void gate_set(int closed) {
+    pthread_mutex_lock(&g_lock);
+    g_closed = closed;
+    pthread_cond_broadcast(&g_cv);
+    pthread_mutex_unlock(&g_lock);
+}
+
+/* Wait until a forward pass is parked at the closed gate. */
+static void gate_wait_held(void) {
+    pthread_mutex_lock(&g_lock);
+    while (!g_held) pthread_cond_wait(&g_cv, &g_lock);
+    pthread_mutex_unlock(&g_lock);
+}
+
+static void trace(void* user, const FAHRENSchedEvent* event) {
+    (void)user;
+    pthread_mutex_lock(&g_lock);
+    if (event->type == FAHREN_SCHED_BATCH_START && g_start_count < 16) g_started[g_start_count++] = event->model;
+    if (event->type == FAHREN_SCHED_SHED) g_shed_events++;
+    if (event->type == FAHREN_SCHED_REJECT) g_reject_events++;
+    pthread_mutex_unlock(&g_lock);
+}
+
+static void sleep_ms(long ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+static float g_x[IN], g_y[16][OUT];
+
+static void request(FAHRENRequest* req, size_t model, size_t i, uint64_t deadline_ns) {
+    memset(req, 0, sizeof(*req));
+    req->model = model;
+    req->input = g_x;
+    req->output = g_y[i];
+    req->rows = 1;
+    req->deadline_ns = deadline_ns;
+}
+
+/* fahren_runtime_forward_groups on its own thread. */
+typedef struct Forward {
+    FAHRENRuntime* rt;
+    const float* x;
+    FAHRENForwardGroup* groups;
+    float* y;
+    FAHRENStatus status;
+} Forward;
+
+static void* forward(void* arg) {
+    Forward* f = (Forward*)arg;
+    f->status = fahren_runtime_forward_groups(f->rt, f->x, f->groups, 3, f->y);
+    return NULL;
+}
+
+/* Callback requests: each call is counted, then the eventfd is signalled. */
+static FAHRENRequest g_cb[6];
+static int g_calls[6];
+
+static void counted(FAHRENRequest* req, void* user) {
+    __atomic_fetch_add(&g_calls[req - g_cb], 1, __ATOMIC_RELAXED);
+    fahren_request_signal_eventfd(req, user);
+}
+
+/* Sum of the eventfd's counter once it reaches `want` (or nothing more
+ * arrives for a second). */
+static uint64_t drain(int fd, uint64_t want) {
+    uint64_t total = 0, n;
+    struct pollfd p = {fd, POLLIN, 0};
+    while (total < want && poll(&p, 1, 1000) == 1) {
+        if (read(fd, &n, sizeof(n)) == (ssize_t)sizeof(n)) total += n;
+    }
+    return total;
+}
+
+static void* open_later(void* arg) {
+    (void)arg;
+    sleep_ms(50);
+    gate_set(0);
+    return NULL;
+}
+
+/* Park the worker inside a request of `model` that has no deadline. */
+static void hold_worker(FAHRENScheduler* sched, size_t model, FAHRENRequest* blocker) {
+    gate_set(1);
+    request(blocker, model, 15, 0);
+    CHECK(fahren_scheduler_submit(sched, blocker) == FAHREN_SUCCESS);
+    gate_wait_held();
+}
+
+int main(void) {
+    FAHRENExecutor executor = {NULL, NULL, gate_parallel_for, gate_workers};
+    FAHRENLayer* layers = NULL;
+    size_t count = 0;
+    FAHREN cm = {0};
+    FAHRENRuntime* rt[MODELS] = {NULL};
+    CHECK(fahren_runtime_parse_layers("8,256:tanh,4", &layers, &count) == FAHREN_SUCCESS);
+    FAHRENExecutor incomplete = {NULL, NULL, gate_parallel_for, NULL};
+    CHECK(fahren_init_ex(&cm, FAHREN_MODEL_SEQUENTIAL, count, layers, &incomplete) == FAHREN_ERROR_INVALID_ARGUMENT);
+    incomplete.parallel_for = NULL;
+    incomplete.worker_count = gate_workers;
+    CHECK(fahren_init_ex(&cm, FAHREN_MODEL_SEQUENTIAL, count, layers, &incomplete) == FAHREN_ERROR_INVALID_ARGUMENT);
+    CHECK(fahren_init_ex(&cm, FAHREN_MODEL_SEQUENTIAL, count, layers, &executor) == FAHREN_SUCCESS);
+    for (size_t i = 0; i < MODELS; ++i) {
+        CHECK(fahren_runtime_create(&cm, "fahren_initial_model.bin", &rt[i]) == FAHREN_SUCCESS);
+        if (!rt[i]) return 1;
+    }
+    for (size_t i = 0; i < IN; ++i) g_x[i] = 0.25f * (float)i - 1.0f;
+
+    FAHRENSchedulerConfig config = {1, trace, NULL};
+    FAHRENScheduler* sched = NULL;
+    CHECK(fahren_scheduler_create(&config, &sched) == FAHREN_SUCCESS);
+    if (!sched) return 1;
+    size_t model[MODELS];
+    FAHRENSchedModelConfig bounded = {0, 0, 2, 0};
+    for (size_t i = 0; i < MODELS; ++i) {
+        CHECK(fahren_scheduler_add_model(sched, rt[i], i + 1 == MODELS ? &bounded : NULL, &model[i]) ==
+              FAHREN_SUCCESS);
+    }
+
+    /* earliest deadline first across models, whatever the submit order */
+    FAHRENRequest blocker, req[3];
+    hold_worker(sched, model[0], &blocker);
+    uint64_t now = fahren_sched_now_ns();
+    request(&req[0], model[0], 0, 0);
+    request(&req[1], model[1], 1, now + 2000000000ull);
+    request(&req[2], model[2], 2, now + 1000000000ull);
+    for (int i = 0; i < 3; ++i) CHECK(fahren_scheduler_submit(sched, &req[i]) == FAHREN_SUCCESS);
+    gate_set(0);
+    CHECK(fahren_request_wait(sched, &blocker) == FAHREN_SUCCESS);
+    for (int i = 0; i < 3; ++i) CHECK(fahren_request_wait(sched, &req[i]) == FAHREN_SUCCESS);
+    CHECK(g_start_count == 4);
+    CHECK(g_started[0] == model[0] && g_started[1] == model[2] && g_started[2] == model[1] &&
+          g_started[3] == model[0]);
+
+    /* admitted in time, but the deadline passes while the worker is busy */
+    hold_worker(sched, model[0], &blocker);
+    request(&req[0], model[1], 0, fahren_sched_now_ns() + 20000000ull);
+    CHECK(fahren_scheduler_submit(sched, &req[0]) == FAHREN_SUCCESS);
+    sleep_ms(60);
+    gate_set(0);
+    CHECK(fahren_request_wait(sched, &req[0]) == FAHREN_ERROR_DEADLINE_EXCEEDED);
+    CHECK(fahren_request_wait(sched, &blocker) == FAHREN_SUCCESS);
+    FAHRENSchedStats stats;
+    CHECK(fahren_scheduler_stats(sched, model[1], &stats) == FAHREN_SUCCESS);
+    CHECK(stats.shed == 1 && stats.submitted == 2 && stats.completed == 1);
+    CHECK(g_shed_events == 1);
+
+    /* past the queue bound, and a deadline no batch could meet */
+    FAHRENRequest late;
+    hold_worker(sched, model[0], &blocker);
+    request(&req[0], model[3], 0, 0);
+    request(&req[1], model[3], 1, 0);
+    request(&req[2], model[3], 2, 0);
+    request(&late, model[1], 3, fahren_sched_now_ns() + 1);
+    CHECK(fahren_scheduler_submit(sched, &req[0]) == FAHREN_SUCCESS);
+    CHECK(fahren_scheduler_submit(sched, &req[1]) == FAHREN_SUCCESS);
+    CHECK(fahren_scheduler_submit(sched, &req[2]) == FAHREN_ERROR_OVERLOADED);
+    CHECK(fahren_scheduler_submit(sched, &late) == FAHREN_ERROR_OVERLOADED);
+    CHECK(fahren_request_poll(sched, &req[2], NULL) == 0);
+    CHECK(fahren_request_wait(sched, &req[2]) == FAHREN_ERROR_INVALID_ARGUMENT);
+    gate_set(0);
+    CHECK(fahren_request_wait(sched, &req[0]) == FAHREN_SUCCESS);
+    CHECK(fahren_request_wait(sched, &req[1]) == FAHREN_SUCCESS);
+    /* a refused request is left as it was and can be sent again */
+    CHECK(fahren_scheduler_submit(sched, &req[2]) == FAHREN_SUCCESS);
+    CHECK(fahren_request_wait(sched, &req[2]) == FAHREN_SUCCESS);
+    CHECK(fahren_request_wait(sched, &blocker) == FAHREN_SUCCESS);
+    CHECK(fahren_scheduler_stats(sched, model[3], &stats) == FAHREN_SUCCESS);
+    CHECK(stats.rejected == 1 && stats.submitted == 3 && stats.completed == 3);
+    CHECK(fahren_scheduler_stats(sched, model[1], &stats) == FAHREN_SUCCESS);
+    CHECK(stats.rejected == 1);
+    CHECK(g_reject_events == 2);
+
+    /* a group cancelled while its batch is inside a layer */
+    float x3[3 * IN], y3[3 * OUT], ref[3 * OUT];
+    for (size_t i = 0; i < 3 * IN; ++i) x3[i] = 0.1f * (float)i - 1.0f;
+    for (size_t i = 0; i < 3 * OUT; ++i) y3[i] = -7.0f;
+    CHECK(fahren_runtime_forward(rt[0], x3, 3, ref) == FAHREN_SUCCESS);
+    FAHRENCancelToken token = {0};
+    FAHRENForwardGroup groups[3] = {{1, NULL, 0}, {1, &token, 0}, {1, NULL, 0}};
+    Forward f = {rt[0], x3, groups, y3, FAHREN_ERROR_PROCESSING_FAILED};
+    pthread_t thread;
+    gate_set(1);
+    CHECK(pthread_create(&thread, NULL, forward, &f) == 0);
+    gate_wait_held();
+    fahren_cancel(&token);
+    gate_set(0);
+    pthread_join(thread, NULL);
+    CHECK(f.status == FAHREN_SUCCESS);
+    CHECK(!groups[0].cancelled && groups[1].cancelled && !groups[2].cancelled);
+    CHECK(memcmp(y3, ref, OUT * sizeof(float)) == 0);
+    CHECK(y3[OUT] == -7.0f && y3[2 * OUT - 1] == -7.0f);
+    CHECK(memcmp(y3 + 2 * OUT, ref + 2 * OUT, OUT * sizeof(float)) == 0);
+
+    /* cancelled while queued, while running, and before submission */
+    FAHRENCancelToken queued = {0}, running = {0};
+    gate_set(1);
+    request(&blocker, model[0], 15, 0);
+    blocker.cancel = &running;
+    CHECK(fahren_scheduler_submit(sched, &blocker) == FAHREN_SUCCESS);
+    gate_wait_held();
+    request(&req[0], model[1], 0, 0);
+    request(&req[1], model[1], 1, 0);
+    req[0].cancel = &queued;
+    CHECK(fahren_scheduler_submit(sched, &req[0]) == FAHREN_SUCCESS);
+    CHECK(fahren_scheduler_submit(sched, &req[1]) == FAHREN_SUCCESS);
+    fahren_scheduler_cancel(sched, &queued);
+    FAHRENStatus status = FAHREN_SUCCESS;
+    CHECK(fahren_request_poll(sched, &req[0], &status) == 1 && status == FAHREN_ERROR_CANCELLED);
+    fahren_scheduler_cancel(sched, &running);
+    gate_set(0);
+    CHECK(fahren_request_wait(sched, &blocker) == FAHREN_ERROR_CANCELLED);
+    CHECK(fahren_request_wait(sched, &req[1]) == FAHREN_SUCCESS);
+    request(&req[2], model[1], 2, 0);
+    req[2].cancel = &queued;
+    CHECK(fahren_scheduler_submit(sched, &req[2]) == FAHREN_ERROR_CANCELLED);
+    CHECK(fahren_scheduler_stats(sched, model[0], &stats) == FAHREN_SUCCESS);
+    CHECK(stats.cancelled == 1);
+    CHECK(fahren_scheduler_stats(sched, model[1], &stats) == FAHREN_SUCCESS);
+    CHECK(stats.cancelled == 1);
+
+    /* every forward pass above ran its loops on the host executor */
+    float y[OUT];
+    size_t loops = g_loops;
+    request(&req[0], model[2], 0, 0);
+    CHECK(fahren_scheduler_submit(sched, &req[0]) == FAHREN_SUCCESS);
+    CHECK(fahren_request_wait(sched, &req[0]) == FAHREN_SUCCESS);
+    CHECK(fahren_runtime_forward(rt[2], g_x, 1, y) == FAHREN_SUCCESS);
+    CHECK(memcmp(y, g_y[0], sizeof(y)) == 0);
+    CHECK(g_loops >= loops + 2);
+
+    /* one signal per completion: success, shed, cancelled; none if refused */
+    int efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    CHECK(efd >= 0);
+    void* fd_user = (void*)(intptr_t)efd;
+    FAHRENCancelToken cb_token = {0};
+    hold_worker(sched, model[0], &blocker);
+    uint64_t deadline[4] = {0, fahren_sched_now_ns() + 20000000ull, 0, fahren_sched_now_ns() + 1};
+    for (size_t i = 0; i < 4; ++i) {
+        request(&g_cb[i], model[1], i, deadline[i]);
+        g_cb[i].on_done = counted;
+        g_cb[i].user = fd_user;
+    }
+    g_cb[2].cancel = &cb_token;
+    for (size_t i = 0; i < 3; ++i) CHECK(fahren_scheduler_submit(sched, &g_cb[i]) == FAHREN_SUCCESS);
+    CHECK(fahren_scheduler_submit(sched, &g_cb[3]) == FAHREN_ERROR_OVERLOADED);
+    fahren_scheduler_cancel(sched, &cb_token);
+    sleep_ms(60);
+    gate_set(0);
+    CHECK(fahren_request_wait(sched, &blocker) == FAHREN_SUCCESS);
+    CHECK(drain(efd, 3) == 3);
+    FAHRENStatus expect[3] = {FAHREN_SUCCESS, FAHREN_ERROR_DEADLINE_EXCEEDED, FAHREN_ERROR_CANCELLED};
+    for (size_t i = 0; i < 3; ++i) {
+        status = FAHREN_ERROR_PROCESSING_FAILED;
+        CHECK(fahren_request_poll(sched, &g_cb[i], &status) == 1 && status == expect[i]);
+    }
+
+    /* requests still queued when the scheduler goes away */
+    hold_worker(sched, model[0], &blocker);
+    for (size_t i = 4; i < 6; ++i) {
+        request(&g_cb[i], model[1], i, 0);
+        g_cb[i].on_done = counted;
+        g_cb[i].user = fd_user;
+        CHECK(fahren_scheduler_submit(sched, &g_cb[i]) == FAHREN_SUCCESS);
+    }
+    CHECK(pthread_create(&thread, NULL, open_later, NULL) == 0);
+    fahren_scheduler_destroy(sched);
+    pthread_join(thread, NULL);
+    CHECK(blocker.status == FAHREN_SUCCESS);
+    CHECK(g_cb[4].status == FAHREN_ERROR_NOT_INITIALIZED && g_cb[5].status == FAHREN_ERROR_NOT_INITIALIZED);
+    CHECK(drain(efd, 2) == 2);
+    sleep_ms(20);
+    uint64_t extra;
+    CHECK(read(efd, &extra, sizeof(extra)) < 0 && errno == EAGAIN);
+    int calls[6] = {1, 1, 1, 0, 1, 1};
+    CHECK(memcmp(g_calls, calls, sizeof(calls)) == 0);
+    close(efd);
+    for (size_t i = 0; i < MODELS; ++i) fahren_runtime_destroy(rt[i]);
+    CHECK(fahren_shutdown(&cm) == FAHREN_SUCCESS);
+    return FAHREN_TEST_RESULT;
+}
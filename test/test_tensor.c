@@ -0,0 +1,100 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* View arithmetic of tensor.h: the strides and offsets that slice,
+ * transpose, flip and reshape produce, reshapes that must be refused,
+ * and fahren_tensor_copy through negative, zero and transposed strides
+ * compared element by element with plain index math. */
+#include <stdint.h>
+#include <string.h>
+
+#include <fahren/tensor.h>
+
+#include "fahren_test.h"
+
+/* Element at a rank-3 index of an F32 view. */
+static float at3(const FAHRENTensor* t, size_t i, size_t j, size_t k) {
+    ptrdiff_t off = (ptrdiff_t)t->offset + (ptrdiff_t)i * t->strides[0] + (ptrdiff_t)j * t->strides[1] +
+                    (ptrdiff_t)k * t->strides[2];
+    return ((const float*)t->base)[off];
+}
+
+int main(void) {
+    float buf[2 * 3 * 4];
+    for (size_t i = 0; i < 24; ++i) buf[i] = (float)i;
+    const size_t shape[3] = {2, 3, 4};
+    FAHRENTensor t, v;
+    CHECK(fahren_tensor_init(&t, FAHREN_DTYPE_F32, buf, 0, 3, shape) == FAHREN_SUCCESS);
+    CHECK(t.strides[0] == 12 && t.strides[1] == 4 && t.strides[2] == 1);
+    CHECK(fahren_tensor_is_contiguous(&t) && fahren_tensor_numel(&t) == 24);
+
+    /* slice and flip only move the offset and negate a stride */
+    CHECK(fahren_tensor_slice(&t, 2, 1, 3, &v) == FAHREN_SUCCESS);
+    CHECK(v.shape[2] == 2 && v.offset == 1 && v.strides[2] == 1 && !fahren_tensor_is_contiguous(&v));
+    CHECK(fahren_tensor_flip(&t, 1, &v) == FAHREN_SUCCESS);
+    CHECK(v.strides[1] == -4 && v.offset == 8);
+    CHECK(at3(&v, 1, 0, 3) == buf[12 + 8 + 3]);
+
+    /* transposing in place swaps shape and strides */
+    v = t;
+    CHECK(fahren_tensor_transpose(&v, 0, 2, &v) == FAHREN_SUCCESS);
+    CHECK(v.shape[0] == 4 && v.shape[2] == 2 && v.strides[0] == 1 && v.strides[2] == 12);
+
+    /* reshape: merging packed axes is a view, merging across a transpose
+     * is not, and the element count must match */
+    const size_t merged[2] = {6, 4}, bad[2] = {5, 4}, across[2] = {8, 3};
+    CHECK(fahren_tensor_reshape(&t, 2, merged, &v) == FAHREN_SUCCESS);
+    CHECK(v.strides[0] == 4 && v.strides[1] == 1);
+    CHECK(fahren_tensor_reshape(&t, 2, bad, &v) == FAHREN_ERROR_INVALID_ARGUMENT);
+    FAHRENTensor tt;
+    CHECK(fahren_tensor_transpose(&t, 1, 2, &tt) == FAHREN_SUCCESS);
+    CHECK(fahren_tensor_reshape(&tt, 2, across, &v) == FAHREN_ERROR_INVALID_ARGUMENT);
+    const size_t split[4] = {2, 3, 2, 2};
+    CHECK(fahren_tensor_reshape(&t, 4, split, &v) == FAHREN_SUCCESS);
+    CHECK(v.strides[2] == 2 && v.strides[3] == 1);
+
+    /* copy a flipped, transposed view into a packed tensor */
+    float out[24];
+    memset(out, 0, sizeof(out));
+    FAHRENTensor src, dst;
+    CHECK(fahren_tensor_flip(&t, 2, &src) == FAHREN_SUCCESS);
+    CHECK(fahren_tensor_transpose(&src, 0, 1, &src) == FAHREN_SUCCESS);
+    const size_t dshape[3] = {3, 2, 4};
+    CHECK(fahren_tensor_init(&dst, FAHREN_DTYPE_F32, out, 0, 3, dshape) == FAHREN_SUCCESS);
+    CHECK(fahren_tensor_copy(&src, &dst) == FAHREN_SUCCESS);
+    size_t wrong = 0;
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 2; ++j)
+            for (size_t k = 0; k < 4; ++k) wrong += out[(i * 2 + j) * 4 + k] != buf[j * 12 + i * 4 + (3 - k)];
+    CHECK(wrong == 0);
+
+    /* a broadcast (stride 0) source repeats one row */
+    const size_t row_shape[3] = {1, 1, 4}, wide[3] = {2, 3, 4};
+    CHECK(fahren_tensor_init(&src, FAHREN_DTYPE_F32, buf, 4, 3, row_shape) == FAHREN_SUCCESS);
+    CHECK(fahren_tensor_broadcast(&src, 0, 2, &src) == FAHREN_SUCCESS);
+    CHECK(fahren_tensor_broadcast(&src, 1, 3, &src) == FAHREN_SUCCESS);
+    CHECK(src.strides[0] == 0 && src.strides[1] == 0);
+    CHECK(fahren_tensor_init(&dst, FAHREN_DTYPE_F32, out, 0, 3, wide) == FAHREN_SUCCESS);
+    CHECK(fahren_tensor_copy(&src, &dst) == FAHREN_SUCCESS);
+    wrong = 0;
+    for (size_t i = 0; i < 24; ++i) wrong += out[i] != buf[4 + i % 4];
+    CHECK(wrong == 0);
+
+    /* 2-byte elements take the same strided path */
+    uint16_t h[6] = {1, 2, 3, 4, 5, 6}, ht[6];
+    const size_t hs[2] = {2, 3}, hts[2] = {3, 2};
+    FAHRENTensor a, b;
+    CHECK(fahren_tensor_init(&a, FAHREN_DTYPE_BF16, h, 0, 2, hs) == FAHREN_SUCCESS);
+    CHECK(fahren_tensor_transpose(&a, 0, 1, &a) == FAHREN_SUCCESS);
+    CHECK(fahren_tensor_init(&b, FAHREN_DTYPE_BF16, ht, 0, 2, hts) == FAHREN_SUCCESS);
+    CHECK(fahren_tensor_copy(&a, &b) == FAHREN_SUCCESS);
+    CHECK(ht[0] == 1 && ht[1] == 4 && ht[2] == 2 && ht[5] == 6);
+
+    /* mismatched shapes are refused */
+    CHECK(fahren_tensor_copy(&t, &dst) == FAHREN_SUCCESS);
+    CHECK(fahren_tensor_init(&dst, FAHREN_DTYPE_F32, out, 0, 3, dshape) == FAHREN_SUCCESS);
+    CHECK(fahren_tensor_copy(&t, &dst) == FAHREN_ERROR_INVALID_ARGUMENT);
+    return FAHREN_TEST_RESULT;
+}
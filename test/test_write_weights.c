@@ -0,0 +1,145 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* fahren_init writes fahren_initial_model.bin: a format 1 header whose
+ * counts match the layer chain, followed by that many floats in the
+ * default uniform range. The file is built under its own
+ * "<path>.tmp.<pid>.<n>" name, created exclusively, so an existing file
+ * of that name is never reused and concurrent writers of one path each
+ * leave a complete blob and no temporary behind. fahren_shutdown keeps
+ * temporaries of live processes and removes those of dead ones. */
+#include <dirent.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <fahren/fahren.h>
+#include <fahren/format.h>
+#include <fahren/runtime.h>
+
+#include "fahren_test.h"
+
+static const char* const PATH = "fahren_initial_model.bin";
+static const char* const WIDE = "64,256:tanh,64"; /* the concurrent writers' model */
+
+static void write_file(const char* name, const char* text) {
+    FILE* f = fopen(name, "w");
+    CHECK(f != NULL);
+    if (!f) return;
+    fputs(text, f);
+    fclose(f);
+}
+
+static int file_is(const char* name, const char* text) {
+    char buf[64] = {0};
+    FILE* f = fopen(name, "r");
+    if (!f) return 0;
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    return n == strlen(text) && memcmp(buf, text, n) == 0;
+}
+
+/* Temporaries of PATH in the current directory. */
+static size_t count_tmp(void) {
+    size_t n = 0, len = strlen(PATH);
+    DIR* d = opendir(".");
+    struct dirent* ent;
+    while (d && (ent = readdir(d)) != NULL) {
+        n += strncmp(ent->d_name, PATH, len) == 0 && strncmp(ent->d_name + len, ".tmp.", 5) == 0;
+    }
+    if (d) closedir(d);
+    return n;
+}
+
+typedef struct Writer {
+    FAHREN cm;
+    FAHRENStatus status;
+} Writer;
+
+static void* write_model(void* arg) {
+    Writer* w = (Writer*)arg;
+    FAHRENLayer* layers = NULL;
+    size_t count = 0;
+    w->status = fahren_runtime_parse_layers(WIDE, &layers, &count);
+    if (w->status == FAHREN_SUCCESS) w->status = fahren_init(&w->cm, FAHREN_MODEL_SEQUENTIAL, count, layers);
+    return NULL;
+}
+
+int main(void) {
+    /* the first temporary name this process would pick is already taken */
+    char squat[64];
+    snprintf(squat, sizeof(squat), "%s.tmp.%ld.0", PATH, (long)getpid());
+    write_file(squat, "squatter");
+
+    FAHRENLayer* layers = NULL;
+    size_t count = 0;
+    CHECK(fahren_runtime_parse_layers("16,32:relu,8", &layers, &count) == FAHREN_SUCCESS);
+    if (!layers) return 1;
+    uint64_t counts[6];
+    CHECK(fahren_model_layer_counts(layers, count, counts) == FAHREN_SUCCESS);
+    uint64_t weights = counts[0] + counts[2] + counts[4], biases = counts[1] + counts[3] + counts[5];
+
+    FAHREN cm = {0};
+    CHECK(fahren_init(&cm, FAHREN_MODEL_SEQUENTIAL, count, layers) == FAHREN_SUCCESS);
+    CHECK(file_is(squat, "squatter"));
+    CHECK(count_tmp() == 1);
+    unlink(squat);
+    FILE* f = fopen(PATH, "rb");
+    CHECK(f != NULL);
+    if (f) {
+        FAHRENModelHeader h;
+        CHECK(fread(&h, sizeof(h), 1, f) == 1);
+        CHECK(h.magic == FAHREN_MODEL_MAGIC);
+        CHECK(h.version_major == FAHREN_VERSION_MAJOR);
+        CHECK(h.weight_count == weights && h.bias_count == biases);
+        size_t n = (size_t)(weights + biases), bad = 0;
+        float* values = (float*)malloc(n * sizeof(float));
+        CHECK(values && fread(values, sizeof(float), n, f) == n);
+        for (size_t i = 0; values && i < n; ++i) bad += !(fabsf(values[i]) <= 0.5f);
+        CHECK(bad == 0);
+        CHECK(fgetc(f) == EOF);
+        free(values);
+        fclose(f);
+    }
+
+    /* two writers of the same path at once */
+    CHECK(fahren_runtime_parse_layers(WIDE, &layers, &count) == FAHREN_SUCCESS);
+    CHECK(count == 3 && fahren_model_layer_counts(layers, count, counts) == FAHREN_SUCCESS);
+    free(layers);
+    Writer w[2];
+    pthread_t thread[2];
+    memset(w, 0, sizeof(w));
+    for (int i = 0; i < 2; ++i) CHECK(pthread_create(&thread[i], NULL, write_model, &w[i]) == 0);
+    for (int i = 0; i < 2; ++i) {
+        pthread_join(thread[i], NULL);
+        CHECK(w[i].status == FAHREN_SUCCESS);
+    }
+    FAHRENModelView view;
+    CHECK(fahren_model_open(PATH, &view) == FAHREN_SUCCESS);
+    CHECK(view.weight_count == counts[0] + counts[2] + counts[4]);
+    CHECK(view.bias_count == counts[1] + counts[3] + counts[5]);
+    fahren_model_close(&view);
+    CHECK(count_tmp() == 0);
+    for (int i = 0; i < 2; ++i) CHECK(fahren_shutdown(&w[i].cm) == FAHREN_SUCCESS);
+
+    /* shutdown spares a live writer's temporary, not a dead one's */
+    pid_t child = fork();
+    if (child == 0) _exit(0);
+    CHECK(child > 0 && waitpid(child, NULL, 0) == child);
+    char live[64], dead[64];
+    snprintf(live, sizeof(live), "%s.tmp.%ld.7", PATH, (long)getpid());
+    snprintf(dead, sizeof(dead), "%s.tmp.%ld.7", PATH, (long)child);
+    write_file(live, "live");
+    write_file(dead, "dead");
+    CHECK(fahren_shutdown(&cm) == FAHREN_SUCCESS);
+    CHECK(file_is(live, "live"));
+    CHECK(access(dead, F_OK) != 0);
+    unlink(live);
+    return FAHREN_TEST_RESULT;
+}
@@ -0,0 +1,265 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* fahren: inspect, convert, verify and benchmark model blobs.
+ *
+ *   fahren inspect FILE
+ *   fahren convert IN OUT [--format 1|2] [--dtype f32|f16|bf16] [--layout split|interleaved] [--spec SPEC]
+ *   fahren verify FILE...
+ *   fahren bench FILE --spec SPEC [--batch N] [--iters N]
+ *
+ * Every command maps its input read-only (format.h), so even multi-GB
+ * blobs are never copied onto the heap. inspect prints the header, the
+ * layer table and value statistics. convert streams into a new file; SPEC
+ * (the runtime's layer spec, see runtime.h) supplies the per-layer counts
+ * that interleaving needs when the source has no table, and is stored as
+ * format 2's table. The defaults are format 2, the source's dtype and its
+ * layout. verify recomputes format 2 checksums and exits 1 on any
+ * mismatch. bench loads a format 1 blob into the runtime and times
+ * forward passes over random inputs. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <fahren/fahren.h>
+#include <fahren/format.h>
+#include <fahren/runtime.h>
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec * 1e-6;
+}
+
+static const char* dtype_name(FAHRENDType dtype) {
+    switch (dtype) {
+    case FAHREN_DTYPE_F32:
+        return "f32";
+    case FAHREN_DTYPE_F16:
+        return "f16";
+    case FAHREN_DTYPE_BF16:
+        return "bf16";
+    }
+    return "?";
+}
+
+static int parse_dtype(const char* s, FAHRENDType* dtype) {
+    if (strcmp(s, "f32") == 0) *dtype = FAHREN_DTYPE_F32;
+    else if (strcmp(s, "f16") == 0) *dtype = FAHREN_DTYPE_F16;
+    else if (strcmp(s, "bf16") == 0) *dtype = FAHREN_DTYPE_BF16;
+    else return 0;
+    return 1;
+}
+
+static int open_model(const char* path, FAHRENModelView* view) {
+    FAHRENStatus st = fahren_model_open(path, view);
+    if (st == FAHREN_SUCCESS) return 1;
+    fprintf(stderr, "fahren: %s: %s\n", path,
+            st == FAHREN_ERROR_INVALID_ARGUMENT ? "not a FAHREN model blob" : "cannot open");
+    return 0;
+}
+
+/* Per-layer counts for SPEC; *counts is malloc'd, 2 x *layer_count. */
+static int spec_counts(const char* spec, uint64_t** counts, size_t* layer_count) {
+    FAHRENLayer* layers = NULL;
+    size_t n = 0;
+    if (fahren_runtime_parse_layers(spec, &layers, &n) != FAHREN_SUCCESS) {
+        fprintf(stderr, "fahren: bad layer spec '%s'\n", spec);
+        return 0;
+    }
+    *counts = (uint64_t*)malloc(2 * n * sizeof(uint64_t));
+    int ok = *counts && fahren_model_layer_counts(layers, n, *counts) == FAHREN_SUCCESS;
+    free(layers);
+    if (!ok) {
+        fprintf(stderr, "fahren: bad layer spec '%s'\n", spec);
+        free(*counts);
+        *counts = NULL;
+        return 0;
+    }
+    *layer_count = n;
+    return 1;
+}
+
+static void print_stats(const char* what, const FAHRENModelStats* s) {
+    printf("%-8s %12llu values  min %-12.6g max %-12.6g mean %-12.6g rms %-12.6g", what,
+           (unsigned long long)s->count, s->min, s->max, s->mean, s->rms);
+    if (s->nonfinite) printf("  non-finite %llu", (unsigned long long)s->nonfinite);
+    printf("\n");
+}
+
+static int cmd_inspect(int argc, char** argv) {
+    if (argc != 1) return 2;
+    FAHRENModelView v;
+    if (!open_model(argv[0], &v)) return 1;
+    printf("file     %s (%zu bytes)\n", argv[0], v.size);
+    printf("format   %u ('%s'), written by FAHREN %u.%u.%u\n", v.format, v.format == 1 ? "FAHN" : "FAHX",
+           v.version_major, v.version_minor, v.version_patch);
+    printf("values   %s, %s\n", dtype_name(v.dtype), v.layout == FAHREN_LAYOUT_SPLIT ? "split" : "interleaved");
+    printf("counts   %llu weights, %llu biases\n", (unsigned long long)v.weight_count,
+           (unsigned long long)v.bias_count);
+    if (v.format == 2) printf("checksum %016llx\n", (unsigned long long)v.checksum);
+    for (uint64_t l = 0; v.layer_counts && l < v.layer_count; ++l) {
+        printf("layer %-4llu %12llu weights %10llu biases\n", (unsigned long long)l,
+               (unsigned long long)v.layer_counts[2 * l], (unsigned long long)v.layer_counts[2 * l + 1]);
+    }
+    FAHRENModelStats w, b;
+    if (fahren_model_stats(&v, &w, &b) == FAHREN_SUCCESS) {
+        print_stats("weights", &w);
+        print_stats("biases", &b);
+    }
+    fahren_model_close(&v);
+    return 0;
+}
+
+static int cmd_convert(int argc, char** argv) {
+    if (argc < 2 || argc % 2 != 0) return 2;
+    FAHRENModelView v;
+    if (!open_model(argv[0], &v)) return 1;
+    FAHRENModelConvertOptions opts = {2, v.dtype, v.layout, NULL, 0};
+    const char* spec = NULL;
+    int bad = 0;
+    for (int i = 2; i + 1 < argc && !bad; i += 2) {
+        if (strcmp(argv[i], "--format") == 0) opts.format = (uint32_t)strtoul(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--dtype") == 0) bad = !parse_dtype(argv[i + 1], &opts.dtype);
+        else if (strcmp(argv[i], "--layout") == 0 && strcmp(argv[i + 1], "split") == 0)
+            opts.layout = FAHREN_LAYOUT_SPLIT;
+        else if (strcmp(argv[i], "--layout") == 0 && strcmp(argv[i + 1], "interleaved") == 0)
+            opts.layout = FAHREN_LAYOUT_INTERLEAVED;
+        else if (strcmp(argv[i], "--spec") == 0) spec = argv[i + 1];
+        else bad = 1;
+    }
+    uint64_t* counts = NULL;
+    if (bad || (spec && !spec_counts(spec, &counts, &opts.layer_count))) {
+        fahren_model_close(&v);
+        return bad ? 2 : 1;
+    }
+    opts.layer_counts = counts;
+    double t0 = now_ms();
+    FAHRENStatus st = fahren_model_convert(&v, argv[1], &opts);
+    double ms = now_ms() - t0;
+    if (st == FAHREN_SUCCESS) {
+        printf("%s -> %s: format %u, %s, %s in %.1f ms\n", argv[0], argv[1], opts.format, dtype_name(opts.dtype),
+               opts.layout == FAHREN_LAYOUT_SPLIT ? "split" : "interleaved", ms);
+    } else if (st == FAHREN_ERROR_INVALID_ARGUMENT) {
+        fprintf(stderr, "fahren: cannot convert %s: format 1 needs f32 and split, interleaving needs "
+                        "per-layer counts (--spec), and a spec must match the blob\n", argv[0]);
+    } else {
+        fprintf(stderr, "fahren: cannot write %s\n", argv[1]);
+    }
+    free(counts);
+    fahren_model_close(&v);
+    return st == FAHREN_SUCCESS ? 0 : 1;
+}
+
+static int cmd_verify(int argc, char** argv) {
+    if (argc < 1) return 2;
+    int failed = 0;
+    for (int i = 0; i < argc; ++i) {
+        FAHRENModelView v;
+        if (!open_model(argv[i], &v)) {
+            failed = 1;
+            continue;
+        }
+        uint64_t actual = 0;
+        double t0 = now_ms();
+        FAHRENStatus st = fahren_model_verify(&v, &actual);
+        double ms = now_ms() - t0;
+        double gbs = ms > 0.0 ? (double)v.size / (ms * 1e6) : 0.0;
+        if (st == FAHREN_SUCCESS) {
+            printf("%s: OK %016llx (%.1f ms, %.2f GB/s)\n", argv[i], (unsigned long long)actual, ms, gbs);
+        } else if (st == FAHREN_ERROR_INVALID_ARGUMENT) {
+            printf("%s: format 1, no stored checksum (content %016llx)\n", argv[i], (unsigned long long)actual);
+        } else {
+            printf("%s: MISMATCH stored %016llx, actual %016llx\n", argv[i], (unsigned long long)v.checksum,
+                   (unsigned long long)actual);
+            failed = 1;
+        }
+        fahren_model_close(&v);
+    }
+    return failed;
+}
+
+static int cmd_bench(int argc, char** argv) {
+    if (argc < 1 || argc % 2 != 1) return 2;
+    const char* spec = NULL;
+    size_t batch = 64, iters = 100;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--spec") == 0) spec = argv[i + 1];
+        else if (strcmp(argv[i], "--batch") == 0) batch = strtoul(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--iters") == 0) iters = strtoul(argv[i + 1], NULL, 10);
+        else return 2;
+    }
+    if (!spec || batch == 0 || iters == 0) return 2;
+    FAHRENModelView v;
+    if (!open_model(argv[0], &v)) return 1;
+    uint32_t format = v.format;
+    fahren_model_close(&v);
+    if (format != 1) {
+        fprintf(stderr, "fahren: %s is format %u; the runtime loads format 1, so convert it first:\n"
+                        "  fahren convert %s OUT --format 1 --dtype f32 --layout split\n", argv[0], format, argv[0]);
+        return 1;
+    }
+
+    /* The model is described by the spec alone; fahren_init is skipped so
+     * no fresh weights are written next to the blob. */
+    FAHREN cm;
+    memset(&cm, 0, sizeof(cm));
+    if (fahren_runtime_parse_layers(spec, &cm.layers, &cm.layer_count) != FAHREN_SUCCESS) {
+        fprintf(stderr, "fahren: bad layer spec '%s'\n", spec);
+        return 1;
+    }
+    cm.model_type = FAHREN_MODEL_SEQUENTIAL;
+    cm.initialized = 1;
+    FAHRENRuntime* rt = NULL;
+    double t0 = now_ms();
+    FAHRENStatus st = fahren_runtime_create(&cm, argv[0], &rt);
+    double load_ms = now_ms() - t0;
+    if (st != FAHREN_SUCCESS) {
+        fprintf(stderr, "fahren: %s does not fit spec '%s'\n", argv[0], spec);
+        free(cm.layers);
+        return 1;
+    }
+    size_t in = fahren_runtime_input_dim(rt), out = fahren_runtime_output_dim(rt);
+    float* x = (float*)malloc(batch * in * sizeof(float));
+    float* y = (float*)malloc(batch * out * sizeof(float));
+    int rc = 1;
+    if (x && y) {
+        srand48(1);
+        for (size_t i = 0; i < batch * in; ++i) x[i] = (float)(drand48() - 0.5);
+        fahren_runtime_forward(rt, x, batch, y); /* warm-up */
+        t0 = now_ms();
+        for (size_t i = 0; i < iters && st == FAHREN_SUCCESS; ++i) st = fahren_runtime_forward(rt, x, batch, y);
+        double ms = now_ms() - t0;
+        if (st == FAHREN_SUCCESS) {
+            printf("%s: load %.1f ms, batch %zu: %.3f ms/forward, %.0f rows/s\n", argv[0], load_ms, batch,
+                   ms / (double)iters, (double)(batch * iters) * 1e3 / ms);
+            rc = 0;
+        }
+    }
+    free(x);
+    free(y);
+    fahren_runtime_destroy(rt);
+    free(cm.layers);
+    return rc;
+}
+
+int main(int argc, char** argv) {
+    int rc = 2;
+    if (argc >= 2) {
+        if (strcmp(argv[1], "inspect") == 0) rc = cmd_inspect(argc - 2, argv + 2);
+        else if (strcmp(argv[1], "convert") == 0) rc = cmd_convert(argc - 2, argv + 2);
+        else if (strcmp(argv[1], "verify") == 0) rc = cmd_verify(argc - 2, argv + 2);
+        else if (strcmp(argv[1], "bench") == 0) rc = cmd_bench(argc - 2, argv + 2);
+    }
+    if (rc == 2) {
+        fprintf(stderr, "usage: fahren inspect FILE\n"
+                        "       fahren convert IN OUT [--format 1|2] [--dtype f32|f16|bf16] "
+                        "[--layout split|interleaved] [--spec SPEC]\n"
+                        "       fahren verify FILE...\n"
+                        "       fahren bench FILE --spec SPEC [--batch N] [--iters N]\n");
+    }
+    return rc;
+}
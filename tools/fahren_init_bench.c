@@ -0,0 +1,279 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* fahren_init_bench: wall-clock time to a target training loss for each
+ * weight initializer.
+ *
+ *   fahren_init_bench [--spec SPEC] [--target LOSS] [--steps N] [--lr RATE] [--batch N]
+ *
+ * The model (default "32,256:relu,256:relu,256:relu,256:relu,10") is
+ * trained with plain SGD on the autograd tape against a fixed synthetic
+ * task: 10-way classification of Gaussian inputs labelled by a random
+ * linear teacher. Each initializer starts from the same data and RNG seed
+ * and the bench stops it once the loss averaged over the last 20 steps
+ * drops below the target, or after N steps. Weights come from
+ * fahren_init, so this also exercises fahren_write_random_weights; it
+ * writes fahren_initial_model.bin in the working directory. */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <fahren/autograd.h>
+#include <fahren/fahren.h>
+#include <fahren/runtime.h>
+
+#define BENCH_SAMPLES 4096
+#define BENCH_CLASSES 10
+#define BENCH_WINDOW 20
+
+typedef struct BenchModel {
+    size_t layers;      /* dense layers after the input layer */
+    size_t* dims;       /* layers + 1 widths */
+    FAHRENActivation* act;
+    float* scale;       /* input layer, applied to the data up front */
+    float* shift;
+    float** w;          /* in x out (transposed from the blob) */
+    float** b;
+    float** dw;
+    float** db;
+} BenchModel;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec * 1e-6;
+}
+
+static float gaussian(void) {
+    double u1 = 1.0 - drand48(), u2 = drand48();
+    return (float)(sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2));
+}
+
+static void model_free(BenchModel* m) {
+    for (size_t l = 0; m->w && l < m->layers; ++l) {
+        free(m->w[l]);
+        free(m->b[l]);
+        free(m->dw[l]);
+        free(m->db[l]);
+    }
+    free(m->w);
+    free(m->b);
+    free(m->dw);
+    free(m->db);
+    free(m->scale);
+    free(m->shift);
+    free(m->dims);
+    free(m->act);
+    memset(m, 0, sizeof(*m));
+}
+
+/* Write weights for `layers` with fahren_init and read them back. */
+static int model_load(BenchModel* m, FAHRENLayer* layers, size_t count) {
+    memset(m, 0, sizeof(*m));
+    FAHREN cm;
+    memset(&cm, 0, sizeof(cm));
+    if (fahren_init(&cm, FAHREN_MODEL_SEQUENTIAL, count, layers) != FAHREN_SUCCESS) return 0;
+    FILE* f = fopen("fahren_initial_model.bin", "rb");
+    if (!f) return 0;
+    m->layers = count - 1;
+    m->dims = (size_t*)calloc(count, sizeof(size_t));
+    m->act = (FAHRENActivation*)calloc(count, sizeof(FAHRENActivation));
+    m->w = (float**)calloc(count, sizeof(float*));
+    m->b = (float**)calloc(count, sizeof(float*));
+    m->dw = (float**)calloc(count, sizeof(float*));
+    m->db = (float**)calloc(count, sizeof(float*));
+    if (!m->dims || !m->act || !m->w || !m->b || !m->dw || !m->db) {
+        fclose(f);
+        model_free(m);
+        return 0;
+    }
+    for (size_t l = 0; l < count; ++l) m->dims[l] = (size_t)layers[l].density;
+    for (size_t l = 1; l < count; ++l) m->act[l - 1] = layers[l].activation;
+    size_t n0 = m->dims[0];
+    m->scale = (float*)malloc(n0 * sizeof(float));
+    m->shift = (float*)malloc(n0 * sizeof(float));
+    int ok = m->scale && m->shift;
+    unsigned char header[32];
+    ok = ok && fread(header, sizeof(header), 1, f) == 1 && fread(m->scale, sizeof(float), n0, f) == n0;
+    for (size_t l = 0; ok && l < m->layers; ++l) {
+        size_t in = m->dims[l], out = m->dims[l + 1];
+        float* blob = (float*)malloc(in * out * sizeof(float));
+        m->w[l] = (float*)malloc(in * out * sizeof(float));
+        m->dw[l] = (float*)calloc(in * out, sizeof(float));
+        ok = blob && m->w[l] && m->dw[l] && fread(blob, sizeof(float), in * out, f) == in * out;
+        for (size_t o = 0; ok && o < out; ++o) {
+            for (size_t i = 0; i < in; ++i) m->w[l][i * out + o] = blob[o * in + i];
+        }
+        free(blob);
+    }
+    ok = ok && fread(m->shift, sizeof(float), n0, f) == n0;
+    for (size_t l = 0; ok && l < m->layers; ++l) {
+        size_t out = m->dims[l + 1];
+        m->b[l] = (float*)malloc(out * sizeof(float));
+        m->db[l] = (float*)calloc(out, sizeof(float));
+        ok = m->b[l] && m->db[l] && fread(m->b[l], sizeof(float), out, f) == out;
+    }
+    fclose(f);
+    if (!ok) model_free(m);
+    return ok;
+}
+
+/* Record one forward pass of rows x[0..rows) and return the loss variable. */
+static FAHRENStatus model_loss(FAHRENTape* tape, BenchModel* m, const float* x, const int* labels, size_t rows,
+                               FAHRENVar* loss) {
+    FAHRENVar h, w, b;
+    FAHRENStatus st = fahren_tape_constant(tape, x, rows, m->dims[0], &h);
+    for (size_t l = 0; st == FAHREN_SUCCESS && l < m->layers; ++l) {
+        size_t in = m->dims[l], out = m->dims[l + 1];
+        st = fahren_tape_param(tape, m->w[l], m->dw[l], in, out, &w);
+        if (st == FAHREN_SUCCESS) st = fahren_tape_param(tape, m->b[l], m->db[l], 1, out, &b);
+        if (st == FAHREN_SUCCESS) st = fahren_tape_matmul(tape, h, w, &h);
+        if (st == FAHREN_SUCCESS) st = fahren_tape_add(tape, h, b, &h);
+        if (st == FAHREN_SUCCESS) st = fahren_tape_activation(tape, h, m->act[l], &h);
+    }
+    if (st == FAHREN_SUCCESS) st = fahren_tape_softmax_xent(tape, h, labels, loss);
+    return st;
+}
+
+static void sgd(BenchModel* m, float lr) {
+    for (size_t l = 0; l < m->layers; ++l) {
+        size_t in = m->dims[l], out = m->dims[l + 1];
+        for (size_t i = 0; i < in * out; ++i) {
+            m->w[l][i] -= lr * m->dw[l][i];
+            m->dw[l][i] = 0.0f;
+        }
+        for (size_t i = 0; i < out; ++i) {
+            m->b[l][i] -= lr * m->db[l][i];
+            m->db[l][i] = 0.0f;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* spec = "32,256:relu,256:relu,256:relu,256:relu,10";
+    double target = 0.5, lr = 0.05;
+    size_t steps = 3000, batch = 64;
+    int bad = argc % 2 == 0;
+    for (int i = 1; i + 1 < argc && !bad; i += 2) {
+        if (strcmp(argv[i], "--spec") == 0) spec = argv[i + 1];
+        else if (strcmp(argv[i], "--target") == 0) target = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--steps") == 0) steps = strtoul(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--lr") == 0) lr = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--batch") == 0) batch = strtoul(argv[i + 1], NULL, 10);
+        else bad = 1;
+    }
+    FAHRENLayer* layers = NULL;
+    size_t count = 0;
+    if (!bad && fahren_runtime_parse_layers(spec, &layers, &count) != FAHREN_SUCCESS) bad = 1;
+    if (bad || count < 2 || steps == 0 || batch == 0 || batch > BENCH_SAMPLES ||
+        (size_t)layers[count - 1].density != BENCH_CLASSES) {
+        fprintf(stderr, "usage: fahren_init_bench [--spec SPEC] [--target LOSS] [--steps N] [--lr RATE] "
+                        "[--batch N]\n  (SPEC needs at least one dense layer and %d outputs)\n", BENCH_CLASSES);
+        free(layers);
+        return 2;
+    }
+
+    /* data: x ~ N(0, 1), label = argmax of a random linear teacher */
+    size_t in_dim = (size_t)layers[0].density;
+    float* data = (float*)malloc(BENCH_SAMPLES * in_dim * sizeof(float));
+    float* x = (float*)malloc(BENCH_SAMPLES * in_dim * sizeof(float));
+    float* teacher = (float*)malloc(in_dim * BENCH_CLASSES * sizeof(float));
+    int* labels = (int*)malloc(BENCH_SAMPLES * sizeof(int));
+    if (!data || !x || !teacher || !labels) return 1;
+    srand48(7);
+    for (size_t i = 0; i < BENCH_SAMPLES * in_dim; ++i) data[i] = gaussian();
+    for (size_t i = 0; i < in_dim * BENCH_CLASSES; ++i) teacher[i] = gaussian();
+    for (size_t s = 0; s < BENCH_SAMPLES; ++s) {
+        float best = -INFINITY;
+        for (int c = 0; c < BENCH_CLASSES; ++c) {
+            float v = 0.0f;
+            for (size_t i = 0; i < in_dim; ++i) v += data[s * in_dim + i] * teacher[i * BENCH_CLASSES + c];
+            if (v > best) {
+                best = v;
+                labels[s] = c;
+            }
+        }
+    }
+
+    size_t widths = 0;
+    for (size_t l = 0; l < count; ++l) widths += (size_t)layers[l].density;
+    FAHRENTape* tape = NULL;
+    if (fahren_tape_create(8 * count + 8, 16 * batch * widths * sizeof(float) + (1u << 20), &tape) != FAHREN_SUCCESS) {
+        return 1;
+    }
+
+    static const struct {
+        const char* name;
+        FAHRENInit init;
+        int zero_bias;
+    } schemes[] = {
+        {"uniform", FAHREN_INIT_UNIFORM, 0},
+        {"xavier", FAHREN_INIT_XAVIER, 1},
+        {"he", FAHREN_INIT_HE, 1},
+        {"orthogonal", FAHREN_INIT_ORTHOGONAL, 1},
+    };
+    printf("model %s  target loss %.3g  lr %.3g  batch %zu\n", spec, target, lr, batch);
+    printf("%-11s %10s %8s %11s %11s\n", "init", "first loss", "steps", "ms", "final loss");
+    int rc = 0;
+    for (size_t k = 0; k < sizeof(schemes) / sizeof(schemes[0]); ++k) {
+        for (size_t l = 0; l < count; ++l) {
+            layers[l].init = schemes[k].init;
+            layers[l].zero_bias = schemes[k].zero_bias;
+        }
+        srand48(42);
+        BenchModel m;
+        if (!model_load(&m, layers, count)) {
+            fprintf(stderr, "fahren_init_bench: cannot write or read initial weights\n");
+            rc = 1;
+            break;
+        }
+        for (size_t s = 0; s < BENCH_SAMPLES; ++s) {
+            for (size_t i = 0; i < in_dim; ++i) {
+                x[s * in_dim + i] = data[s * in_dim + i] * m.scale[i] + m.shift[i];
+            }
+        }
+
+        double window[BENCH_WINDOW] = {0}, avg = INFINITY, first = 0.0;
+        size_t step = 0;
+        double t0 = now_ms();
+        for (; step < steps; ++step) {
+            size_t row = (step * batch) % (BENCH_SAMPLES - batch + 1);
+            FAHRENVar loss;
+            fahren_tape_reset(tape);
+            if (model_loss(tape, &m, x + row * in_dim, labels + row, batch, &loss) != FAHREN_SUCCESS ||
+                fahren_tape_backward(tape, loss) != FAHREN_SUCCESS) {
+                fprintf(stderr, "fahren_init_bench: tape too small\n");
+                rc = 1;
+                break;
+            }
+            double v = fahren_tape_value(tape, loss)[0];
+            if (step == 0) first = v;
+            sgd(&m, (float)lr);
+            window[step % BENCH_WINDOW] = isfinite(v) ? v : 1e30;
+            if (step + 1 >= BENCH_WINDOW) {
+                avg = 0.0;
+                for (int i = 0; i < BENCH_WINDOW; ++i) avg += window[i] / BENCH_WINDOW;
+                if (avg < target) {
+                    ++step;
+                    break;
+                }
+            }
+        }
+        double ms = now_ms() - t0;
+        if (avg < target) printf("%-11s %10.3g %8zu %11.1f %11.3g\n", schemes[k].name, first, step, ms, avg);
+        else printf("%-11s %10.3g %8s %11s %11.3g\n", schemes[k].name, first, "-", "not hit", avg);
+        model_free(&m);
+        if (rc) break;
+    }
+    fahren_tape_destroy(tape);
+    free(layers);
+    free(data);
+    free(x);
+    free(teacher);
+    free(labels);
+    return rc;
+}
@@ -0,0 +1,113 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* fahren_ipc_bench: round-trip latency against a running fahren_server.
+ *
+ *   fahren_ipc_bench [--name NAME] [--clients N] [--requests N] [--rows N]
+ *
+ * Each client thread has its own connection and issues requests back to
+ * back through the zero-copy request calls; the report gives latency
+ * percentiles over all requests and the aggregate request rate. */
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <fahren/ipc.h>
+
+typedef struct BenchClient {
+    const char* name;
+    size_t requests, rows;
+    double* lat_us;
+    FAHRENStatus status;
+} BenchClient;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec * 1e-3;
+}
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void* run_client(void* arg) {
+    BenchClient* b = (BenchClient*)arg;
+    FAHRENIpcClient* c;
+    b->status = fahren_ipc_connect(b->name, &c);
+    if (b->status != FAHREN_SUCCESS) return NULL;
+    size_t in_dim = fahren_ipc_input_dim(c);
+    for (size_t i = 0; i < b->requests && b->status == FAHREN_SUCCESS; ++i) {
+        FAHRENIpcRequest req;
+        double t0 = now_us();
+        b->status = fahren_ipc_request_begin(c, &req);
+        if (b->status != FAHREN_SUCCESS) break;
+        if (b->rows > req.max_rows) {
+            b->status = FAHREN_ERROR_INVALID_ARGUMENT;
+            fahren_ipc_request_end(c, &req);
+            break;
+        }
+        for (size_t k = 0; k < b->rows * in_dim; ++k) req.input[k] = (float)((i + k) % 7) * 0.125f;
+        b->status = fahren_ipc_request_submit(c, &req, b->rows);
+        if (b->status == FAHREN_SUCCESS) b->status = fahren_ipc_request_wait(c, &req);
+        fahren_ipc_request_end(c, &req);
+        b->lat_us[i] = now_us() - t0;
+    }
+    fahren_ipc_disconnect(c);
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    const char* name = "fahren";
+    size_t clients = 1, requests = 100000, rows = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--name") == 0) name = argv[i + 1];
+        else if (strcmp(argv[i], "--clients") == 0) clients = strtoul(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--requests") == 0) requests = strtoul(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--rows") == 0) rows = strtoul(argv[i + 1], NULL, 10);
+        else {
+            fprintf(stderr, "usage: fahren_ipc_bench [--name NAME] [--clients N] [--requests N] [--rows N]\n");
+            return 2;
+        }
+    }
+    if (clients == 0 || requests == 0 || rows == 0) return 2;
+
+    BenchClient* b = (BenchClient*)calloc(clients, sizeof(BenchClient));
+    pthread_t* th = (pthread_t*)calloc(clients, sizeof(pthread_t));
+    double* lat = (double*)calloc(clients * requests, sizeof(double));
+    if (!b || !th || !lat) return 1;
+
+    double t0 = now_us();
+    for (size_t i = 0; i < clients; ++i) {
+        b[i].name = name;
+        b[i].requests = requests;
+        b[i].rows = rows;
+        b[i].lat_us = lat + i * requests;
+        pthread_create(&th[i], NULL, run_client, &b[i]);
+    }
+    for (size_t i = 0; i < clients; ++i) pthread_join(th[i], NULL);
+    double elapsed = now_us() - t0;
+
+    for (size_t i = 0; i < clients; ++i) {
+        if (b[i].status != FAHREN_SUCCESS) {
+            fprintf(stderr, "fahren_ipc_bench: client %zu failed (status %d)\n", i, (int)b[i].status);
+            return 1;
+        }
+    }
+    size_t n = clients * requests;
+    qsort(lat, n, sizeof(double), cmp_double);
+    printf("requests %zu  rows %zu  clients %zu\n", n, rows, clients);
+    printf("round trip us: p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n", lat[n / 2], lat[n * 9 / 10],
+           lat[n * 99 / 100], lat[n - 1]);
+    printf("throughput: %.0f req/s\n", (double)n / (elapsed * 1e-6));
+    free(lat);
+    free(th);
+    free(b);
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* fahren_net_bench: load generator for fahren_server's socket front end.
+ *
+ *   fahren_net_bench --connect ADDR [--clients N] [--requests N]
+ *                    [--rows N] [--depth N]
+ *
+ * ADDR is "unix:PATH" or "host:port". Each client thread keeps `depth`
+ * requests in flight on its own connection; the report gives latency
+ * percentiles (send to response) and the aggregate rates. */
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <fahren/net.h>
+
+typedef struct BenchClient {
+    const char* address;
+    size_t requests, rows, depth;
+    double* lat_us;
+    FAHRENStatus status;
+} BenchClient;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec * 1e-3;
+}
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void* run_client(void* arg) {
+    BenchClient* b = (BenchClient*)arg;
+    FAHRENNetClient* c;
+    b->status = fahren_net_connect(b->address, &c);
+    if (b->status != FAHREN_SUCCESS) return NULL;
+    size_t in_dim = fahren_net_input_dim(c), out_dim = fahren_net_output_dim(c);
+    float* x = (float*)malloc(b->rows * in_dim * sizeof(float));
+    float* y = (float*)malloc(fahren_net_max_rows(c) * out_dim * sizeof(float));
+    double* sent = (double*)malloc(b->requests * sizeof(double));
+    if (!x || !y || !sent || b->rows > fahren_net_max_rows(c)) {
+        b->status = FAHREN_ERROR_INVALID_ARGUMENT;
+    } else {
+        for (size_t k = 0; k < b->rows * in_dim; ++k) x[k] = (float)(k % 7) * 0.125f;
+        size_t next = 0, done = 0;
+        while (done < b->requests && b->status == FAHREN_SUCCESS) {
+            while (next < b->requests && next - done < b->depth && b->status == FAHREN_SUCCESS) {
+                sent[next] = now_us();
+                b->status = fahren_net_send(c, (uint32_t)next, x, b->rows);
+                ++next;
+            }
+            if (b->status != FAHREN_SUCCESS) break;
+            uint32_t id;
+            b->status = fahren_net_recv(c, &id, y, NULL);
+            if (b->status == FAHREN_SUCCESS && id < b->requests) b->lat_us[done] = now_us() - sent[id];
+            ++done;
+        }
+    }
+    free(x);
+    free(y);
+    free(sent);
+    fahren_net_disconnect(c);
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    const char* address = NULL;
+    size_t clients = 1, requests = 100000, rows = 1, depth = 1;
+    int bad = argc % 2 == 0;
+    for (int i = 1; i + 1 < argc && !bad; i += 2) {
+        if (strcmp(argv[i], "--connect") == 0) address = argv[i + 1];
+        else if (strcmp(argv[i], "--clients") == 0) clients = strtoul(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--requests") == 0) requests = strtoul(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--rows") == 0) rows = strtoul(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--depth") == 0) depth = strtoul(argv[i + 1], NULL, 10);
+        else bad = 1;
+    }
+    if (bad || !address || clients == 0 || requests == 0 || rows == 0 || depth == 0) {
+        fprintf(stderr, "usage: fahren_net_bench --connect ADDR [--clients N] [--requests N] [--rows N] [--depth N]\n");
+        return 2;
+    }
+
+    BenchClient* b = (BenchClient*)calloc(clients, sizeof(BenchClient));
+    pthread_t* th = (pthread_t*)calloc(clients, sizeof(pthread_t));
+    double* lat = (double*)calloc(clients * requests, sizeof(double));
+    if (!b || !th || !lat) return 1;
+
+    double t0 = now_us();
+    for (size_t i = 0; i < clients; ++i) {
+        b[i].address = address;
+        b[i].requests = requests;
+        b[i].rows = rows;
+        b[i].depth = depth;
+        b[i].lat_us = lat + i * requests;
+        pthread_create(&th[i], NULL, run_client, &b[i]);
+    }
+    for (size_t i = 0; i < clients; ++i) pthread_join(th[i], NULL);
+    double elapsed = now_us() - t0;
+
+    for (size_t i = 0; i < clients; ++i) {
+        if (b[i].status != FAHREN_SUCCESS) {
+            fprintf(stderr, "fahren_net_bench: client %zu failed (status %d)\n", i, (int)b[i].status);
+            return 1;
+        }
+    }
+    size_t n = clients * requests;
+    qsort(lat, n, sizeof(double), cmp_double);
+    printf("requests %zu  rows %zu  clients %zu  depth %zu\n", n, rows, clients, depth);
+    printf("latency us: p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n", lat[n / 2], lat[n * 9 / 10], lat[n * 99 / 100],
+           lat[n - 1]);
+    printf("throughput: %.0f req/s, %.0f rows/s\n", (double)n / (elapsed * 1e-6),
+           (double)(n * rows) / (elapsed * 1e-6));
+    free(lat);
+    free(th);
+    free(b);
+    return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* fahren_server: serve a dense model to local processes over shared memory
+ * and, optionally, over TCP and Unix-domain sockets.
+ *
+ *   fahren_server --layers 784,256:relu,10:sigmoid [--weights FILE]
+ *                 [--name NAME] [--slots N] [--max-rows N]
+ *                 [--max-batch N] [--batch-window-us N]
+ *                 [--tcp [HOST:]PORT] [--unix PATH] [--loops N] [--no-shm]
+ *
+ * Without --weights the model runs on the random weights fahren_init
+ * writes to fahren_initial_model.bin. Shared-memory clients connect with
+ * fahren_ipc_connect(NAME), socket clients with fahren_net_connect. The
+ * batching options apply to both front ends. SIGINT/SIGTERM shut the
+ * server down. */
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fahren/fahren.h>
+#include <fahren/ipc.h>
+#include <fahren/net.h>
+#include <fahren/runtime.h>
+
+static FAHRENIpcServer* g_server;
+static FAHRENNetServer* g_net;
+
+static void on_signal(int sig) {
+    (void)sig;
+    fahren_ipc_server_stop(g_server);
+    fahren_net_server_stop(g_net);
+}
+
+static void* run_ipc(void* arg) {
+    (void)arg;
+    fahren_ipc_server_run(g_server);
+    return NULL;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: fahren_server --layers SPEC [--weights FILE] [--name NAME] [--slots N]\n"
+            "                     [--max-rows N] [--max-batch N] [--batch-window-us N]\n"
+            "                     [--tcp [HOST:]PORT] [--unix PATH] [--loops N] [--no-shm]\n");
+}
+
+int main(int argc, char** argv) {
+    const char* spec = NULL;
+    const char* weights = "fahren_initial_model.bin";
+    const char* name = "fahren";
+    int use_shm = 1;
+    FAHRENIpcServerConfig config;
+    FAHRENNetServerConfig net;
+    memset(&config, 0, sizeof(config));
+    memset(&net, 0, sizeof(net));
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--no-shm") == 0) {
+            use_shm = 0;
+            continue;
+        }
+        if (!val) {
+            usage();
+            return 2;
+        }
+        if (strcmp(arg, "--layers") == 0) spec = val;
+        else if (strcmp(arg, "--weights") == 0) weights = val;
+        else if (strcmp(arg, "--name") == 0) name = val;
+        else if (strcmp(arg, "--slots") == 0) config.slots = (unsigned)strtoul(val, NULL, 10);
+        else if (strcmp(arg, "--max-rows") == 0) config.max_rows = (unsigned)strtoul(val, NULL, 10);
+        else if (strcmp(arg, "--max-batch") == 0) config.max_batch_rows = (unsigned)strtoul(val, NULL, 10);
+        else if (strcmp(arg, "--batch-window-us") == 0) config.batch_window_us = (unsigned)strtoul(val, NULL, 10);
+        else if (strcmp(arg, "--tcp") == 0) net.tcp_address = val;
+        else if (strcmp(arg, "--unix") == 0) net.unix_path = val;
+        else if (strcmp(arg, "--loops") == 0) net.loops = (unsigned)strtoul(val, NULL, 10);
+        else {
+            usage();
+            return 2;
+        }
+        ++i;
+    }
+    int use_net = net.tcp_address || net.unix_path;
+    if (!spec || (!use_shm && !use_net)) {
+        usage();
+        return 2;
+    }
+    net.max_rows = config.max_rows;
+    net.max_batch_rows = config.max_batch_rows;
+    net.batch_window_us = config.batch_window_us;
+
+    FAHRENLayer* layers;
+    size_t count;
+    if (fahren_runtime_parse_layers(spec, &layers, &count) != FAHREN_SUCCESS) {
+        fprintf(stderr, "fahren_server: bad layer spec '%s'\n", spec);
+        return 2;
+    }
+    FAHREN cm;
+    memset(&cm, 0, sizeof(cm));
+    if (fahren_init(&cm, FAHREN_MODEL_SEQUENTIAL, count, layers) != FAHREN_SUCCESS) {
+        fprintf(stderr, "fahren_server: model init failed\n");
+        free(layers);
+        return 1;
+    }
+
+    FAHRENRuntime* rt = NULL;
+    FAHRENStatus st = fahren_runtime_create(&cm, weights, &rt);
+    /* fahren_shutdown would also sweep fahren_* files out of the working
+     * directory, this binary included; the layer array is all it owns. */
+    free(cm.layers);
+    if (st != FAHREN_SUCCESS) {
+        fprintf(stderr, "fahren_server: cannot load '%s' for this model (status %d)\n", weights, (int)st);
+        return 1;
+    }
+
+    if (use_shm) {
+        st = fahren_ipc_server_create(name, rt, &config, &g_server);
+        if (st != FAHREN_SUCCESS) {
+            fprintf(stderr, "fahren_server: cannot create shared memory '%s' (status %d)\n", name, (int)st);
+            fahren_runtime_destroy(rt);
+            return 1;
+        }
+    }
+    if (use_net) {
+        st = fahren_net_server_create(rt, &net, &g_net);
+        if (st != FAHREN_SUCCESS) {
+            fprintf(stderr, "fahren_server: cannot listen (status %d)\n", (int)st);
+            fahren_ipc_server_destroy(g_server);
+            fahren_runtime_destroy(rt);
+            return 1;
+        }
+    }
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    fprintf(stderr, "fahren_server: model %zu -> %zu\n", fahren_runtime_input_dim(rt), fahren_runtime_output_dim(rt));
+    if (use_shm) fprintf(stderr, "fahren_server: shared memory '%s'\n", name);
+    if (net.tcp_address) fprintf(stderr, "fahren_server: tcp port %d\n", fahren_net_server_tcp_port(g_net));
+    if (net.unix_path) fprintf(stderr, "fahren_server: unix socket %s\n", net.unix_path);
+
+    if (use_shm && use_net) {
+        pthread_t th;
+        if (pthread_create(&th, NULL, run_ipc, NULL) != 0) {
+            st = FAHREN_ERROR_PROCESSING_FAILED;
+        } else {
+            st = fahren_net_server_run(g_net);
+            fahren_ipc_server_stop(g_server);
+            pthread_join(th, NULL);
+        }
+    } else if (use_net) {
+        st = fahren_net_server_run(g_net);
+    } else {
+        st = fahren_ipc_server_run(g_server);
+    }
+    fahren_net_server_destroy(g_net);
+    fahren_ipc_server_destroy(g_server);
+    fahren_runtime_destroy(rt);
+    return st == FAHREN_SUCCESS ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+/*
+ * SPDX-License-Identifier: MIT
+ * Part of the FAHREN library; see LICENSE for the full text.
+ */
+
+/* fahren_static_bench: compile-time-shaped model (include/fahren/static.hpp)
+ * against the dynamic runtime on the same weights.
+ *
+ *   fahren_static_bench [--weights FILE] [--iters N]
+ *
+ * The model is fixed at compile time (Net below). Without --weights it is
+ * run on random weights written by fahren_init. Both paths are checked
+ * against each other, then timed at batch sizes 1, 4 and 64; the report
+ * gives ns per row for each. */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <fahren/fahren.h>
+#include <fahren/runtime.h>
+#include <fahren/static.hpp>
+
+using Net = fahren::Sequential<fahren::Input<32>, fahren::Dense<32, 64, FAHREN_ACTIVATION_RELU>,
+                               fahren::Dense<64, 64, FAHREN_ACTIVATION_RELU>,
+                               fahren::Dense<64, 8, FAHREN_ACTIVATION_SIGMOID>>;
+
+template <class F>
+static double ns_per_row(F&& run, std::size_t rows, std::size_t iters) {
+    run(); /* warm-up */
+    auto t0 = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iters; ++i) run();
+    std::chrono::duration<double, std::nano> dt = std::chrono::steady_clock::now() - t0;
+    return dt.count() / (double)(iters * rows);
+}
+
+int main(int argc, char** argv) {
+    const char* weights = "fahren_initial_model.bin";
+    std::size_t iters = 20000;
+    int bad = argc % 2 == 0;
+    for (int i = 1; i + 1 < argc && !bad; i += 2) {
+        if (std::strcmp(argv[i], "--weights") == 0) weights = argv[i + 1];
+        else if (std::strcmp(argv[i], "--iters") == 0) iters = std::strtoul(argv[i + 1], nullptr, 10);
+        else bad = 1;
+    }
+    if (bad || iters == 0) {
+        std::fprintf(stderr, "usage: fahren_static_bench [--weights FILE] [--iters N]\n");
+        return 2;
+    }
+
+    const std::string spec = Net::spec();
+    FAHRENLayer* layers;
+    std::size_t count;
+    if (fahren_runtime_parse_layers(spec.c_str(), &layers, &count) != FAHREN_SUCCESS) return 1;
+    FAHREN cm;
+    std::memset(&cm, 0, sizeof(cm));
+    FAHRENRuntime* rt = nullptr;
+    FAHRENStatus st = fahren_init(&cm, FAHREN_MODEL_SEQUENTIAL, count, layers);
+    if (st == FAHREN_SUCCESS) st = fahren_runtime_create(&cm, weights, &rt);
+    /* fahren_shutdown would also sweep fahren_* files out of the working
+     * directory; the layer array is all it owns. */
+    std::free(layers);
+    auto net = std::make_unique<Net>();
+    if (st == FAHREN_SUCCESS) st = net->load(weights);
+    if (st != FAHREN_SUCCESS) {
+        std::fprintf(stderr, "fahren_static_bench: cannot load '%s' as %s (status %d)\n", weights, spec.c_str(),
+                     (int)st);
+        fahren_runtime_destroy(rt);
+        return 1;
+    }
+
+    const std::size_t max_rows = 64;
+    std::vector<float> x(max_rows * Net::input_dim), ys(max_rows * Net::output_dim), yd(ys.size());
+    for (std::size_t i = 0; i < x.size(); ++i) x[i] = std::sin(0.37f * (float)i);
+    net->forward(x.data(), ys.data(), max_rows);
+    if (fahren_runtime_forward(rt, x.data(), max_rows, yd.data()) != FAHREN_SUCCESS) return 1;
+    double diff = 0.0;
+    for (std::size_t i = 0; i < ys.size(); ++i) diff = std::fmax(diff, std::fabs(ys[i] - yd[i]));
+
+    std::printf("model %s  max |static - runtime| %.3g\n", spec.c_str(), diff);
+    std::printf("%6s %14s %14s %8s\n", "batch", "static ns/row", "runtime ns/row", "speedup");
+    for (std::size_t rows : {std::size_t(1), std::size_t(4), max_rows}) {
+        std::size_t n = iters * 64 / rows / 4 + 1;
+        double s = ns_per_row([&] { net->forward(x.data(), ys.data(), rows); }, rows, n);
+        double d = ns_per_row([&] { (void)fahren_runtime_forward(rt, x.data(), rows, yd.data()); }, rows, n);
+        std::printf("%6zu %14.1f %14.1f %7.2fx\n", rows, s, d, d / s);
+    }
+    fahren_runtime_destroy(rt);
+    return diff < 1e-4 ? 0 : 1;
+}